@@ -0,0 +1,139 @@
+#include <string.h>
+#include "esp_check.h"
+#include "esp_log.h"
+#include "espcan_protocol.h"
+#include "espcan_filter.h"
+
+static const char *TAG = "espcan_filter";
+
+#define ESPCAN_FILTER_ID_BITS       0x7FF
+#define ESPCAN_FILTER1_SHIFT        21          // 过滤器1: ID在[31:21]，RTR在[20]
+#define ESPCAN_FILTER2_SHIFT        5           // 过滤器2: ID在[15:5]，RTR在[4]
+#define ESPCAN_FILTER_DATA_BITS     0x000F000F  // 过滤器1比较的第一个数据字节，不使用
+
+static const uint32_t s_bus_ids[] = ESPCAN_BUS_IDS;
+
+// 一个过滤器匹配的ID集合: (id & ~mask) == (code & ~mask)
+typedef struct {
+    uint32_t code;
+    uint32_t mask;
+} id_cube_t;
+
+static bool cube_match(const id_cube_t *cube, uint32_t id)
+{
+    return ((id ^ cube->code) & ~cube->mask & ESPCAN_FILTER_ID_BITS) == 0;
+}
+
+// 两个过滤器一起放过的ID数量
+static uint32_t union_size(const id_cube_t *a, const id_cube_t *b)
+{
+    uint32_t size = (1u << __builtin_popcount(a->mask)) + (1u << __builtin_popcount(b->mask));
+    if (((a->code ^ b->code) & ~(a->mask | b->mask) & ESPCAN_FILTER_ID_BITS) == 0) {
+        size -= 1u << __builtin_popcount(a->mask & b->mask);
+    }
+    return size;
+}
+
+static bool is_wanted(const uint32_t *ids, size_t count, uint32_t id)
+{
+    for (size_t i = 0; i < count; i++) {
+        if (ids[i] == id) {
+            return true;
+        }
+    }
+    return false;
+}
+
+esp_err_t espcan_filter_plan(const uint32_t *ids, size_t count, espcan_filter_plan_t *plan)
+{
+    ESP_RETURN_ON_FALSE(ids && plan && count > 0, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(count <= ESPCAN_MAX_HANDLERS, ESP_ERR_INVALID_SIZE, TAG, "too many ids");
+    for (size_t i = 0; i < count; i++) {
+        ESP_RETURN_ON_FALSE(ids[i] <= ESPCAN_FILTER_ID_BITS, ESP_ERR_INVALID_ARG, TAG,
+                            "id 0x%lX exceeds 11 bits", (unsigned long)ids[i]);
+    }
+
+    // 总线上其它节点的ID
+    uint32_t others[sizeof(s_bus_ids) / sizeof(s_bus_ids[0])];
+    size_t num_others = 0;
+    for (size_t i = 0; i < sizeof(s_bus_ids) / sizeof(s_bus_ids[0]); i++) {
+        if (!is_wanted(ids, count, s_bus_ids[i])) {
+            others[num_others++] = s_bus_ids[i];
+        }
+    }
+
+    // ids[0]固定在第一组，枚举其余ID的分组: groups的第i位为1表示ids[i + 1]在第二组
+    id_cube_t best[2] = {0};
+    uint32_t best_bus_false = UINT32_MAX;
+    uint32_t best_size = UINT32_MAX;
+    uint32_t num_groups = 1u << (count - 1);
+
+    for (uint32_t groups = 0; groups < num_groups; groups++) {
+        id_cube_t cube[2] = {{.code = ids[0]}, {0}};
+        bool second_used = false;
+        for (size_t i = 1; i < count; i++) {
+            id_cube_t *c = &cube[(groups >> (i - 1)) & 1];
+            if (c == &cube[1] && !second_used) {
+                c->code = ids[i];
+                second_used = true;
+            }
+            c->mask |= ids[i] ^ c->code;
+        }
+        if (!second_used) {
+            cube[1] = cube[0];
+        }
+
+        uint32_t bus_false = 0;
+        for (size_t i = 0; i < num_others; i++) {
+            if (cube_match(&cube[0], others[i]) || cube_match(&cube[1], others[i])) {
+                bus_false++;
+            }
+        }
+        uint32_t size = union_size(&cube[0], &cube[1]);
+
+        if (bus_false < best_bus_false || (bus_false == best_bus_false && size < best_size)) {
+            best_bus_false = bus_false;
+            best_size = size;
+            best[0] = cube[0];
+            best[1] = cube[1];
+        }
+    }
+
+    // RTR位必须为0 (远程帧不分发)，第一个数据字节任意
+    memset(plan, 0, sizeof(*plan));
+    for (int i = 0; i < 2; i++) {
+        plan->filter_mask[i] = best[i].mask & ESPCAN_FILTER_ID_BITS;
+        plan->filter_id[i] = best[i].code & ~best[i].mask & ESPCAN_FILTER_ID_BITS;
+    }
+    plan->config.acceptance_code = ((uint32_t)plan->filter_id[0] << ESPCAN_FILTER1_SHIFT) |
+                                   ((uint32_t)plan->filter_id[1] << ESPCAN_FILTER2_SHIFT);
+    plan->config.acceptance_mask = ((uint32_t)plan->filter_mask[0] << ESPCAN_FILTER1_SHIFT) |
+                                   ((uint32_t)plan->filter_mask[1] << ESPCAN_FILTER2_SHIFT) |
+                                   ESPCAN_FILTER_DATA_BITS;
+    plan->config.single_filter = false;
+    plan->wanted_ids = count;
+    plan->accepted_ids = best_size;
+    plan->bus_false_ids = best_bus_false;
+    plan->bus_other_ids = num_others;
+    return ESP_OK;
+}
+
+esp_err_t espcan_filter_plan_registered(espcan_filter_plan_t *plan)
+{
+    uint32_t ids[ESPCAN_MAX_HANDLERS];
+    size_t count = espcan_get_registered_ids(ids, ESPCAN_MAX_HANDLERS);
+    ESP_RETURN_ON_FALSE(count > 0, ESP_ERR_INVALID_STATE, TAG, "no handler registered");
+    ESP_RETURN_ON_ERROR(espcan_filter_plan(ids, count, plan), TAG, "plan failed");
+
+    // 误收率: 放过的不需要的ID占所有不需要的ID的比例，以及总线上其它节点ID的误收数
+    uint32_t false_ids = plan->accepted_ids - plan->wanted_ids;
+    ESP_LOGI(TAG, "filter 0x%03X/0x%03X + 0x%03X/0x%03X (code 0x%08lX mask 0x%08lX)",
+             plan->filter_id[0], plan->filter_mask[0], plan->filter_id[1], plan->filter_mask[1],
+             (unsigned long)plan->config.acceptance_code, (unsigned long)plan->config.acceptance_mask);
+    ESP_LOGI(TAG, "%u ids wanted, %u accepted: %lu false (%lu.%02lu%% of unwanted), %u/%u bus ids of other nodes",
+             plan->wanted_ids, plan->accepted_ids, (unsigned long)false_ids,
+             (unsigned long)(false_ids * 100 / (ESPCAN_STD_ID_COUNT - plan->wanted_ids)),
+             (unsigned long)(false_ids * 10000 / (ESPCAN_STD_ID_COUNT - plan->wanted_ids) % 100),
+             plan->bus_false_ids, plan->bus_other_ids);
+    return ESP_OK;
+}
@@ -0,0 +1,101 @@
+#include <string.h>
+#include "esp_check.h"
+#include "esp_log.h"
+#include "espcan_protocol.h"
+
+static const char *TAG = "espcan_protocol";
+
+#define ESPCAN_STD_ID_MASK  (ESPCAN_STD_ID_COUNT - 1)
+#define ESPCAN_NO_HANDLER   0
+
+typedef struct {
+    uint32_t id;
+    espcan_handler_t handler;
+    void *arg;
+} espcan_handler_entry_t;
+
+// ID -> 处理函数序号+1 (0为未注册)。每个ID一个字节，分发时只查一次表
+static uint8_t s_handler_index[ESPCAN_STD_ID_COUNT];
+static espcan_handler_entry_t s_handlers[ESPCAN_MAX_HANDLERS];
+static size_t s_num_handlers = 0;
+static espcan_handler_t s_default_handler = NULL;
+static void *s_default_arg = NULL;
+
+esp_err_t espcan_encode(uint32_t id, const void *payload, size_t len, twai_message_t *message)
+{
+    ESP_RETURN_ON_FALSE(message && (payload || len == 0), ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(id <= ESPCAN_STD_ID_MASK, ESP_ERR_INVALID_ARG, TAG, "id 0x%lX exceeds 11 bits", (unsigned long)id);
+    ESP_RETURN_ON_FALSE(len <= sizeof(message->data), ESP_ERR_INVALID_SIZE, TAG, "payload too long");
+
+    memset(message, 0, sizeof(*message));
+    message->identifier = id;
+    message->ss = 1;        // 单次发送，总线错误时不重发过期命令
+    message->data_length_code = len;
+    memcpy(message->data, payload, len);
+    return ESP_OK;
+}
+
+esp_err_t espcan_decode(const twai_message_t *message, size_t min_len, void *payload, size_t size)
+{
+    ESP_RETURN_ON_FALSE(message && payload, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    if (message->rtr || message->data_length_code < min_len) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    size_t len = message->data_length_code < size ? message->data_length_code : size;
+    memcpy(payload, message->data, len);
+    return ESP_OK;
+}
+
+esp_err_t espcan_register_handler(uint32_t id, espcan_handler_t handler, void *arg)
+{
+    ESP_RETURN_ON_FALSE(handler, ESP_ERR_INVALID_ARG, TAG, "invalid handler");
+    ESP_RETURN_ON_FALSE(id <= ESPCAN_STD_ID_MASK, ESP_ERR_INVALID_ARG, TAG, "id 0x%lX exceeds 11 bits", (unsigned long)id);
+
+    uint8_t index = s_handler_index[id];
+    if (index == ESPCAN_NO_HANDLER) {
+        ESP_RETURN_ON_FALSE(s_num_handlers < ESPCAN_MAX_HANDLERS, ESP_ERR_NO_MEM, TAG, "handler table full");
+        index = ++s_num_handlers;
+    }
+
+    s_handlers[index - 1] = (espcan_handler_entry_t) {
+        .id = id,
+        .handler = handler,
+        .arg = arg,
+    };
+    s_handler_index[id] = index;
+    return ESP_OK;
+}
+
+size_t espcan_get_registered_ids(uint32_t *ids, size_t max_ids)
+{
+    for (size_t i = 0; i < s_num_handlers && i < max_ids; i++) {
+        ids[i] = s_handlers[i].id;
+    }
+    return s_num_handlers;
+}
+
+void espcan_set_default_handler(espcan_handler_t handler, void *arg)
+{
+    s_default_handler = handler;
+    s_default_arg = arg;
+}
+
+esp_err_t espcan_dispatch(const twai_message_t *message)
+{
+    uint8_t index = ESPCAN_NO_HANDLER;
+    if (!message->extd && !message->rtr) {
+        index = s_handler_index[message->identifier & ESPCAN_STD_ID_MASK];
+    }
+
+    if (index == ESPCAN_NO_HANDLER) {
+        if (s_default_handler) {
+            s_default_handler(message, s_default_arg);
+        }
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    const espcan_handler_entry_t *entry = &s_handlers[index - 1];
+    entry->handler(message, entry->arg);
+    return ESP_OK;
+}
@@ -0,0 +1,292 @@
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_check.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "espcan_protocol.h"
+#include "espcan_sync.h"
+
+static const char *TAG = "espcan_sync";
+
+// PI校正系数: 偏移每次修正误差的1/2，频率每次修正误差对应频偏的1/8 (主机仿真可用-D比较其他系数)
+#ifndef ESPCAN_CLOCK_KP_DIV
+#define ESPCAN_CLOCK_KP_DIV     2
+#endif
+#ifndef ESPCAN_CLOCK_KI_DIV
+#define ESPCAN_CLOCK_KI_DIV     8
+#endif
+
+static espcan_clock_t s_clock;
+static portMUX_TYPE s_clock_lock = portMUX_INITIALIZER_UNLOCKED;
+static bool s_master = false;
+
+// 主控: 最近发出的同步帧序号和自收时间
+static uint8_t s_sequence = 0;
+static uint8_t s_prev_sequence = 0;
+static uint32_t s_prev_time_us = 0;
+static bool s_prev_valid = false;
+
+// 节点: 上一个同步帧的序号和本地接收时间，等下一帧带来主控时间后组成样本
+static uint8_t s_last_sequence = 0;
+static int64_t s_last_rx_us = 0;
+static bool s_have_last = false;
+static int64_t s_last_sample_us = 0;
+
+// 生效定时器: 待执行的action和数据只在s_action_lock内读写，回调取出副本后在锁外执行
+static esp_timer_handle_t s_timer = NULL;
+static portMUX_TYPE s_action_lock = portMUX_INITIALIZER_UNLOCKED;
+static espcan_sync_action_t s_action = NULL;
+static uint8_t s_action_data[ESPCAN_SYNC_MAX_DATA];
+static int64_t s_action_due_us = 0;
+static uint32_t s_scheduled = 0;
+static uint32_t s_immediate = 0;
+
+void espcan_clock_reset(espcan_clock_t *clock)
+{
+    memset(clock, 0, sizeof(*clock));
+}
+
+uint32_t espcan_clock_to_master(const espcan_clock_t *clock, int64_t local_us)
+{
+    int64_t dt = local_us - clock->local_ref_us;
+    return clock->master_ref_us + (uint32_t)(dt + dt * clock->drift_ppb / 1000000000LL);
+}
+
+int64_t espcan_clock_to_local(const espcan_clock_t *clock, uint32_t master_us)
+{
+    int64_t dm = (int32_t)(master_us - clock->master_ref_us);
+    return clock->local_ref_us + dm - dm * clock->drift_ppb / 1000000000LL;
+}
+
+// 直接对齐到样本，保留已估计的频率
+static void clock_step(espcan_clock_t *clock, int64_t local_us, uint32_t master_us)
+{
+    clock->locked = true;
+    clock->local_ref_us = local_us;
+    clock->master_ref_us = master_us;
+    clock->outliers = 0;
+    clock->jitter_us = ESPCAN_SYNC_OUTLIER_US / 3;
+    clock->samples++;
+}
+
+void espcan_clock_update(espcan_clock_t *clock, int64_t local_us, uint32_t master_us)
+{
+    if (!clock->locked) {
+        clock_step(clock, local_us, master_us);
+        return;
+    }
+
+    int64_t interval_us = local_us - clock->local_ref_us;
+    if (interval_us <= 0) {
+        return;
+    }
+
+    uint32_t predicted_us = espcan_clock_to_master(clock, local_us);
+    int32_t error_us = (int32_t)(master_us - predicted_us);
+    clock->last_error_us = error_us;
+
+    uint32_t threshold_us = clock->jitter_us * 3;
+    if (threshold_us < ESPCAN_SYNC_OUTLIER_MIN_US) {
+        threshold_us = ESPCAN_SYNC_OUTLIER_MIN_US;
+    } else if (threshold_us > ESPCAN_SYNC_OUTLIER_US) {
+        threshold_us = ESPCAN_SYNC_OUTLIER_US;
+    }
+
+    uint32_t abs_error_us = error_us < 0 ? -error_us : error_us;
+    if (abs_error_us > threshold_us) {
+        // 接收任务被抢占等造成的异常时间戳是随机的；连续几次偏差一致说明时钟真的跳变了
+        int32_t diff_us = error_us - clock->outlier_error_us;
+        if (clock->outliers > 0 && (diff_us > (int32_t)threshold_us || diff_us < -(int32_t)threshold_us)) {
+            clock->outliers = 0;
+        }
+        clock->outlier_error_us = error_us;
+        clock->rejected++;
+        if (++clock->outliers >= ESPCAN_SYNC_MAX_OUTLIERS) {
+            clock_step(clock, local_us, master_us);
+        }
+        return;
+    }
+    clock->outliers = 0;
+    clock->jitter_us += ((int32_t)abs_error_us - (int32_t)clock->jitter_us) / 16;
+
+    int64_t drift_ppb = clock->drift_ppb + error_us * 1000000000LL / interval_us / ESPCAN_CLOCK_KI_DIV;
+    if (drift_ppb > ESPCAN_SYNC_MAX_DRIFT_PPB) {
+        drift_ppb = ESPCAN_SYNC_MAX_DRIFT_PPB;
+    } else if (drift_ppb < -ESPCAN_SYNC_MAX_DRIFT_PPB) {
+        drift_ppb = -ESPCAN_SYNC_MAX_DRIFT_PPB;
+    }
+    clock->drift_ppb = (int32_t)drift_ppb;
+
+    clock->local_ref_us = local_us;
+    clock->master_ref_us = predicted_us + error_us / ESPCAN_CLOCK_KP_DIV;
+    clock->samples++;
+}
+
+// 主控收到自己发出的同步帧
+static void handle_master_sync(const twai_message_t *message, void *arg)
+{
+    int64_t now_us = esp_timer_get_time();
+    espcan_time_sync_t sync;
+    if (espcan_decode_time_sync(message, &sync) != ESP_OK || sync.sequence != s_sequence) {
+        return;
+    }
+    s_prev_sequence = sync.sequence;
+    s_prev_time_us = (uint32_t)now_us;
+    s_prev_valid = true;
+}
+
+// 节点收到同步帧: 本帧记录接收时间，帧中带的是上一帧的主控时间
+static void handle_node_sync(const twai_message_t *message, void *arg)
+{
+    int64_t now_us = esp_timer_get_time();
+    espcan_time_sync_t sync;
+    if (espcan_decode_time_sync(message, &sync) != ESP_OK) {
+        return;
+    }
+
+    if (s_have_last && sync.prev_sequence != sync.sequence && sync.prev_sequence == s_last_sequence) {
+        portENTER_CRITICAL(&s_clock_lock);
+        espcan_clock_update(&s_clock, s_last_rx_us, sync.prev_time_us);
+        espcan_clock_t clock = s_clock;
+        portEXIT_CRITICAL(&s_clock_lock);
+        s_last_sample_us = now_us;
+
+        ESP_LOGD(TAG, "sync #%d: error %ldus, drift %ldppb", sync.prev_sequence,
+                 (long)clock.last_error_us, (long)clock.drift_ppb);
+    }
+
+    s_last_sequence = sync.sequence;
+    s_last_rx_us = now_us;
+    s_have_last = true;
+}
+
+static void activate_timer_cb(void *arg)
+{
+    uint8_t data[ESPCAN_SYNC_MAX_DATA];
+    espcan_sync_action_t action = NULL;
+    int64_t now_us = esp_timer_get_time();
+
+    // esp_timer_stop不等待正在执行的回调: 旧定时器的回调可能在espcan_sync_run_at换上新action之后
+    // 才进锁，这时还没到新action的生效时间，留给新定时器执行
+    portENTER_CRITICAL(&s_action_lock);
+    if (s_action && now_us >= s_action_due_us) {
+        action = s_action;
+        memcpy(data, s_action_data, sizeof(data));
+        s_action = NULL;
+    }
+    portEXIT_CRITICAL(&s_action_lock);
+
+    if (action) {
+        action(data);
+    }
+}
+
+esp_err_t espcan_sync_master_init(void)
+{
+    s_master = true;
+    return espcan_register_handler(ESPCAN_ID_TIME_SYNC, handle_master_sync, NULL);
+}
+
+esp_err_t espcan_sync_master_build(twai_message_t *message)
+{
+    ESP_RETURN_ON_FALSE(s_master, ESP_ERR_INVALID_STATE, TAG, "not initialized as master");
+
+    s_sequence++;
+    espcan_time_sync_t sync = {
+        .sequence = s_sequence,
+        .prev_sequence = s_prev_valid ? s_prev_sequence : s_sequence,
+        .prev_time_us = s_prev_time_us,
+    };
+    ESP_RETURN_ON_ERROR(espcan_encode_time_sync(&sync, message), TAG, "encode failed");
+    message->self = 1;      // 自收: 主控和节点在同一时刻取接收时间戳
+    return ESP_OK;
+}
+
+esp_err_t espcan_sync_init(void)
+{
+    if (s_timer == NULL) {
+        const esp_timer_create_args_t timer_args = {
+            .callback = activate_timer_cb,
+            .name = "espcan_activate",
+        };
+        ESP_RETURN_ON_ERROR(esp_timer_create(&timer_args, &s_timer), TAG, "create timer failed");
+    }
+    espcan_clock_reset(&s_clock);
+    return espcan_register_handler(ESPCAN_ID_TIME_SYNC, handle_node_sync, NULL);
+}
+
+bool espcan_sync_locked(void)
+{
+    if (s_master) {
+        return true;
+    }
+    return s_clock.locked && esp_timer_get_time() - s_last_sample_us < ESPCAN_SYNC_TIMEOUT_MS * 1000LL;
+}
+
+uint32_t espcan_sync_now(void)
+{
+    int64_t now_us = esp_timer_get_time();
+    if (s_master || !espcan_sync_locked()) {
+        return (uint32_t)now_us;
+    }
+
+    portENTER_CRITICAL(&s_clock_lock);
+    uint32_t master_us = espcan_clock_to_master(&s_clock, now_us);
+    portEXIT_CRITICAL(&s_clock_lock);
+    return master_us;
+}
+
+esp_err_t espcan_sync_run_at(uint16_t activate_tick, espcan_sync_action_t action, const void *data, size_t len)
+{
+    ESP_RETURN_ON_FALSE(action && (data || len == 0), ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(len <= ESPCAN_SYNC_MAX_DATA, ESP_ERR_INVALID_SIZE, TAG, "data too long");
+    ESP_RETURN_ON_FALSE(s_timer, ESP_ERR_INVALID_STATE, TAG, "not initialized");
+
+    // 替换还没执行的旧action
+    esp_timer_stop(s_timer);
+    portENTER_CRITICAL(&s_action_lock);
+    s_action = NULL;
+    portEXIT_CRITICAL(&s_action_lock);
+
+    int64_t now_us = esp_timer_get_time();
+    int64_t delay_us = 0;
+    if (espcan_sync_locked()) {
+        portENTER_CRITICAL(&s_clock_lock);
+        espcan_clock_t clock = s_clock;
+        portEXIT_CRITICAL(&s_clock_lock);
+
+        uint32_t target_us = espcan_sync_tick_to_us(activate_tick, espcan_clock_to_master(&clock, now_us));
+        delay_us = espcan_clock_to_local(&clock, target_us) - now_us;
+    }
+
+    if (delay_us <= 0 || delay_us > ESPCAN_SYNC_MAX_DELAY_US) {
+        s_immediate++;
+        action(data);
+        return ESP_OK;
+    }
+
+    portENTER_CRITICAL(&s_action_lock);
+    s_action = action;
+    memcpy(s_action_data, data, len);
+    s_action_due_us = now_us + delay_us;
+    portEXIT_CRITICAL(&s_action_lock);
+    s_scheduled++;
+    return esp_timer_start_once(s_timer, delay_us);
+}
+
+void espcan_sync_get_stats(espcan_sync_stats_t *stats)
+{
+    portENTER_CRITICAL(&s_clock_lock);
+    espcan_clock_t clock = s_clock;
+    portEXIT_CRITICAL(&s_clock_lock);
+
+    *stats = (espcan_sync_stats_t) {
+        .locked = espcan_sync_locked(),
+        .last_error_us = clock.last_error_us,
+        .drift_ppb = clock.drift_ppb,
+        .samples = clock.samples,
+        .rejected = clock.rejected,
+        .scheduled = s_scheduled,
+        .immediate = s_immediate,
+    };
+}
@@ -0,0 +1,209 @@
+// 解码+分发的吞吐量 (帧/秒): 1024个预先编码的帧，轮流使用六种命令ID和一个未注册的ID，
+// 处理函数解码负载并累加到结果中。比较分发表和各节点原来的if/else链，以及注册满16个处理函数后的分发表
+// 500kbit/s总线上每秒最多约8000帧，打印为对比
+
+#include <stdio.h>
+#include <string.h>
+#include "host_test.h"
+#include "espcan_protocol.h"
+
+#define BENCH_FRAMES 1024
+#define BENCH_ITERATIONS 20000
+#define BENCH_ROUNDS 5
+#define BENCH_QUICK_ITERATIONS 20
+#define BENCH_BUS_FRAMES_PER_S 8000
+#define BENCH_UNKNOWN_ID 0x555
+
+typedef struct {
+    uint32_t frames[8];     // 按消息类型计数，最后一项为未注册的ID
+    uint32_t sum;           // 解码出的字段之和，避免解码被优化掉
+} bench_sink_t;
+
+enum {
+    SINK_LED, SINK_EMOTION, SINK_RANDOM, SINK_MOTOR, SINK_FOGGER, SINK_SCENE, SINK_UNKNOWN = 7,
+};
+
+static twai_message_t s_frames[BENCH_FRAMES];
+
+static void handle_led(const twai_message_t *message, void *arg)
+{
+    bench_sink_t *sink = arg;
+    espcan_led_cmd_t cmd;
+    if (espcan_decode_led_cmd(message, &cmd) == ESP_OK) {
+        sink->frames[SINK_LED]++;
+        sink->sum += cmd.state;
+    }
+}
+
+static void handle_emotion(const twai_message_t *message, void *arg)
+{
+    bench_sink_t *sink = arg;
+    espcan_emotion_cmd_t cmd;
+    if (espcan_decode_emotion_cmd(message, &cmd) == ESP_OK) {
+        sink->frames[SINK_EMOTION]++;
+        sink->sum += cmd.emotion;
+    }
+}
+
+static void handle_random(const twai_message_t *message, void *arg)
+{
+    bench_sink_t *sink = arg;
+    espcan_random_cmd_t cmd = {.speed = 128, .brightness = 200};
+    if (espcan_decode_random_cmd(message, &cmd) == ESP_OK) {
+        sink->frames[SINK_RANDOM]++;
+        sink->sum += cmd.state + cmd.speed + cmd.brightness;
+    }
+}
+
+static void handle_motor(const twai_message_t *message, void *arg)
+{
+    bench_sink_t *sink = arg;
+    espcan_motor_cmd_t cmd = {.mode = ESPCAN_MOTOR_MODE_FIXED};
+    if (espcan_decode_motor_cmd(message, &cmd) == ESP_OK) {
+        sink->frames[SINK_MOTOR]++;
+        sink->sum += cmd.duty + cmd.on_off + cmd.mode;
+    }
+}
+
+static void handle_fogger(const twai_message_t *message, void *arg)
+{
+    bench_sink_t *sink = arg;
+    espcan_fogger_cmd_t cmd;
+    if (espcan_decode_fogger_cmd(message, &cmd) == ESP_OK) {
+        sink->frames[SINK_FOGGER]++;
+        sink->sum += cmd.state;
+    }
+}
+
+static void handle_scene(const twai_message_t *message, void *arg)
+{
+    bench_sink_t *sink = arg;
+    espcan_scene_t scene;
+    if (espcan_decode_scene(message, &scene) == ESP_OK) {
+        sink->frames[SINK_SCENE]++;
+        sink->sum += scene.emotion + scene.flags + scene.motor_duty + scene.activate_tick;
+    }
+}
+
+static void handle_unknown(const twai_message_t *message, void *arg)
+{
+    bench_sink_t *sink = arg;
+    (void)message;
+    sink->frames[SINK_UNKNOWN]++;
+}
+
+static void dispatch_table(void *arg)
+{
+    (void)arg;
+    for (int i = 0; i < BENCH_FRAMES; i++) {
+        espcan_dispatch(&s_frames[i]);
+    }
+}
+
+// 各节点原来的接收循环: 按ID逐个比较
+static void dispatch_chain(void *arg)
+{
+    for (int i = 0; i < BENCH_FRAMES; i++) {
+        const twai_message_t *message = &s_frames[i];
+        if (message->extd || message->rtr) {
+            handle_unknown(message, arg);
+        } else if (message->identifier == ESPCAN_ID_LED_CMD) {
+            handle_led(message, arg);
+        } else if (message->identifier == ESPCAN_ID_EMOTION_CMD) {
+            handle_emotion(message, arg);
+        } else if (message->identifier == ESPCAN_ID_RANDOM_CMD) {
+            handle_random(message, arg);
+        } else if (message->identifier == ESPCAN_ID_MOTOR_CMD) {
+            handle_motor(message, arg);
+        } else if (message->identifier == ESPCAN_ID_FOGGER_CMD) {
+            handle_fogger(message, arg);
+        } else if (message->identifier == ESPCAN_ID_SCENE) {
+            handle_scene(message, arg);
+        } else {
+            handle_unknown(message, arg);
+        }
+    }
+}
+
+static void build_frames(void)
+{
+    for (int i = 0; i < BENCH_FRAMES; i++) {
+        uint8_t v = (uint8_t)(i * 37);
+        twai_message_t *message = &s_frames[i];
+        switch (i % 7) {
+        case 0:
+            espcan_encode_led_cmd(&(espcan_led_cmd_t){.state = v & 1}, message);
+            break;
+        case 1:
+            espcan_encode_emotion_cmd(&(espcan_emotion_cmd_t){.emotion = v % 5}, message);
+            break;
+        case 2:
+            // 只带必需字段的随机效果命令
+            espcan_encode(ESPCAN_ID_RANDOM_CMD, &(espcan_random_cmd_t){.state = 1}, 1, message);
+            break;
+        case 3:
+            espcan_encode_motor_cmd(&(espcan_motor_cmd_t){.duty = v, .on_off = 1, .mode = v & 1}, message);
+            break;
+        case 4:
+            espcan_encode_fogger_cmd(&(espcan_fogger_cmd_t){.state = v & 1}, message);
+            break;
+        case 5:
+            espcan_encode_scene(&(espcan_scene_t){.emotion = v % 5, .flags = v, .motor_duty = v, .activate_tick = i},
+                                message);
+            break;
+        default:
+            espcan_encode(BENCH_UNKNOWN_ID, &v, 1, message);
+            break;
+        }
+    }
+}
+
+// 每轮的帧数按类型计数，分发表和if/else链必须得到相同的结果
+static bool sink_matches(const bench_sink_t *sink, const bench_sink_t *expected, uint64_t passes)
+{
+    for (int k = 0; k < 8; k++) {
+        if (sink->frames[k] != expected->frames[k] * passes) {
+            return false;
+        }
+    }
+    return (uint32_t)(sink->sum - expected->sum * passes) == 0;
+}
+
+int main(int argc, char **argv)
+{
+    static bench_sink_t expected;
+    static bench_sink_t sink;
+    bool quick = host_bench_quick(argc, argv);
+    uint32_t iterations = quick ? BENCH_QUICK_ITERATIONS : BENCH_ITERATIONS;
+    int rounds = quick ? 1 : BENCH_ROUNDS;
+
+    build_frames();
+    dispatch_chain(&expected);
+
+    HOST_CHECK_EQ(espcan_register_handler(ESPCAN_ID_LED_CMD, handle_led, &sink), ESP_OK);
+    HOST_CHECK_EQ(espcan_register_handler(ESPCAN_ID_EMOTION_CMD, handle_emotion, &sink), ESP_OK);
+    HOST_CHECK_EQ(espcan_register_handler(ESPCAN_ID_RANDOM_CMD, handle_random, &sink), ESP_OK);
+    HOST_CHECK_EQ(espcan_register_handler(ESPCAN_ID_MOTOR_CMD, handle_motor, &sink), ESP_OK);
+    HOST_CHECK_EQ(espcan_register_handler(ESPCAN_ID_FOGGER_CMD, handle_fogger, &sink), ESP_OK);
+    HOST_CHECK_EQ(espcan_register_handler(ESPCAN_ID_SCENE, handle_scene, &sink), ESP_OK);
+    espcan_set_default_handler(handle_unknown, &sink);
+
+    printf("%-22s %14s %9s %12s\n", "case", "frames/s", "ns/frame", "x bus rate");
+    for (int k = 0; k < 3; k++) {
+        const char *name = k == 0 ? "table, 6 handlers" : k == 1 ? "if/else chain" : "table, 16 handlers";
+        if (k == 2) {
+            // 填满处理函数表，查表的开销不随ID数量变化
+            for (uint32_t id = 0x600; espcan_get_registered_ids(NULL, 0) < ESPCAN_MAX_HANDLERS; id++) {
+                HOST_CHECK_EQ(espcan_register_handler(id, handle_unknown, &sink), ESP_OK);
+            }
+        }
+        memset(&sink, 0, sizeof(sink));
+        double ns = host_bench_run(k == 1 ? dispatch_chain : dispatch_table, &sink, iterations, rounds);
+        HOST_CHECK(sink_matches(&sink, &expected, (uint64_t)iterations * rounds));
+        double frames_per_s = BENCH_FRAMES * 1e9 / ns;
+        HOST_CHECK(frames_per_s > 100.0 * BENCH_BUS_FRAMES_PER_S);
+        printf("%-22s %14.0f %9.2f %12.0f\n", name, frames_per_s, ns / BENCH_FRAMES,
+               frames_per_s / BENCH_BUS_FRAMES_PER_S);
+    }
+    return host_test_finish("bench_espcan_dispatch");
+}
@@ -0,0 +1,387 @@
+// 总线时间同步仿真: 主控每sync_s秒广播同步帧 (自收时间戳)，6个节点的本地时钟有±50ppm频偏和温漂，
+// 主控的esp_timer在开始20s后越过32位回绕。场景帧带40ms后的生效时间，统计各节点实际执行时刻之差 (skew)，
+// 与收到即执行 (旧代码) 对比。每种情况仿真4小时，前60s不统计
+//
+// 节点0走组件的完整路径: espcan_sync_init注册的处理函数收同步帧，espcan_sync_run_at在虚拟时间的esp_timer中执行；
+// 其余节点直接调用同样的espcan_clock_*。修改espcan_sync.c中的PI系数后重新运行即可比较
+//
+// 接收时间戳 = 帧结束 + 40us + 指数分布的驱动/调度延迟 (均值15us) + 按概率出现的任务抢占 + 循环末尾的延时；
+// 定时器执行延迟5-30us，1%的情况再加最多200us
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "host_test.h"
+#include "host_idf.h"
+#include "esp_timer.h"
+#include "espcan_protocol.h"
+#include "espcan_sync.h"
+
+#define SIM_NODES 6
+#define SIM_HOURS 4
+#define SIM_MASTER_START_US (4294967296.0 - 20e6)   // 主控时间20s后回绕
+#define SIM_MAX_DRIFT_PPM 50
+#define SIM_WANDER_PPM 0.02                         // 温漂: 每秒频偏随机游走的标准差
+#define SIM_SCENE_LEAD_US 40000                     // 主控取生效时间 = 提交时的同步时间 + 40ms
+#define SIM_SUBMIT_US 300                           // 主控提交到场景帧结束的时间
+#define SIM_SCENE_MIN_S 3                           // 场景间隔3-11s
+#define SIM_SCENE_SPAN_S 8
+#define SIM_WARMUP_US 60e6
+#define SIM_SKEW_LIMIT_US 1000                      // 目标: 各执行器相差1ms以内
+#define SIM_LOCK_US 100                             // 所有节点的时钟误差小于该值视为已对准
+#define SIM_MAX_RECOVERY_S 10                       // 主控重启后重新对准的时间上限
+
+typedef struct {
+    double spike_p;             // 接收任务被抢占的概率
+    double spike_max_us;        // 抢占时间 (均匀分布)
+    double loop_sleep_us;       // 接收循环末尾的延时 (旧代码为10ms)
+} sim_load_t;
+
+typedef struct {
+    const char *name;
+    sim_load_t load;
+    double sync_s;              // 同步帧周期
+    double reboot_s;            // 主控重启时间 (<0为不重启)
+    bool synced;                // true: skew p99必须小于1ms；false: 对照，必须做不到
+} sim_case_t;
+
+static const sim_case_t sim_cases[] = {
+    {"quiet, sync 1 s", {0, 0, 0}, 1, -1, true},
+    {"5% 0-3 ms spikes", {0.05, 3000, 0}, 1, -1, true},
+    {"20% 0-8 ms spikes", {0.20, 8000, 0}, 1, -1, true},
+    {"5% spikes, sync 5 s", {0.05, 3000, 0}, 5, -1, true},
+    {"5% spikes, reboot 2 h", {0.05, 3000, 0}, 1, 7200, true},
+    {"5% spikes, 10 ms sleep", {0.05, 3000, 10000}, 1, -1, false},
+};
+
+typedef struct {
+    double offset_us;           // local(t) = offset + t * (1 + drift)
+    double drift;
+    espcan_clock_t clock;       // 节点1..5的时钟模型 (节点0在组件内)
+    bool have_last;
+    uint8_t last_sequence;
+    int64_t last_rx_us;
+} sim_node_t;
+
+typedef struct {
+    double *values;
+    size_t count;
+    size_t capacity;
+} sim_stats_t;
+
+static sim_node_t s_nodes[SIM_NODES];
+static uint64_t s_rand = 88172645463325252ULL;
+
+// 节点0的生效定时器在场景之后才执行，执行时补上它的时刻并统计这一场景
+static struct {
+    bool pending;
+    bool counted;               // 超过预热时间，计入统计
+    double fire_us[SIM_NODES];
+    double receive_us[SIM_NODES];
+    uint32_t completed;
+} s_scene;
+static double s_timer_jitter_us;
+static sim_stats_t s_skew;
+static sim_stats_t s_on_receive;
+
+static double urand(void)
+{
+    s_rand ^= s_rand << 13;
+    s_rand ^= s_rand >> 7;
+    s_rand ^= s_rand << 17;
+    return (s_rand >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static double nrand(void)
+{
+    return sqrt(-2 * log(urand() + 1e-300)) * cos(2 * M_PI * urand());
+}
+
+static void stats_add(sim_stats_t *stats, double value)
+{
+    if (stats->count == stats->capacity) {
+        stats->capacity = stats->capacity ? stats->capacity * 2 : 1024;
+        stats->values = realloc(stats->values, stats->capacity * sizeof(double));
+    }
+    stats->values[stats->count++] = value;
+}
+
+static int compare_double(const void *a, const void *b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return x < y ? -1 : x > y;
+}
+
+// 排序后取百分位 (100为最大值)
+static double stats_percentile(sim_stats_t *stats, int percent)
+{
+    if (stats->count == 0) {
+        return 0;
+    }
+    qsort(stats->values, stats->count, sizeof(double), compare_double);
+    size_t index = stats->count * percent / 100;
+    return stats->values[index < stats->count ? index : stats->count - 1];
+}
+
+// 帧结束到接收任务取时间戳的延迟
+static double rx_latency(const sim_load_t *load)
+{
+    double latency = 40 - 15 * log(urand() + 1e-12);
+    if (urand() < load->spike_p) {
+        latency += urand() * load->spike_max_us;
+    }
+    return latency + urand() * load->loop_sleep_us;
+}
+
+static double timer_jitter(void)
+{
+    return 5 + urand() * 25 + (urand() < 0.01 ? urand() * 200 : 0);
+}
+
+static int64_t local_at(const sim_node_t *node, double t)
+{
+    return (int64_t)floor(node->offset_us + t * (1 + node->drift));
+}
+
+static double true_at(const sim_node_t *node, double local_us)
+{
+    return (local_us - node->offset_us) / (1 + node->drift);
+}
+
+// 节点0: 把虚拟时间推进到本地时间local_us (同一个接收循环按顺序处理帧，时间不会倒退)
+static int64_t node0_advance(int64_t local_us)
+{
+    int64_t now_us = esp_timer_get_time();
+    if (local_us > now_us) {
+        host_timer_advance(local_us - now_us);
+        now_us = local_us;
+    }
+    return now_us;
+}
+
+static void finish_scene(void)
+{
+    double lo = INFINITY;
+    double hi = -INFINITY;
+    double receive_lo = INFINITY;
+    double receive_hi = -INFINITY;
+    for (int i = 0; i < SIM_NODES; i++) {
+        lo = fmin(lo, s_scene.fire_us[i]);
+        hi = fmax(hi, s_scene.fire_us[i]);
+        receive_lo = fmin(receive_lo, s_scene.receive_us[i]);
+        receive_hi = fmax(receive_hi, s_scene.receive_us[i]);
+    }
+    if (s_scene.counted) {
+        stats_add(&s_skew, hi - lo);
+        stats_add(&s_on_receive, receive_hi - receive_lo);
+    }
+    s_scene.pending = false;
+    s_scene.completed++;
+}
+
+// 节点0的action: 在esp_timer回调中 (或未同步时在espcan_sync_run_at中) 执行
+static void node0_activate(const void *data)
+{
+    (void)data;
+    if (!s_scene.pending) {
+        return;
+    }
+    s_scene.fire_us[0] = true_at(&s_nodes[0], esp_timer_get_time()) + s_timer_jitter_us;
+    finish_scene();
+}
+
+// 节点1..5按espcan_sync_run_at的方法计算执行时刻
+static double node_fire_time(sim_node_t *node, int64_t now_us, uint16_t tick)
+{
+    int64_t delay_us = 0;
+    if (node->clock.locked) {
+        uint32_t target_us = espcan_sync_tick_to_us(tick, espcan_clock_to_master(&node->clock, now_us));
+        delay_us = espcan_clock_to_local(&node->clock, target_us) - now_us;
+    }
+    if (delay_us <= 0 || delay_us > ESPCAN_SYNC_MAX_DELAY_US) {
+        return true_at(node, now_us);
+    }
+    return true_at(node, now_us + delay_us) + timer_jitter();
+}
+
+static void run_case(const sim_case_t *c)
+{
+    double master_start_us = SIM_MASTER_START_US;
+    double end_us = SIM_HOURS * 3600e6;
+    double next_sync_us = 0.3e6;
+    double next_scene_us = 5e6;
+    double locked_at_us = -1;
+    double recovered_at_us = -1;
+    uint8_t sequence = 0;
+    uint8_t prev_sequence = 0;
+    uint32_t prev_time_us = 0;
+    bool prev_valid = false;
+    uint32_t scenes = 0;
+    sim_stats_t clock_error = {0};
+
+    s_skew.count = 0;
+    s_on_receive.count = 0;
+    memset(&s_scene, 0, sizeof(s_scene));
+    for (int i = 0; i < SIM_NODES; i++) {
+        sim_node_t *node = &s_nodes[i];
+        node->offset_us = urand() * 1e12;
+        node->drift = (urand() * 2 - 1) * SIM_MAX_DRIFT_PPM * 1e-6;
+        node->have_last = false;
+        espcan_clock_reset(&node->clock);
+    }
+    host_timer_use_virtual_time(local_at(&s_nodes[0], 0));
+    HOST_CHECK_EQ(espcan_sync_init(), ESP_OK);
+    espcan_sync_stats_t start_stats;
+    espcan_sync_get_stats(&start_stats);
+
+    while (next_sync_us < end_us || next_scene_us < end_us) {
+        if (next_sync_us <= next_scene_us) {
+            double t = next_sync_us;
+            if (c->reboot_s > 0 && t >= c->reboot_s * 1e6 && t - c->sync_s * 1e6 < c->reboot_s * 1e6) {
+                // 主控重启: 时间从0.3s开始，还没有自收时间
+                master_start_us = 0.3e6 - t;
+                prev_valid = false;
+            }
+            sequence++;
+            espcan_time_sync_t sync = {
+                .sequence = sequence,
+                .prev_sequence = prev_valid ? prev_sequence : sequence,
+                .prev_time_us = prev_time_us,
+            };
+            twai_message_t message;
+            HOST_CHECK_EQ(espcan_encode_time_sync(&sync, &message), ESP_OK);
+            // 主控自收本帧的时间在下一帧中发出
+            prev_sequence = sequence;
+            prev_time_us = (uint32_t)(uint64_t)(master_start_us + t + rx_latency(&c->load));
+            prev_valid = true;
+
+            double worst_us = 0;
+            bool all_locked = true;
+            for (int i = 0; i < SIM_NODES; i++) {
+                sim_node_t *node = &s_nodes[i];
+                double error_us;
+                bool locked;
+                if (i == 0) {
+                    int64_t rx_us = node0_advance(local_at(node, t + rx_latency(&c->load)));
+                    espcan_dispatch(&message);
+                    error_us = (int32_t)(espcan_sync_now() - (uint32_t)(uint64_t)(master_start_us + true_at(node, rx_us)));
+                    locked = espcan_sync_locked();
+                } else {
+                    int64_t rx_us = local_at(node, t + rx_latency(&c->load));
+                    if (node->have_last && sync.prev_sequence != sync.sequence && sync.prev_sequence == node->last_sequence) {
+                        espcan_clock_update(&node->clock, node->last_rx_us, sync.prev_time_us);
+                    }
+                    node->last_sequence = sync.sequence;
+                    node->last_rx_us = rx_us;
+                    node->have_last = true;
+                    error_us = (int32_t)(espcan_clock_to_master(&node->clock, local_at(node, t)) -
+                                         (uint32_t)(uint64_t)(master_start_us + t));
+                    locked = node->clock.locked;
+                }
+                all_locked = all_locked && locked;
+                // 主控重启后到重新对准之前的误差是重启造成的跳变，不计入
+                bool rebooting = c->reboot_s > 0 && t >= c->reboot_s * 1e6 && recovered_at_us < 0;
+                if (t > SIM_WARMUP_US && locked && !rebooting) {
+                    stats_add(&clock_error, fabs(error_us));
+                }
+                worst_us = fmax(worst_us, fabs(error_us));
+                // 温漂，保持本地时钟连续
+                double step = nrand() * SIM_WANDER_PPM * 1e-6 * sqrt(c->sync_s);
+                node->offset_us -= t * step;
+                node->drift += step;
+            }
+            if (all_locked && worst_us < SIM_LOCK_US) {
+                if (locked_at_us < 0) {
+                    locked_at_us = t;
+                }
+                if (c->reboot_s > 0 && t > c->reboot_s * 1e6 && recovered_at_us < 0) {
+                    recovered_at_us = t;
+                }
+            }
+            next_sync_us += c->sync_s * 1e6;
+        } else {
+            double t = next_scene_us;
+            uint16_t tick = espcan_sync_tick((uint32_t)(uint64_t)(master_start_us + t - SIM_SUBMIT_US + SIM_SCENE_LEAD_US));
+            // 节点0先推进到收到场景帧的时刻，上一个场景必须已经由定时器执行，没有被替换
+            sim_node_t *node0 = &s_nodes[0];
+            int64_t rx0_us = node0_advance(local_at(node0, t + rx_latency(&c->load)));
+            HOST_CHECK(!s_scene.pending);
+            s_scene.pending = true;
+            s_scene.counted = t > SIM_WARMUP_US;
+            s_scene.receive_us[0] = true_at(node0, rx0_us);
+            for (int i = 1; i < SIM_NODES; i++) {
+                double rx_true_us = t + rx_latency(&c->load);
+                s_scene.receive_us[i] = rx_true_us;
+                s_scene.fire_us[i] = node_fire_time(&s_nodes[i], local_at(&s_nodes[i], rx_true_us), tick);
+            }
+            // 节点0的action可能立即执行并结束这一场景，最后提交
+            s_timer_jitter_us = timer_jitter();
+            HOST_CHECK_EQ(espcan_sync_run_at(tick, node0_activate, NULL, 0), ESP_OK);
+            scenes++;
+            next_scene_us += (SIM_SCENE_MIN_S + urand() * SIM_SCENE_SPAN_S) * 1e6;
+        }
+    }
+    // 执行最后一个场景
+    node0_advance(esp_timer_get_time() + ESPCAN_SYNC_MAX_DELAY_US);
+
+    espcan_sync_stats_t stats;
+    espcan_sync_get_stats(&stats);
+    double skew_p99 = stats_percentile(&s_skew, 99);
+    char lock_s[16] = "-";
+    if (locked_at_us >= 0) {
+        snprintf(lock_s, sizeof(lock_s), "%.0f", locked_at_us / 1e6);
+    }
+    printf("%-24s %6lu %6.0f %6.0f %6.0f   %6.0f %6.0f %6.0f   %5.0f %6.0f %6s\n", c->name,
+           (unsigned long)s_skew.count, stats_percentile(&s_skew, 50), skew_p99, stats_percentile(&s_skew, 100),
+           stats_percentile(&s_on_receive, 50), stats_percentile(&s_on_receive, 99),
+           stats_percentile(&s_on_receive, 100), stats_percentile(&clock_error, 99),
+           stats_percentile(&clock_error, 100), lock_s);
+    if (c->reboot_s > 0) {
+        printf("%24s clocks back within %dus %.0f s after the reboot\n", "", SIM_LOCK_US,
+               (recovered_at_us - c->reboot_s * 1e6) / 1e6);
+    }
+
+    // 节点0的每个场景都执行了，同步后都由定时器执行
+    HOST_CHECK_EQ(s_scene.completed, scenes);
+    if (c->synced) {
+        HOST_CHECK(skew_p99 < SIM_SKEW_LIMIT_US);
+        HOST_CHECK(locked_at_us >= 0 && locked_at_us < SIM_WARMUP_US);
+        HOST_CHECK(stats.scheduled - start_stats.scheduled >= s_skew.count);
+        if (c->reboot_s > 0) {
+            HOST_CHECK(recovered_at_us > 0 && recovered_at_us - c->reboot_s * 1e6 < SIM_MAX_RECOVERY_S * 1e6);
+        }
+    } else {
+        HOST_CHECK(skew_p99 > SIM_SKEW_LIMIT_US);
+    }
+    free(clock_error.values);
+}
+
+// 生效时间只带同步时钟的低16个单位，在32位回绕前后都要还原到同一时刻 (晚不超过一个单位)
+static void test_tick_wrap(void)
+{
+    uint32_t bad = 0;
+    for (uint64_t m = 4294967296ULL - 5000000; m < 4294967296ULL + 5000000; m += 997) {
+        uint32_t now_us = (uint32_t)m;
+        uint32_t target_us = now_us + SIM_SCENE_LEAD_US;
+        int32_t late_us = (int32_t)(espcan_sync_tick_to_us(espcan_sync_tick(target_us), now_us) - target_us);
+        bad += late_us < 0 || late_us >= 1 << ESPCAN_SYNC_TICK_SHIFT;
+    }
+    printf("tick round-trip across the 32-bit wrap: %lu bad\n", (unsigned long)bad);
+    HOST_CHECK_EQ(bad, 0);
+}
+
+int main(void)
+{
+    test_tick_wrap();
+    printf("%-24s %6s %20s   %20s   %19s\n", "", "", "skew (us)", "on receive (us)", "clock error (us)");
+    printf("%-24s %6s %6s %6s %6s   %6s %6s %6s   %5s %6s %6s\n", "case", "scenes", "p50", "p99", "max",
+           "p50", "p99", "max", "p99", "max", "lock s");
+    for (size_t i = 0; i < sizeof(sim_cases) / sizeof(sim_cases[0]); i++) {
+        run_case(&sim_cases[i]);
+    }
+    free(s_skew.values);
+    free(s_on_receive.values);
+    return host_test_finish("sim_espcan_sync");
+}
@@ -0,0 +1,158 @@
+// 接收过滤器规划: 按SJA1000双过滤器 (标准帧) 的寄存器位定义逐帧判断是否接收，对各节点实际注册的ID检查
+// 需要的ID在任意数据字节下都能收到，放过的ID数与规划一致，远程帧全部丢弃，误收的总线ID数与启动日志一致
+//
+// 寄存器布局 (ACR0..ACR3依次为acceptance_code的[31:24]..[7:0]，掩码位为1表示任意):
+// 过滤器1: ACR0 = ID[10:3]，ACR1[7:5] = ID[2:0]，ACR1[4] = RTR，ACR1[3:0] = 数据字节1[7:4]，ACR3[3:0] = 数据字节1[3:0]
+// 过滤器2: ACR2 = ID[10:3]，ACR3[7:5] = ID[2:0]，ACR3[4] = RTR
+
+#include <stdio.h>
+#include <string.h>
+#include "host_test.h"
+#include "espcan_protocol.h"
+#include "espcan_filter.h"
+
+typedef struct {
+    const char *name;
+    uint32_t ids[ESPCAN_MAX_HANDLERS];  // 按注册顺序，espcan_sync_init/espcan_sync_master_init最后注册TIME_SYNC
+    size_t count;
+    uint16_t accepted_ids;              // 启动日志中的放过ID数
+    uint16_t bus_false_ids;             // 启动日志中误收的其它节点ID数
+    uint16_t bus_other_ids;
+} node_case_t;
+
+static const node_case_t node_cases[] = {
+    {"espcan-light", {ESPCAN_ID_LED_CMD, ESPCAN_ID_EMOTION_CMD, ESPCAN_ID_RANDOM_CMD, ESPCAN_ID_SCENE, ESPCAN_ID_TIME_SYNC},
+     5, 320, 0, 3},
+    {"espcan-12V-sk6812", {ESPCAN_ID_LED_CMD, ESPCAN_ID_EMOTION_CMD, ESPCAN_ID_SCENE, ESPCAN_ID_RANDOM_CMD, ESPCAN_ID_TIME_SYNC},
+     5, 320, 0, 3},
+    {"espcan-light-12V-sk6812grbw", {ESPCAN_ID_LED_CMD, ESPCAN_ID_EMOTION_CMD, ESPCAN_ID_SCENE, ESPCAN_ID_TIME_SYNC},
+     4, 160, 0, 4},
+    {"espcan-sound", {ESPCAN_ID_EMOTION_CMD, ESPCAN_ID_SCENE, ESPCAN_ID_WOODEN_FISH_HIT, ESPCAN_ID_TIME_SYNC},
+     4, 48, 1, 4},
+    {"espcan-motor-fogger", {ESPCAN_ID_MOTOR_CMD, ESPCAN_ID_FOGGER_CMD, ESPCAN_ID_EMOTION_CMD, ESPCAN_ID_SCENE, ESPCAN_ID_TIME_SYNC},
+     5, 24, 0, 3},
+    {"espcan-fogger", {ESPCAN_ID_FOGGER_CMD, ESPCAN_ID_SCENE, ESPCAN_ID_TIME_SYNC}, 3, 9, 0, 5},
+    {"espcan-motor", {ESPCAN_ID_MOTOR_CMD, ESPCAN_ID_SCENE, ESPCAN_ID_TIME_SYNC}, 3, 3, 0, 5},
+    {"espcan-master-muyu", {ESPCAN_ID_MOTOR_CMD, ESPCAN_ID_FOGGER_CMD, ESPCAN_ID_TIME_SYNC}, 3, 3, 0, 5},
+};
+
+static const uint32_t s_bus_ids[] = ESPCAN_BUS_IDS;
+
+// 按寄存器定义判断一帧标准帧是否通过: 任一过滤器的所有非任意位都相等即接收
+static bool filter_accepts(const twai_filter_config_t *config, uint32_t id, bool rtr, uint8_t data0)
+{
+    uint8_t acr[4];
+    uint8_t amr[4];
+    for (int i = 0; i < 4; i++) {
+        acr[i] = config->acceptance_code >> (24 - 8 * i);
+        amr[i] = config->acceptance_mask >> (24 - 8 * i);
+    }
+
+    // 过滤器1比较的位: ACR0，ACR1，ACR3[3:0]
+    uint8_t frame1[3] = {id >> 3, (uint8_t)((id & 0x7) << 5 | rtr << 4 | data0 >> 4), data0 & 0x0F};
+    uint8_t code1[3] = {acr[0], acr[1], acr[3] & 0x0F};
+    uint8_t mask1[3] = {amr[0], amr[1], amr[3] | 0xF0};
+    bool match1 = true;
+    for (int i = 0; i < 3; i++) {
+        match1 &= ((frame1[i] ^ code1[i]) & ~mask1[i] & 0xFF) == 0;
+    }
+
+    // 过滤器2比较的位: ACR2，ACR3[7:4]
+    uint8_t frame2[2] = {id >> 3, (uint8_t)((id & 0x7) << 5 | rtr << 4)};
+    uint8_t code2[2] = {acr[2], acr[3] & 0xF0};
+    uint8_t mask2[2] = {amr[2], amr[3] | 0x0F};
+    bool match2 = true;
+    for (int i = 0; i < 2; i++) {
+        match2 &= ((frame2[i] ^ code2[i]) & ~mask2[i] & 0xFF) == 0;
+    }
+    return match1 || match2;
+}
+
+static bool is_in(const uint32_t *ids, size_t count, uint32_t id)
+{
+    for (size_t i = 0; i < count; i++) {
+        if (ids[i] == id) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void test_nodes(void)
+{
+    for (size_t n = 0; n < sizeof(node_cases) / sizeof(node_cases[0]); n++) {
+        const node_case_t *node = &node_cases[n];
+        espcan_filter_plan_t plan;
+        HOST_CHECK_EQ(espcan_filter_plan(node->ids, node->count, &plan), ESP_OK);
+        HOST_CHECK(!plan.config.single_filter);
+
+        uint32_t missed = 0;        // 需要的ID在某个数据字节下被丢弃
+        uint32_t accepted = 0;      // 任意数据字节下放过的数据帧ID
+        uint32_t partial = 0;       // 只在部分数据字节下放过的ID (数据字节应为任意)
+        uint32_t rtr_passed = 0;
+        uint32_t bus_false = 0;
+        for (uint32_t id = 0; id < ESPCAN_STD_ID_COUNT; id++) {
+            uint32_t data_passed = 0;
+            for (int data0 = 0; data0 < 256; data0++) {
+                data_passed += filter_accepts(&plan.config, id, false, data0);
+                rtr_passed += filter_accepts(&plan.config, id, true, data0);
+            }
+            bool wanted = is_in(node->ids, node->count, id);
+            missed += wanted && data_passed != 256;
+            partial += data_passed != 0 && data_passed != 256;
+            accepted += data_passed != 0;
+            bus_false += data_passed != 0 && !wanted && is_in(s_bus_ids, sizeof(s_bus_ids) / sizeof(s_bus_ids[0]), id);
+        }
+        printf("%-28s wanted %u, accepted %lu (plan %u), bus false %lu/%u, rtr passed %lu\n", node->name,
+               plan.wanted_ids, (unsigned long)accepted, plan.accepted_ids, (unsigned long)bus_false,
+               plan.bus_other_ids, (unsigned long)rtr_passed);
+
+        HOST_CHECK_EQ(missed, 0);
+        HOST_CHECK_EQ(partial, 0);
+        HOST_CHECK_EQ(rtr_passed, 0);
+        HOST_CHECK_EQ(plan.wanted_ids, node->count);
+        HOST_CHECK_EQ(accepted, plan.accepted_ids);
+        HOST_CHECK_EQ(bus_false, plan.bus_false_ids);
+        HOST_CHECK_EQ(plan.accepted_ids, node->accepted_ids);
+        HOST_CHECK_EQ(plan.bus_false_ids, node->bus_false_ids);
+        HOST_CHECK_EQ(plan.bus_other_ids, node->bus_other_ids);
+    }
+}
+
+// 注册满16个ID时规划仍然覆盖所有需要的ID
+static void test_full_table(void)
+{
+    uint32_t ids[ESPCAN_MAX_HANDLERS];
+    for (size_t i = 0; i < ESPCAN_MAX_HANDLERS; i++) {
+        ids[i] = (uint32_t)(i * 0x7F + 0x11) & 0x7FF;
+    }
+    espcan_filter_plan_t plan;
+    HOST_CHECK_EQ(espcan_filter_plan(ids, ESPCAN_MAX_HANDLERS, &plan), ESP_OK);
+    uint32_t accepted = 0;
+    for (uint32_t id = 0; id < ESPCAN_STD_ID_COUNT; id++) {
+        accepted += filter_accepts(&plan.config, id, false, 0x5A);
+        HOST_CHECK(!filter_accepts(&plan.config, id, true, 0x5A));
+    }
+    for (size_t i = 0; i < ESPCAN_MAX_HANDLERS; i++) {
+        HOST_CHECK(filter_accepts(&plan.config, ids[i], false, 0xA5));
+    }
+    HOST_CHECK_EQ(accepted, plan.accepted_ids);
+}
+
+static void test_invalid(void)
+{
+    espcan_filter_plan_t plan;
+    uint32_t ids[ESPCAN_MAX_HANDLERS + 1] = {ESPCAN_ID_SCENE, 0xABC};
+    HOST_CHECK_EQ(espcan_filter_plan(ids, 2, &plan), ESP_ERR_INVALID_ARG);
+    HOST_CHECK_EQ(espcan_filter_plan(ids, 0, &plan), ESP_ERR_INVALID_ARG);
+    HOST_CHECK_EQ(espcan_filter_plan(NULL, 1, &plan), ESP_ERR_INVALID_ARG);
+    HOST_CHECK_EQ(espcan_filter_plan(ids, ESPCAN_MAX_HANDLERS + 1, &plan), ESP_ERR_INVALID_SIZE);
+}
+
+int main(void)
+{
+    test_nodes();
+    test_full_table();
+    test_invalid();
+    return host_test_finish("test_espcan_filter");
+}
@@ -0,0 +1,244 @@
+// CAN协议: 各消息编码后的字节与负载格式逐字节对应，解码拒绝过短的帧和远程帧并保留可选字段的默认值，
+// 分发表按ID调用注册的处理函数，其它帧交给默认处理函数
+// 分发表是组件内的全局状态，各测试按顺序注册，填满处理函数表的测试放在最后
+
+#include <stdio.h>
+#include <string.h>
+#include "host_test.h"
+#include "espcan_protocol.h"
+
+typedef struct {
+    uint32_t calls;
+    uint32_t last_id;
+    void *last_arg;
+} handler_log_t;
+
+static handler_log_t s_log_a;
+static handler_log_t s_log_b;
+static handler_log_t s_log_default;
+
+static void log_call(handler_log_t *log, const twai_message_t *message, void *arg)
+{
+    log->calls++;
+    log->last_id = message->identifier;
+    log->last_arg = arg;
+}
+
+static void handler_a(const twai_message_t *message, void *arg)
+{
+    log_call(&s_log_a, message, arg);
+}
+
+static void handler_b(const twai_message_t *message, void *arg)
+{
+    log_call(&s_log_b, message, arg);
+}
+
+static void handler_default(const twai_message_t *message, void *arg)
+{
+    log_call(&s_log_default, message, arg);
+}
+
+static bool frame_is(const twai_message_t *message, uint32_t id, const uint8_t *data, uint8_t len)
+{
+    return message->identifier == id && message->data_length_code == len && message->ss && !message->extd &&
+           !message->rtr && memcmp(message->data, data, len) == 0;
+}
+
+static twai_message_t make_frame(uint32_t id, const uint8_t *data, uint8_t len)
+{
+    twai_message_t message = {
+        .identifier = id,
+        .data_length_code = len,
+    };
+    if (len) {
+        memcpy(message.data, data, len);
+    }
+    return message;
+}
+
+// 负载在帧中的字节顺序 (多字节字段为小端，ESP32和主机相同)
+static void test_encode_layout(void)
+{
+    twai_message_t message;
+
+    espcan_scene_t scene = {
+        .emotion = ESPCAN_EMOTION_SURPRISE,
+        .flags = ESPCAN_SCENE_LED_ON | ESPCAN_SCENE_MOTOR_ON | ESPCAN_SCENE_TIMED,
+        .motor_duty = 200,
+        .random_speed = 128,
+        .random_brightness = 201,
+        .sequence = 7,
+        .activate_tick = 0x1234,
+    };
+    static const uint8_t scene_bytes[] = {0x03, 0x29, 0xC8, 0x80, 0xC9, 0x07, 0x34, 0x12};
+    HOST_CHECK_EQ(espcan_encode_scene(&scene, &message), ESP_OK);
+    HOST_CHECK(frame_is(&message, ESPCAN_ID_SCENE, scene_bytes, sizeof(scene_bytes)));
+
+    espcan_time_sync_t sync = {.sequence = 5, .prev_sequence = 4, .prev_time_us = 0x01020304};
+    static const uint8_t sync_bytes[] = {0x05, 0x04, 0x00, 0x00, 0x04, 0x03, 0x02, 0x01};
+    HOST_CHECK_EQ(espcan_encode_time_sync(&sync, &message), ESP_OK);
+    HOST_CHECK(frame_is(&message, ESPCAN_ID_TIME_SYNC, sync_bytes, sizeof(sync_bytes)));
+
+    espcan_motor_cmd_t motor = {.duty = 180, .on_off = 1, .mode = ESPCAN_MOTOR_MODE_GRADUAL};
+    static const uint8_t motor_bytes[] = {180, 1, ESPCAN_MOTOR_MODE_GRADUAL};
+    HOST_CHECK_EQ(espcan_encode_motor_cmd(&motor, &message), ESP_OK);
+    HOST_CHECK(frame_is(&message, ESPCAN_ID_MOTOR_CMD, motor_bytes, sizeof(motor_bytes)));
+
+    espcan_motor_status_t motor_status = {.duty = 180, .on_off = 1, .mode = 0, .ack = ESPCAN_STATUS_ACK};
+    static const uint8_t motor_status_bytes[] = {180, 1, 0, ESPCAN_STATUS_ACK};
+    HOST_CHECK_EQ(espcan_encode_motor_status(&motor_status, &message), ESP_OK);
+    HOST_CHECK(frame_is(&message, ESPCAN_ID_MOTOR_CMD, motor_status_bytes, sizeof(motor_status_bytes)));
+
+    espcan_fogger_status_t fogger_status = {.state = ESPCAN_FOGGER_ON, .ack = ESPCAN_STATUS_ACK};
+    static const uint8_t fogger_status_bytes[] = {ESPCAN_FOGGER_ON, ESPCAN_STATUS_ACK};
+    HOST_CHECK_EQ(espcan_encode_fogger_status(&fogger_status, &message), ESP_OK);
+    HOST_CHECK(frame_is(&message, ESPCAN_ID_FOGGER_CMD, fogger_status_bytes, sizeof(fogger_status_bytes)));
+
+    espcan_random_cmd_t random = {.state = ESPCAN_RANDOM_START, .speed = 30, .brightness = 90};
+    static const uint8_t random_bytes[] = {ESPCAN_RANDOM_START, 30, 90};
+    HOST_CHECK_EQ(espcan_encode_random_cmd(&random, &message), ESP_OK);
+    HOST_CHECK(frame_is(&message, ESPCAN_ID_RANDOM_CMD, random_bytes, sizeof(random_bytes)));
+
+    // 单字节命令
+    static const uint8_t on[] = {1};
+    HOST_CHECK_EQ(espcan_encode_led_cmd(&(espcan_led_cmd_t){.state = ESPCAN_LED_ON}, &message), ESP_OK);
+    HOST_CHECK(frame_is(&message, ESPCAN_ID_LED_CMD, on, 1));
+    HOST_CHECK_EQ(espcan_encode_emotion_cmd(&(espcan_emotion_cmd_t){.emotion = ESPCAN_EMOTION_HAPPY}, &message), ESP_OK);
+    HOST_CHECK(frame_is(&message, ESPCAN_ID_EMOTION_CMD, on, 1));
+    HOST_CHECK_EQ(espcan_encode_fogger_cmd(&(espcan_fogger_cmd_t){.state = ESPCAN_FOGGER_ON}, &message), ESP_OK);
+    HOST_CHECK(frame_is(&message, ESPCAN_ID_FOGGER_CMD, on, 1));
+    HOST_CHECK_EQ(espcan_encode_wooden_fish_hit(&(espcan_wooden_fish_hit_t){.event = ESPCAN_WOODEN_FISH_HIT}, &message), ESP_OK);
+    HOST_CHECK(frame_is(&message, ESPCAN_ID_WOODEN_FISH_HIT, on, 1));
+
+    // 旧的随机效果ID超出11位，负载超过8字节
+    static const uint8_t long_payload[9] = {0};
+    HOST_CHECK_EQ(espcan_encode(0xABC, on, 1, &message), ESP_ERR_INVALID_ARG);
+    HOST_CHECK_EQ(espcan_encode(ESPCAN_ID_LED_CMD, long_payload, sizeof(long_payload), &message), ESP_ERR_INVALID_SIZE);
+    HOST_CHECK_EQ(espcan_encode(ESPCAN_ID_LED_CMD, NULL, 1, &message), ESP_ERR_INVALID_ARG);
+}
+
+static void test_decode(void)
+{
+    // 编码再解码得到相同的负载
+    espcan_scene_t scene = {
+        .emotion = ESPCAN_EMOTION_SAD, .flags = ESPCAN_SCENE_FOGGER_ON, .motor_duty = 1,
+        .random_speed = 2, .random_brightness = 3, .sequence = 255, .activate_tick = 0xFFFE,
+    };
+    espcan_scene_t scene_out;
+    twai_message_t message;
+    HOST_CHECK_EQ(espcan_encode_scene(&scene, &message), ESP_OK);
+    HOST_CHECK_EQ(espcan_decode_scene(&message, &scene_out), ESP_OK);
+    HOST_CHECK(memcmp(&scene, &scene_out, sizeof(scene)) == 0);
+
+    // 可选字段: 帧中没有时保留默认值 (随机效果速度128/亮度200，电机固定速度)
+    static const uint8_t start[] = {ESPCAN_RANDOM_START};
+    message = make_frame(ESPCAN_ID_RANDOM_CMD, start, sizeof(start));
+    espcan_random_cmd_t random = {.speed = 128, .brightness = 200};
+    HOST_CHECK_EQ(espcan_decode_random_cmd(&message, &random), ESP_OK);
+    HOST_CHECK(random.state == ESPCAN_RANDOM_START && random.speed == 128 && random.brightness == 200);
+
+    static const uint8_t motor_bytes[] = {90, 1};
+    message = make_frame(ESPCAN_ID_MOTOR_CMD, motor_bytes, sizeof(motor_bytes));
+    espcan_motor_cmd_t motor = {.mode = ESPCAN_MOTOR_MODE_FIXED};
+    HOST_CHECK_EQ(espcan_decode_motor_cmd(&message, &motor), ESP_OK);
+    HOST_CHECK(motor.duty == 90 && motor.on_off == 1 && motor.mode == ESPCAN_MOTOR_MODE_FIXED);
+
+    // 帧比结构体长时只取结构体大小
+    static const uint8_t long_led[] = {1, 0xAA, 0xBB};
+    message = make_frame(ESPCAN_ID_LED_CMD, long_led, sizeof(long_led));
+    uint8_t led_buf[2] = {0, 0x55};
+    HOST_CHECK_EQ(espcan_decode_led_cmd(&message, (espcan_led_cmd_t *)led_buf), ESP_OK);
+    HOST_CHECK(led_buf[0] == 1 && led_buf[1] == 0x55);
+
+    // 缺少必需字段的帧和远程帧
+    message = make_frame(ESPCAN_ID_MOTOR_CMD, motor_bytes, 1);
+    HOST_CHECK_EQ(espcan_decode_motor_cmd(&message, &motor), ESP_ERR_INVALID_SIZE);
+    message = make_frame(ESPCAN_ID_MOTOR_CMD, motor_bytes, 2);
+    espcan_motor_status_t motor_status;
+    HOST_CHECK_EQ(espcan_decode_motor_status(&message, &motor_status), ESP_ERR_INVALID_SIZE);
+    message = make_frame(ESPCAN_ID_SCENE, motor_bytes, 2);
+    HOST_CHECK_EQ(espcan_decode_scene(&message, &scene_out), ESP_ERR_INVALID_SIZE);
+    message = make_frame(ESPCAN_ID_LED_CMD, NULL, 0);
+    espcan_led_cmd_t led;
+    HOST_CHECK_EQ(espcan_decode_led_cmd(&message, &led), ESP_ERR_INVALID_SIZE);
+    message = make_frame(ESPCAN_ID_LED_CMD, long_led, 1);
+    message.rtr = 1;
+    HOST_CHECK_EQ(espcan_decode_led_cmd(&message, &led), ESP_ERR_INVALID_SIZE);
+}
+
+static void test_dispatch(void)
+{
+    static int arg_a;
+    static int arg_b;
+    static int arg_default;
+    static const uint8_t on[] = {1};
+    twai_message_t message;
+
+    HOST_CHECK_EQ(espcan_register_handler(ESPCAN_ID_LED_CMD, NULL, NULL), ESP_ERR_INVALID_ARG);
+    HOST_CHECK_EQ(espcan_register_handler(0x800, handler_a, NULL), ESP_ERR_INVALID_ARG);
+    HOST_CHECK_EQ(espcan_register_handler(ESPCAN_ID_LED_CMD, handler_a, &arg_a), ESP_OK);
+    HOST_CHECK_EQ(espcan_register_handler(ESPCAN_ID_EMOTION_CMD, handler_b, &arg_b), ESP_OK);
+
+    // 没有默认处理函数时其它帧被忽略
+    message = make_frame(0x555, on, 1);
+    HOST_CHECK_EQ(espcan_dispatch(&message), ESP_ERR_NOT_FOUND);
+    espcan_set_default_handler(handler_default, &arg_default);
+
+    message = make_frame(ESPCAN_ID_LED_CMD, on, 1);
+    HOST_CHECK_EQ(espcan_dispatch(&message), ESP_OK);
+    HOST_CHECK(s_log_a.calls == 1 && s_log_a.last_id == ESPCAN_ID_LED_CMD && s_log_a.last_arg == &arg_a);
+    message = make_frame(ESPCAN_ID_EMOTION_CMD, on, 1);
+    HOST_CHECK_EQ(espcan_dispatch(&message), ESP_OK);
+    HOST_CHECK(s_log_b.calls == 1 && s_log_b.last_id == ESPCAN_ID_EMOTION_CMD && s_log_b.last_arg == &arg_b);
+
+    // 未注册的ID、ID相同的扩展帧和远程帧交给默认处理函数
+    message = make_frame(0x555, on, 1);
+    HOST_CHECK_EQ(espcan_dispatch(&message), ESP_ERR_NOT_FOUND);
+    message = make_frame(ESPCAN_ID_LED_CMD, on, 1);
+    message.extd = 1;
+    HOST_CHECK_EQ(espcan_dispatch(&message), ESP_ERR_NOT_FOUND);
+    message = make_frame(ESPCAN_ID_LED_CMD, NULL, 0);
+    message.rtr = 1;
+    HOST_CHECK_EQ(espcan_dispatch(&message), ESP_ERR_NOT_FOUND);
+    HOST_CHECK(s_log_default.calls == 3 && s_log_default.last_arg == &arg_default);
+    HOST_CHECK_EQ(s_log_a.calls, 1);
+
+    // 重复注册替换处理函数，顺序和数量不变
+    HOST_CHECK_EQ(espcan_register_handler(ESPCAN_ID_LED_CMD, handler_b, NULL), ESP_OK);
+    message = make_frame(ESPCAN_ID_LED_CMD, on, 1);
+    HOST_CHECK_EQ(espcan_dispatch(&message), ESP_OK);
+    HOST_CHECK(s_log_a.calls == 1 && s_log_b.calls == 2 && s_log_b.last_arg == NULL);
+    uint32_t ids[ESPCAN_MAX_HANDLERS];
+    HOST_CHECK_EQ(espcan_get_registered_ids(ids, ESPCAN_MAX_HANDLERS), 2);
+    HOST_CHECK(ids[0] == ESPCAN_ID_LED_CMD && ids[1] == ESPCAN_ID_EMOTION_CMD);
+    HOST_CHECK_EQ(espcan_get_registered_ids(ids, 1), 2);
+}
+
+static void test_table_full(void)
+{
+    size_t registered = espcan_get_registered_ids(NULL, 0);
+    for (uint32_t id = 0x600; registered < ESPCAN_MAX_HANDLERS; id++, registered++) {
+        HOST_CHECK_EQ(espcan_register_handler(id, handler_a, NULL), ESP_OK);
+    }
+    HOST_CHECK_EQ(espcan_register_handler(0x7FF, handler_a, NULL), ESP_ERR_NO_MEM);
+    // 已注册的ID仍可替换，表满不影响分发
+    HOST_CHECK_EQ(espcan_register_handler(ESPCAN_ID_EMOTION_CMD, handler_a, NULL), ESP_OK);
+    static const uint8_t on[] = {1};
+    twai_message_t message = make_frame(0x7FF, on, 1);
+    HOST_CHECK_EQ(espcan_dispatch(&message), ESP_ERR_NOT_FOUND);
+    uint32_t calls = s_log_a.calls;
+    message = make_frame(ESPCAN_ID_EMOTION_CMD, on, 1);
+    HOST_CHECK_EQ(espcan_dispatch(&message), ESP_OK);
+    HOST_CHECK_EQ(s_log_a.calls, calls + 1);
+    HOST_CHECK_EQ(espcan_get_registered_ids(NULL, 0), ESPCAN_MAX_HANDLERS);
+}
+
+int main(void)
+{
+    test_encode_layout();
+    test_decode();
+    test_dispatch();
+    test_table_full();
+    return host_test_finish("test_espcan_protocol");
+}
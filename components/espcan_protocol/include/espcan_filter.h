@@ -0,0 +1,56 @@
+#ifndef ESPCAN_FILTER_H
+#define ESPCAN_FILTER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "driver/twai.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 接收过滤器规划: 由节点需要的ID计算双过滤器模式下最紧的acceptance_code/acceptance_mask。
+// 双过滤器模式下每个过滤器只能匹配一个"ID的若干位任意"的集合，需要的ID多于两个时
+// 会放过一些不需要的ID，由分发表丢弃。规划时先避免放过总线上其它节点的ID
+// (ESPCAN_BUS_IDS)，再让放过的ID总数最少。远程帧在硬件中过滤掉。
+
+// 规划结果
+typedef struct {
+    twai_filter_config_t config;    // 双过滤器配置，直接传给twai_driver_install
+    uint16_t filter_id[2];          // 两个过滤器匹配的ID
+    uint16_t filter_mask[2];        // 两个过滤器的任意位 (1为任意)
+    uint16_t wanted_ids;            // 需要接收的ID数
+    uint16_t accepted_ids;          // 硬件放过的标准帧ID数 (含需要的)
+    uint16_t bus_false_ids;         // 放过的总线上其它节点的ID数
+    uint16_t bus_other_ids;         // 总线上其它节点的ID数
+} espcan_filter_plan_t;
+
+/**
+ * @brief 计算接收ids所需的双过滤器配置
+ *
+ * 把ID分成两组，每组取最紧的code/mask，枚举所有分组取最优 (ID数不超过ESPCAN_MAX_HANDLERS)。
+ *
+ * @param ids 需要接收的11位标准帧ID
+ * @param count ID数量
+ * @param plan 输出的规划结果
+ * @return esp_err_t
+ */
+esp_err_t espcan_filter_plan(const uint32_t *ids, size_t count, espcan_filter_plan_t *plan);
+
+/**
+ * @brief 按已注册处理函数的ID计算过滤器配置，并输出误收率
+ *
+ * 在注册完所有处理函数 (包括espcan_sync_init/espcan_sync_master_init) 之后、
+ * 安装TWAI驱动之前调用。
+ *
+ * @param plan 输出的规划结果
+ * @return esp_err_t
+ */
+esp_err_t espcan_filter_plan_registered(espcan_filter_plan_t *plan);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ESPCAN_FILTER_H
@@ -0,0 +1,291 @@
+#ifndef ESPCAN_PROTOCOL_H
+#define ESPCAN_PROTOCOL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "driver/twai.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 所有节点共用的CAN协议定义: 消息ID、负载格式、编解码函数和按ID分发的处理函数表。
+// 只在这里修改ID和负载格式，各节点不再各自定义。
+
+// 消息ID (11位标准帧)
+#define ESPCAN_ID_TIME_SYNC         0x080   // 时间同步 (主控周期广播)
+#define ESPCAN_ID_WOODEN_FISH_HIT   0x123   // 木鱼敲击事件
+#define ESPCAN_ID_SCENE             0x300   // 场景 (一帧切换所有节点的状态)
+#define ESPCAN_ID_MOTOR_CMD         0x301   // 电机控制命令 (电机节点用同一ID回复状态)
+#define ESPCAN_ID_FOGGER_CMD        0x321   // 雾化器控制命令 (雾化器节点用同一ID回复状态)
+#define ESPCAN_ID_LED_CMD           0x456   // LED控制命令
+#define ESPCAN_ID_EMOTION_CMD       0x789   // 情绪状态命令
+#define ESPCAN_ID_RANDOM_CMD        0x2BC   // 随机效果命令 (原0xABC超出11位，控制器实际发送的就是0x2BC)
+
+// 总线上会出现的所有ID，规划接收过滤器时优先避免误收其中不需要的ID。新增ID时同时加到这里
+#define ESPCAN_BUS_IDS { \
+    ESPCAN_ID_TIME_SYNC, ESPCAN_ID_WOODEN_FISH_HIT, ESPCAN_ID_SCENE, ESPCAN_ID_MOTOR_CMD, \
+    ESPCAN_ID_FOGGER_CMD, ESPCAN_ID_LED_CMD, ESPCAN_ID_EMOTION_CMD, ESPCAN_ID_RANDOM_CMD, \
+}
+
+#define ESPCAN_STD_ID_COUNT         2048    // 11位标准帧ID数量
+#define ESPCAN_MAX_HANDLERS         16      // 每个节点最多注册的处理函数数量
+
+// 情绪状态
+#define ESPCAN_EMOTION_NEUTRAL      0       // 中性 - 呼吸灯切换颜色效果
+#define ESPCAN_EMOTION_HAPPY        1       // 开心 - 彩虹效果
+#define ESPCAN_EMOTION_SAD          2       // 伤心 - 紫色追逐效果，开启雾化器
+#define ESPCAN_EMOTION_SURPRISE     3       // 惊讶 - 闪电效果，开启电机
+#define ESPCAN_EMOTION_RANDOM       4       // 随机效果
+
+// 开关状态
+#define ESPCAN_LED_OFF              0
+#define ESPCAN_LED_ON               1
+#define ESPCAN_FOGGER_OFF           0
+#define ESPCAN_FOGGER_ON            1
+#define ESPCAN_RANDOM_STOP          0
+#define ESPCAN_RANDOM_START         1
+
+// 电机速度模式
+#define ESPCAN_MOTOR_MODE_FIXED     0       // 固定速度
+#define ESPCAN_MOTOR_MODE_GRADUAL   1       // 渐变速度
+
+// 场景标志位
+#define ESPCAN_SCENE_LED_ON         (1 << 0)    // 板载LED开启
+#define ESPCAN_SCENE_RANDOM_ON      (1 << 1)    // 随机灯光效果开启
+#define ESPCAN_SCENE_FOGGER_ON      (1 << 2)    // 雾化器开启
+#define ESPCAN_SCENE_MOTOR_ON       (1 << 3)    // 电机启动
+#define ESPCAN_SCENE_MOTOR_GRADUAL  (1 << 4)    // 电机渐变速度模式
+#define ESPCAN_SCENE_TIMED          (1 << 5)    // activate_tick有效，到时间再生效
+
+#define ESPCAN_WOODEN_FISH_HIT      1       // 敲击事件
+#define ESPCAN_STATUS_ACK           0x01    // 状态回复中的确认标志
+
+// 负载格式 (与帧数据逐字节对应)
+typedef struct __attribute__((packed)) {
+    uint8_t state;          // ESPCAN_LED_OFF / ESPCAN_LED_ON
+} espcan_led_cmd_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t emotion;        // ESPCAN_EMOTION_*
+} espcan_emotion_cmd_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t state;          // ESPCAN_RANDOM_STOP / ESPCAN_RANDOM_START
+    uint8_t speed;          // 可选: 速度、密度等
+    uint8_t brightness;     // 可选: 亮度、颜色等
+} espcan_random_cmd_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t duty;           // PWM占空比 (0-255)
+    uint8_t on_off;         // 0=停止, 1=启动
+    uint8_t mode;           // 可选: ESPCAN_MOTOR_MODE_*
+} espcan_motor_cmd_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t duty;           // 当前占空比
+    uint8_t on_off;         // 当前状态
+    uint8_t mode;           // 当前模式
+    uint8_t ack;            // ESPCAN_STATUS_ACK
+} espcan_motor_status_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t state;          // ESPCAN_FOGGER_OFF / ESPCAN_FOGGER_ON
+} espcan_fogger_cmd_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t state;          // 当前状态
+    uint8_t ack;            // ESPCAN_STATUS_ACK
+} espcan_fogger_status_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t event;          // ESPCAN_WOODEN_FISH_HIT
+} espcan_wooden_fish_hit_t;
+
+// 场景: 一帧携带所有节点的目标状态，各节点只取自己负责的部分。
+// 切换情绪时代替分别发送的雾化器、电机和情绪命令，节点不需要回复状态
+typedef struct __attribute__((packed)) {
+    uint8_t emotion;            // ESPCAN_EMOTION_*
+    uint8_t flags;              // ESPCAN_SCENE_*
+    uint8_t motor_duty;         // 电机PWM占空比 (0-255)
+    uint8_t random_speed;       // 随机效果速度
+    uint8_t random_brightness;  // 随机效果亮度
+    uint8_t sequence;           // 场景序号，每次切换加1
+    uint16_t activate_tick;     // 生效时间: 同步时钟的低16位 (单位1024us，见espcan_sync.h)
+} espcan_scene_t;
+
+// 时间同步: 主控用自收功能记录每个同步帧的接收时间，下一帧带上该时间。
+// 主控和节点都在收到同一帧时取时间戳，驱动和任务延迟的固定部分互相抵消
+typedef struct __attribute__((packed)) {
+    uint8_t sequence;           // 本帧序号
+    uint8_t prev_sequence;      // prev_time_us对应的帧序号 (等于sequence时无效)
+    uint16_t reserved;          // 保留 (为0)
+    uint32_t prev_time_us;      // 主控收到prev_sequence帧时的主控时间 (us)
+} espcan_time_sync_t;
+
+// 消息处理函数，arg为注册时传入的参数
+typedef void (*espcan_handler_t)(const twai_message_t *message, void *arg);
+
+/**
+ * @brief 把负载编码为标准数据帧 (单次发送)
+ *
+ * @param id 消息ID
+ * @param payload 负载
+ * @param len 负载长度 (不超过8字节)
+ * @param message 输出的帧
+ * @return esp_err_t
+ */
+esp_err_t espcan_encode(uint32_t id, const void *payload, size_t len, twai_message_t *message);
+
+/**
+ * @brief 从数据帧解码负载
+ *
+ * 帧中没有的可选字段保持调用者预先填入的默认值。
+ *
+ * @param message 收到的帧
+ * @param min_len 必需字段的长度，帧更短时返回ESP_ERR_INVALID_SIZE
+ * @param payload 输出的负载
+ * @param size 负载结构体大小
+ * @return esp_err_t
+ */
+esp_err_t espcan_decode(const twai_message_t *message, size_t min_len, void *payload, size_t size);
+
+/**
+ * @brief 注册消息处理函数 (同一ID重复注册时替换)
+ *
+ * @param id 11位标准帧ID
+ * @param handler 处理函数
+ * @param arg 传给处理函数的参数
+ * @return esp_err_t
+ */
+esp_err_t espcan_register_handler(uint32_t id, espcan_handler_t handler, void *arg);
+
+/**
+ * @brief 读取已注册处理函数的ID (按注册顺序)
+ *
+ * @param ids 输出的ID
+ * @param max_ids ids的长度
+ * @return size_t 已注册的ID数量 (可能大于max_ids)
+ */
+size_t espcan_get_registered_ids(uint32_t *ids, size_t max_ids);
+
+/**
+ * @brief 设置未注册ID、扩展帧和远程帧的处理函数 (NULL为忽略)
+ */
+void espcan_set_default_handler(espcan_handler_t handler, void *arg);
+
+/**
+ * @brief 按ID查表分发收到的帧
+ *
+ * @param message 收到的帧
+ * @return ESP_OK 由注册的处理函数处理; ESP_ERR_NOT_FOUND 交给默认处理函数或忽略
+ */
+esp_err_t espcan_dispatch(const twai_message_t *message);
+
+// 各消息的编解码
+static inline esp_err_t espcan_encode_led_cmd(const espcan_led_cmd_t *cmd, twai_message_t *message)
+{
+    return espcan_encode(ESPCAN_ID_LED_CMD, cmd, sizeof(*cmd), message);
+}
+
+static inline esp_err_t espcan_decode_led_cmd(const twai_message_t *message, espcan_led_cmd_t *cmd)
+{
+    return espcan_decode(message, 1, cmd, sizeof(*cmd));
+}
+
+static inline esp_err_t espcan_encode_emotion_cmd(const espcan_emotion_cmd_t *cmd, twai_message_t *message)
+{
+    return espcan_encode(ESPCAN_ID_EMOTION_CMD, cmd, sizeof(*cmd), message);
+}
+
+static inline esp_err_t espcan_decode_emotion_cmd(const twai_message_t *message, espcan_emotion_cmd_t *cmd)
+{
+    return espcan_decode(message, 1, cmd, sizeof(*cmd));
+}
+
+static inline esp_err_t espcan_encode_random_cmd(const espcan_random_cmd_t *cmd, twai_message_t *message)
+{
+    return espcan_encode(ESPCAN_ID_RANDOM_CMD, cmd, sizeof(*cmd), message);
+}
+
+static inline esp_err_t espcan_decode_random_cmd(const twai_message_t *message, espcan_random_cmd_t *cmd)
+{
+    return espcan_decode(message, 1, cmd, sizeof(*cmd));
+}
+
+static inline esp_err_t espcan_encode_motor_cmd(const espcan_motor_cmd_t *cmd, twai_message_t *message)
+{
+    return espcan_encode(ESPCAN_ID_MOTOR_CMD, cmd, sizeof(*cmd), message);
+}
+
+static inline esp_err_t espcan_decode_motor_cmd(const twai_message_t *message, espcan_motor_cmd_t *cmd)
+{
+    return espcan_decode(message, 2, cmd, sizeof(*cmd));
+}
+
+static inline esp_err_t espcan_encode_motor_status(const espcan_motor_status_t *status, twai_message_t *message)
+{
+    return espcan_encode(ESPCAN_ID_MOTOR_CMD, status, sizeof(*status), message);
+}
+
+static inline esp_err_t espcan_decode_motor_status(const twai_message_t *message, espcan_motor_status_t *status)
+{
+    return espcan_decode(message, sizeof(*status), status, sizeof(*status));
+}
+
+static inline esp_err_t espcan_encode_fogger_cmd(const espcan_fogger_cmd_t *cmd, twai_message_t *message)
+{
+    return espcan_encode(ESPCAN_ID_FOGGER_CMD, cmd, sizeof(*cmd), message);
+}
+
+static inline esp_err_t espcan_decode_fogger_cmd(const twai_message_t *message, espcan_fogger_cmd_t *cmd)
+{
+    return espcan_decode(message, 1, cmd, sizeof(*cmd));
+}
+
+static inline esp_err_t espcan_encode_fogger_status(const espcan_fogger_status_t *status, twai_message_t *message)
+{
+    return espcan_encode(ESPCAN_ID_FOGGER_CMD, status, sizeof(*status), message);
+}
+
+static inline esp_err_t espcan_decode_fogger_status(const twai_message_t *message, espcan_fogger_status_t *status)
+{
+    return espcan_decode(message, sizeof(*status), status, sizeof(*status));
+}
+
+static inline esp_err_t espcan_encode_scene(const espcan_scene_t *scene, twai_message_t *message)
+{
+    return espcan_encode(ESPCAN_ID_SCENE, scene, sizeof(*scene), message);
+}
+
+static inline esp_err_t espcan_decode_scene(const twai_message_t *message, espcan_scene_t *scene)
+{
+    return espcan_decode(message, sizeof(*scene), scene, sizeof(*scene));
+}
+
+static inline esp_err_t espcan_encode_time_sync(const espcan_time_sync_t *sync, twai_message_t *message)
+{
+    return espcan_encode(ESPCAN_ID_TIME_SYNC, sync, sizeof(*sync), message);
+}
+
+static inline esp_err_t espcan_decode_time_sync(const twai_message_t *message, espcan_time_sync_t *sync)
+{
+    return espcan_decode(message, sizeof(*sync), sync, sizeof(*sync));
+}
+
+static inline esp_err_t espcan_encode_wooden_fish_hit(const espcan_wooden_fish_hit_t *hit, twai_message_t *message)
+{
+    return espcan_encode(ESPCAN_ID_WOODEN_FISH_HIT, hit, sizeof(*hit), message);
+}
+
+static inline esp_err_t espcan_decode_wooden_fish_hit(const twai_message_t *message, espcan_wooden_fish_hit_t *hit)
+{
+    return espcan_decode(message, 1, hit, sizeof(*hit));
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ESPCAN_PROTOCOL_H
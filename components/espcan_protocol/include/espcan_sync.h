@@ -0,0 +1,154 @@
+#ifndef ESPCAN_SYNC_H
+#define ESPCAN_SYNC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "driver/twai.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 总线时间同步: 主控周期广播同步帧，节点维护校正过偏移和频率的本地时钟，
+// 场景命令带上生效时间，各节点在同一时刻执行。
+// 同步时钟就是主控的esp_timer时间 (低32位，单位us，约71分钟回绕一次)。
+
+#define ESPCAN_SYNC_INTERVAL_MS     1000    // 同步帧周期
+#define ESPCAN_SYNC_TIMEOUT_MS      5000    // 超过该时间没有同步样本时视为未同步
+#define ESPCAN_SYNC_OUTLIER_US      500     // 异常样本门限上限 (任务被抢占等)
+#define ESPCAN_SYNC_OUTLIER_MIN_US  100     // 异常样本门限下限，平时按测得的抖动的3倍
+#define ESPCAN_SYNC_MAX_OUTLIERS    3       // 连续且一致的异常样本达到该数量时重新对时
+#define ESPCAN_SYNC_MAX_DRIFT_PPB   500000  // 频率校正上限 (500ppm)
+#define ESPCAN_SYNC_TICK_SHIFT      10      // 生效时间单位: 1 << 10 us
+#define ESPCAN_SYNC_MAX_DELAY_US    2000000 // 生效时间距现在超过该值时视为无效，立即执行
+#define ESPCAN_SYNC_MAX_DATA        8       // 待执行命令保存的数据长度上限 (一帧的负载)
+
+// 本地时钟相对同步时钟的模型: master = master_ref + (local - local_ref) * (1 + drift_ppb / 1e9)
+typedef struct {
+    bool locked;                // 已对时
+    int64_t local_ref_us;       // 上次校正时的本地时间
+    uint32_t master_ref_us;     // 对应的同步时间
+    int32_t drift_ppb;          // 同步时钟相对本地时钟的频率偏差 (十亿分之一)
+    uint8_t outliers;           // 连续且一致的异常样本数
+    int32_t outlier_error_us;   // 上一个异常样本的偏差
+    uint32_t jitter_us;         // 样本偏差绝对值的滑动平均
+    int32_t last_error_us;      // 最近一个样本与模型的偏差
+    uint32_t samples;           // 已使用的样本数
+    uint32_t rejected;          // 被丢弃的异常样本数
+} espcan_clock_t;
+
+// 同步状态 (节点)
+typedef struct {
+    bool locked;                // 当前是否已同步
+    int32_t last_error_us;      // 最近一个样本的偏差
+    int32_t drift_ppb;          // 频率校正量
+    uint32_t samples;           // 已使用的样本数
+    uint32_t rejected;          // 被丢弃的异常样本数
+    uint32_t scheduled;         // 按生效时间执行的命令数
+    uint32_t immediate;         // 未同步、已过时或无生效时间而立即执行的命令数
+} espcan_sync_stats_t;
+
+// 到生效时间时执行的函数 (在esp_timer任务中调用)，data为提交时复制的数据
+typedef void (*espcan_sync_action_t)(const void *data);
+
+/**
+ * @brief 清除时钟模型 (重新对时)
+ */
+void espcan_clock_reset(espcan_clock_t *clock);
+
+/**
+ * @brief 加入一个同步样本: 同一帧的本地接收时间和主控接收时间
+ *
+ * 第一个样本直接对齐；之后用PI校正偏移和频率。偏差超过抖动3倍的样本被丢弃，
+ * 连续几个异常样本的偏差一致时认为时钟跳变，重新对时。
+ *
+ * @param clock 时钟模型
+ * @param local_us 本地接收时间
+ * @param master_us 主控接收时间
+ */
+void espcan_clock_update(espcan_clock_t *clock, int64_t local_us, uint32_t master_us);
+
+/**
+ * @brief 本地时间换算为同步时间
+ */
+uint32_t espcan_clock_to_master(const espcan_clock_t *clock, int64_t local_us);
+
+/**
+ * @brief 同步时间换算为本地时间
+ */
+int64_t espcan_clock_to_local(const espcan_clock_t *clock, uint32_t master_us);
+
+/**
+ * @brief 同步时间转换为生效时间 (向上取整到一个单位)
+ */
+static inline uint16_t espcan_sync_tick(uint32_t master_us)
+{
+    return (uint16_t)((master_us + (1u << ESPCAN_SYNC_TICK_SHIFT) - 1) >> ESPCAN_SYNC_TICK_SHIFT);
+}
+
+/**
+ * @brief 由生效时间还原出离now_us最近的同步时间
+ */
+static inline uint32_t espcan_sync_tick_to_us(uint16_t tick, uint32_t now_us)
+{
+    uint32_t now_tick = now_us >> ESPCAN_SYNC_TICK_SHIFT;
+    int16_t delta = (int16_t)(tick - (uint16_t)now_tick);
+    return (now_tick + delta) << ESPCAN_SYNC_TICK_SHIFT;
+}
+
+/**
+ * @brief 初始化主控端: 注册同步帧处理函数，记录自己发出的同步帧的接收时间
+ *
+ * 同步帧以自收方式发送，主控的接收过滤器需要接收ESPCAN_ID_TIME_SYNC。
+ */
+esp_err_t espcan_sync_master_init(void);
+
+/**
+ * @brief 生成下一个同步帧 (主控每ESPCAN_SYNC_INTERVAL_MS发送一次)
+ *
+ * @param message 输出的帧
+ */
+esp_err_t espcan_sync_master_build(twai_message_t *message);
+
+/**
+ * @brief 初始化节点端: 注册同步帧处理函数并创建生效定时器
+ *
+ * 接收循环需要在twai_receive返回后立即调用espcan_dispatch，
+ * 中间不能有延时，否则接收时间戳不准。
+ */
+esp_err_t espcan_sync_init(void);
+
+/**
+ * @brief 当前同步时间 (主控为本地时间；节点未同步时返回本地时间)
+ */
+uint32_t espcan_sync_now(void);
+
+/**
+ * @brief 节点是否已同步 (主控始终为true)
+ */
+bool espcan_sync_locked(void);
+
+/**
+ * @brief 在生效时间执行action
+ *
+ * 未同步、生效时间已过或距现在超过ESPCAN_SYNC_MAX_DELAY_US时在调用者中立即执行。
+ * 只保留一个待执行的action，新的调用替换还没执行的旧action。
+ *
+ * @param activate_tick 生效时间
+ * @param action 执行的函数
+ * @param data 传给action的数据 (复制保存)
+ * @param len 数据长度 (不超过ESPCAN_SYNC_MAX_DATA)
+ */
+esp_err_t espcan_sync_run_at(uint16_t activate_tick, espcan_sync_action_t action, const void *data, size_t len);
+
+/**
+ * @brief 读取同步状态
+ */
+void espcan_sync_get_stats(espcan_sync_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ESPCAN_SYNC_H
@@ -0,0 +1,31 @@
+#ifndef SK6812_ENCODER_H
+#define SK6812_ENCODER_H
+
+#include "esp_err.h"
+#include "driver/rmt_encoder.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// SK6812 RMT流式编码器: 发送时把像素缓冲区的颜色字节逐位展开为RMT符号，并在末尾追加复位信号。
+// 每个颜色字节MSB优先发送，字节顺序就是缓冲区中的顺序，GRB (每像素3字节) 和GRBW (每像素4字节)
+// 灯带都可使用。
+
+#define SK6812_ENCODER_RESOLUTION_HZ    10000000    // 时序按10MHz的RMT分辨率定义
+
+/**
+ * @brief 创建SK6812编码器
+ *
+ * RMT通道的分辨率必须是SK6812_ENCODER_RESOLUTION_HZ。
+ *
+ * @param ret_encoder 返回的编码器，用rmt_del_encoder删除
+ * @return esp_err_t
+ */
+esp_err_t sk6812_new_encoder(rmt_encoder_handle_t *ret_encoder);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SK6812_ENCODER_H
@@ -0,0 +1,58 @@
+#ifndef SK6812_POWER_H
+#define SK6812_POWER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// SK6812 功率限制: 应用写像素时增量累计所有分量之和 (减去被覆盖的旧值，加上新值)，提交帧时据此估算电流，
+// 不需要再遍历整帧。估算值超出预算时整帧按统一系数缩放，缩放通过查找表完成，系数不变时不重建。
+// 估算与分量值成线性关系。
+
+#define SK6812_POWER_DEFAULT_CHANNEL_MA 12  // 单个颜色分量满值时的电流 (毫安)
+
+typedef struct {
+    uint32_t channel_sum;       // 所有分量之和，写像素时增量更新
+    uint32_t budget_ma;         // 电流预算 (0为不限制)
+    uint32_t channel_ma;        // 单个分量满值时的电流
+    uint32_t idle_ma;           // 全灭时的静态电流
+    uint32_t estimated_ma;      // 最近一帧限制前的估算电流
+    uint32_t output_ma;         // 最近一帧限制后的估算电流
+    uint32_t limited_frames;    // 被缩放的帧数
+    uint8_t scale;              // 最近一帧的缩放系数 (255为未限制)
+    uint8_t lut[256];           // 按scale缩放的查找表，scale变化时重建
+} sk6812_power_t;
+
+/**
+ * @brief 初始化功率模型，分量之和清零
+ *
+ * @param power 功率模型
+ * @param budget_ma 电流预算 (毫安，0为不限制)
+ * @param channel_ma 单个分量满值时的电流 (毫安，0为默认值SK6812_POWER_DEFAULT_CHANNEL_MA)
+ * @param idle_ma 全灭时的静态电流 (毫安)
+ */
+void sk6812_power_init(sk6812_power_t *power, uint32_t budget_ma, uint32_t channel_ma, uint32_t idle_ma);
+
+/**
+ * @brief 按分量之和估算本帧电流，超出预算时计算统一的缩放系数并更新查找表
+ *
+ * @param power 功率模型
+ * @return uint8_t 缩放系数，255为不需要缩放
+ */
+uint8_t sk6812_power_update(sk6812_power_t *power);
+
+/**
+ * @brief 按最近一次sk6812_power_update的系数缩放len个分量 (src和dst可以相同)
+ *
+ * @return uint32_t 缩放后的分量之和
+ */
+uint32_t sk6812_power_apply(const sk6812_power_t *power, const uint8_t *src, uint8_t *dst, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SK6812_POWER_H
@@ -0,0 +1,151 @@
+// SK6812 RMT流式编码器 - 发送时将颜色字节逐位展开为RMT符号
+// 像素缓冲区只需保存原始颜色字节 (GRB每像素3字节，GRBW每像素4字节)，无需预先展开为RMT符号
+
+#include <stdlib.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_check.h"
+#include "sk6812_encoder.h"
+
+static const char *TAG = "sk6812_encoder";
+
+// 按SK6812_ENCODER_RESOLUTION_HZ (10MHz) 计的时序，单位0.1us
+#define T0H 3
+#define T0L 9 
+#define T1H 6
+#define T1L 6
+#define TRS 800
+
+// RMT编码器结构体
+typedef struct {
+    rmt_encoder_t base;
+    rmt_encoder_t *bytes_encoder;
+    rmt_encoder_t *copy_encoder;
+    int state;
+    rmt_symbol_word_t reset_code;
+} sk6812_encoder_t;
+
+// 编码器状态
+enum {
+    SK6812_ENCODE_DATA = 0,
+    SK6812_ENCODE_RESET,
+};
+
+// 编码器回调函数: 先发送像素字节，再发送复位信号
+static size_t sk6812_encode(rmt_encoder_t *encoder, rmt_channel_handle_t channel,
+                            const void *primary_data, size_t data_size,
+                            rmt_encode_state_t *ret_state)
+{
+    sk6812_encoder_t *sk6812_encoder = __containerof(encoder, sk6812_encoder_t, base);
+    rmt_encoder_handle_t bytes_encoder = sk6812_encoder->bytes_encoder;
+    rmt_encoder_handle_t copy_encoder = sk6812_encoder->copy_encoder;
+    rmt_encode_state_t session_state = RMT_ENCODING_RESET;
+    rmt_encode_state_t state = RMT_ENCODING_RESET;
+    size_t encoded_symbols = 0;
+
+    switch (sk6812_encoder->state) {
+        case SK6812_ENCODE_DATA:
+            encoded_symbols += bytes_encoder->encode(bytes_encoder, channel, primary_data, data_size, &session_state);
+            if (session_state & RMT_ENCODING_COMPLETE) {
+                sk6812_encoder->state = SK6812_ENCODE_RESET;
+            }
+            if (session_state & RMT_ENCODING_MEM_FULL) {
+                state |= RMT_ENCODING_MEM_FULL;
+                goto out;  // RMT内存已满，等待下次继续编码
+            }
+            // fall-through
+        case SK6812_ENCODE_RESET:
+            encoded_symbols += copy_encoder->encode(copy_encoder, channel, &sk6812_encoder->reset_code,
+                                                    sizeof(sk6812_encoder->reset_code), &session_state);
+            if (session_state & RMT_ENCODING_COMPLETE) {
+                sk6812_encoder->state = SK6812_ENCODE_DATA;  // 回到初始状态，准备下一帧
+                state |= RMT_ENCODING_COMPLETE;
+            }
+            if (session_state & RMT_ENCODING_MEM_FULL) {
+                state |= RMT_ENCODING_MEM_FULL;
+                goto out;
+            }
+    }
+out:
+    *ret_state = state;
+    return encoded_symbols;
+}
+
+// 编码器重置
+static esp_err_t sk6812_encoder_reset(rmt_encoder_t *encoder)
+{
+    sk6812_encoder_t *sk6812_encoder = __containerof(encoder, sk6812_encoder_t, base);
+    rmt_encoder_reset(sk6812_encoder->bytes_encoder);
+    rmt_encoder_reset(sk6812_encoder->copy_encoder);
+    sk6812_encoder->state = SK6812_ENCODE_DATA;
+    return ESP_OK;
+}
+
+// 编码器删除
+static esp_err_t sk6812_encoder_del(rmt_encoder_t *encoder)
+{
+    sk6812_encoder_t *sk6812_encoder = __containerof(encoder, sk6812_encoder_t, base);
+    rmt_del_encoder(sk6812_encoder->bytes_encoder);
+    rmt_del_encoder(sk6812_encoder->copy_encoder);
+    free(sk6812_encoder);
+    return ESP_OK;
+}
+
+esp_err_t sk6812_new_encoder(rmt_encoder_handle_t *ret_encoder)
+{
+    esp_err_t ret = ESP_OK;
+    sk6812_encoder_t *sk6812_encoder = NULL;
+
+    ESP_GOTO_ON_FALSE(ret_encoder, ESP_ERR_INVALID_ARG, err, TAG, "invalid argument");
+
+    sk6812_encoder = calloc(1, sizeof(sk6812_encoder_t));
+    ESP_GOTO_ON_FALSE(sk6812_encoder, ESP_ERR_NO_MEM, err, TAG, "no mem for sk6812 encoder");
+
+    sk6812_encoder->base.encode = sk6812_encode;
+    sk6812_encoder->base.del = sk6812_encoder_del;
+    sk6812_encoder->base.reset = sk6812_encoder_reset;
+
+    // 创建字节编码器，按缓冲区顺序逐字节MSB优先: G7...G0 R7...R0 B7...B0 (W7...W0)
+    rmt_bytes_encoder_config_t bytes_encoder_config = {
+        .bit0 = {
+            .level0 = 1,
+            .duration0 = T0H,
+            .level1 = 0,
+            .duration1 = T0L,
+        },
+        .bit1 = {
+            .level0 = 1,
+            .duration0 = T1H,
+            .level1 = 0,
+            .duration1 = T1L,
+        },
+        .flags.msb_first = 1
+    };
+    ESP_GOTO_ON_ERROR(rmt_new_bytes_encoder(&bytes_encoder_config, &sk6812_encoder->bytes_encoder), err, TAG, "create bytes encoder failed");
+
+    // 创建复制编码器，用于发送复位信号
+    rmt_copy_encoder_config_t copy_encoder_config = {};
+    ESP_GOTO_ON_ERROR(rmt_new_copy_encoder(&copy_encoder_config, &sk6812_encoder->copy_encoder), err, TAG, "create copy encoder failed");
+
+    sk6812_encoder->reset_code = (rmt_symbol_word_t) {
+        .level0 = 0,
+        .duration0 = TRS,
+        .level1 = 0,
+        .duration1 = 0,
+    };
+
+    *ret_encoder = &sk6812_encoder->base;
+    return ESP_OK;
+
+err:
+    if (sk6812_encoder) {
+        if (sk6812_encoder->bytes_encoder) {
+            rmt_del_encoder(sk6812_encoder->bytes_encoder);
+        }
+        if (sk6812_encoder->copy_encoder) {
+            rmt_del_encoder(sk6812_encoder->copy_encoder);
+        }
+        free(sk6812_encoder);
+    }
+    return ret;
+}
@@ -0,0 +1,52 @@
+// SK6812 功率限制 - 按增量累计的分量之和估算每帧电流，超出预算时整帧统一缩放
+
+#include <string.h>
+#include "sk6812_power.h"
+
+// 按缩放系数重建查找表，向下取整保证不超预算
+static void sk6812_power_build_lut(sk6812_power_t *power)
+{
+    for (int i = 0; i < 256; i++) {
+        power->lut[i] = i * power->scale / 255;
+    }
+}
+
+void sk6812_power_init(sk6812_power_t *power, uint32_t budget_ma, uint32_t channel_ma, uint32_t idle_ma)
+{
+    memset(power, 0, sizeof(sk6812_power_t));
+    power->budget_ma = budget_ma;
+    power->channel_ma = channel_ma ? channel_ma : SK6812_POWER_DEFAULT_CHANNEL_MA;
+    power->idle_ma = idle_ma;
+    power->scale = 255;
+    sk6812_power_build_lut(power);
+}
+
+uint8_t sk6812_power_update(sk6812_power_t *power)
+{
+    uint32_t dynamic_ma = (uint64_t)power->channel_sum * power->channel_ma / 255;
+    uint8_t scale = 255;
+
+    power->estimated_ma = power->idle_ma + dynamic_ma;
+    if (power->budget_ma && power->estimated_ma > power->budget_ma) {
+        // 静态电流无法缩放，只缩放LED部分
+        scale = power->budget_ma > power->idle_ma ? (power->budget_ma - power->idle_ma) * 255 / dynamic_ma : 0;
+        power->limited_frames++;
+    }
+    power->output_ma = power->idle_ma + dynamic_ma * scale / 255;
+    if (scale != power->scale) {
+        power->scale = scale;
+        sk6812_power_build_lut(power);
+    }
+    return scale;
+}
+
+uint32_t sk6812_power_apply(const sk6812_power_t *power, const uint8_t *src, uint8_t *dst, size_t len)
+{
+    const uint8_t *lut = power->lut;
+    uint32_t sum = 0;
+    for (size_t i = 0; i < len; i++) {
+        dst[i] = lut[src[i]];
+        sum += dst[i];
+    }
+    return sum;
+}
@@ -0,0 +1,84 @@
+// 白色提取的每帧耗时: 900和1800个LED，刷新时后缓冲区复制到前缓冲区 (只查表/直接复制/提取白色/提取后查表)，与只查表比较
+// 主机上的RMT立即完成发送，不计编码耗时；每项都必须远小于一帧在线上的时间 (每个LED 32位 x 1.2us)
+
+#include <stdio.h>
+#include "host_test.h"
+#include "host_idf.h"
+#include "sk6812.h"
+
+#define BENCH_FRAMES 2000
+#define BENCH_ROUNDS 5
+#define BENCH_QUICK_FRAMES 20
+#define BENCH_WIRE_NS_PER_LED 38400
+
+static const uint16_t bench_led_counts[] = {900, 1800};
+
+typedef struct {
+    const char *name;
+    bool white;             // 提取白色
+    uint8_t brightness;     // 255且gamma为1.0时直接复制
+    float gamma;
+} bench_case_t;
+
+static const bench_case_t bench_cases[] = {
+    {"lut", false, 200, 2.2f},
+    {"copy", false, 255, 1.0f},
+    {"white", true, 255, 1.0f},
+    {"white + lut", true, 200, 2.2f},
+};
+
+static void refresh_strip(void *arg)
+{
+    sk6812_refresh(arg);
+}
+
+static void bench_layout(uint16_t leds, uint32_t frames, int rounds)
+{
+    double wire_ns = (double)leds * BENCH_WIRE_NS_PER_LED;
+    double lut_ns = 0;
+    for (size_t k = 0; k < sizeof(bench_cases) / sizeof(bench_cases[0]); k++) {
+        const bench_case_t *c = &bench_cases[k];
+        sk6812_config_t config = {
+            .gpio_num = 18,
+            .led_count = leds,
+            .resolution_hz = 10000000,
+        };
+        sk6812_handle_t strip = NULL;
+        HOST_CHECK_EQ(sk6812_new(&config, &strip), ESP_OK);
+        if (strip == NULL) {
+            return;
+        }
+        HOST_CHECK_EQ(sk6812_enable(strip), ESP_OK);
+        HOST_CHECK_EQ(sk6812_set_white_extraction(strip, c->white ? &SK6812_WHITE_NEUTRAL_4500K : NULL), ESP_OK);
+        HOST_CHECK_EQ(sk6812_set_brightness(strip, c->brightness), ESP_OK);
+        HOST_CHECK_EQ(sk6812_set_gamma(strip, c->gamma), ESP_OK);
+        // 混合色，每个像素都有白色成分
+        for (uint16_t i = 0; i < leds; i++) {
+            sk6812_set_pixel_rgb(strip, i, 255 - (i & 0x7F), 128 + (i * 3 & 0x7F), 64 + (i * 5 & 0x7F));
+        }
+
+        uint64_t allocs = host_alloc_count();
+        double ns = host_bench_run(refresh_strip, strip, frames, rounds);
+        HOST_CHECK_EQ(host_alloc_count() - allocs, 0);
+        HOST_CHECK(ns < wire_ns);
+        if (k == 0) {
+            lut_ns = ns;
+        }
+        printf("%5u  %-12s %10.2f %9.2f %8.2fx %9.2f%%\n", leds, c->name, ns / 1000, ns / leds, ns / lut_ns,
+               ns * 100 / wire_ns);
+        HOST_CHECK_EQ(sk6812_del(strip), ESP_OK);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    bool quick = host_bench_quick(argc, argv);
+    uint32_t frames = quick ? BENCH_QUICK_FRAMES : BENCH_FRAMES;
+    int rounds = quick ? 1 : BENCH_ROUNDS;
+
+    printf("%5s  %-12s %10s %9s %9s %10s\n", "leds", "case", "us/frame", "ns/led", "vs lut", "of wire");
+    for (size_t i = 0; i < sizeof(bench_led_counts) / sizeof(bench_led_counts[0]); i++) {
+        bench_layout(bench_led_counts[i], frames, rounds);
+    }
+    return host_test_finish("bench_sk6812_white");
+}
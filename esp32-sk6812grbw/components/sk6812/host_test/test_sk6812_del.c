@@ -0,0 +1,69 @@
+// 删除灯带: 启用的灯带先等正在发送的帧发完 (RMT按线路时序在虚拟时间中发送) 再禁用通道，
+// 通道删除失败时返回错误；禁用后或从未启用的灯带直接删除
+
+#include <stdio.h>
+#include "host_test.h"
+#include "host_idf.h"
+#include "esp_timer.h"
+#include "sk6812.h"
+
+#define TEST_LEDS 300
+
+static sk6812_handle_t new_strip(void)
+{
+    sk6812_config_t config = {
+        .gpio_num = 18,
+        .led_count = TEST_LEDS,
+        .resolution_hz = 10000000,
+    };
+    sk6812_handle_t strip = NULL;
+    HOST_CHECK_EQ(sk6812_new(&config, &strip), ESP_OK);
+    return strip;
+}
+
+// 帧还在线路上时删除: 返回时帧已发完
+static void test_del_in_flight(void)
+{
+    sk6812_handle_t strip = new_strip();
+    if (strip == NULL) {
+        return;
+    }
+    rmt_channel_handle_t channel = host_rmt_last_channel();
+    HOST_CHECK_EQ(sk6812_enable(strip), ESP_OK);
+    for (int i = 0; i < TEST_LEDS; i++) {
+        sk6812_set_pixel_grbw(strip, i, i, 2 * i, 3 * i, 4 * i);
+    }
+    int64_t start_us = esp_timer_get_time();
+    HOST_CHECK_EQ(sk6812_show_async(strip), ESP_OK);
+    uint64_t wire_us = host_rmt_wire_us(channel);
+    HOST_CHECK(wire_us > 0);
+    HOST_CHECK_EQ(host_rmt_frames(channel), 0);
+    HOST_CHECK_EQ(sk6812_del(strip), ESP_OK);
+    printf("frame on the wire %lu us, deleted after %lu us\n", (unsigned long)wire_us,
+           (unsigned long)(esp_timer_get_time() - start_us));
+    HOST_CHECK(esp_timer_get_time() - start_us >= (int64_t)wire_us);
+}
+
+static void test_del_disabled(void)
+{
+    sk6812_handle_t strip = new_strip();
+    if (strip) {
+        HOST_CHECK_EQ(sk6812_del(strip), ESP_OK);
+    }
+    strip = new_strip();
+    if (strip) {
+        HOST_CHECK_EQ(sk6812_enable(strip), ESP_OK);
+        HOST_CHECK_EQ(sk6812_refresh(strip), ESP_OK);
+        HOST_CHECK_EQ(sk6812_disable(strip), ESP_OK);
+        HOST_CHECK_EQ(sk6812_del(strip), ESP_OK);
+    }
+}
+
+int main(void)
+{
+    host_timer_use_virtual_time(0);
+    host_rmt_set_wire_time(true, 0, 0);
+    test_del_in_flight();
+    test_del_disabled();
+    return host_test_finish("test_sk6812_del");
+}
@@ -0,0 +1,103 @@
+// 功率限制: 超出预算的帧按统一系数缩放，发送的字节等于亮度/gamma表项乘系数后向下取整，
+// 估算的输出电流不超过预算；像素缓冲区保持原颜色，取消限制后恢复原输出
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "host_test.h"
+#include "host_idf.h"
+#include "sk6812.h"
+
+#define TEST_LEDS 300
+#define TEST_CHANNEL_MA 15
+#define TEST_IDLE_MA 120
+#define TEST_BUDGET_MA 2000
+
+// 与驱动建表相同的单精度计算
+static uint8_t ref_base(uint8_t value, uint8_t brightness, float gamma)
+{
+    float level = gamma == 1.0f ? value : 255.0f * powf(value / 255.0f, gamma);
+    return (uint8_t)(level * brightness / 255.0f + 0.5f);
+}
+
+static sk6812_handle_t new_strip(void)
+{
+    sk6812_config_t config = {
+        .gpio_num = 18,
+        .led_count = TEST_LEDS,
+        .resolution_hz = 10000000,
+    };
+    sk6812_handle_t strip = NULL;
+    HOST_CHECK_EQ(sk6812_new(&config, &strip), ESP_OK);
+    if (strip) {
+        HOST_CHECK_EQ(sk6812_enable(strip), ESP_OK);
+    }
+    return strip;
+}
+
+// 用fill填满灯带后刷新，逐字节比较发送数据，返回不一致的字节数
+static int refresh_and_compare(sk6812_handle_t strip, uint8_t fill, uint8_t brightness, float gamma,
+                               sk6812_power_stats_t *stats)
+{
+    for (int i = 0; i < TEST_LEDS; i++) {
+        sk6812_set_pixel_grbw(strip, i, fill, fill / 2, (uint8_t)(fill + i), i & 0xFF);
+    }
+    HOST_CHECK_EQ(sk6812_refresh(strip), ESP_OK);
+    HOST_CHECK_EQ(sk6812_get_power_stats(strip, stats), ESP_OK);
+
+    size_t size = 0;
+    const uint8_t *payload = host_rmt_last_payload(host_rmt_last_channel(), &size);
+    HOST_CHECK_EQ(size, TEST_LEDS * 4);
+    if (size != TEST_LEDS * 4) {
+        return -1;
+    }
+    int errors = 0;
+    for (int i = 0; i < TEST_LEDS; i++) {
+        const uint8_t grbw[4] = {fill, fill / 2, (uint8_t)(fill + i), i & 0xFF};
+        for (int c = 0; c < 4; c++) {
+            errors += payload[i * 4 + c] != ref_base(grbw[c], brightness, gamma) * stats->scale / 255;
+        }
+    }
+    return errors;
+}
+
+static void test_limited_frames(void)
+{
+    const uint8_t brightness = 200;
+    const float gamma = 2.2f;
+    sk6812_handle_t strip = new_strip();
+    if (strip == NULL) {
+        return;
+    }
+    HOST_CHECK_EQ(sk6812_set_brightness(strip, brightness), ESP_OK);
+    HOST_CHECK_EQ(sk6812_set_gamma(strip, gamma), ESP_OK);
+    HOST_CHECK_EQ(sk6812_set_power_limit(strip, TEST_BUDGET_MA, TEST_CHANNEL_MA, TEST_IDLE_MA), ESP_OK);
+
+    // 每帧的分量之和不同，缩放系数逐帧变化
+    uint32_t limited = 0;
+    for (int fill = 0; fill < 256; fill += 15) {
+        sk6812_power_stats_t stats;
+        HOST_CHECK_EQ(refresh_and_compare(strip, fill, brightness, gamma, &stats), 0);
+        HOST_CHECK(stats.output_ma <= TEST_BUDGET_MA);
+        HOST_CHECK(stats.scale == 255 || stats.estimated_ma > TEST_BUDGET_MA);
+        limited += stats.scale < 255;
+    }
+    HOST_CHECK(limited > 5);
+
+    // 限制生效期间改亮度，再取消限制
+    HOST_CHECK_EQ(sk6812_set_brightness(strip, 255), ESP_OK);
+    sk6812_power_stats_t stats;
+    HOST_CHECK_EQ(refresh_and_compare(strip, 240, 255, gamma, &stats), 0);
+    HOST_CHECK(stats.scale < 255);
+    HOST_CHECK_EQ(sk6812_set_power_limit(strip, 0, TEST_CHANNEL_MA, TEST_IDLE_MA), ESP_OK);
+    HOST_CHECK_EQ(refresh_and_compare(strip, 240, 255, gamma, &stats), 0);
+    HOST_CHECK_EQ(stats.scale, 255);
+    HOST_CHECK_EQ(sk6812_del(strip), ESP_OK);
+}
+
+int main(void)
+{
+    host_rmt_set_capture(true);
+    test_limited_frames();
+    return host_test_finish("test_sk6812_power");
+}
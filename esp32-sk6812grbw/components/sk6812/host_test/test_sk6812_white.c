@@ -0,0 +1,189 @@
+// 白色提取: 三种预设色温下，驱动发给RMT的GRBW字节与浮点参考逐像素比较
+// 参考: W = floor(min(分量 * 255 / 白点分量))，各分量减去round(W * 白点分量 / 255)
+// R和G遍历全部取值，B按步长取值 (每帧都经过RMT编码器，全部1677万种输入太慢；12V节点的测试遍历全部输入)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "host_test.h"
+#include "host_idf.h"
+#include "sk6812.h"
+
+#define TEST_G_PER_FRAME 64
+#define TEST_LEDS (256 * TEST_G_PER_FRAME)  // 一帧: R全部取值 x 64个G值
+#define TEST_B_STEP 5                       // 0, 5, ... 255
+#define TEST_RESOLUTION_HZ 10000000
+
+static const struct {
+    const char *name;
+    sk6812_white_point_t point;
+} test_presets[] = {
+    {"3000K", SK6812_WHITE_WARM_3000K},
+    {"4500K", SK6812_WHITE_NEUTRAL_4500K},
+    {"6500K", SK6812_WHITE_COOL_6500K},
+};
+
+// 浮点参考，输出GRBW
+static void ref_extract(const sk6812_white_point_t *white, const uint8_t rgb[3], uint8_t grbw[4])
+{
+    const uint8_t point[3] = {white->r, white->g, white->b};
+    double level = 255;
+    for (int c = 0; c < 3; c++) {
+        if (point[c]) {
+            level = fmin(level, rgb[c] * 255.0 / point[c]);
+        }
+    }
+    int w = (int)floor(level);
+    int out[3];
+    for (int c = 0; c < 3; c++) {
+        out[c] = rgb[c] - (int)floor(w * point[c] / 255.0 + 0.5);
+    }
+    grbw[0] = out[1];
+    grbw[1] = out[0];
+    grbw[2] = out[2];
+    grbw[3] = w;
+}
+
+// W和剩下的RGB合起来与输入颜色的偏差 (LSB)，不超过0.5
+static bool color_kept(const sk6812_white_point_t *white, const uint8_t rgb[3], const uint8_t grbw[4])
+{
+    const uint8_t point[3] = {white->r, white->g, white->b};
+    const uint8_t out[3] = {grbw[1], grbw[0], grbw[2]};
+    for (int c = 0; c < 3; c++) {
+        // 无符号回绕时输出会远大于输入
+        if (out[c] > rgb[c] || fabs(out[c] + grbw[3] * point[c] / 255.0 - rgb[c]) > 0.5) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static sk6812_handle_t new_strip(uint16_t leds)
+{
+    sk6812_config_t config = {
+        .gpio_num = 18,
+        .led_count = leds,
+        .resolution_hz = TEST_RESOLUTION_HZ,
+    };
+    sk6812_handle_t strip = NULL;
+    HOST_CHECK_EQ(sk6812_new(&config, &strip), ESP_OK);
+    if (strip) {
+        HOST_CHECK_EQ(sk6812_enable(strip), ESP_OK);
+    }
+    return strip;
+}
+
+// 刷新一帧，返回发给RMT的字节 (led_count * 4，大小不对时返回NULL)
+static const uint8_t *refresh_payload(sk6812_handle_t strip, uint16_t leds)
+{
+    size_t size = 0;
+    HOST_CHECK_EQ(sk6812_refresh(strip), ESP_OK);
+    const uint8_t *payload = host_rmt_last_payload(host_rmt_last_channel(), &size);
+    HOST_CHECK_EQ(size, leds * 4);
+    return size == leds * 4u ? payload : NULL;
+}
+
+static void test_presets_sweep(void)
+{
+    sk6812_handle_t strip = new_strip(TEST_LEDS);
+    if (strip == NULL) {
+        return;
+    }
+    for (size_t p = 0; p < sizeof(test_presets) / sizeof(test_presets[0]); p++) {
+        const sk6812_white_point_t *white = &test_presets[p].point;
+        HOST_CHECK_EQ(sk6812_set_white_extraction(strip, white), ESP_OK);
+        uint32_t mismatches = 0;
+        uint32_t color_errors = 0;
+        uint32_t pixels = 0;
+        for (int b = 0; b <= 255; b += TEST_B_STEP) {
+            for (int g0 = 0; g0 < 256; g0 += TEST_G_PER_FRAME) {
+                for (int i = 0; i < TEST_LEDS; i++) {
+                    sk6812_set_pixel_rgb(strip, i, i & 0xFF, g0 + (i >> 8), b);
+                }
+                const uint8_t *payload = refresh_payload(strip, TEST_LEDS);
+                if (payload == NULL) {
+                    continue;
+                }
+                for (int i = 0; i < TEST_LEDS; i++) {
+                    const uint8_t rgb[3] = {i & 0xFF, g0 + (i >> 8), b};
+                    uint8_t expected[4];
+                    ref_extract(white, rgb, expected);
+                    mismatches += memcmp(&payload[i * 4], expected, 4) != 0;
+                    color_errors += !color_kept(white, rgb, &payload[i * 4]);
+                    pixels++;
+                }
+            }
+        }
+        printf("%s: %lu pixels, %lu mismatches, %lu color errors\n", test_presets[p].name,
+               (unsigned long)pixels, (unsigned long)mismatches, (unsigned long)color_errors);
+        HOST_CHECK_EQ(mismatches, 0);
+        HOST_CHECK_EQ(color_errors, 0);
+    }
+    HOST_CHECK_EQ(sk6812_del(strip), ESP_OK);
+}
+
+// 白色与已有的W相加后饱和；像素缓冲区保持RGB，重复刷新结果不变；关闭后原样发送
+static void test_existing_white(void)
+{
+    sk6812_handle_t strip = new_strip(3);
+    if (strip == NULL) {
+        return;
+    }
+    HOST_CHECK_EQ(sk6812_set_white_extraction(strip, &SK6812_WHITE_NEUTRAL_4500K), ESP_OK);
+    sk6812_set_pixel_grbw(strip, 0, 219, 255, 186, 10);    // 正好是白点: 全部转到W
+    sk6812_set_pixel_grbw(strip, 1, 219, 255, 186, 200);   // W饱和
+    sk6812_set_pixel_grbw(strip, 2, 0, 255, 0, 77);        // 纯红没有白色成分
+    static const uint8_t expected[3][4] = {{0, 0, 0, 255}, {0, 0, 0, 255}, {0, 255, 0, 77}};
+    for (int frame = 0; frame < 2; frame++) {
+        const uint8_t *payload = refresh_payload(strip, 3);
+        HOST_CHECK(payload && memcmp(payload, expected, sizeof(expected)) == 0);
+    }
+
+    HOST_CHECK_EQ(sk6812_set_white_extraction(strip, NULL), ESP_OK);
+    static const uint8_t raw[3][4] = {{219, 255, 186, 10}, {219, 255, 186, 200}, {0, 255, 0, 77}};
+    const uint8_t *payload = refresh_payload(strip, 3);
+    HOST_CHECK(payload && memcmp(payload, raw, sizeof(raw)) == 0);
+    HOST_CHECK_EQ(sk6812_del(strip), ESP_OK);
+}
+
+// 亮度和gamma查找表在白色提取之后应用
+static void test_lut_after_extraction(void)
+{
+    enum { LEDS = 256 };
+    const float gamma = 2.2f;
+    const uint8_t brightness = 128;
+    sk6812_handle_t strip = new_strip(LEDS);
+    if (strip == NULL) {
+        return;
+    }
+    HOST_CHECK_EQ(sk6812_set_white_extraction(strip, &SK6812_WHITE_WARM_3000K), ESP_OK);
+    HOST_CHECK_EQ(sk6812_set_brightness(strip, brightness), ESP_OK);
+    HOST_CHECK_EQ(sk6812_set_gamma(strip, gamma), ESP_OK);
+    for (int i = 0; i < LEDS; i++) {
+        sk6812_set_pixel_rgb(strip, i, i, 255 - i, (i * 7) & 0xFF);
+    }
+    const uint8_t *payload = refresh_payload(strip, LEDS);
+    int errors = 0;
+    for (int i = 0; payload && i < LEDS; i++) {
+        const uint8_t rgb[3] = {i, 255 - i, (i * 7) & 0xFF};
+        uint8_t grbw[4];
+        ref_extract(&SK6812_WHITE_WARM_3000K, rgb, grbw);
+        for (int c = 0; c < 4; c++) {
+            // 与驱动建表相同的单精度计算
+            float level = 255.0f * powf(grbw[c] / 255.0f, gamma);
+            errors += payload[i * 4 + c] != (uint8_t)(level * brightness / 255.0f + 0.5f);
+        }
+    }
+    HOST_CHECK_EQ(errors, 0);
+    HOST_CHECK_EQ(sk6812_del(strip), ESP_OK);
+}
+
+int main(void)
+{
+    host_rmt_set_capture(true);
+    test_presets_sweep();
+    test_existing_white();
+    test_lut_after_extraction();
+    return host_test_finish("test_sk6812_white");
+}
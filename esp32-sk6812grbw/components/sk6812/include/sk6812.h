@@ -16,6 +16,8 @@ extern "C" {
 #define SK6812_T1L_NS    600   // 1码低电平时间
 #define SK6812_RESET_US  80    // 复位时间 (微秒)
 
+#define SK6812_DEFAULT_CHANNEL_MA 12   // 单个颜色分量满值时的电流 (毫安)
+
 // 颜色结构体 (GRBW)
 typedef struct {
     uint8_t g;  // Green
@@ -24,6 +26,18 @@ typedef struct {
     uint8_t w;  // White
 } sk6812_color_t;
 
+// 白光LED满亮度时相当于的RGB颜色 (色温)，用于从RGB中提取白色
+typedef struct {
+    uint8_t r;
+    uint8_t g;
+    uint8_t b;
+} sk6812_white_point_t;
+
+// 常见白光LED色温
+#define SK6812_WHITE_WARM_3000K     ((sk6812_white_point_t){.r = 255, .g = 177, .b = 110})
+#define SK6812_WHITE_NEUTRAL_4500K  ((sk6812_white_point_t){.r = 255, .g = 219, .b = 186})
+#define SK6812_WHITE_COOL_6500K     ((sk6812_white_point_t){.r = 255, .g = 254, .b = 250})
+
 // SK6812 配置结构体
 typedef struct {
     uint8_t gpio_num;           // GPIO引脚
@@ -32,6 +46,14 @@ typedef struct {
     rmt_channel_handle_t rmt_channel;  // RMT通道句柄
 } sk6812_config_t;
 
+// 功率统计 (最近一次刷新的帧)
+typedef struct {
+    uint32_t estimated_ma;      // 限制前的估算电流 (毫安)
+    uint32_t output_ma;         // 限制后的估算电流 (毫安)
+    uint8_t scale;              // 应用的缩放系数 (255为未限制)
+    uint32_t limited_frames;    // 创建以来被缩放的帧数
+} sk6812_power_stats_t;
+
 // SK6812 句柄
 typedef struct sk6812_strip_t* sk6812_handle_t;
 
@@ -47,6 +69,8 @@ esp_err_t sk6812_new(const sk6812_config_t *config, sk6812_handle_t *handle);
 /**
  * @brief 删除 SK6812 灯带实例
  * 
+ * 灯带已启用时先等待正在发送的帧完成并禁用通道
+ * 
  * @param handle 句柄
  * @return esp_err_t 
  */
@@ -75,6 +99,20 @@ esp_err_t sk6812_set_pixel(sk6812_handle_t handle, uint16_t index, sk6812_color_
  */
 esp_err_t sk6812_set_pixel_grbw(sk6812_handle_t handle, uint16_t index, uint8_t g, uint8_t r, uint8_t b, uint8_t w);
 
+/**
+ * @brief 设置单个像素的RGB颜色 (白色分量为0)
+ * 
+ * 开启白色提取 (sk6812_set_white_extraction) 后，发送时自动把RGB中的白色部分转到白光LED
+ * 
+ * @param handle 句柄
+ * @param index 像素索引
+ * @param r 红色分量
+ * @param g 绿色分量
+ * @param b 蓝色分量
+ * @return esp_err_t 
+ */
+esp_err_t sk6812_set_pixel_rgb(sk6812_handle_t handle, uint16_t index, uint8_t r, uint8_t g, uint8_t b);
+
 /**
  * @brief 清空所有像素
  * 
@@ -84,13 +122,95 @@ esp_err_t sk6812_set_pixel_grbw(sk6812_handle_t handle, uint16_t index, uint8_t
 esp_err_t sk6812_clear(sk6812_handle_t handle);
 
 /**
- * @brief 刷新显示
+ * @brief 提交当前帧并立即返回
+ * 
+ * 灯带有前后两个缓冲区: sk6812_set_pixel等函数只写后缓冲区，本函数把后缓冲区 (经亮度/gamma查找表)
+ * 复制到前缓冲区并排队发送，RMT只读取前缓冲区。返回后即可绘制下一帧，不会撕裂正在发送的帧，
+ * 后缓冲区内容保持不变。上一帧仍在发送时先等待其完成。
+ * 
+ * @param handle 句柄
+ * @return esp_err_t 
+ */
+esp_err_t sk6812_show_async(sk6812_handle_t handle);
+
+/**
+ * @brief 等待已提交的帧发送完成
+ * 
+ * @param handle 句柄
+ * @param timeout_ms 超时时间 (毫秒)，-1为一直等待
+ * @return esp_err_t ESP_OK发送完成，ESP_ERR_TIMEOUT超时
+ */
+esp_err_t sk6812_wait_done(sk6812_handle_t handle, int32_t timeout_ms);
+
+/**
+ * @brief 刷新显示，与sk6812_show_async相同
  * 
  * @param handle 句柄
  * @return esp_err_t 
  */
 esp_err_t sk6812_refresh(sk6812_handle_t handle);
 
+/**
+ * @brief 设置全局亮度
+ * 
+ * 亮度和gamma合并成一张256项查找表，在刷新时随数据一起转换，
+ * 像素缓冲区保持全亮度颜色，调节亮度不需要重新渲染。
+ * 
+ * @param handle 句柄
+ * @param brightness 亮度 (255为全亮)
+ * @return esp_err_t 
+ */
+esp_err_t sk6812_set_brightness(sk6812_handle_t handle, uint8_t brightness);
+
+/**
+ * @brief 设置gamma校正
+ * 
+ * @param handle 句柄
+ * @param gamma gamma指数 (1.0为不校正)
+ * @return esp_err_t 
+ */
+esp_err_t sk6812_set_gamma(sk6812_handle_t handle, float gamma);
+
+/**
+ * @brief 开启/关闭白色提取
+ * 
+ * 开启后每次发送时取 R/G/B 能共同提供的白色 (按白光LED的色温折算后取最小值)，
+ * 从RGB中减去并加到白色分量上 (饱和到255)。同样的颜色只用一个白光LED发出，
+ * 每瓦亮度更高，效果代码只需要写RGB。转换通过查找表在复制到前缓冲区时完成，
+ * 像素缓冲区保持原颜色。
+ * 
+ * @param handle 句柄
+ * @param white 白光LED的色温 (如SK6812_WHITE_NEUTRAL_4500K)，NULL为关闭
+ * @return esp_err_t 
+ */
+esp_err_t sk6812_set_white_extraction(sk6812_handle_t handle, const sk6812_white_point_t *white);
+
+/**
+ * @brief 设置电流预算
+ * 
+ * 写像素时增量累计所有分量之和，刷新时不需要额外遍历整帧即可估算电流。
+ * 估算值超出预算时在查找表中统一缩放整帧，像素缓冲区保持原颜色。
+ * 估算与分量值成线性关系，gamma大于1.0时为上限值。
+ * 
+ * @param handle 句柄
+ * @param budget_ma 电流预算 (毫安，0为不限制)
+ * @param channel_ma 单个分量满值时的电流 (毫安，0为默认值SK6812_DEFAULT_CHANNEL_MA)
+ * @param idle_ma 全灭时整条灯带的静态电流 (毫安)
+ * @return esp_err_t 
+ */
+esp_err_t sk6812_set_power_limit(sk6812_handle_t handle, uint32_t budget_ma, uint32_t channel_ma, uint32_t idle_ma);
+
+/**
+ * @brief 读取最近一次刷新的估算电流
+ * 
+ * 未设置预算时也会估算
+ * 
+ * @param handle 句柄
+ * @param stats 返回的功率统计
+ * @return esp_err_t 
+ */
+esp_err_t sk6812_get_power_stats(sk6812_handle_t handle, sk6812_power_stats_t *stats);
+
 /**
  * @brief 启用灯带
  * 
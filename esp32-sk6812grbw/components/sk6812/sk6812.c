@@ -1,10 +1,14 @@
 #include "sk6812.h"
 #include <stdlib.h>
 #include <string.h>
+#include <stdbool.h>
+#include <math.h>
+#include "esp_attr.h"
 #include "esp_log.h"
 #include "esp_check.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
 
 static const char *TAG = "sk6812";
 
@@ -12,9 +16,26 @@ static const char *TAG = "sk6812";
 struct sk6812_strip_t {
     rmt_channel_handle_t rmt_channel;
     rmt_encoder_handle_t encoder;
-    uint8_t *pixel_buf;
+    uint8_t *pixel_buf;     // 后缓冲区: 应用写入的像素
     uint16_t led_count;
     uint8_t gpio_num;
+    uint8_t brightness;     // 全局亮度 (255为全亮)
+    float gamma;            // gamma指数 (1.0为线性)
+    bool lut_identity;      // 亮度255且gamma为1.0时直接发送像素缓冲区
+    uint8_t lut_base[256];  // 亮度和gamma合并后的查找表，只在这两个参数变化时重建
+    uint8_t lut[256];       // lut_base再乘功率限制系数，发送时使用
+    uint8_t *tx_buf;        // 前缓冲区: 经过查找表后的发送数据，RMT发送期间只读
+    SemaphoreHandle_t done_sem; // 前缓冲区空闲时可获取，发送完成回调中释放
+    bool enabled;           // RMT通道已启用 (删除前必须禁用)
+    uint32_t channel_sum;   // 像素缓冲区所有分量之和，写像素时增量更新
+    uint32_t budget_ma;     // 电流预算 (0为不限制)
+    uint32_t channel_ma;    // 单个分量满值时的电流
+    uint32_t idle_ma;       // 全灭时整条灯带的静态电流
+    uint8_t limit;          // 功率限制系数 (255为不限制)，从lut_base导出lut
+    sk6812_power_stats_t power_stats;
+    bool white_enabled;             // 发送前从RGB中提取白色
+    uint8_t white_level[3][256];    // 按R/G/B分量值查: 该分量最多能由白光LED提供的白色亮度
+    uint8_t white_sub[3][256];      // 按白色亮度查: 需要从R/G/B分量中减去的值
 };
 
 // RMT编码器结构体
@@ -48,6 +69,83 @@ static const rmt_symbol_word_t sk6812_bit1 = {
     .duration1 = 6   // T1L = 600ns (at 10MHz)
 };
 
+// 按功率限制系数从lut_base导出发送用的查找表，每项一次整数乘法，向下取整保证不超预算
+static void sk6812_apply_limit(struct sk6812_strip_t *strip)
+{
+    uint32_t limit = strip->limit;
+    strip->lut_identity = limit == 255 && strip->brightness == 255 && strip->gamma == 1.0f;
+    for (int i = 0; i < 256; i++) {
+        strip->lut[i] = strip->lut_base[i] * limit / 255;
+    }
+}
+
+// 重建亮度/gamma查找表 (gamma不为1.0时每项一次powf，只在亮度和gamma变化时调用)
+static void sk6812_update_lut(struct sk6812_strip_t *strip)
+{
+    for (int i = 0; i < 256; i++) {
+        float level = strip->gamma == 1.0f ? i : 255.0f * powf(i / 255.0f, strip->gamma);
+        strip->lut_base[i] = (uint8_t)(level * strip->brightness / 255.0f + 0.5f);
+    }
+    sk6812_apply_limit(strip);
+}
+
+// 发送完成回调 (中断上下文)，释放前缓冲区
+static bool IRAM_ATTR sk6812_tx_done(rmt_channel_handle_t channel, const rmt_tx_done_event_data_t *edata, void *user_ctx)
+{
+    struct sk6812_strip_t *strip = (struct sk6812_strip_t *)user_ctx;
+    BaseType_t task_woken = pdFALSE;
+    xSemaphoreGiveFromISR(strip->done_sem, &task_woken);
+    return task_woken == pdTRUE;
+}
+
+// 按白光LED的色温建立白色提取查找表
+static void sk6812_update_white_lut(struct sk6812_strip_t *strip, const sk6812_white_point_t *white)
+{
+    const uint8_t point[3] = {white->r, white->g, white->b};
+    for (int c = 0; c < 3; c++) {
+        for (int v = 0; v < 256; v++) {
+            // 白光LED不含该分量时不限制白色亮度；向下取整保证减去的值不超过分量本身
+            uint32_t level = point[c] ? v * 255 / point[c] : 255;
+            strip->white_level[c][v] = level > 255 ? 255 : level;
+            strip->white_sub[c][v] = (v * point[c] + 127) / 255;
+        }
+    }
+}
+
+// 把后缓冲区经白色提取和查找表写入前缓冲区
+static void sk6812_render_front(struct sk6812_strip_t *strip)
+{
+    const uint8_t *src = strip->pixel_buf;
+    uint8_t *dst = strip->tx_buf;
+    const uint8_t *lut = strip->lut;
+    
+    if (!strip->white_enabled) {
+        size_t data_size = strip->led_count * 4;
+        if (strip->lut_identity) {
+            memcpy(dst, src, data_size);
+        } else {
+            for (size_t i = 0; i < data_size; i++) {
+                dst[i] = lut[src[i]];
+            }
+        }
+        return;
+    }
+    
+    for (uint16_t i = 0; i < strip->led_count; i++, src += 4, dst += 4) {
+        // 三个分量能共同提供的白色取最小值，由白光LED代替RGB发出
+        uint8_t w = strip->white_level[0][src[1]];
+        uint8_t level = strip->white_level[1][src[0]];
+        w = level < w ? level : w;
+        level = strip->white_level[2][src[2]];
+        w = level < w ? level : w;
+        uint32_t white = src[3] + w;
+        dst[0] = lut[src[0] - strip->white_sub[1][w]];
+        dst[1] = lut[src[1] - strip->white_sub[0][w]];
+        dst[2] = lut[src[2] - strip->white_sub[2][w]];
+        dst[3] = lut[white > 255 ? 255 : white];
+    }
+}
+
 // 编码器回调函数
 static size_t sk6812_encode(rmt_encoder_t *encoder, rmt_channel_handle_t channel,
                            const void *primary_data, size_t data_size,
@@ -173,15 +271,25 @@ esp_err_t sk6812_new(const sk6812_config_t *config, sk6812_handle_t *handle)
     struct sk6812_strip_t *strip = calloc(1, sizeof(struct sk6812_strip_t));
     ESP_RETURN_ON_FALSE(strip, ESP_ERR_NO_MEM, TAG, "no mem for strip");
     
-    // 分配像素缓冲区 (每个像素4字节: GRBW)
+    // 分配前后两个像素缓冲区 (每个像素4字节: GRBW)
     strip->pixel_buf = calloc(config->led_count, 4);
-    if (!strip->pixel_buf) {
-        free(strip);
-        ESP_RETURN_ON_ERROR(ESP_ERR_NO_MEM, TAG, "no mem for pixel buffer");
-    }
+    ESP_GOTO_ON_FALSE(strip->pixel_buf, ESP_ERR_NO_MEM, err, TAG, "no mem for pixel buffer");
+    strip->tx_buf = calloc(config->led_count, 4);
+    ESP_GOTO_ON_FALSE(strip->tx_buf, ESP_ERR_NO_MEM, err, TAG, "no mem for tx buffer");
+    
+    // 初始时没有帧在发送，前缓冲区空闲
+    strip->done_sem = xSemaphoreCreateBinary();
+    ESP_GOTO_ON_FALSE(strip->done_sem, ESP_ERR_NO_MEM, err, TAG, "no mem for done semaphore");
+    xSemaphoreGive(strip->done_sem);
     
     strip->led_count = config->led_count;
     strip->gpio_num = config->gpio_num;
+    strip->brightness = 255;
+    strip->gamma = 1.0f;
+    strip->limit = 255;
+    strip->channel_ma = SK6812_DEFAULT_CHANNEL_MA;
+    strip->power_stats.scale = 255;
+    sk6812_update_lut(strip);
     
     // 创建RMT发送通道
     rmt_tx_channel_config_t tx_config = {
@@ -196,6 +304,11 @@ esp_err_t sk6812_new(const sk6812_config_t *config, sk6812_handle_t *handle)
     
     ESP_GOTO_ON_ERROR(rmt_new_tx_channel(&tx_config, &strip->rmt_channel), err, TAG, "create RMT TX channel failed");
     
+    rmt_tx_event_callbacks_t cbs = {
+        .on_trans_done = sk6812_tx_done,
+    };
+    ESP_GOTO_ON_ERROR(rmt_tx_register_event_callbacks(strip->rmt_channel, &cbs, strip), err, TAG, "register tx callback failed");
+    
     // 创建编码器
     ESP_GOTO_ON_ERROR(sk6812_new_encoder(config->resolution_hz, &strip->encoder), err, TAG, "create encoder failed");
     
@@ -210,6 +323,10 @@ err:
         if (strip->pixel_buf) {
             free(strip->pixel_buf);
         }
+        if (strip->done_sem) {
+            vSemaphoreDelete(strip->done_sem);
+        }
+        free(strip->tx_buf);
         free(strip);
     }
     return ret;
@@ -219,15 +336,21 @@ esp_err_t sk6812_del(sk6812_handle_t handle)
 {
     ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
     
+    if (handle->enabled) {
+        // 等待正在发送的帧完成 (完成回调还会访问done_sem)，再禁用通道，之后才能删除
+        xSemaphoreTake(handle->done_sem, portMAX_DELAY);
+        ESP_RETURN_ON_ERROR(rmt_disable(handle->rmt_channel), TAG, "disable RMT channel failed");
+        handle->enabled = false;
+    }
+    ESP_RETURN_ON_ERROR(rmt_del_channel(handle->rmt_channel), TAG, "delete RMT channel failed");
     if (handle->encoder) {
         rmt_del_encoder(handle->encoder);
     }
-    if (handle->rmt_channel) {
-        rmt_del_channel(handle->rmt_channel);
-    }
     if (handle->pixel_buf) {
         free(handle->pixel_buf);
     }
+    free(handle->tx_buf);
+    vSemaphoreDelete(handle->done_sem);
     free(handle);
     
     return ESP_OK;
@@ -239,6 +362,9 @@ esp_err_t sk6812_set_pixel(sk6812_handle_t handle, uint16_t index, sk6812_color_
     ESP_RETURN_ON_FALSE(index < handle->led_count, ESP_ERR_INVALID_ARG, TAG, "index out of range");
     
     uint8_t *pixel = &handle->pixel_buf[index * 4];
+    // 减去被覆盖的旧值，估算功率时不需要再遍历整帧
+    handle->channel_sum += color.g + color.r + color.b + color.w;
+    handle->channel_sum -= pixel[0] + pixel[1] + pixel[2] + pixel[3];
     pixel[0] = color.g;
     pixel[1] = color.r;
     pixel[2] = color.b;
@@ -253,25 +379,145 @@ esp_err_t sk6812_set_pixel_grbw(sk6812_handle_t handle, uint16_t index, uint8_t
     return sk6812_set_pixel(handle, index, color);
 }
 
+esp_err_t sk6812_set_pixel_rgb(sk6812_handle_t handle, uint16_t index, uint8_t r, uint8_t g, uint8_t b)
+{
+    sk6812_color_t color = {.g = g, .r = r, .b = b, .w = 0};
+    return sk6812_set_pixel(handle, index, color);
+}
+
 esp_err_t sk6812_clear(sk6812_handle_t handle)
 {
     ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
     
     memset(handle->pixel_buf, 0, handle->led_count * 4);
+    handle->channel_sum = 0;
     return ESP_OK;
 }
 
-esp_err_t sk6812_refresh(sk6812_handle_t handle)
+// 设置亮度或gamma，参数变化时重建查找表
+static void sk6812_apply_lut(sk6812_handle_t handle, uint8_t brightness, float gamma)
+{
+    if (brightness == handle->brightness && gamma == handle->gamma) {
+        return;
+    }
+    handle->brightness = brightness;
+    handle->gamma = gamma;
+    sk6812_update_lut(handle);
+}
+
+// 设置功率限制系数，只从缓存的lut_base导出查找表
+static void sk6812_set_limit(sk6812_handle_t handle, uint8_t limit)
+{
+    if (limit == handle->limit) {
+        return;
+    }
+    handle->limit = limit;
+    sk6812_apply_limit(handle);
+}
+
+// 按分量之和估算本帧电流，超出预算时计算统一的缩放系数
+static uint8_t sk6812_estimate_power(sk6812_handle_t handle)
 {
+    sk6812_power_stats_t *stats = &handle->power_stats;
+    uint32_t dynamic_ma = (uint64_t)handle->channel_sum * handle->channel_ma * handle->brightness / (255 * 255);
+    uint8_t scale = 255;
+
+    stats->estimated_ma = handle->idle_ma + dynamic_ma;
+    if (handle->budget_ma && stats->estimated_ma > handle->budget_ma) {
+        // 静态电流无法缩放，只缩放LED部分，向下取整保证不超预算
+        scale = handle->budget_ma > handle->idle_ma ? (handle->budget_ma - handle->idle_ma) * 255 / dynamic_ma : 0;
+        stats->limited_frames++;
+    }
+    stats->output_ma = handle->idle_ma + dynamic_ma * scale / 255;
+    stats->scale = scale;
+    return scale;
+}
+
+esp_err_t sk6812_show_async(sk6812_handle_t handle)
+{
+    esp_err_t ret = ESP_OK;
     ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
     
     rmt_transmit_config_t tx_config = {
         .loop_count = 0,
     };
     
-    ESP_RETURN_ON_ERROR(rmt_transmit(handle->rmt_channel, handle->encoder, handle->pixel_buf, 
-                                   handle->led_count * 4, &tx_config), TAG, "transmit failed");
+    // 限制系数变化时只从lut_base导出查找表，像素缓冲区保持原颜色
+    sk6812_set_limit(handle, sk6812_estimate_power(handle));
+    
+    // 上一帧可能还在读取前缓冲区
+    xSemaphoreTake(handle->done_sem, portMAX_DELAY);
+    
+    // 后缓冲区经查找表复制到前缓冲区，之后应用可以立即绘制下一帧，后缓冲区内容保持不变
+    size_t data_size = handle->led_count * 4;
+    sk6812_render_front(handle);
+    
+    ESP_GOTO_ON_ERROR(rmt_transmit(handle->rmt_channel, handle->encoder, handle->tx_buf,
+                                 data_size, &tx_config), err, TAG, "transmit failed");
+    return ESP_OK;
+    
+err:
+    // 没有排队成功，不会有完成回调
+    xSemaphoreGive(handle->done_sem);
+    return ret;
+}
+
+esp_err_t sk6812_wait_done(sk6812_handle_t handle, int32_t timeout_ms)
+{
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    
+    TickType_t ticks = timeout_ms < 0 ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+    ESP_RETURN_ON_FALSE(xSemaphoreTake(handle->done_sem, ticks) == pdTRUE, ESP_ERR_TIMEOUT, TAG, "wait frame done timeout");
+    // 只是等待，不占用前缓冲区
+    xSemaphoreGive(handle->done_sem);
+    return ESP_OK;
+}
+
+esp_err_t sk6812_refresh(sk6812_handle_t handle)
+{
+    return sk6812_show_async(handle);
+}
+
+esp_err_t sk6812_set_brightness(sk6812_handle_t handle, uint8_t brightness)
+{
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    sk6812_apply_lut(handle, brightness, handle->gamma);
+    return ESP_OK;
+}
+
+esp_err_t sk6812_set_gamma(sk6812_handle_t handle, float gamma)
+{
+    ESP_RETURN_ON_FALSE(handle && gamma > 0, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    sk6812_apply_lut(handle, handle->brightness, gamma);
+    return ESP_OK;
+}
+
+esp_err_t sk6812_set_white_extraction(sk6812_handle_t handle, const sk6812_white_point_t *white)
+{
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
     
+    // 先关闭再重建查找表，避免发送时读到一半更新的表
+    handle->white_enabled = false;
+    if (white) {
+        sk6812_update_white_lut(handle, white);
+        handle->white_enabled = true;
+    }
+    return ESP_OK;
+}
+
+esp_err_t sk6812_set_power_limit(sk6812_handle_t handle, uint32_t budget_ma, uint32_t channel_ma, uint32_t idle_ma)
+{
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    handle->budget_ma = budget_ma;
+    handle->channel_ma = channel_ma ? channel_ma : SK6812_DEFAULT_CHANNEL_MA;
+    handle->idle_ma = idle_ma;
+    return ESP_OK;
+}
+
+esp_err_t sk6812_get_power_stats(sk6812_handle_t handle, sk6812_power_stats_t *stats)
+{
+    ESP_RETURN_ON_FALSE(handle && stats, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    *stats = handle->power_stats;
     return ESP_OK;
 }
 
@@ -280,6 +526,7 @@ esp_err_t sk6812_enable(sk6812_handle_t handle)
     ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
     
     ESP_RETURN_ON_ERROR(rmt_enable(handle->rmt_channel), TAG, "enable RMT channel failed");
+    handle->enabled = true;
     return ESP_OK;
 }
 
@@ -288,5 +535,8 @@ esp_err_t sk6812_disable(sk6812_handle_t handle)
     ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
     
     ESP_RETURN_ON_ERROR(rmt_disable(handle->rmt_channel), TAG, "disable RMT channel failed");
+    handle->enabled = false;
+    // 禁用会中止未完成的发送，不会再有完成回调，前缓冲区重新空闲
+    xSemaphoreGive(handle->done_sem);
     return ESP_OK;
 } 
\ No newline at end of file
@@ -53,13 +53,15 @@ void strip_begin(void) {
     strip.handle = led_strip;
     strip.num_pixels = NUM_LEDS;
     strip.brightness = BRIGHTNESS;
+    ESP_ERROR_CHECK(sk6812_set_brightness(led_strip, BRIGHTNESS));
     
     ESP_LOGI(TAG, "NeoPixel 风格灯带初始化完成，LED数量: %d", NUM_LEDS);
 }
 
-// 设置亮度 (模拟 setBrightness)
+// 设置亮度 (模拟 setBrightness)，由驱动在刷新时通过查找表统一缩放
 void strip_setBrightness(uint8_t brightness) {
     strip.brightness = brightness;
+    sk6812_set_brightness(strip.handle, brightness);
 }
 
 // 获取像素数量 (模拟 numPixels)
@@ -69,12 +71,7 @@ uint16_t strip_numPixels(void) {
 
 // 创建颜色值 (模拟 Color)
 uint32_t strip_Color(uint8_t r, uint8_t g, uint8_t b, uint8_t w) {
-    // 应用亮度调整
-    r = (r * strip.brightness) / 255;
-    g = (g * strip.brightness) / 255;
-    b = (b * strip.brightness) / 255;
-    w = (w * strip.brightness) / 255;
-    
+    // 亮度在刷新时由驱动统一应用，这里保持原始颜色
     return ((uint32_t)g << 24) | ((uint32_t)r << 16) | ((uint32_t)b << 8) | w;
 }
 
@@ -0,0 +1,130 @@
+// 12V SK6812节点的功率限制: 两条灯带镜像同一画布，写像素时按LED数累计的分量之和等于两条灯带实际的分量之和，
+// 超出预算的帧两条灯带都发送缩放后的画布 (floor(分量 * scale / 255))，画布保持原颜色，预算以内原样发送
+
+#include <stdio.h>
+#include <string.h>
+#include "driver/rmt_tx.h"
+#include "host_idf.h"
+#include "host_test.h"
+#include "sk6812_encoder.h"
+#include "sk6812_power.h"
+
+#define TEST_LEDS_PER_STRIP 900
+#define TEST_STRIP_BYTES (TEST_LEDS_PER_STRIP * 3)
+#define TEST_FRAMES 300
+
+// main.c中定义的全局变量
+rmt_channel_handle_t rmt_channel_1 = NULL;
+rmt_channel_handle_t rmt_channel_2 = NULL;
+rmt_encoder_handle_t led_encoder_1 = NULL;
+rmt_encoder_handle_t led_encoder_2 = NULL;
+const char *TAG = "SK6812_TEST";
+
+extern bool initCanvas(void);
+extern uint8_t *getCanvas(void);
+extern const sk6812_power_t *getCanvasPower(void);
+extern void setAllLEDs(uint8_t r, uint8_t g, uint8_t b);
+extern void rainbow_effect(int delay_ms);
+extern void purple_chase_effect(int delay_ms);
+extern void blue_lightning_effect(int delay_ms);
+extern void breathing_light_effect(int delay_ms);
+
+static rmt_channel_handle_t new_channel(int gpio)
+{
+    rmt_tx_channel_config_t tx_config = {
+        .clk_src = RMT_CLK_SRC_DEFAULT,
+        .gpio_num = gpio,
+        .mem_block_symbols = 64,
+        .resolution_hz = SK6812_ENCODER_RESOLUTION_HZ,
+        .trans_queue_depth = 4,
+    };
+    rmt_channel_handle_t channel = NULL;
+    HOST_CHECK_EQ(rmt_new_tx_channel(&tx_config, &channel), ESP_OK);
+    HOST_CHECK_EQ(rmt_enable(channel), ESP_OK);
+    return channel;
+}
+
+// 两条灯带最近一帧的发送数据与画布按当前系数缩放后的结果比较，返回不一致的字节数
+static uint32_t check_sent(uint32_t *canvas_sum)
+{
+    const sk6812_power_t *power = getCanvasPower();
+    const uint8_t *canvas = getCanvas();
+    rmt_channel_handle_t channels[] = {rmt_channel_1, rmt_channel_2};
+    uint32_t errors = 0;
+    *canvas_sum = 0;
+    for (int i = 0; i < TEST_STRIP_BYTES; i++) {
+        *canvas_sum += canvas[i];
+    }
+    for (int s = 0; s < 2; s++) {
+        size_t size = 0;
+        const uint8_t *payload = host_rmt_last_payload(channels[s], &size);
+        HOST_CHECK_EQ(size, TEST_STRIP_BYTES);
+        if (size != TEST_STRIP_BYTES) {
+            return UINT32_MAX;
+        }
+        for (int i = 0; i < TEST_STRIP_BYTES; i++) {
+            errors += payload[i] != canvas[i] * power->scale / 255;
+        }
+    }
+    return errors;
+}
+
+static void test_effects(void)
+{
+    static void (*const effects[])(int delay_ms) = {
+        rainbow_effect, purple_chase_effect, blue_lightning_effect, breathing_light_effect,
+    };
+    const sk6812_power_t *power = getCanvasPower();
+    uint32_t errors = 0;
+    uint32_t sum_errors = 0;
+    uint32_t limited = power->limited_frames;
+    for (size_t e = 0; e < sizeof(effects) / sizeof(effects[0]); e++) {
+        for (int frame = 0; frame < TEST_FRAMES; frame++) {
+            effects[e](0);
+            uint32_t canvas_sum;
+            errors += check_sent(&canvas_sum);
+            sum_errors += power->channel_sum != 2 * canvas_sum;
+            HOST_CHECK(power->output_ma <= power->budget_ma);
+        }
+    }
+    HOST_CHECK_EQ(errors, 0);
+    HOST_CHECK_EQ(sum_errors, 0);
+    HOST_CHECK(power->limited_frames > limited);
+}
+
+static void test_limit(void)
+{
+    const sk6812_power_t *power = getCanvasPower();
+    uint32_t canvas_sum;
+
+    // 全白: 估算 = 静态电流 + 1800 x 3 x 12mA
+    setAllLEDs(255, 255, 255);
+    HOST_CHECK_EQ(power->estimated_ma, power->idle_ma + 2 * TEST_LEDS_PER_STRIP * 3 * SK6812_POWER_DEFAULT_CHANNEL_MA);
+    HOST_CHECK(power->scale < 255);
+    HOST_CHECK(power->output_ma <= power->budget_ma);
+    HOST_CHECK_EQ(check_sent(&canvas_sum), 0);
+    HOST_CHECK_EQ(canvas_sum, TEST_STRIP_BYTES * 255);
+    printf("full white: estimated %lu mA, output %lu mA, budget %lu mA, scale %u/255\n",
+           (unsigned long)power->estimated_ma, (unsigned long)power->output_ma,
+           (unsigned long)power->budget_ma, power->scale);
+
+    // 预算以内原样发送
+    setAllLEDs(20, 10, 30);
+    HOST_CHECK_EQ(power->scale, 255);
+    HOST_CHECK_EQ(check_sent(&canvas_sum), 0);
+    HOST_CHECK_EQ(power->channel_sum, 2 * TEST_LEDS_PER_STRIP * 60);
+}
+
+int main(void)
+{
+    host_rmt_set_capture(true);
+    rmt_channel_1 = new_channel(18);
+    rmt_channel_2 = new_channel(17);
+    HOST_CHECK_EQ(sk6812_new_encoder(&led_encoder_1), ESP_OK);
+    HOST_CHECK_EQ(sk6812_new_encoder(&led_encoder_2), ESP_OK);
+    HOST_CHECK(initCanvas());
+
+    test_limit();
+    test_effects();
+    return host_test_finish("test_canvas_power");
+}
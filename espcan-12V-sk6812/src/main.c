@@ -19,6 +19,10 @@
 #include "driver/twai.h"
 #include "driver/rmt_tx.h"
 #include "sdkconfig.h"
+#include "espcan_protocol.h"
+#include "espcan_filter.h"
+#include "espcan_sync.h"
+#include "sk6812_encoder.h"
 
 // 定义引脚和参数
 #define CAN_TX_PIN GPIO_NUM_5
@@ -28,26 +32,7 @@
 #define WS2812_PIN_2 GPIO_NUM_17
 #define WS2812_LEDS_PER_STRIP 900
 #define WS2812_LEDS_TOTAL (WS2812_LEDS_PER_STRIP * 2)  // 总共1800个灯
-#define RMT_RESOLUTION_HZ 10000000
-
-// SK6812时序定义 (与WS2812B时序类似)
-#define T0H 3
-#define T0L 9 
-#define T1H 6
-#define T1L 6
-#define TRS 800
-
-// CAN消息ID
-#define LED_CMD_ID 0x456
-#define EMOTION_CMD_ID 0x789
-#define RANDOM_CMD_ID 0xABC
-
-// 情绪状态命令
-#define EMOTION_HAPPY 1      // 开心 - 彩虹效果
-#define EMOTION_SAD 2        // 伤心 - 紫色追逐效果  
-#define EMOTION_SURPRISE 3   // 惊讶 - 闪电效果
-#define EMOTION_NEUTRAL 4    // 中性 - 呼吸灯切换颜色效果
-#define EMOTION_RANDOM 4     // 兼容性别名
+#define RMT_RESOLUTION_HZ SK6812_ENCODER_RESOLUTION_HZ
 
 const char *TAG = "ESPCAN_SK6812";
 static uint8_t current_emotion = 0;
@@ -73,16 +58,17 @@ static const twai_general_config_t g_config = {
 };
 
 static const twai_timing_config_t t_config = TWAI_TIMING_CONFIG_500KBITS();
-static const twai_filter_config_t f_config = TWAI_FILTER_CONFIG_ACCEPT_ALL();
 
 // 函数声明
-extern void byteToRMTSymbols(uint8_t byte_val, rmt_symbol_word_t *symbols);
-extern void sendPixels(rmt_symbol_word_t *pixel_data, size_t data_size);
-extern void setPixelRGB(int index, uint8_t r, uint8_t g, uint8_t b, rmt_symbol_word_t *led_data);
-extern void refreshLEDs(rmt_symbol_word_t *led_data);
+extern void sendPixels(int strip, uint8_t *pixel_data, size_t data_size);
+extern void setPixelRGB(int index, uint8_t r, uint8_t g, uint8_t b, uint8_t *led_data);
+extern void refreshLEDs(uint8_t *led_data);
 extern void setAllLEDs(uint8_t r, uint8_t g, uint8_t b);
 extern void clearAllLEDs(void);
 
+// 虚拟画布函数声明
+extern bool initCanvas(void);
+
 // 动画效果函数声明
 extern void rainbow_effect(int delay_ms);
 extern void purple_chase_effect(int delay_ms);
@@ -116,11 +102,10 @@ static bool initRMT(void)
         return false;
     }
 
-    // 创建简单的复制编码器1
-    rmt_copy_encoder_config_t copy_encoder_config_1 = {};
-    ret = rmt_new_copy_encoder(&copy_encoder_config_1, &led_encoder_1);
+    // 创建SK6812流式编码器1 (发送时将GRB字节展开为RMT符号)
+    ret = sk6812_new_encoder(&led_encoder_1);
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "创建复制编码器1失败: %s", esp_err_to_name(ret));
+        ESP_LOGE(TAG, "创建SK6812编码器1失败: %s", esp_err_to_name(ret));
         return false;
     }
 
@@ -153,11 +138,10 @@ static bool initRMT(void)
         return false;
     }
 
-    // 创建简单的复制编码器2
-    rmt_copy_encoder_config_t copy_encoder_config_2 = {};
-    ret = rmt_new_copy_encoder(&copy_encoder_config_2, &led_encoder_2);
+    // 创建SK6812流式编码器2 (发送时将GRB字节展开为RMT符号)
+    ret = sk6812_new_encoder(&led_encoder_2);
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "创建复制编码器2失败: %s", esp_err_to_name(ret));
+        ESP_LOGE(TAG, "创建SK6812编码器2失败: %s", esp_err_to_name(ret));
         return false;
     }
 
@@ -172,42 +156,41 @@ static bool initRMT(void)
     return true;
 }
 
+// 设置LED状态
+static void set_led_state(uint8_t state) {
+    gpio_set_level(LED_PIN, state);
+    ESP_LOGI(TAG, "LED状态已设置为: %s", state ? "开启" : "关闭");
+}
+
 // 处理LED控制命令
-void handle_led_command(twai_message_t *message) {
-    if (message->data_length_code < 1) {
+static void handle_led_command(const twai_message_t *message, void *arg) {
+    espcan_led_cmd_t cmd;
+    if (espcan_decode_led_cmd(message, &cmd) != ESP_OK) {
         ESP_LOGE(TAG, "LED命令数据长度不足");
         return;
     }
     
-    uint8_t led_state = message->data[0];
-    gpio_set_level(LED_PIN, led_state);
-    ESP_LOGI(TAG, "LED状态已设置为: %s", led_state ? "开启" : "关闭");
+    set_led_state(cmd.state);
 }
 
-// 处理情绪状态命令
-void handle_emotion_command(twai_message_t *message) {
-    if (message->data_length_code < 1) {
-        ESP_LOGE(TAG, "情绪状态命令数据长度不足");
-        return;
-    }
-    
-    uint8_t emotion_state = message->data[0];
+// 切换情绪状态
+static void set_emotion(uint8_t emotion_state) {
     current_emotion = emotion_state;
     
     switch (emotion_state) {
-        case EMOTION_HAPPY:
+        case ESPCAN_EMOTION_HAPPY:
             ESP_LOGI(TAG, "情绪状态设置为: 开心 (彩虹效果)");
             break;
             
-        case EMOTION_SAD:
+        case ESPCAN_EMOTION_SAD:
             ESP_LOGI(TAG, "情绪状态设置为: 伤心 (紫色追逐效果)");
             break;
             
-        case EMOTION_SURPRISE:
+        case ESPCAN_EMOTION_SURPRISE:
             ESP_LOGI(TAG, "情绪状态设置为: 惊讶 (闪电效果)");
             break;
             
-        case EMOTION_NEUTRAL:
+        case ESPCAN_EMOTION_NEUTRAL:
             ESP_LOGI(TAG, "情绪状态设置为: 中性 (呼吸灯切换颜色)");
             break;
             
@@ -217,27 +200,72 @@ void handle_emotion_command(twai_message_t *message) {
     }
 }
 
+// 处理情绪状态命令
+static void handle_emotion_command(const twai_message_t *message, void *arg) {
+    espcan_emotion_cmd_t cmd;
+    if (espcan_decode_emotion_cmd(message, &cmd) != ESP_OK) {
+        ESP_LOGE(TAG, "情绪状态命令数据长度不足");
+        return;
+    }
+    
+    set_emotion(cmd.emotion);
+}
+
+// 处理随机效果命令 (本节点没有随机效果)
+static void handle_random_command(const twai_message_t *message, void *arg) {
+    ESP_LOGI(TAG, "收到随机效果命令");
+}
+
+// 执行场景: 灯光节点使用情绪和LED部分
+static void apply_scene(const void *data) {
+    const espcan_scene_t *scene = data;
+    
+    ESP_LOGI(TAG, "场景 #%d", scene->sequence);
+    set_led_state((scene->flags & ESPCAN_SCENE_LED_ON) ? 1 : 0);
+    set_emotion(scene->emotion);
+}
+
+// 处理场景命令 (带TIMED标志时按生效时间执行)
+static void handle_scene_command(const twai_message_t *message, void *arg) {
+    espcan_scene_t scene;
+    if (espcan_decode_scene(message, &scene) != ESP_OK) {
+        ESP_LOGE(TAG, "场景命令数据长度不足");
+        return;
+    }
+    
+    if (scene.flags & ESPCAN_SCENE_TIMED) {
+        espcan_sync_run_at(scene.activate_tick, apply_scene, &scene, sizeof(scene));
+    } else {
+        apply_scene(&scene);
+    }
+}
+
+// 记录未注册的帧
+static void handle_unknown_frame(const twai_message_t *message, void *arg) {
+    ESP_LOGW(TAG, "收到未知ID消息: 0x%lx", (unsigned long)message->identifier);
+}
+
 // 情绪灯光动画任务
 void emotion_animation_task(void *pvParameters) {
     while (1) {
         // 根据当前情绪状态设置灯光效果
         switch (current_emotion) {
-            case EMOTION_HAPPY:
+            case ESPCAN_EMOTION_HAPPY:
                 // 开心 - 彩虹效果
                 rainbow_effect(50);
                 break;
                 
-            case EMOTION_SAD:
+            case ESPCAN_EMOTION_SAD:
                 // 伤心 - 紫色追逐效果
                 purple_chase_effect(30);
                 break;
                 
-            case EMOTION_SURPRISE:
+            case ESPCAN_EMOTION_SURPRISE:
                 // 惊讶 - 闪电效果
                 blue_lightning_effect(80);
                 break;
                 
-            case EMOTION_NEUTRAL:
+            case ESPCAN_EMOTION_NEUTRAL:
                 // 中性状态 - 呼吸灯切换颜色
                 breathing_light_effect(30);
                 break;
@@ -267,6 +295,12 @@ void app_main(void)
         return;
     }
     
+    // 按灯带布局生成虚拟画布的映射表
+    if (!initCanvas()) {
+        ESP_LOGE(TAG, "虚拟画布初始化失败");
+        return;
+    }
+    
     // 测试LED - 显示彩色测试5秒
     ESP_LOGI(TAG, "显示彩色测试 - 5秒");
     setAllLEDs(255, 0, 0);  // 红色
@@ -280,9 +314,21 @@ void app_main(void)
     clearAllLEDs();
     vTaskDelay(pdMS_TO_TICKS(1000));
     
+    // 注册CAN消息处理函数
+    ESP_ERROR_CHECK(espcan_register_handler(ESPCAN_ID_LED_CMD, handle_led_command, NULL));
+    ESP_ERROR_CHECK(espcan_register_handler(ESPCAN_ID_EMOTION_CMD, handle_emotion_command, NULL));
+    ESP_ERROR_CHECK(espcan_register_handler(ESPCAN_ID_SCENE, handle_scene_command, NULL));
+    ESP_ERROR_CHECK(espcan_register_handler(ESPCAN_ID_RANDOM_CMD, handle_random_command, NULL));
+    espcan_set_default_handler(handle_unknown_frame, NULL);
+    ESP_ERROR_CHECK(espcan_sync_init());
+    
+    // 按注册的ID规划接收过滤器
+    espcan_filter_plan_t filter;
+    ESP_ERROR_CHECK(espcan_filter_plan_registered(&filter));
+    
     // 安装TWAI驱动
     ESP_LOGI(TAG, "CAN接收端初始化中...");
-    ESP_ERROR_CHECK(twai_driver_install(&g_config, &t_config, &f_config));
+    ESP_ERROR_CHECK(twai_driver_install(&g_config, &t_config, &filter.config));
     ESP_LOGI(TAG, "TWAI驱动安装成功");
 
     // 启动TWAI驱动
@@ -301,23 +347,11 @@ void app_main(void)
         esp_err_t result = twai_receive(&rx_message, pdMS_TO_TICKS(100));
         
         if (result == ESP_OK) {
-            // 根据消息ID分发处理
-            if (rx_message.identifier == LED_CMD_ID) {
-                handle_led_command(&rx_message);
-            } else if (rx_message.identifier == EMOTION_CMD_ID) {
-                handle_emotion_command(&rx_message);
-            } else if (rx_message.identifier == RANDOM_CMD_ID) {
-                // 处理随机效果命令
-                ESP_LOGI(TAG, "收到随机效果命令");
-            } else {
-                ESP_LOGW(TAG, "收到未知ID消息: 0x%lx", (unsigned long)rx_message.identifier);
-            }
+            // 按ID查表分发
+            espcan_dispatch(&rx_message);
         } else if (result != ESP_ERR_TIMEOUT) {
             // 忽略超时错误
             ESP_LOGE(TAG, "CAN接收错误: %s", esp_err_to_name(result));
         }
-        
-        // 短暂延时
-        vTaskDelay(pdMS_TO_TICKS(10));
     }
 } 
\ No newline at end of file
@@ -0,0 +1,190 @@
+// SK6812 虚拟画布 - 效果只绘制一张逻辑画布，按段映射 (偏移、反向、镜像) 输出到多条物理灯带
+//
+// 映射在初始化时展开为每条灯带的索引表，输出时每个像素只查一次表。
+// 整条灯带正向连续映射时直接从画布发送，镜像的灯带共享同一块画布，不需要重复写像素。
+// 写像素时按该像素在所有灯带上的LED数累计分量之和，输出时据此估算电流，超出预算时各灯带按同一系数缩放。
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_log.h"
+#include "sk6812_power.h"
+
+// 外部变量和定义
+extern const char *TAG;
+
+#define WS2812_LEDS_PER_STRIP 900
+#define STRIP_COUNT 2
+#define BYTES_PER_LED 3  // GRB
+#define CANVAS_LEDS WS2812_LEDS_PER_STRIP  // 逻辑画布像素数
+#define UNMAPPED_LED UINT16_MAX             // 没有映射到画布的LED (保持黑色)
+#define CANVAS_STATS_INTERVAL 100           // 每100帧输出一次功率统计
+
+// 电流预算: 两条灯带合计，按12V电源能力调整，0为不限制
+#ifndef LED_POWER_BUDGET_MA
+#define LED_POWER_BUDGET_MA 10000
+#endif
+#define LED_CHANNEL_MA SK6812_POWER_DEFAULT_CHANNEL_MA              // 单个颜色分量满值时的电流
+#define LED_IDLE_MA (WS2812_LEDS_PER_STRIP * STRIP_COUNT / 2)       // 全灭时的静态电流 (每个LED约0.5mA)
+
+extern void sendPixels(int strip, uint8_t *pixel_data, size_t data_size);
+
+// 物理灯带上的一段LED，显示画布上的一段连续像素
+typedef struct {
+    int strip;              // 物理灯带 (1或2)
+    int strip_start;        // 段在灯带上的起始LED
+    int canvas_start;       // 段对应的画布起始像素
+    int length;             // 段的LED数量
+    bool reversed;          // 反向: 段的第一个LED显示对应画布范围的最后一个像素
+} canvas_segment_t;
+
+// 灯带布局: 两条灯带镜像显示同一画布。
+// 改为首尾相接时把CANVAS_LEDS设为1800，第二段的canvas_start设为900 (同时修改sk6812_functions.c中的CANVAS_LEDS)；
+// 灯带反向安装时把对应段的reversed设为true
+static const canvas_segment_t canvas_layout[] = {
+    {.strip = 1, .strip_start = 0, .canvas_start = 0, .length = WS2812_LEDS_PER_STRIP, .reversed = false},
+    {.strip = 2, .strip_start = 0, .canvas_start = 0, .length = WS2812_LEDS_PER_STRIP, .reversed = false},
+};
+
+// 逻辑画布 (GRB，每像素3字节)
+static uint8_t canvas[CANVAS_LEDS * BYTES_PER_LED];
+
+// 每条灯带的映射表
+static uint16_t strip_map[STRIP_COUNT][WS2812_LEDS_PER_STRIP];
+static int direct_offset[STRIP_COUNT];              // 整条灯带正向连续映射时的画布起点，否则为-1
+static uint8_t *strip_buffer[STRIP_COUNT] = {NULL}; // 非连续映射或需要缩放时的发送缓冲区
+static uint8_t canvas_copies[CANVAS_LEDS];          // 每个画布像素在所有灯带上显示的LED数 (镜像时为2)
+static sk6812_power_t canvas_power;                 // channel_sum为所有灯带上的分量之和
+static uint32_t canvas_frames = 0;
+
+// 展开灯带布局，生成每条灯带的映射表 (启动时调用一次)
+bool initCanvas(void)
+{
+    for (int s = 0; s < STRIP_COUNT; s++) {
+        for (int i = 0; i < WS2812_LEDS_PER_STRIP; i++) {
+            strip_map[s][i] = UNMAPPED_LED;
+        }
+    }
+
+    memset(canvas, 0, sizeof(canvas));
+    memset(canvas_copies, 0, sizeof(canvas_copies));
+    sk6812_power_init(&canvas_power, LED_POWER_BUDGET_MA, LED_CHANNEL_MA, LED_IDLE_MA);
+
+    // 同一LED被多个段覆盖时后面的段生效
+    for (size_t n = 0; n < sizeof(canvas_layout) / sizeof(canvas_layout[0]); n++) {
+        const canvas_segment_t *seg = &canvas_layout[n];
+        if (seg->strip < 1 || seg->strip > STRIP_COUNT || seg->strip_start < 0 || seg->canvas_start < 0 ||
+            seg->strip_start + seg->length > WS2812_LEDS_PER_STRIP || seg->canvas_start + seg->length > CANVAS_LEDS) {
+            ESP_LOGE(TAG, "灯带布局第%d段超出范围", (int)n);
+            return false;
+        }
+        for (int i = 0; i < seg->length; i++) {
+            strip_map[seg->strip - 1][seg->strip_start + i] =
+                seg->canvas_start + (seg->reversed ? seg->length - 1 - i : i);
+        }
+    }
+
+    for (int s = 0; s < STRIP_COUNT; s++) {
+        for (int i = 0; i < WS2812_LEDS_PER_STRIP; i++) {
+            if (strip_map[s][i] != UNMAPPED_LED) {
+                canvas_copies[strip_map[s][i]]++;
+            }
+        }
+        direct_offset[s] = strip_map[s][0] == UNMAPPED_LED ? -1 : strip_map[s][0];
+        for (int i = 0; i < WS2812_LEDS_PER_STRIP; i++) {
+            if (strip_map[s][i] != strip_map[s][0] + i) {
+                direct_offset[s] = -1;
+                break;
+            }
+        }
+        // 直接映射的灯带在超出预算时也要先缩放到发送缓冲区
+        if (strip_buffer[s] == NULL) {
+            strip_buffer[s] = malloc(WS2812_LEDS_PER_STRIP * BYTES_PER_LED);
+            if (strip_buffer[s] == NULL) {
+                ESP_LOGE(TAG, "灯带%d映射缓冲区分配失败", s + 1);
+                return false;
+            }
+        }
+        ESP_LOGI(TAG, "灯带%d: %s", s + 1, direct_offset[s] >= 0 ? "直接从画布发送" : "按映射表收集像素");
+    }
+    return true;
+}
+
+// 获取逻辑画布 (发送在showCanvas返回前完成，之后可以直接修改)
+uint8_t *getCanvas(void)
+{
+    return canvas;
+}
+
+// 设置画布像素 (GRB)，按该像素显示的LED数更新分量之和
+void setCanvasPixel(int index, uint8_t g, uint8_t r, uint8_t b)
+{
+    uint8_t *pixel = &canvas[index * BYTES_PER_LED];
+    // 减去被覆盖的旧值，输出时不需要再遍历整帧估算电流
+    int32_t delta = (g + r + b) - (pixel[0] + pixel[1] + pixel[2]);
+    canvas_power.channel_sum += delta * canvas_copies[index];
+    pixel[0] = g;
+    pixel[1] = r;
+    pixel[2] = b;
+}
+
+// 清空画布，分量之和同时清零
+void clearCanvas(void)
+{
+    memset(canvas, 0, sizeof(canvas));
+    canvas_power.channel_sum = 0;
+}
+
+// 最近一帧的功率估算
+const sk6812_power_t *getCanvasPower(void)
+{
+    return &canvas_power;
+}
+
+// 输出功率统计
+static void report_power_stats(void)
+{
+    ESP_LOGI(TAG, "功率: 估算%lumA, 限制后%lumA, 缩放%u/255, 累计限制%lu帧",
+             (unsigned long)canvas_power.estimated_ma, (unsigned long)canvas_power.output_ma,
+             canvas_power.scale, (unsigned long)canvas_power.limited_frames);
+}
+
+// 把画布按映射输出到所有灯带，超出电流预算时按同一系数缩放 (画布保持原颜色)
+void showCanvas(void)
+{
+    uint8_t scale = sk6812_power_update(&canvas_power);
+
+    for (int s = 0; s < STRIP_COUNT; s++) {
+        uint8_t *pixels = strip_buffer[s];
+        size_t data_size = WS2812_LEDS_PER_STRIP * BYTES_PER_LED;
+        if (direct_offset[s] >= 0) {
+            uint8_t *src = &canvas[direct_offset[s] * BYTES_PER_LED];
+            if (scale == 255) {
+                pixels = src;
+            } else {
+                sk6812_power_apply(&canvas_power, src, pixels, data_size);
+            }
+        } else {
+            uint8_t *out = pixels;
+            for (int i = 0; i < WS2812_LEDS_PER_STRIP; i++, out += BYTES_PER_LED) {
+                uint16_t index = strip_map[s][i];
+                if (index == UNMAPPED_LED) {
+                    out[0] = out[1] = out[2] = 0;
+                } else {
+                    memcpy(out, &canvas[index * BYTES_PER_LED], BYTES_PER_LED);
+                }
+            }
+            if (scale < 255) {
+                sk6812_power_apply(&canvas_power, pixels, pixels, data_size);
+            }
+        }
+        sendPixels(s + 1, pixels, data_size);
+    }
+
+    if (++canvas_frames % CANVAS_STATS_INTERVAL == 0) {
+        report_power_stats();
+    }
+}
@@ -20,18 +20,19 @@ extern rmt_encoder_handle_t led_encoder_2;
 extern const char *TAG;
 
 #define WS2812_LEDS_PER_STRIP 900
-#define WS2812_LEDS_TOTAL (WS2812_LEDS_PER_STRIP * 2)
-#define T0H 3
-#define T0L 9 
-#define T1H 6
-#define T1L 6
-#define TRS 800
+#define BYTES_PER_LED 3  // GRB
+#define CANVAS_LEDS WS2812_LEDS_PER_STRIP  // 逻辑画布像素数 (与sk6812_canvas.c一致)
+
+// 虚拟画布 (sk6812_canvas.c)，效果只绘制一次，按灯带布局输出到两条灯带
+extern uint8_t *getCanvas(void);
+extern void showCanvas(void);
+extern void setCanvasPixel(int index, uint8_t g, uint8_t r, uint8_t b);
+extern void clearCanvas(void);
 
 // 前向声明内部函数
-void setPixelRGB(int strip, int index, uint8_t r, uint8_t g, uint8_t b, rmt_symbol_word_t *led_data);
-void refreshLEDs(int strip, rmt_symbol_word_t *led_data);
-void sendPixels(int strip, rmt_symbol_word_t *pixel_data, size_t data_size);
-void byteToRMTSymbols(uint8_t byte_val, rmt_symbol_word_t *symbols);
+void setPixelRGB(int index, uint8_t r, uint8_t g, uint8_t b, uint8_t *led_data);
+void refreshLEDs(uint8_t *led_data);
+void sendPixels(int strip, uint8_t *pixel_data, size_t data_size);
 
 // 简单的正弦函数近似，输入范围[0,1]，输出范围[0,1]
 float simple_sine(float x) {
@@ -41,28 +42,9 @@ float simple_sine(float x) {
     return pi_x - pi_x * pi_x * pi_x / 6.0;
 }
 
-// 将字节值转换为RMT符号 (8个位)
-void byteToRMTSymbols(uint8_t byte_val, rmt_symbol_word_t *symbols)
-{
-    for (int i = 7; i >= 0; i--) {  // MSB优先
-        if (byte_val & (1 << i)) {
-            // 发送'1'位
-            symbols[7-i].level0 = 1;
-            symbols[7-i].duration0 = T1H;
-            symbols[7-i].level1 = 0;
-            symbols[7-i].duration1 = T1L;
-        } else {
-            // 发送'0'位  
-            symbols[7-i].level0 = 1;
-            symbols[7-i].duration0 = T0H;
-            symbols[7-i].level1 = 0;
-            symbols[7-i].duration1 = T0L;
-        }
-    }
-}
-
 // 发送像素数据
-void sendPixels(int strip, rmt_symbol_word_t *pixel_data, size_t data_size)
+// 编码器在发送时将颜色字节展开为RMT符号，并在末尾追加复位信号
+void sendPixels(int strip, uint8_t *pixel_data, size_t data_size)
 {
     rmt_transmit_config_t tx_config = {
         .loop_count = 0, // 不循环
@@ -72,8 +54,7 @@ void sendPixels(int strip, rmt_symbol_word_t *pixel_data, size_t data_size)
     rmt_channel_handle_t channel = (strip == 1) ? rmt_channel_1 : rmt_channel_2;
     rmt_encoder_handle_t encoder = (strip == 1) ? led_encoder_1 : led_encoder_2;
 
-    esp_err_t ret = rmt_transmit(channel, encoder, pixel_data, 
-                                data_size * sizeof(rmt_symbol_word_t), &tx_config);
+    esp_err_t ret = rmt_transmit(channel, encoder, pixel_data, data_size, &tx_config);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "发送像素数据到灯带%d失败: %s", strip, esp_err_to_name(ret));
     }
@@ -85,67 +66,33 @@ void sendPixels(int strip, rmt_symbol_word_t *pixel_data, size_t data_size)
     }
 }
 
-// 设置单个LED的RGB颜色
-void setPixelRGB(int strip, int index, uint8_t r, uint8_t g, uint8_t b, rmt_symbol_word_t *led_data)
+// 设置画布上单个像素的RGB颜色 (led_data为getCanvas返回的画布，经画布模块写入以更新分量之和)
+void setPixelRGB(int index, uint8_t r, uint8_t g, uint8_t b, uint8_t *led_data)
 {
-    if (index >= WS2812_LEDS_PER_STRIP) return;
+    if (index < 0 || index >= CANVAS_LEDS) return;
     
     // SK6812的顺序是GRB
-    int offset = index * 24;  // 每个LED使用24位 (3个字节)
-    byteToRMTSymbols(g, &led_data[offset + 0]);   // 绿色
-    byteToRMTSymbols(r, &led_data[offset + 8]);   // 红色  
-    byteToRMTSymbols(b, &led_data[offset + 16]);  // 蓝色
+    setCanvasPixel(index, g, r, b);
 }
 
-// 更新一个LED灯带
-void refreshLEDs(int strip, rmt_symbol_word_t *led_data)
+// 把画布输出到所有灯带 (led_data为getCanvas返回的画布)
+void refreshLEDs(uint8_t *led_data)
 {
-    size_t total_symbols = WS2812_LEDS_PER_STRIP * 24 + 1;
-    
-    // 添加最终的复位信号
-    led_data[WS2812_LEDS_PER_STRIP * 24].level0 = 0;
-    led_data[WS2812_LEDS_PER_STRIP * 24].duration0 = TRS;
-    led_data[WS2812_LEDS_PER_STRIP * 24].level1 = 0;
-    led_data[WS2812_LEDS_PER_STRIP * 24].duration1 = 0;
-    
-    // 发送数据
-    sendPixels(strip, led_data, total_symbols);
+    showCanvas();
 }
 
 // 为所有LED设置相同颜色
 void setAllLEDs(uint8_t r, uint8_t g, uint8_t b)
 {
-    // 为所有LED分配内存：每个LED 24位数据 + 最后一个复位信号
-    size_t total_symbols = WS2812_LEDS_PER_STRIP * 24 + 1;
-    
-    // 创建灯带1的数据
-    rmt_symbol_word_t *led_data_1 = malloc(total_symbols * sizeof(rmt_symbol_word_t));
-    if (led_data_1 == NULL) {
-        ESP_LOGE(TAG, "灯带1内存分配失败");
-        return;
-    }
+    uint8_t *led_data = getCanvas();
     
-    // 创建灯带2的数据
-    rmt_symbol_word_t *led_data_2 = malloc(total_symbols * sizeof(rmt_symbol_word_t));
-    if (led_data_2 == NULL) {
-        ESP_LOGE(TAG, "灯带2内存分配失败");
-        free(led_data_1);
-        return;
+    // 为每个像素构建RGB数据
+    for (int led = 0; led < CANVAS_LEDS; led++) {
+        setPixelRGB(led, r, g, b, led_data);
     }
     
-    // 为每个LED构建RGB数据
-    for (int led = 0; led < WS2812_LEDS_PER_STRIP; led++) {
-        setPixelRGB(1, led, r, g, b, led_data_1);
-        setPixelRGB(2, led, r, g, b, led_data_2);
-    }
-    
-    // 并行更新两个灯带
-    refreshLEDs(1, led_data_1);
-    refreshLEDs(2, led_data_2);
-    
-    // 释放内存
-    free(led_data_1);
-    free(led_data_2);
+    // 更新显示
+    refreshLEDs(led_data);
 }
 
 // 关闭所有LED
@@ -158,37 +105,28 @@ void clearAllLEDs(void)
 void rainbow_effect(int delay_ms) {
     static uint8_t hue = 0;
     
-    // 分配LED数据内存
-    size_t total_symbols = WS2812_LEDS_PER_STRIP * 24 + 1;
-    rmt_symbol_word_t *led_data = malloc(total_symbols * sizeof(rmt_symbol_word_t));
-    if (led_data == NULL) {
-        return;
-    }
+    // 使用虚拟画布 (sendPixels返回时发送已完成，可安全复用)
+    uint8_t *led_data = getCanvas();
     
     // 创建彩虹效果
-    for (int i = 0; i < WS2812_LEDS_PER_STRIP; i++) {
+    for (int i = 0; i < CANVAS_LEDS; i++) {
         // 计算每个LED的色调，形成彩虹
-        uint8_t pos = (i * 256 / WS2812_LEDS_PER_STRIP + hue) & 0xFF;
+        uint8_t pos = (i * 256 / CANVAS_LEDS + hue) & 0xFF;
         
         // 将HSV转换为RGB (简化版彩虹算法)
         if (pos < 85) {
-            setPixelRGB(1, i, 255 - pos * 3, pos * 3, 0, led_data);
-            setPixelRGB(2, i, 255 - pos * 3, pos * 3, 0, led_data);
+            setPixelRGB(i, 255 - pos * 3, pos * 3, 0, led_data);
         } else if (pos < 170) {
             pos -= 85;
-            setPixelRGB(1, i, 0, 255 - pos * 3, pos * 3, led_data);
-            setPixelRGB(2, i, 0, 255 - pos * 3, pos * 3, led_data);
+            setPixelRGB(i, 0, 255 - pos * 3, pos * 3, led_data);
         } else {
             pos -= 170;
-            setPixelRGB(1, i, pos * 3, 0, 255 - pos * 3, led_data);
-            setPixelRGB(2, i, pos * 3, 0, 255 - pos * 3, led_data);
+            setPixelRGB(i, pos * 3, 0, 255 - pos * 3, led_data);
         }
     }
     
     // 更新显示
-    refreshLEDs(1, led_data);
-    refreshLEDs(2, led_data);
-    free(led_data);
+    refreshLEDs(led_data);
     
     // 移动彩虹
     hue += 2;
@@ -203,25 +141,18 @@ void purple_chase_effect(int delay_ms) {
     static uint8_t brightness_level = 255; // 用于脉冲亮度变化
     static int8_t brightness_direction = -1; // 亮度变化方向
     
-    // 分配LED数据内存
-    size_t total_symbols = WS2812_LEDS_PER_STRIP * 24 + 1;
-    rmt_symbol_word_t *led_data = malloc(total_symbols * sizeof(rmt_symbol_word_t));
-    if (led_data == NULL) {
-        return;
-    }
+    // 使用虚拟画布 (sendPixels返回时发送已完成，可安全复用)
+    uint8_t *led_data = getCanvas();
     
     // 先清空所有LED
-    for (int i = 0; i < WS2812_LEDS_PER_STRIP; i++) {
-        setPixelRGB(1, i, 0, 0, 0, led_data);
-        setPixelRGB(2, i, 0, 0, 0, led_data);
-    }
+    clearCanvas();
     
     // 追逐灯的长度 - 增加到约150个LED一组
     const int chase_length = 150;
     
     // 创建渐变的紫色光束 (紫色脉冲波)
     for (int i = 0; i < chase_length; i++) {
-        int pos = (position + i) % WS2812_LEDS_PER_STRIP;
+        int pos = (position + i) % CANVAS_LEDS;
         
         // 根据位置计算渐变强度 - 使用正弦波形创建更平滑的渐变
         float progress = (float)i / chase_length;
@@ -235,23 +166,20 @@ void purple_chase_effect(int delay_ms) {
         // 在光束的不同部分使用不同的紫色色调
         if (i < chase_length / 3) {
             // 偏蓝紫色
-            setPixelRGB(1, pos, r_val * 0.7, 0, b_val, led_data);
-            setPixelRGB(2, pos, r_val * 0.7, 0, b_val, led_data);
+            setPixelRGB(pos, r_val * 0.7, 0, b_val, led_data);
         } else if (i < 2 * chase_length / 3) {
             // 标准紫色
-            setPixelRGB(1, pos, r_val, 0, b_val, led_data);
-            setPixelRGB(2, pos, r_val, 0, b_val, led_data);
+            setPixelRGB(pos, r_val, 0, b_val, led_data);
         } else {
             // 偏红紫色
-            setPixelRGB(1, pos, r_val, 0, b_val * 0.7, led_data);
-            setPixelRGB(2, pos, r_val, 0, b_val * 0.7, led_data);
+            setPixelRGB(pos, r_val, 0, b_val * 0.7, led_data);
         }
     }
     
     // 创建第二个紫色追逐组，与第一个距离适当间隔
-    int second_group_pos = (position + WS2812_LEDS_PER_STRIP/2) % WS2812_LEDS_PER_STRIP;
+    int second_group_pos = (position + CANVAS_LEDS/2) % CANVAS_LEDS;
     for (int i = 0; i < chase_length; i++) {
-        int pos = (second_group_pos + i) % WS2812_LEDS_PER_STRIP;
+        int pos = (second_group_pos + i) % CANVAS_LEDS;
         
         // 与第一组类似但颜色亮度稍有不同
         float progress = (float)i / chase_length;
@@ -263,24 +191,19 @@ void purple_chase_effect(int delay_ms) {
         
         // 第二组使用略有不同的紫色色调
         if (i < chase_length / 3) {
-            setPixelRGB(1, pos, r_val * 0.8, 0, b_val, led_data);
-            setPixelRGB(2, pos, r_val * 0.8, 0, b_val, led_data);
+            setPixelRGB(pos, r_val * 0.8, 0, b_val, led_data);
         } else if (i < 2 * chase_length / 3) {
-            setPixelRGB(1, pos, r_val, 0, b_val * 0.9, led_data);
-            setPixelRGB(2, pos, r_val, 0, b_val * 0.9, led_data);
+            setPixelRGB(pos, r_val, 0, b_val * 0.9, led_data);
         } else {
-            setPixelRGB(1, pos, r_val, 0, b_val * 0.8, led_data);
-            setPixelRGB(2, pos, r_val, 0, b_val * 0.8, led_data);
+            setPixelRGB(pos, r_val, 0, b_val * 0.8, led_data);
         }
     }
     
     // 更新显示
-    refreshLEDs(1, led_data);
-    refreshLEDs(2, led_data);
-    free(led_data);
+    refreshLEDs(led_data);
     
     // 移动追逐位置 - 加快移动速度
-    position = (position + 5) % WS2812_LEDS_PER_STRIP;
+    position = (position + 5) % CANVAS_LEDS;
     
     // 更新亮度级别，制造脉冲呼吸效果
     brightness_level += brightness_direction * 5;
@@ -296,18 +219,11 @@ void purple_chase_effect(int delay_ms) {
 
 // 蓝色闪电效果实现
 void blue_lightning_effect(int delay_ms) {
-    // 分配LED数据内存
-    size_t total_symbols = WS2812_LEDS_PER_STRIP * 24 + 1;
-    rmt_symbol_word_t *led_data = malloc(total_symbols * sizeof(rmt_symbol_word_t));
-    if (led_data == NULL) {
-        return;
-    }
+    // 使用虚拟画布 (sendPixels返回时发送已完成，可安全复用)
+    uint8_t *led_data = getCanvas();
     
     // 先清空所有LED
-    for (int i = 0; i < WS2812_LEDS_PER_STRIP; i++) {
-        setPixelRGB(1, i, 0, 0, 0, led_data);
-        setPixelRGB(2, i, 0, 0, 0, led_data);
-    }
+    clearCanvas();
     
     // 增加闪电数量和随机性
     int num_flashes = 8 + (esp_random() % 8); // 8-15个闪电点
@@ -317,24 +233,22 @@ void blue_lightning_effect(int delay_ms) {
     
     for (int i = 0; i < num_flashes; i++) {
         // 随机生成闪电位置，可能形成区域性闪电
-        int base_pos = esp_random() % WS2812_LEDS_PER_STRIP;
+        int base_pos = esp_random() % CANVAS_LEDS;
         int lightning_length = 1 + (esp_random() % 5); // 1-5个LED的闪电长度
         
         // 随机决定闪电强度
         uint8_t intensity = 200 + (esp_random() % 55); // 200-255，更亮
         
         for (int j = 0; j < lightning_length; j++) {
-            int pos = (base_pos + j) % WS2812_LEDS_PER_STRIP;
+            int pos = (base_pos + j) % CANVAS_LEDS;
             
             // 根据闪电类型和位置设置颜色
             if (lightning_type == 0 || (lightning_type == 2 && (i % 2 == 0))) {
                 // 纯白色闪电
-                setPixelRGB(1, pos, intensity, intensity, intensity, led_data);
-                setPixelRGB(2, pos, intensity, intensity, intensity, led_data);
+                setPixelRGB(pos, intensity, intensity, intensity, led_data);
             } else {
                 // 蓝色闪电
-                setPixelRGB(1, pos, intensity/8, intensity/5, intensity, led_data);
-                setPixelRGB(2, pos, intensity/8, intensity/5, intensity, led_data);
+                setPixelRGB(pos, intensity/8, intensity/5, intensity, led_data);
             }
             
             // 添加较大的光晕效果
@@ -347,25 +261,21 @@ void blue_lightning_effect(int delay_ms) {
                 if (pos - k >= 0) {
                     if (lightning_type == 0 || (lightning_type == 2 && (i % 2 == 0))) {
                         // 白色光晕
-                        setPixelRGB(1, pos - k, halo_intensity, halo_intensity, halo_intensity, led_data);
-                        setPixelRGB(2, pos - k, halo_intensity, halo_intensity, halo_intensity, led_data);
+                        setPixelRGB(pos - k, halo_intensity, halo_intensity, halo_intensity, led_data);
                     } else {
                         // 蓝色光晕
-                        setPixelRGB(1, pos - k, halo_intensity/8, halo_intensity/5, halo_intensity, led_data);
-                        setPixelRGB(2, pos - k, halo_intensity/8, halo_intensity/5, halo_intensity, led_data);
+                        setPixelRGB(pos - k, halo_intensity/8, halo_intensity/5, halo_intensity, led_data);
                     }
                 }
                 
                 // 后面的光晕
-                if (pos + k < WS2812_LEDS_PER_STRIP) {
+                if (pos + k < CANVAS_LEDS) {
                     if (lightning_type == 0 || (lightning_type == 2 && (i % 2 == 0))) {
                         // 白色光晕
-                        setPixelRGB(1, pos + k, halo_intensity, halo_intensity, halo_intensity, led_data);
-                        setPixelRGB(2, pos + k, halo_intensity, halo_intensity, halo_intensity, led_data);
+                        setPixelRGB(pos + k, halo_intensity, halo_intensity, halo_intensity, led_data);
                     } else {
                         // 蓝色光晕
-                        setPixelRGB(1, pos + k, halo_intensity/8, halo_intensity/5, halo_intensity, led_data);
-                        setPixelRGB(2, pos + k, halo_intensity/8, halo_intensity/5, halo_intensity, led_data);
+                        setPixelRGB(pos + k, halo_intensity/8, halo_intensity/5, halo_intensity, led_data);
                     }
                 }
             }
@@ -373,9 +283,7 @@ void blue_lightning_effect(int delay_ms) {
     }
     
     // 更新显示
-    refreshLEDs(1, led_data);
-    refreshLEDs(2, led_data);
-    free(led_data);
+    refreshLEDs(led_data);
     
     // 闪电持续时间更短，更爆闪
     vTaskDelay(pdMS_TO_TICKS(delay_ms / 2));
@@ -402,12 +310,8 @@ void breathing_light_effect(int delay_ms) {
     };
     static const int num_colors = sizeof(colors) / sizeof(colors[0]);
     
-    // 分配LED数据内存
-    size_t total_symbols = WS2812_LEDS_PER_STRIP * 24 + 1;
-    rmt_symbol_word_t *led_data = malloc(total_symbols * sizeof(rmt_symbol_word_t));
-    if (led_data == NULL) {
-        return;
-    }
+    // 使用虚拟画布 (sendPixels返回时发送已完成，可安全复用)
+    uint8_t *led_data = getCanvas();
     
     // 应用当前亮度到当前颜色
     uint8_t r = (colors[color_index][0] * brightness) / 255;
@@ -415,15 +319,12 @@ void breathing_light_effect(int delay_ms) {
     uint8_t b = (colors[color_index][2] * brightness) / 255;
     
     // 设置所有LED
-    for (int i = 0; i < WS2812_LEDS_PER_STRIP; i++) {
-        setPixelRGB(1, i, r, g, b, led_data);
-        setPixelRGB(2, i, r, g, b, led_data);
+    for (int i = 0; i < CANVAS_LEDS; i++) {
+        setPixelRGB(i, r, g, b, led_data);
     }
     
     // 更新显示
-    refreshLEDs(1, led_data);
-    refreshLEDs(2, led_data);
-    free(led_data);
+    refreshLEDs(led_data);
     
     // 更新亮度
     brightness += (direction * 5);
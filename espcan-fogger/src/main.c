@@ -8,6 +8,9 @@
 #include "esp_log.h"
 #include "driver/gpio.h"
 #include "driver/twai.h"
+#include "espcan_protocol.h"
+#include "espcan_filter.h"
+#include "espcan_sync.h"
 
 // 定义CAN引脚
 #define CAN_TX_PIN CONFIG_CAN_TX_GPIO
@@ -16,13 +19,6 @@
 // 定义继电器控制引脚
 #define RELAY_PIN CONFIG_FOGGER_RELAY_GPIO
 
-// 消息ID
-#define FOGGER_CMD_ID CONFIG_CAN_FOGGER_ID
-
-// 雾化器控制命令
-#define FOGGER_CMD_OFF 0
-#define FOGGER_CMD_ON 1
-
 // 日志标签
 static const char *TAG = "FOGGER_CTRL";
 
@@ -52,13 +48,6 @@ static const twai_general_config_t g_config = {
 // 波特率配置 (500Kbps)
 static const twai_timing_config_t t_config = TWAI_TIMING_CONFIG_500KBITS();
 
-// 过滤器配置 - 只接收雾化器控制消息
-static const twai_filter_config_t f_config = {
-    .acceptance_code = (FOGGER_CMD_ID << 21),
-    .acceptance_mask = ~(0x7FF << 21),  // 只匹配11位ID
-    .single_filter = true
-};
-
 // 初始化继电器
 void relay_init(void) {
     gpio_config_t io_conf = {
@@ -85,40 +74,72 @@ void set_fogger_state(uint8_t state) {
     gpio_set_level(RELAY_PIN, state);
     
     ESP_LOGI(TAG, "雾化器状态设置为: %s", state ? "开启" : "关闭");
-    
-    // 发送状态确认消息
+}
+
+// 发送雾化器状态确认消息
+static void send_fogger_status(void) {
+    espcan_fogger_status_t status = {
+        .state = fogger_state.is_on,
+        .ack = ESPCAN_STATUS_ACK,
+    };
     twai_message_t tx_message;
-    tx_message.identifier = FOGGER_CMD_ID;
-    tx_message.extd = 0;      // 标准帧
-    tx_message.rtr = 0;       // 非远程帧
-    tx_message.ss = 1;        // 单次发送
-    tx_message.self = 0;      // 不是自发自收
-    tx_message.data_length_code = 2;
-    tx_message.data[0] = state;   // 当前状态
-    tx_message.data[1] = 0x01;    // 确认标志
+    espcan_encode_fogger_status(&status, &tx_message);
     
     twai_transmit(&tx_message, pdMS_TO_TICKS(100));
 }
 
 // 处理接收到的雾化器控制命令
-void process_fogger_command(twai_message_t *message) {
-    if (message->data_length_code < 1) {
+static void process_fogger_command(const twai_message_t *message, void *arg) {
+    espcan_fogger_cmd_t cmd;
+    if (espcan_decode_fogger_cmd(message, &cmd) != ESP_OK) {
         ESP_LOGW(TAG, "收到无效雾化器命令 (数据长度不足)");
         return;
     }
     
-    uint8_t fogger_cmd = message->data[0];
-    ESP_LOGI(TAG, "收到雾化器控制命令: %s", fogger_cmd ? "开启" : "关闭");
+    ESP_LOGI(TAG, "收到雾化器控制命令: %s", cmd.state ? "开启" : "关闭");
+    
+    // 设置雾化器状态并回复
+    set_fogger_state(cmd.state);
+    send_fogger_status();
+}
+
+// 执行场景: 雾化器部分
+static void apply_scene(const void *data) {
+    const espcan_scene_t *scene = data;
+    
+    ESP_LOGI(TAG, "收到场景命令 #%d", scene->sequence);
+    set_fogger_state((scene->flags & ESPCAN_SCENE_FOGGER_ON) ? 1 : 0);
+}
+
+// 处理场景命令 (带TIMED标志时按生效时间执行)
+static void process_scene_command(const twai_message_t *message, void *arg) {
+    espcan_scene_t scene;
+    if (espcan_decode_scene(message, &scene) != ESP_OK) {
+        ESP_LOGW(TAG, "收到无效场景命令 (数据长度不足)");
+        return;
+    }
     
-    // 设置雾化器状态
-    set_fogger_state(fogger_cmd);
+    if (scene.flags & ESPCAN_SCENE_TIMED) {
+        espcan_sync_run_at(scene.activate_tick, apply_scene, &scene, sizeof(scene));
+    } else {
+        apply_scene(&scene);
+    }
 }
 
 void app_main(void)
 {
+    // 注册CAN消息处理函数
+    ESP_ERROR_CHECK(espcan_register_handler(ESPCAN_ID_FOGGER_CMD, process_fogger_command, NULL));
+    ESP_ERROR_CHECK(espcan_register_handler(ESPCAN_ID_SCENE, process_scene_command, NULL));
+    ESP_ERROR_CHECK(espcan_sync_init());
+    
+    // 按注册的ID规划接收过滤器
+    espcan_filter_plan_t filter;
+    ESP_ERROR_CHECK(espcan_filter_plan_registered(&filter));
+    
     // 安装TWAI驱动
     ESP_LOGI(TAG, "雾化器控制器初始化中...");
-    ESP_ERROR_CHECK(twai_driver_install(&g_config, &t_config, &f_config));
+    ESP_ERROR_CHECK(twai_driver_install(&g_config, &t_config, &filter.config));
     ESP_LOGI(TAG, "TWAI驱动安装成功");
 
     // 启动TWAI驱动
@@ -129,7 +150,7 @@ void app_main(void)
     relay_init();
     
     ESP_LOGI(TAG, "雾化器控制器初始化完成，等待CAN控制命令...");
-    ESP_LOGI(TAG, "CAN ID: 0x%lX, 控制引脚: %d", (unsigned long)FOGGER_CMD_ID, RELAY_PIN);
+    ESP_LOGI(TAG, "CAN ID: 0x%lX, 控制引脚: %d", (unsigned long)ESPCAN_ID_FOGGER_CMD, RELAY_PIN);
     
     // 接收CAN消息变量
     twai_message_t rx_message;
@@ -139,13 +160,8 @@ void app_main(void)
         esp_err_t result = twai_receive(&rx_message, pdMS_TO_TICKS(100));
         
         if (result == ESP_OK) {
-            // 检查消息ID是否为雾化器控制ID
-            if (rx_message.identifier == FOGGER_CMD_ID) {
-                process_fogger_command(&rx_message);
-            }
+            // 按ID查表分发
+            espcan_dispatch(&rx_message);
         }
-        
-        // 短暂延时
-        vTaskDelay(pdMS_TO_TICKS(10));
     }
 } 
\ No newline at end of file
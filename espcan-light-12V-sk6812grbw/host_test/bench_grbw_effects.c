@@ -0,0 +1,97 @@
+// GRBW效果基准测试: 效果绘制到帧缓冲区并提交给RMT (主机上的RMT立即完成发送，不计编码耗时)
+// 灯带长度由编译时的WS2812_LEDS_COUNT决定，每个长度编译一个程序
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "driver/rmt_tx.h"
+#include "host_idf.h"
+#include "host_test.h"
+#include "sk6812_encoder.h"
+
+#define BENCH_FRAME_MS 30
+#define BENCH_FRAMES 1000           // 每轮的帧数
+#define BENCH_ROUNDS 5              // 取最快的一轮
+#define BENCH_QUICK_FRAMES 50
+#define BENCH_WARMUP_FRAMES 10
+
+// main.c中定义的全局变量
+rmt_channel_handle_t rmt_channel = NULL;
+rmt_encoder_handle_t led_encoder = NULL;
+const char *TAG = "GRBW_BENCH";
+
+extern bool initFrameBuffers(rmt_channel_handle_t channel);
+extern void initWhiteExtraction(void);
+extern void setAllLEDs(uint8_t g, uint8_t r, uint8_t b, uint8_t w);
+extern void rainbow_effect_grbw(int delay_ms);
+extern void purple_chase_effect_grbw(int delay_ms);
+extern void blue_lightning_effect_grbw(int delay_ms);
+extern void breathing_light_effect_grbw(int delay_ms);
+
+static void set_all_bench(int delay_ms)
+{
+    (void)delay_ms;
+    setAllLEDs(50, 80, 30, 255);
+}
+
+typedef struct {
+    const char *name;
+    void (*render)(int delay_ms);
+} bench_effect_t;
+
+static void render_frame(void *arg)
+{
+    const bench_effect_t *effect = arg;
+    effect->render(BENCH_FRAME_MS);
+}
+
+static const bench_effect_t bench_effects[] = {
+    {"rainbow_grbw", rainbow_effect_grbw},
+    {"purple_chase_grbw", purple_chase_effect_grbw},
+    {"blue_lightning_grbw", blue_lightning_effect_grbw},
+    {"breathing_light_grbw", breathing_light_effect_grbw},
+    {"set_all_leds", set_all_bench},
+};
+
+int main(int argc, char **argv)
+{
+    bool quick = host_bench_quick(argc, argv);
+    uint32_t frames = quick ? BENCH_QUICK_FRAMES : BENCH_FRAMES;
+    int rounds = quick ? 1 : BENCH_ROUNDS;
+
+    rmt_tx_channel_config_t tx_config = {
+        .clk_src = RMT_CLK_SRC_DEFAULT,
+        .gpio_num = 18,
+        .mem_block_symbols = 64,
+        .resolution_hz = SK6812_ENCODER_RESOLUTION_HZ,
+        .trans_queue_depth = 4,
+    };
+    HOST_CHECK_EQ(rmt_new_tx_channel(&tx_config, &rmt_channel), ESP_OK);
+    HOST_CHECK_EQ(sk6812_new_encoder(&led_encoder), ESP_OK);
+    initWhiteExtraction();
+    HOST_CHECK(initFrameBuffers(rmt_channel));
+    HOST_CHECK_EQ(rmt_enable(rmt_channel), ESP_OK);
+
+    printf("%5s  %-22s %10s %9s %12s\n", "leds", "effect", "frames/s", "ns/pixel", "allocs/frame");
+    for (size_t e = 0; e < sizeof(bench_effects) / sizeof(bench_effects[0]); e++) {
+        const bench_effect_t *effect = &bench_effects[e];
+        for (int i = 0; i < BENCH_WARMUP_FRAMES; i++) {
+            effect->render(BENCH_FRAME_MS);
+        }
+
+        uint32_t sent = host_rmt_frames(rmt_channel);
+        uint64_t allocs = host_alloc_count();
+        double ns_per_call = host_bench_run(render_frame, (void *)effect, frames, rounds);
+        uint32_t calls = frames * rounds;
+        allocs = host_alloc_count() - allocs;
+        sent = host_rmt_frames(rmt_channel) - sent;
+
+        printf("%5d  %-22s %10.0f %9.2f %12.2f\n", WS2812_LEDS_COUNT, effect->name,
+               1e9 / ns_per_call, ns_per_call / WS2812_LEDS_COUNT, (double)allocs / calls);
+        // 每次调用至少提交一帧 (没有因缓冲区仍在发送而丢帧，闪电偶尔多发一帧全黑的间歇帧)，
+        // 渲染循环中不分配内存
+        HOST_CHECK(sent >= calls);
+        HOST_CHECK_EQ(allocs, 0);
+    }
+    return host_test_finish("bench_grbw_effects");
+}
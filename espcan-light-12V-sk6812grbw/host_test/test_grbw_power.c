@@ -0,0 +1,102 @@
+// GRBW节点的功率限制: 写像素时增量累计的分量之和与实际发送的帧一致 (两块缓冲区轮换、清空和缩放之后)，
+// 超出预算的帧按统一系数缩放后发送，估算的输出电流不超过预算，预算以内的帧原样发送
+
+#include <stdio.h>
+#include <string.h>
+#include "driver/rmt_tx.h"
+#include "host_idf.h"
+#include "host_test.h"
+#include "sk6812_encoder.h"
+#include "sk6812_power.h"
+
+#define TEST_LEDS 900
+#define TEST_FRAMES 400
+
+// main.c中定义的全局变量
+rmt_channel_handle_t rmt_channel = NULL;
+rmt_encoder_handle_t led_encoder = NULL;
+const char *TAG = "GRBW_TEST";
+
+extern bool initFrameBuffers(rmt_channel_handle_t channel);
+extern void initWhiteExtraction(void);
+extern void setAllLEDs(uint8_t g, uint8_t r, uint8_t b, uint8_t w);
+extern void rainbow_effect_grbw(int delay_ms);
+extern void purple_chase_effect_grbw(int delay_ms);
+extern void blue_lightning_effect_grbw(int delay_ms);
+extern void breathing_light_effect_grbw(int delay_ms);
+extern sk6812_power_t frame_power;
+
+// 最近发送的一帧的分量之和，大小不对时返回UINT32_MAX
+static uint32_t sent_sum(void)
+{
+    size_t size = 0;
+    const uint8_t *payload = host_rmt_last_payload(rmt_channel, &size);
+    HOST_CHECK_EQ(size, TEST_LEDS * 4);
+    if (size != TEST_LEDS * 4) {
+        return UINT32_MAX;
+    }
+    uint32_t sum = 0;
+    for (size_t i = 0; i < size; i++) {
+        sum += payload[i];
+    }
+    return sum;
+}
+
+// 各效果轮流绘制，每帧提交后保存的分量之和等于实际发送的字节之和
+static void test_tracking(void)
+{
+    static void (*const effects[])(int delay_ms) = {
+        rainbow_effect_grbw, purple_chase_effect_grbw, blue_lightning_effect_grbw, breathing_light_effect_grbw,
+    };
+    uint32_t errors = 0;
+    uint32_t limited = frame_power.limited_frames;
+    for (size_t e = 0; e < sizeof(effects) / sizeof(effects[0]); e++) {
+        for (int frame = 0; frame < TEST_FRAMES; frame++) {
+            effects[e](0);
+            errors += frame_power.channel_sum != sent_sum();
+        }
+    }
+    HOST_CHECK_EQ(errors, 0);
+    // 彩虹和呼吸灯的亮帧超出预算
+    HOST_CHECK(frame_power.limited_frames > limited);
+}
+
+static void test_limit(void)
+{
+    // 全亮: 估算 = 静态电流 + 900 x 4 x 12mA，缩放后每个分量都是255 * scale / 255
+    setAllLEDs(255, 255, 255, 255);
+    HOST_CHECK_EQ(frame_power.estimated_ma, frame_power.idle_ma + TEST_LEDS * 4 * SK6812_POWER_DEFAULT_CHANNEL_MA);
+    HOST_CHECK(frame_power.scale < 255);
+    HOST_CHECK(frame_power.output_ma <= frame_power.budget_ma);
+    HOST_CHECK_EQ(sent_sum(), TEST_LEDS * 4 * frame_power.scale);
+    printf("full white: estimated %lu mA, output %lu mA, budget %lu mA, scale %u/255\n",
+           (unsigned long)frame_power.estimated_ma, (unsigned long)frame_power.output_ma,
+           (unsigned long)frame_power.budget_ma, frame_power.scale);
+
+    // 预算以内原样发送
+    setAllLEDs(10, 20, 30, 40);
+    HOST_CHECK_EQ(frame_power.scale, 255);
+    HOST_CHECK(frame_power.estimated_ma <= frame_power.budget_ma);
+    HOST_CHECK_EQ(sent_sum(), TEST_LEDS * 100);
+}
+
+int main(void)
+{
+    rmt_tx_channel_config_t tx_config = {
+        .clk_src = RMT_CLK_SRC_DEFAULT,
+        .gpio_num = 18,
+        .mem_block_symbols = 64,
+        .resolution_hz = SK6812_ENCODER_RESOLUTION_HZ,
+        .trans_queue_depth = 4,
+    };
+    host_rmt_set_capture(true);
+    HOST_CHECK_EQ(rmt_new_tx_channel(&tx_config, &rmt_channel), ESP_OK);
+    HOST_CHECK_EQ(sk6812_new_encoder(&led_encoder), ESP_OK);
+    initWhiteExtraction();
+    HOST_CHECK(initFrameBuffers(rmt_channel));
+    HOST_CHECK_EQ(rmt_enable(rmt_channel), ESP_OK);
+
+    test_limit();
+    test_tracking();
+    return host_test_finish("test_grbw_power");
+}
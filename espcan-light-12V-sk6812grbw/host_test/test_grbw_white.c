@@ -0,0 +1,73 @@
+// setPixelRGB的白色提取: 全部1677万种RGB输入与浮点参考逐像素比较 (白点与sk6812_functions.c相同，约4500K)
+// 参考: W = floor(min(分量 * 255 / 白点分量))，各分量减去round(W * 白点分量 / 255)
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "driver/rmt_tx.h"
+#include "host_test.h"
+
+#define TEST_WHITE_R 255
+#define TEST_WHITE_G 219
+#define TEST_WHITE_B 186
+
+// main.c中定义的全局变量
+rmt_channel_handle_t rmt_channel = NULL;
+rmt_encoder_handle_t led_encoder = NULL;
+const char *TAG = "GRBW_TEST";
+
+extern void initWhiteExtraction(void);
+extern void setPixelRGB(int index, uint8_t r, uint8_t g, uint8_t b, uint8_t *led_data);
+
+// 浮点参考，输出GRBW
+static void ref_extract(const uint8_t rgb[3], uint8_t grbw[4])
+{
+    const uint8_t point[3] = {TEST_WHITE_R, TEST_WHITE_G, TEST_WHITE_B};
+    double level = 255;
+    for (int c = 0; c < 3; c++) {
+        level = fmin(level, rgb[c] * 255.0 / point[c]);
+    }
+    int w = (int)floor(level);
+    int out[3];
+    for (int c = 0; c < 3; c++) {
+        out[c] = rgb[c] - (int)floor(w * point[c] / 255.0 + 0.5);
+    }
+    grbw[0] = out[1];
+    grbw[1] = out[0];
+    grbw[2] = out[2];
+    grbw[3] = w;
+}
+
+int main(void)
+{
+    const uint8_t point[3] = {TEST_WHITE_R, TEST_WHITE_G, TEST_WHITE_B};
+    uint8_t led_data[2 * 4];
+    uint32_t mismatches = 0;
+    uint32_t color_errors = 0;
+    uint32_t guard_errors = 0;
+
+    initWhiteExtraction();
+    memset(led_data, 0xEE, sizeof(led_data));
+    for (uint32_t rgb24 = 0; rgb24 < 1 << 24; rgb24++) {
+        const uint8_t rgb[3] = {rgb24 >> 16, rgb24 >> 8, rgb24};
+        uint8_t expected[4];
+        setPixelRGB(0, rgb[0], rgb[1], rgb[2], led_data);
+        ref_extract(rgb, expected);
+        mismatches += memcmp(led_data, expected, 4) != 0;
+        // W和剩下的RGB合起来与输入颜色的偏差不超过0.5 LSB，分量不会因下溢回绕
+        const uint8_t out[3] = {led_data[1], led_data[0], led_data[2]};
+        for (int c = 0; c < 3; c++) {
+            color_errors += out[c] > rgb[c] || fabs(out[c] + led_data[3] * point[c] / 255.0 - rgb[c]) > 0.5;
+        }
+    }
+    // 只写一个像素
+    for (int i = 4; i < 8; i++) {
+        guard_errors += led_data[i] != 0xEE;
+    }
+    printf("%lu pixels, %lu mismatches, %lu color errors\n", 1UL << 24, (unsigned long)mismatches,
+           (unsigned long)color_errors);
+    HOST_CHECK_EQ(mismatches, 0);
+    HOST_CHECK_EQ(color_errors, 0);
+    HOST_CHECK_EQ(guard_errors, 0);
+    return host_test_finish("test_grbw_white");
+}
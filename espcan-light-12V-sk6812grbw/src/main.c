@@ -19,6 +19,10 @@
 #include "driver/twai.h"
 #include "driver/rmt_tx.h"
 #include "sdkconfig.h"
+#include "espcan_protocol.h"
+#include "espcan_filter.h"
+#include "espcan_sync.h"
+#include "sk6812_encoder.h"
 
 // 定义引脚和参数
 #define CAN_TX_PIN GPIO_NUM_5
@@ -26,26 +30,7 @@
 #define LED_PIN GPIO_NUM_2
 #define WS2812_PIN GPIO_NUM_18
 #define WS2812_LEDS_COUNT 900
-#define RMT_RESOLUTION_HZ 10000000
-
-// SK6812 GRBW时序定义
-#define T0H 3
-#define T0L 9 
-#define T1H 6
-#define T1L 6
-#define TRS 800
-
-// CAN消息ID
-#define LED_CMD_ID 0x456
-#define EMOTION_CMD_ID 0x789
-#define RANDOM_CMD_ID 0xABC
-
-// 情绪状态命令
-#define EMOTION_HAPPY 1      // 开心 - 彩虹效果
-#define EMOTION_SAD 2        // 伤心 - 闪电效果  
-#define EMOTION_SURPRISE 3   // 惊讶 - 紫色追逐效果
-#define EMOTION_NEUTRAL 4    // 中性 - 呼吸灯切换颜色效果
-#define EMOTION_RANDOM 4     // 兼容性别名
+#define RMT_RESOLUTION_HZ SK6812_ENCODER_RESOLUTION_HZ
 
 const char *TAG = "ESPCAN_SK6812";
 static uint8_t current_emotion = 0;
@@ -69,16 +54,19 @@ static const twai_general_config_t g_config = {
 };
 
 static const twai_timing_config_t t_config = TWAI_TIMING_CONFIG_500KBITS();
-static const twai_filter_config_t f_config = TWAI_FILTER_CONFIG_ACCEPT_ALL();
 
 // 函数声明
-extern void byteToRMTSymbols(uint8_t byte_val, rmt_symbol_word_t *symbols);
-extern void sendPixels(rmt_symbol_word_t *pixel_data, size_t data_size);
-extern void setPixelGRBW(int index, uint8_t g, uint8_t r, uint8_t b, uint8_t w, rmt_symbol_word_t *led_data);
-extern void refreshLEDs(rmt_symbol_word_t *led_data);
+extern esp_err_t sendPixels(uint8_t *pixel_data, size_t data_size);
+extern void setPixelGRBW(int index, uint8_t g, uint8_t r, uint8_t b, uint8_t w, uint8_t *led_data);
+extern void setPixelRGB(int index, uint8_t r, uint8_t g, uint8_t b, uint8_t *led_data);
+extern void initWhiteExtraction(void);
+extern void refreshLEDs(uint8_t *led_data);
 extern void setAllLEDs(uint8_t g, uint8_t r, uint8_t b, uint8_t w);
 extern void clearAllLEDs(void);
 
+// 帧缓冲管理函数声明
+extern bool initFrameBuffers(rmt_channel_handle_t channel);
+
 // 动画效果函数声明
 extern void rainbow_effect_grbw(int delay_ms);
 extern void purple_chase_effect_grbw(int delay_ms);
@@ -112,11 +100,16 @@ static bool initRMT(void)
         return false;
     }
 
-    // 创建简单的复制编码器
-    rmt_copy_encoder_config_t copy_encoder_config = {};
-    ret = rmt_new_copy_encoder(&copy_encoder_config, &led_encoder);
+    // 创建SK6812流式编码器 (发送时将GRBW字节展开为RMT符号)
+    ret = sk6812_new_encoder(&led_encoder);
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "创建复制编码器失败: %s", esp_err_to_name(ret));
+        ESP_LOGE(TAG, "创建SK6812编码器失败: %s", esp_err_to_name(ret));
+        return false;
+    }
+
+    // 预分配双帧缓冲区并注册发送完成回调 (须在启用通道之前)
+    if (!initFrameBuffers(rmt_channel)) {
+        ESP_LOGE(TAG, "帧缓冲区初始化失败");
         return false;
     }
 
@@ -131,42 +124,41 @@ static bool initRMT(void)
     return true;
 }
 
+// 设置LED状态
+static void set_led_state(uint8_t state) {
+    gpio_set_level(LED_PIN, state);
+    ESP_LOGI(TAG, "LED状态已设置为: %s", state ? "开启" : "关闭");
+}
+
 // 处理LED控制命令
-void handle_led_command(twai_message_t *message) {
-    if (message->data_length_code < 1) {
+static void handle_led_command(const twai_message_t *message, void *arg) {
+    espcan_led_cmd_t cmd;
+    if (espcan_decode_led_cmd(message, &cmd) != ESP_OK) {
         ESP_LOGE(TAG, "LED命令数据长度不足");
         return;
     }
     
-    uint8_t led_state = message->data[0];
-    gpio_set_level(LED_PIN, led_state);
-    ESP_LOGI(TAG, "LED状态已设置为: %s", led_state ? "开启" : "关闭");
+    set_led_state(cmd.state);
 }
 
-// 处理情绪状态命令
-void handle_emotion_command(twai_message_t *message) {
-    if (message->data_length_code < 1) {
-        ESP_LOGE(TAG, "情绪状态命令数据长度不足");
-        return;
-    }
-    
-    uint8_t emotion_state = message->data[0];
+// 切换情绪状态
+static void set_emotion(uint8_t emotion_state) {
     current_emotion = emotion_state;
     
     switch (emotion_state) {
-        case EMOTION_HAPPY:
+        case ESPCAN_EMOTION_HAPPY:
             ESP_LOGI(TAG, "情绪状态设置为: 开心 (彩虹效果)");
             break;
             
-        case EMOTION_SAD:
+        case ESPCAN_EMOTION_SAD:
             ESP_LOGI(TAG, "情绪状态设置为: 伤心 (闪电效果)");
             break;
             
-        case EMOTION_SURPRISE:
+        case ESPCAN_EMOTION_SURPRISE:
             ESP_LOGI(TAG, "情绪状态设置为: 惊讶 (紫色追逐)");
             break;
             
-        case EMOTION_NEUTRAL:
+        case ESPCAN_EMOTION_NEUTRAL:
             ESP_LOGI(TAG, "情绪状态设置为: 中性 (呼吸灯切换颜色)");
             break;
             
@@ -176,27 +168,72 @@ void handle_emotion_command(twai_message_t *message) {
     }
 }
 
+// 处理情绪状态命令
+static void handle_emotion_command(const twai_message_t *message, void *arg) {
+    espcan_emotion_cmd_t cmd;
+    if (espcan_decode_emotion_cmd(message, &cmd) != ESP_OK) {
+        ESP_LOGE(TAG, "情绪状态命令数据长度不足");
+        return;
+    }
+    
+    set_emotion(cmd.emotion);
+}
+
+// 执行场景: 灯光节点使用情绪和LED部分
+static void apply_scene(const void *data) {
+    const espcan_scene_t *scene = data;
+    
+    ESP_LOGI(TAG, "场景 #%d", scene->sequence);
+    set_led_state((scene->flags & ESPCAN_SCENE_LED_ON) ? 1 : 0);
+    set_emotion(scene->emotion);
+}
+
+// 处理场景命令 (带TIMED标志时按生效时间执行)
+static void handle_scene_command(const twai_message_t *message, void *arg) {
+    espcan_scene_t scene;
+    if (espcan_decode_scene(message, &scene) != ESP_OK) {
+        ESP_LOGE(TAG, "场景命令数据长度不足");
+        return;
+    }
+    
+    if (scene.flags & ESPCAN_SCENE_TIMED) {
+        espcan_sync_run_at(scene.activate_tick, apply_scene, &scene, sizeof(scene));
+    } else {
+        apply_scene(&scene);
+    }
+}
+
+// 打印未注册的帧
+static void handle_unknown_frame(const twai_message_t *message, void *arg) {
+    ESP_LOGI(TAG, "接收到数据长度: %d", message->data_length_code);
+    printf("数据 (HEX): ");
+    for (int i = 0; i < message->data_length_code; i++) {
+        printf("0x%02X ", message->data[i]);
+    }
+    printf("\n");
+}
+
 // 情绪灯光动画任务
 void emotion_animation_task(void *pvParameters) {
     while (1) {
         // 根据当前情绪状态设置灯光效果
         switch (current_emotion) {
-            case EMOTION_HAPPY:
+            case ESPCAN_EMOTION_HAPPY:
                 // 开心 - 彩虹效果
                 rainbow_effect_grbw(50);
                 break;
                 
-            case EMOTION_SAD:
+            case ESPCAN_EMOTION_SAD:
                 // 伤心 - 闪电效果
                 blue_lightning_effect_grbw(80);
                 break;
                 
-            case EMOTION_SURPRISE:
+            case ESPCAN_EMOTION_SURPRISE:
                 // 惊讶 - 紫色追逐
                 purple_chase_effect_grbw(60);
                 break;
                 
-            case EMOTION_NEUTRAL:
+            case ESPCAN_EMOTION_NEUTRAL:
                 // 中性状态 - 呼吸灯切换颜色
                 breathing_light_effect_grbw(30);
                 break;
@@ -220,6 +257,9 @@ void app_main(void)
     gpio_set_direction(LED_PIN, GPIO_MODE_OUTPUT);
     gpio_set_level(LED_PIN, 0);
     
+    // 生成白色提取查找表 (效果代码只写RGB)
+    initWhiteExtraction();
+    
     // 初始化RMT
     if (!initRMT()) {
         ESP_LOGE(TAG, "RMT初始化失败");
@@ -239,9 +279,20 @@ void app_main(void)
     clearAllLEDs();
     vTaskDelay(pdMS_TO_TICKS(1000));
     
+    // 注册CAN消息处理函数
+    ESP_ERROR_CHECK(espcan_register_handler(ESPCAN_ID_LED_CMD, handle_led_command, NULL));
+    ESP_ERROR_CHECK(espcan_register_handler(ESPCAN_ID_EMOTION_CMD, handle_emotion_command, NULL));
+    ESP_ERROR_CHECK(espcan_register_handler(ESPCAN_ID_SCENE, handle_scene_command, NULL));
+    espcan_set_default_handler(handle_unknown_frame, NULL);
+    ESP_ERROR_CHECK(espcan_sync_init());
+    
+    // 按注册的ID规划接收过滤器
+    espcan_filter_plan_t filter;
+    ESP_ERROR_CHECK(espcan_filter_plan_registered(&filter));
+    
     // 安装TWAI驱动
     ESP_LOGI(TAG, "CAN接收端初始化中...");
-    ESP_ERROR_CHECK(twai_driver_install(&g_config, &t_config, &f_config));
+    ESP_ERROR_CHECK(twai_driver_install(&g_config, &t_config, &filter.config));
     ESP_LOGI(TAG, "TWAI驱动安装成功");
 
     // 启动TWAI驱动
@@ -268,21 +319,12 @@ void app_main(void)
         esp_err_t result = twai_receive(&rx_message, pdMS_TO_TICKS(10000));
         
         if (result == ESP_OK) {
-            ESP_LOGI(TAG, "接收到CAN帧 - ID: 0x%lX", (unsigned long)rx_message.identifier);
-            
-            // 检查消息类型
-            if (rx_message.identifier == LED_CMD_ID) {
-                handle_led_command(&rx_message);
-            } else if (rx_message.identifier == EMOTION_CMD_ID) {
-                handle_emotion_command(&rx_message);
-            } else {
-                ESP_LOGI(TAG, "接收到数据长度: %d", rx_message.data_length_code);
-                printf("数据 (HEX): ");
-                for (int i = 0; i < rx_message.data_length_code; i++) {
-                    printf("0x%02X ", rx_message.data[i]);
-                }
-                printf("\n");
+            if (rx_message.identifier != ESPCAN_ID_TIME_SYNC) {
+                ESP_LOGI(TAG, "接收到CAN帧 - ID: 0x%lX", (unsigned long)rx_message.identifier);
             }
+            
+            // 按ID查表分发
+            espcan_dispatch(&rx_message);
         } else if (result == ESP_ERR_TIMEOUT) {
             ESP_LOGI(TAG, "等待接收超时，继续等待...");
         } else {
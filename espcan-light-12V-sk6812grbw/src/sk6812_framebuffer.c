@@ -0,0 +1,207 @@
+// SK6812 帧缓冲管理 - 初始化时预分配两块GRBW像素缓冲区，逐帧乒乓切换
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_attr.h"
+#include "driver/rmt_tx.h"
+#include "sk6812_power.h"
+
+// 外部变量和定义
+extern const char *TAG;
+
+#ifndef WS2812_LEDS_COUNT
+#define WS2812_LEDS_COUNT 900   // 主机基准测试用-D指定其他长度
+#endif
+#define FRAME_BYTES (WS2812_LEDS_COUNT * 4)        // 每个LED 4字节 (GRBW)
+#define FRAME_BUFFER_COUNT 2
+#define FRAME_STATS_INTERVAL 100                    // 每100帧输出一次统计
+#define FRAME_WAIT_TIMEOUT_MS 100                   // 等待缓冲区发送完成的超时时间
+
+// 电流预算: 按12V电源能力调整，0为不限制
+#ifndef LED_POWER_BUDGET_MA
+#define LED_POWER_BUDGET_MA 10000
+#endif
+#define LED_CHANNEL_MA SK6812_POWER_DEFAULT_CHANNEL_MA  // 单个颜色分量满值时的电流
+#define LED_IDLE_MA (WS2812_LEDS_COUNT / 2)             // 全灭时的静态电流 (每个LED约0.5mA)
+
+extern esp_err_t sendPixels(uint8_t *pixel_data, size_t data_size);
+
+// 帧缓冲区 (只在初始化时分配一次)
+static uint8_t *frame_buffers[FRAME_BUFFER_COUNT] = {NULL};
+static uint32_t frame_seq[FRAME_BUFFER_COUNT] = {0};  // 每个缓冲区最近一次提交的帧序号
+static int back_buffer = 0;                            // 当前用于渲染的缓冲区
+
+// 功率模型: channel_sum是正在渲染的缓冲区的分量之和 (setPixelGRBW增量更新)，切换缓冲区时保存和恢复
+sk6812_power_t frame_power;
+static uint32_t buffer_channel_sum[FRAME_BUFFER_COUNT] = {0};
+
+// 帧序号: 已提交 / 已发送完成
+static uint32_t frames_submitted = 0;
+static volatile uint32_t frames_done = 0;
+static SemaphoreHandle_t frame_done_sem = NULL;
+
+// 每帧时间统计 (单位: 微秒)
+static portMUX_TYPE stats_lock = portMUX_INITIALIZER_UNLOCKED;
+static int64_t submit_time_us[FRAME_BUFFER_COUNT] = {0};
+static int64_t last_done_us = 0;
+static int64_t render_start_us = 0;
+static uint32_t stat_frames = 0;
+static uint32_t stat_render_us = 0;
+static uint32_t stat_render_max_us = 0;
+static uint32_t stat_transmit_frames = 0;
+static uint32_t stat_transmit_us = 0;
+static uint32_t stat_transmit_max_us = 0;
+static int64_t stat_window_start_us = 0;
+
+// RMT发送完成回调 (中断上下文)
+static bool IRAM_ATTR frame_tx_done_cb(rmt_channel_handle_t channel, const rmt_tx_done_event_data_t *edata, void *user_ctx)
+{
+    BaseType_t high_task_wakeup = pdFALSE;
+    int64_t now = esp_timer_get_time();
+
+    portENTER_CRITICAL_ISR(&stats_lock);
+    // 帧按提交顺序发送完成，前一帧结束之前本帧处于排队状态，不计入发送时间
+    int64_t start = submit_time_us[frames_done % FRAME_BUFFER_COUNT];
+    if (start < last_done_us) {
+        start = last_done_us;
+    }
+    uint32_t transmit_us = (uint32_t)(now - start);
+    stat_transmit_us += transmit_us;
+    if (transmit_us > stat_transmit_max_us) {
+        stat_transmit_max_us = transmit_us;
+    }
+    stat_transmit_frames++;
+    last_done_us = now;
+    frames_done++;
+    portEXIT_CRITICAL_ISR(&stats_lock);
+
+    xSemaphoreGiveFromISR(frame_done_sem, &high_task_wakeup);
+    return high_task_wakeup == pdTRUE;
+}
+
+// 输出并清零统计数据
+static void report_frame_stats(void)
+{
+    int64_t now = esp_timer_get_time();
+
+    portENTER_CRITICAL(&stats_lock);
+    uint32_t frames = stat_frames;
+    uint32_t render_us = stat_render_us;
+    uint32_t render_max_us = stat_render_max_us;
+    uint32_t transmit_frames = stat_transmit_frames;
+    uint32_t transmit_us = stat_transmit_us;
+    uint32_t transmit_max_us = stat_transmit_max_us;
+    stat_frames = 0;
+    stat_render_us = 0;
+    stat_render_max_us = 0;
+    stat_transmit_frames = 0;
+    stat_transmit_us = 0;
+    stat_transmit_max_us = 0;
+    portEXIT_CRITICAL(&stats_lock);
+
+    float fps = frames * 1000000.0f / (float)(now - stat_window_start_us);
+    stat_window_start_us = now;
+
+    ESP_LOGI(TAG, "帧统计: %lu帧 %.1ffps, 渲染 平均%luus/最大%luus, 发送 平均%luus/最大%luus",
+             (unsigned long)frames, fps,
+             (unsigned long)(render_us / frames), (unsigned long)render_max_us,
+             (unsigned long)(transmit_frames ? transmit_us / transmit_frames : 0), (unsigned long)transmit_max_us);
+    ESP_LOGI(TAG, "功率: 估算%lumA, 限制后%lumA, 缩放%u/255, 累计限制%lu帧",
+             (unsigned long)frame_power.estimated_ma, (unsigned long)frame_power.output_ma,
+             frame_power.scale, (unsigned long)frame_power.limited_frames);
+}
+
+// 分配帧缓冲区并注册发送完成回调 (必须在rmt_enable之前调用)
+bool initFrameBuffers(rmt_channel_handle_t channel)
+{
+    for (int i = 0; i < FRAME_BUFFER_COUNT; i++) {
+        // 清零分配，与分量之和的初始值0一致
+        frame_buffers[i] = calloc(1, FRAME_BYTES);
+        if (frame_buffers[i] == NULL) {
+            ESP_LOGE(TAG, "帧缓冲区%d内存分配失败", i);
+            return false;
+        }
+    }
+
+    frame_done_sem = xSemaphoreCreateBinary();
+    if (frame_done_sem == NULL) {
+        ESP_LOGE(TAG, "创建帧完成信号量失败");
+        return false;
+    }
+
+    rmt_tx_event_callbacks_t cbs = {
+        .on_trans_done = frame_tx_done_cb,
+    };
+    esp_err_t ret = rmt_tx_register_event_callbacks(channel, &cbs, NULL);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "注册RMT发送完成回调失败: %s", esp_err_to_name(ret));
+        return false;
+    }
+
+    sk6812_power_init(&frame_power, LED_POWER_BUDGET_MA, LED_CHANNEL_MA, LED_IDLE_MA);
+    stat_window_start_us = esp_timer_get_time();
+    ESP_LOGI(TAG, "帧缓冲区初始化成功: %d x %u字节", FRAME_BUFFER_COUNT,
+             (unsigned)FRAME_BYTES);
+    return true;
+}
+
+// 获取用于渲染的后台缓冲区，如该缓冲区的上一帧仍在发送则等待其完成
+// 等待超时返回NULL: 缓冲区仍被RMT读取，调用者必须放弃本帧而不能写入
+uint8_t *acquireFrameBuffer(void)
+{
+    while ((int32_t)(frame_seq[back_buffer] - frames_done) > 0) {
+        if (xSemaphoreTake(frame_done_sem, pdMS_TO_TICKS(FRAME_WAIT_TIMEOUT_MS)) != pdTRUE) {
+            ESP_LOGE(TAG, "等待帧缓冲区%d发送完成超时，丢弃本帧", back_buffer);
+            return NULL;
+        }
+    }
+
+    render_start_us = esp_timer_get_time();
+    frame_power.channel_sum = buffer_channel_sum[back_buffer];
+    return frame_buffers[back_buffer];
+}
+
+// 提交渲染完成的缓冲区进行发送 (不等待发送完成)，并切换到另一块缓冲区
+void submitFrameBuffer(uint8_t *led_data, size_t data_size)
+{
+    int64_t now = esp_timer_get_time();
+    uint32_t render_us = (uint32_t)(now - render_start_us);
+    uint32_t prev_seq = frame_seq[back_buffer];
+
+    // 超出电流预算时整帧统一缩放。缓冲区两帧后才重新绘制，写像素时减去的是缩放后的旧值，
+    // 所以保存的分量之和也取缩放后的值
+    if (sk6812_power_update(&frame_power) < 255) {
+        frame_power.channel_sum = sk6812_power_apply(&frame_power, led_data, led_data, data_size);
+    }
+    buffer_channel_sum[back_buffer] = frame_power.channel_sum;
+
+    portENTER_CRITICAL(&stats_lock);
+    submit_time_us[frames_submitted % FRAME_BUFFER_COUNT] = now;
+    stat_render_us += render_us;
+    if (render_us > stat_render_max_us) {
+        stat_render_max_us = render_us;
+    }
+    stat_frames++;
+    portEXIT_CRITICAL(&stats_lock);
+
+    // 发送完成回调可能在rmt_transmit返回前触发，需提前登记帧序号
+    frame_seq[back_buffer] = frames_submitted + 1;
+    if (sendPixels(led_data, data_size) == ESP_OK) {
+        frames_submitted++;
+        back_buffer = (back_buffer + 1) % FRAME_BUFFER_COUNT;
+    } else {
+        frame_seq[back_buffer] = prev_seq;
+    }
+
+    if (stat_frames >= FRAME_STATS_INTERVAL) {
+        report_frame_stats();
+    }
+}
@@ -10,103 +10,122 @@
 #include "esp_log.h"
 #include "esp_random.h"
 #include "driver/rmt_tx.h"
+#include "sk6812_power.h"
 
 // 外部变量和定义
 extern rmt_channel_handle_t rmt_channel;
 extern rmt_encoder_handle_t led_encoder;
 extern const char *TAG;
 
-#define WS2812_LEDS_COUNT 900
-#define T0H 3
-#define T0L 9 
-#define T1H 6
-#define T1L 6
-#define TRS 800
+#ifndef WS2812_LEDS_COUNT
+#define WS2812_LEDS_COUNT 900   // 主机基准测试用-D指定其他长度
+#endif
+#define BYTES_PER_LED 4  // GRBW
 
-// 前向声明内部函数
-void setPixelGRBW(int index, uint8_t g, uint8_t r, uint8_t b, uint8_t w, rmt_symbol_word_t *led_data);
-void refreshLEDs(rmt_symbol_word_t *led_data);
-void sendPixels(rmt_symbol_word_t *pixel_data, size_t data_size);
-void byteToRMTSymbols(uint8_t byte_val, rmt_symbol_word_t *symbols);
+// RGB转GRBW时从RGB中提取白色，由白光LED代替三色LED发光 (0为白色分量固定为0)
+#define WHITE_EXTRACTION_ENABLED 1
+// 白光LED满亮度时相当于的RGB颜色 (色温约4500K)
+#define WHITE_POINT_R 255
+#define WHITE_POINT_G 219
+#define WHITE_POINT_B 186
 
-// 将字节值转换为RMT符号 (8个位)
-void byteToRMTSymbols(uint8_t byte_val, rmt_symbol_word_t *symbols)
-{
-    for (int i = 7; i >= 0; i--) {  // MSB优先
-        if (byte_val & (1 << i)) {
-            // 发送'1'位
-            symbols[7-i].level0 = 1;
-            symbols[7-i].duration0 = T1H;
-            symbols[7-i].level1 = 0;
-            symbols[7-i].duration1 = T1L;
-        } else {
-            // 发送'0'位  
-            symbols[7-i].level0 = 1;
-            symbols[7-i].duration0 = T0H;
-            symbols[7-i].level1 = 0;
-            symbols[7-i].duration1 = T0L;
-        }
-    }
-}
+// 帧缓冲管理 (sk6812_framebuffer.c)，acquireFrameBuffer等待超时返回NULL
+extern uint8_t *acquireFrameBuffer(void);
+extern void submitFrameBuffer(uint8_t *led_data, size_t data_size);
+extern sk6812_power_t frame_power;   // channel_sum为当前渲染缓冲区的分量之和
+
+// 前向声明内部函数
+void setPixelGRBW(int index, uint8_t g, uint8_t r, uint8_t b, uint8_t w, uint8_t *led_data);
+void setPixelRGB(int index, uint8_t r, uint8_t g, uint8_t b, uint8_t *led_data);
+void clearPixels(uint8_t *led_data);
+void refreshLEDs(uint8_t *led_data);
+esp_err_t sendPixels(uint8_t *pixel_data, size_t data_size);
 
-// 发送像素数据
-void sendPixels(rmt_symbol_word_t *pixel_data, size_t data_size)
+// 发送像素数据 (只排队不等待，缓冲区在发送完成前由帧缓冲管理保护)
+// 编码器在发送时将颜色字节展开为RMT符号，并在末尾追加复位信号
+esp_err_t sendPixels(uint8_t *pixel_data, size_t data_size)
 {
     rmt_transmit_config_t tx_config = {
         .loop_count = 0, // 不循环
     };
 
-    esp_err_t ret = rmt_transmit(rmt_channel, led_encoder, pixel_data, 
-                                data_size * sizeof(rmt_symbol_word_t), &tx_config);
+    esp_err_t ret = rmt_transmit(rmt_channel, led_encoder, pixel_data, data_size, &tx_config);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "发送像素数据失败: %s", esp_err_to_name(ret));
     }
-
-    // 等待传输完成
-    ret = rmt_tx_wait_all_done(rmt_channel, 100);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "等待传输完成超时: %s", esp_err_to_name(ret));
-    }
+    return ret;
 }
 
 // 设置单个LED的GRBW颜色
 void setPixelGRBW(int index, uint8_t g, uint8_t r, uint8_t b, uint8_t w, 
-                  rmt_symbol_word_t *led_data)
+                  uint8_t *led_data)
 {
     if (index >= WS2812_LEDS_COUNT) return;
     
-    int offset = index * 32;
-    byteToRMTSymbols(g, &led_data[offset + 0]);   // 绿色
-    byteToRMTSymbols(r, &led_data[offset + 8]);   // 红色  
-    byteToRMTSymbols(b, &led_data[offset + 16]);  // 蓝色
-    byteToRMTSymbols(w, &led_data[offset + 24]);  // 白色
+    uint8_t *pixel = &led_data[index * BYTES_PER_LED];
+    // 减去被覆盖的旧值，提交时不需要再遍历整帧估算电流
+    frame_power.channel_sum += g + r + b + w;
+    frame_power.channel_sum -= pixel[0] + pixel[1] + pixel[2] + pixel[3];
+    pixel[0] = g;   // 绿色
+    pixel[1] = r;   // 红色  
+    pixel[2] = b;   // 蓝色
+    pixel[3] = w;   // 白色
+}
+
+// 关闭缓冲区中所有LED，分量之和同时清零
+void clearPixels(uint8_t *led_data)
+{
+    memset(led_data, 0, WS2812_LEDS_COUNT * BYTES_PER_LED);
+    frame_power.channel_sum = 0;
+}
+
+// 白色提取查找表 (initWhiteExtraction中生成)
+static uint8_t white_level[3][256];     // 按R/G/B分量值查: 该分量最多能由白光LED提供的白色亮度
+static uint8_t white_sub[3][256];       // 按白色亮度查: 需要从R/G/B分量中减去的值
+
+// 按白光LED的色温生成白色提取查找表 (启动时调用一次)
+void initWhiteExtraction(void)
+{
+    const uint8_t point[3] = {WHITE_POINT_R, WHITE_POINT_G, WHITE_POINT_B};
+    for (int c = 0; c < 3; c++) {
+        for (int v = 0; v < 256; v++) {
+            // 向下取整保证减去的值不超过分量本身
+            uint32_t level = point[c] ? v * 255 / point[c] : 255;
+            white_level[c][v] = level > 255 ? 255 : level;
+            white_sub[c][v] = (v * point[c] + 127) / 255;
+        }
+    }
+}
+
+// 以RGB设置单个LED，三个分量能共同提供的白色转到白光LED
+void setPixelRGB(int index, uint8_t r, uint8_t g, uint8_t b, uint8_t *led_data)
+{
+#if WHITE_EXTRACTION_ENABLED
+    uint8_t w = white_level[0][r];
+    uint8_t level = white_level[1][g];
+    w = level < w ? level : w;
+    level = white_level[2][b];
+    w = level < w ? level : w;
+    setPixelGRBW(index, g - white_sub[1][w], r - white_sub[0][w], b - white_sub[2][w], w, led_data);
+#else
+    setPixelGRBW(index, g, r, b, 0, led_data);
+#endif
 }
 
 // 更新整个LED条
-void refreshLEDs(rmt_symbol_word_t *led_data)
+void refreshLEDs(uint8_t *led_data)
 {
-    size_t total_symbols = WS2812_LEDS_COUNT * 32 + 1;
-    
-    // 添加最终的复位信号
-    led_data[WS2812_LEDS_COUNT * 32].level0 = 0;
-    led_data[WS2812_LEDS_COUNT * 32].duration0 = TRS;
-    led_data[WS2812_LEDS_COUNT * 32].level1 = 0;
-    led_data[WS2812_LEDS_COUNT * 32].duration1 = 0;
-    
-    // 发送数据
-    sendPixels(led_data, total_symbols);
+    // 提交发送
+    submitFrameBuffer(led_data, WS2812_LEDS_COUNT * BYTES_PER_LED);
 }
 
 // 为所有LED设置相同颜色
 void setAllLEDs(uint8_t g, uint8_t r, uint8_t b, uint8_t w)
 {
-    // 为所有LED分配内存：每个LED 32位数据 + 最后一个复位信号
-    size_t total_symbols = WS2812_LEDS_COUNT * 32 + 1;
-    rmt_symbol_word_t *led_data = malloc(total_symbols * sizeof(rmt_symbol_word_t));
-    
+    // 获取预分配的帧缓冲区
+    uint8_t *led_data = acquireFrameBuffer();
     if (led_data == NULL) {
-        ESP_LOGE(TAG, "内存分配失败");
-        return;
+        return;  // 缓冲区仍在发送，跳过本帧
     }
     
     // 为每个LED构建GRBW数据
@@ -116,9 +135,6 @@ void setAllLEDs(uint8_t g, uint8_t r, uint8_t b, uint8_t w)
     
     // 更新显示
     refreshLEDs(led_data);
-    
-    // 释放内存
-    free(led_data);
 }
 
 // 关闭所有LED
@@ -131,11 +147,10 @@ void clearAllLEDs(void)
 void rainbow_effect_grbw(int delay_ms) {
     static uint8_t hue = 0;
     
-    // 分配LED数据内存
-    size_t total_symbols = WS2812_LEDS_COUNT * 32 + 1;
-    rmt_symbol_word_t *led_data = malloc(total_symbols * sizeof(rmt_symbol_word_t));
+    // 获取预分配的帧缓冲区
+    uint8_t *led_data = acquireFrameBuffer();
     if (led_data == NULL) {
-        return;
+        return;  // 缓冲区仍在发送，跳过本帧
     }
     
     // 创建彩虹效果
@@ -143,21 +158,20 @@ void rainbow_effect_grbw(int delay_ms) {
         // 计算每个LED的色调，形成彩虹
         uint8_t pos = (i * 256 / WS2812_LEDS_COUNT + hue) & 0xFF;
         
-        // 将HSV转换为GRBW (简化版彩虹算法，白色通道设为0)
+        // 将HSV转换为RGB (简化版彩虹算法)
         if (pos < 85) {
-            setPixelGRBW(i, pos * 3, 255 - pos * 3, 0, 0, led_data);
+            setPixelRGB(i, 255 - pos * 3, pos * 3, 0, led_data);
         } else if (pos < 170) {
             pos -= 85;
-            setPixelGRBW(i, 255 - pos * 3, 0, pos * 3, 0, led_data);
+            setPixelRGB(i, 0, 255 - pos * 3, pos * 3, led_data);
         } else {
             pos -= 170;
-            setPixelGRBW(i, 0, pos * 3, 255 - pos * 3, 0, led_data);
+            setPixelRGB(i, pos * 3, 0, 255 - pos * 3, led_data);
         }
     }
     
     // 更新显示
     refreshLEDs(led_data);
-    free(led_data);
     
     // 移动彩虹
     hue += 2;
@@ -170,17 +184,14 @@ void rainbow_effect_grbw(int delay_ms) {
 void purple_chase_effect_grbw(int delay_ms) {
     static int position = 0;
     
-    // 分配LED数据内存
-    size_t total_symbols = WS2812_LEDS_COUNT * 32 + 1;
-    rmt_symbol_word_t *led_data = malloc(total_symbols * sizeof(rmt_symbol_word_t));
+    // 获取预分配的帧缓冲区
+    uint8_t *led_data = acquireFrameBuffer();
     if (led_data == NULL) {
-        return;
+        return;  // 缓冲区仍在发送，跳过本帧
     }
     
     // 先清空所有LED
-    for (int i = 0; i < WS2812_LEDS_COUNT; i++) {
-        setPixelGRBW(i, 0, 0, 0, 0, led_data);
-    }
+    clearPixels(led_data);
     
     // 追逐灯的长度
     const int chase_length = 8;
@@ -190,12 +201,11 @@ void purple_chase_effect_grbw(int delay_ms) {
         int pos = (position + i) % WS2812_LEDS_COUNT;
         // 根据距离头部的位置，亮度逐渐降低
         uint8_t brightness = 255 - (i * 255 / chase_length);
-        setPixelGRBW(pos, 0, brightness, brightness, 0, led_data); // 紫色：红+蓝
+        setPixelRGB(pos, brightness, 0, brightness, led_data); // 紫色：红+蓝
     }
     
     // 更新显示
     refreshLEDs(led_data);
-    free(led_data);
     
     // 移动追逐位置
     position = (position + 1) % WS2812_LEDS_COUNT;
@@ -206,17 +216,14 @@ void purple_chase_effect_grbw(int delay_ms) {
 
 // 蓝色闪电效果实现 (GRBW版本)
 void blue_lightning_effect_grbw(int delay_ms) {
-    // 分配LED数据内存
-    size_t total_symbols = WS2812_LEDS_COUNT * 32 + 1;
-    rmt_symbol_word_t *led_data = malloc(total_symbols * sizeof(rmt_symbol_word_t));
+    // 获取预分配的帧缓冲区
+    uint8_t *led_data = acquireFrameBuffer();
     if (led_data == NULL) {
-        return;
+        return;  // 缓冲区仍在发送，跳过本帧
     }
     
     // 先清空所有LED
-    for (int i = 0; i < WS2812_LEDS_COUNT; i++) {
-        setPixelGRBW(i, 0, 0, 0, 0, led_data);
-    }
+    clearPixels(led_data);
     
     // 随机生成闪电位置
     int num_flashes = 3 + (esp_random() % 4); // 3-6个闪电点
@@ -230,16 +237,15 @@ void blue_lightning_effect_grbw(int delay_ms) {
         
         // 闪电周围有淡蓝色光晕
         if (pos > 0) {
-            setPixelGRBW(pos-1, 20, 20, 120, 0, led_data);
+            setPixelRGB(pos-1, 20, 20, 120, led_data);
         }
         if (pos < WS2812_LEDS_COUNT-1) {
-            setPixelGRBW(pos+1, 20, 20, 120, 0, led_data);
+            setPixelRGB(pos+1, 20, 20, 120, led_data);
         }
     }
     
     // 更新显示
     refreshLEDs(led_data);
-    free(led_data);
     
     // 闪电持续时间短
     vTaskDelay(pdMS_TO_TICKS(delay_ms));
@@ -0,0 +1,190 @@
+// Per-frame cost of writing one frame to two mirrored strips, for the RMT and the SPI backend:
+// led_strip_set_pixel() twice per LED against set_pixels/fill followed by mirror.
+// Every variant is refreshed once with the output captured, and the bytes must match the per-pixel path.
+#include <stdio.h>
+#include <string.h>
+#include "host_test.h"
+#include "host_idf.h"
+#include "led_strip.h"
+
+#define BENCH_FRAMES 2000
+#define BENCH_ROUNDS 5
+#define BENCH_QUICK_FRAMES 20
+#define BENCH_MAX_LEDS 1800
+#define BENCH_MAX_WIRE_BYTES (BENCH_MAX_LEDS * 3 * 3)   // SPI sends 3 bytes per color byte
+
+static const uint32_t bench_led_counts[] = {900, 1800};
+
+typedef struct {
+    led_strip_handle_t strips[2];
+    uint32_t leds;
+    uint8_t colors[BENCH_MAX_LEDS * 3];
+} bench_ctx_t;
+
+typedef struct {
+    const char *name;
+    void (*write)(void *arg);
+} bench_case_t;
+
+typedef struct {
+    const char *name;
+    esp_err_t (*new_strip)(const led_strip_config_t *config, int index, led_strip_handle_t *strip);
+    const uint8_t *(*last_output)(size_t *size);    // bytes sent by the strip created last
+} bench_backend_t;
+
+static esp_err_t new_rmt_strip(const led_strip_config_t *config, int index, led_strip_handle_t *strip)
+{
+    led_strip_rmt_config_t rmt_config = {0};
+    (void)index;
+    return led_strip_new_rmt_device(config, &rmt_config, strip);
+}
+
+static const uint8_t *rmt_last_output(size_t *size)
+{
+    return host_rmt_last_payload(host_rmt_last_channel(), size);
+}
+
+static esp_err_t new_spi_strip(const led_strip_config_t *config, int index, led_strip_handle_t *strip)
+{
+    led_strip_spi_config_t spi_config = {
+        .spi_bus = index ? SPI3_HOST : SPI2_HOST,
+        .flags.with_dma = true,
+    };
+    return led_strip_new_spi_device(config, &spi_config, strip);
+}
+
+static const uint8_t *spi_last_output(size_t *size)
+{
+    return host_spi_output(host_spi_last_device(), size);
+}
+
+static const bench_backend_t bench_backends[] = {
+    {"rmt", new_rmt_strip, rmt_last_output},
+    {"spi", new_spi_strip, spi_last_output},
+};
+
+// what the effects did before the bulk API: one call per LED and strip
+static void write_per_pixel(void *arg)
+{
+    bench_ctx_t *ctx = arg;
+    for (uint32_t i = 0; i < ctx->leds; i++) {
+        const uint8_t *c = &ctx->colors[i * 3];
+        led_strip_set_pixel(ctx->strips[0], i, c[0], c[1], c[2]);
+        led_strip_set_pixel(ctx->strips[1], i, c[0], c[1], c[2]);
+    }
+}
+
+static void write_set_pixels(void *arg)
+{
+    bench_ctx_t *ctx = arg;
+    led_strip_set_pixels(ctx->strips[0], 0, ctx->leds, ctx->colors);
+    led_strip_mirror(ctx->strips[1], ctx->strips[0]);
+}
+
+// solid frame: the per-pixel path for comparison is write_per_pixel with one color
+static void write_fill_per_pixel(void *arg)
+{
+    bench_ctx_t *ctx = arg;
+    for (uint32_t i = 0; i < ctx->leds; i++) {
+        led_strip_set_pixel(ctx->strips[0], i, 12, 34, 56);
+        led_strip_set_pixel(ctx->strips[1], i, 12, 34, 56);
+    }
+}
+
+static void write_fill(void *arg)
+{
+    bench_ctx_t *ctx = arg;
+    led_strip_fill(ctx->strips[0], 0, ctx->leds, 12, 34, 56);
+    led_strip_mirror(ctx->strips[1], ctx->strips[0]);
+}
+
+static const bench_case_t bench_cases[] = {
+    {"set_pixel x2", write_per_pixel},
+    {"set_pixels+mirror", write_set_pixels},
+    {"fill set_pixel x2", write_fill_per_pixel},
+    {"fill+mirror", write_fill},
+};
+
+// refresh both strips and return a copy of the bytes sent on the second one
+static size_t capture_frame(const bench_backend_t *backend, bench_ctx_t *ctx, uint8_t *out)
+{
+    size_t size = 0;
+    HOST_CHECK_EQ(led_strip_refresh(ctx->strips[0]), ESP_OK);
+    if (backend->last_output == spi_last_output) {
+        // the SPI stand-in keeps everything sent since the last clear
+        host_spi_clear_output(host_spi_last_device());
+    }
+    HOST_CHECK_EQ(led_strip_refresh(ctx->strips[1]), ESP_OK);
+    const uint8_t *payload = backend->last_output(&size);
+    HOST_CHECK(size > 0 && size <= BENCH_MAX_WIRE_BYTES);
+    size = size <= BENCH_MAX_WIRE_BYTES ? size : 0;
+    memcpy(out, payload, size);
+    return size;
+}
+
+static void bench_layout(const bench_backend_t *backend, bench_ctx_t *ctx, uint32_t leds, uint32_t frames, int rounds)
+{
+    static uint8_t expected[BENCH_MAX_WIRE_BYTES];
+    static uint8_t sent[BENCH_MAX_WIRE_BYTES];
+    size_t expected_size = 0;
+    led_strip_config_t strip_config = {
+        .max_leds = leds,
+        .led_model = LED_MODEL_WS2812,
+        .color_component_format = LED_STRIP_COLOR_COMPONENT_FMT_GRB,
+    };
+    ctx->leds = leds;
+    for (int i = 0; i < 2; i++) {
+        strip_config.strip_gpio_num = 18 + i;
+        HOST_CHECK_EQ(backend->new_strip(&strip_config, i, &ctx->strips[i]), ESP_OK);
+    }
+
+    double per_pixel_ns = 0;
+    for (size_t k = 0; k < sizeof(bench_cases) / sizeof(bench_cases[0]); k++) {
+        const bench_case_t *bench = &bench_cases[k];
+        // even cases are the per-pixel reference of the following bulk case
+        led_strip_clear(ctx->strips[0]);
+        led_strip_clear(ctx->strips[1]);
+        bench->write(ctx);
+        if (k % 2) {
+            size_t size = capture_frame(backend, ctx, sent);
+            HOST_CHECK(size == expected_size && memcmp(sent, expected, size) == 0);
+        } else {
+            expected_size = capture_frame(backend, ctx, expected);
+        }
+
+        uint64_t allocs = host_alloc_count();
+        double ns = host_bench_run(bench->write, ctx, frames, rounds);
+        HOST_CHECK_EQ(host_alloc_count() - allocs, 0);
+        if (k % 2 == 0) {
+            per_pixel_ns = ns;
+        }
+        printf("%-4s %5lu  %-20s %10.1f %9.2f %8.2fx\n", backend->name, (unsigned long)leds, bench->name,
+               ns / 1000, ns / leds, per_pixel_ns / ns);
+    }
+
+    for (int i = 0; i < 2; i++) {
+        led_strip_del(ctx->strips[i]);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    static bench_ctx_t ctx;
+    bool quick = host_bench_quick(argc, argv);
+    uint32_t frames = quick ? BENCH_QUICK_FRAMES : BENCH_FRAMES;
+    int rounds = quick ? 1 : BENCH_ROUNDS;
+
+    for (uint32_t i = 0; i < sizeof(ctx.colors); i++) {
+        ctx.colors[i] = (uint8_t)(i * 7 + (i >> 8));
+    }
+    host_rmt_set_capture(true);
+    host_spi_set_capture(true);
+
+    printf("%-4s %5s  %-20s %10s %9s %9s\n", "", "leds", "case", "us/frame", "ns/led", "speedup");
+    for (size_t b = 0; b < sizeof(bench_backends) / sizeof(bench_backends[0]); b++) {
+        for (size_t i = 0; i < sizeof(bench_led_counts) / sizeof(bench_led_counts[0]); i++) {
+            bench_layout(&bench_backends[b], &ctx, bench_led_counts[i], frames, rounds);
+        }
+    }
+    return host_test_finish("bench_led_strip_bulk");
+}
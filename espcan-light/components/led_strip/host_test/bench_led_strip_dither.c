@@ -0,0 +1,147 @@
+// Per-frame cost of high depth mode for 900 and 1800 RGB LEDs: the dither kernel alone, with the brightness/gamma
+// curve, and whole refreshes of RMT and chunked SPI strips against the 8-bit ones.
+// Every case must stay well within the time the frame takes on the wire (30us per LED).
+#include <stdio.h>
+#include <string.h>
+#include "host_test.h"
+#include "host_idf.h"
+#include "led_strip.h"
+#include "led_strip_dither.h"
+
+#define BENCH_FRAMES 2000
+#define BENCH_ROUNDS 5
+#define BENCH_QUICK_FRAMES 20
+#define BENCH_MAX_LEDS 1800
+#define BENCH_WIRE_NS_PER_LED 30000 // 24 bits of 1.25us
+#define BENCH_SPI_CHUNK_LEDS 64
+
+static const uint32_t bench_led_counts[] = {900, 1800};
+
+typedef struct {
+    uint32_t leds;
+    led_strip_handle_t strip;
+    uint16_t curve[LED_STRIP_DITHER_CURVE_POINTS];
+    uint16_t colors16[BENCH_MAX_LEDS * 3];
+    uint8_t colors[BENCH_MAX_LEDS * 3];
+    uint8_t residual[BENCH_MAX_LEDS * 3];
+    uint8_t out[BENCH_MAX_LEDS * 3];
+} bench_ctx_t;
+
+static void dither_plain(void *arg)
+{
+    bench_ctx_t *ctx = arg;
+    led_strip_dither_encode(ctx->colors16, ctx->residual, NULL, ctx->out, ctx->leds * 3);
+    host_clobber(ctx->out);
+}
+
+static void dither_curve(void *arg)
+{
+    bench_ctx_t *ctx = arg;
+    led_strip_dither_encode(ctx->colors16, ctx->residual, ctx->curve, ctx->out, ctx->leds * 3);
+    host_clobber(ctx->out);
+}
+
+// the stand-ins don't copy the output, only the driver's work is timed
+static void refresh_strip(void *arg)
+{
+    bench_ctx_t *ctx = arg;
+    led_strip_refresh(ctx->strip);
+}
+
+static esp_err_t new_rmt_strip(uint32_t leds, bool high_depth, led_strip_handle_t *strip)
+{
+    led_strip_config_t strip_config = {
+        .strip_gpio_num = 18,
+        .max_leds = leds,
+        .led_model = LED_MODEL_WS2812,
+        .color_component_format = LED_STRIP_COLOR_COMPONENT_FMT_RGB,
+        .flags.high_depth = high_depth,
+    };
+    led_strip_rmt_config_t rmt_config = {0};
+    return led_strip_new_rmt_device(&strip_config, &rmt_config, strip);
+}
+
+static esp_err_t new_spi_strip(uint32_t leds, bool high_depth, led_strip_handle_t *strip)
+{
+    led_strip_config_t strip_config = {
+        .strip_gpio_num = 18,
+        .max_leds = leds,
+        .led_model = LED_MODEL_WS2812,
+        .color_component_format = LED_STRIP_COLOR_COMPONENT_FMT_RGB,
+        .flags.high_depth = high_depth,
+    };
+    led_strip_spi_config_t spi_config = {
+        .spi_bus = SPI2_HOST,
+        .chunk_leds = BENCH_SPI_CHUNK_LEDS,
+        .flags.with_dma = true,
+    };
+    return led_strip_new_spi_device(&strip_config, &spi_config, strip);
+}
+
+typedef struct {
+    const char *name;
+    void (*fn)(void *arg);
+    esp_err_t (*new_strip)(uint32_t leds, bool high_depth, led_strip_handle_t *strip);
+    bool high_depth;
+} bench_case_t;
+
+static const bench_case_t bench_cases[] = {
+    {"dither", dither_plain, NULL, false},
+    {"dither + curve", dither_curve, NULL, false},
+    {"rmt refresh 8-bit", refresh_strip, new_rmt_strip, false},
+    {"rmt refresh 16-bit", refresh_strip, new_rmt_strip, true},
+    {"spi refresh 8-bit", refresh_strip, new_spi_strip, false},
+    {"spi refresh 16-bit", refresh_strip, new_spi_strip, true},
+};
+
+static void bench_layout(bench_ctx_t *ctx, uint32_t leds, uint32_t frames, int rounds)
+{
+    double wire_ns = (double)leds * BENCH_WIRE_NS_PER_LED;
+    ctx->leds = leds;
+    for (size_t k = 0; k < sizeof(bench_cases) / sizeof(bench_cases[0]); k++) {
+        const bench_case_t *c = &bench_cases[k];
+        ctx->strip = NULL;
+        if (c->new_strip) {
+            HOST_CHECK_EQ(c->new_strip(leds, c->high_depth, &ctx->strip), ESP_OK);
+            if (ctx->strip == NULL) {
+                continue;
+            }
+            // the gamma curve is applied in both depths, as in espcan-light
+            HOST_CHECK_EQ(led_strip_set_gamma(ctx->strip, 2.2f), ESP_OK);
+            if (c->high_depth) {
+                HOST_CHECK_EQ(led_strip_set_pixels_16(ctx->strip, 0, leds, ctx->colors16), ESP_OK);
+            } else {
+                HOST_CHECK_EQ(led_strip_set_pixels(ctx->strip, 0, leds, ctx->colors), ESP_OK);
+            }
+        }
+        double ns = host_bench_run(c->fn, ctx, frames, rounds);
+        HOST_CHECK(ns < wire_ns);
+        printf("%5lu  %-20s %10.1f %9.2f %9.2f%%\n", (unsigned long)leds, c->name, ns / 1000, ns / leds, ns * 100 / wire_ns);
+        if (ctx->strip) {
+            led_strip_del(ctx->strip);
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    static bench_ctx_t ctx;
+    bool quick = host_bench_quick(argc, argv);
+    uint32_t frames = quick ? BENCH_QUICK_FRAMES : BENCH_FRAMES;
+    int rounds = quick ? 1 : BENCH_ROUNDS;
+
+    for (int i = 0; i < LED_STRIP_DITHER_CURVE_POINTS; i++) {
+        uint32_t x = i * 256 > 0xFFFF ? 0xFFFF : i * 256;
+        ctx.curve[i] = (uint16_t)(x * x / 0xFFFF);
+    }
+    for (size_t i = 0; i < BENCH_MAX_LEDS * 3; i++) {
+        ctx.colors16[i] = (uint16_t)(i * 2671 + (i >> 4));
+        ctx.colors[i] = ctx.colors16[i] >> 8;
+    }
+
+    printf("%5s  %-20s %10s %9s %10s\n", "leds", "case", "us/frame", "ns/led", "of wire");
+    for (size_t i = 0; i < sizeof(bench_led_counts) / sizeof(bench_led_counts[0]); i++) {
+        bench_layout(&ctx, bench_led_counts[i], frames, rounds);
+    }
+    return host_test_finish("bench_led_strip_dither");
+}
@@ -0,0 +1,130 @@
+// Parallel backend encoding cost: the bit-by-bit interleaving against the 8x8 transpose kernel,
+// and a whole refresh through the driver, for 8 strips of 900 and 1800 GRB LEDs.
+// The frame takes 24 bus slots of 400ns per color byte on the wire, printed for comparison.
+#include <stdio.h>
+#include <string.h>
+#include "host_test.h"
+#include "host_idf.h"
+#include "led_strip.h"
+#include "led_strip_parallel_kernel.h"
+
+#define BENCH_FRAMES 200
+#define BENCH_ROUNDS 5
+#define BENCH_QUICK_FRAMES 2
+#define BENCH_MAX_LEDS 1800
+#define BENCH_BYTES_PER_PIXEL 3
+#define BENCH_SLOT_NS 400
+
+static const uint32_t bench_led_counts[] = {900, 1800};
+
+typedef struct {
+    led_strip_handle_t strip;
+    uint32_t leds;
+    const uint8_t *lanes[LED_STRIP_PARALLEL_MAX_LANES];
+    uint8_t colors[LED_STRIP_PARALLEL_MAX_STRIPS][BENCH_MAX_LEDS * BENCH_BYTES_PER_PIXEL];
+    uint8_t out[BENCH_MAX_LEDS * BENCH_BYTES_PER_PIXEL * LED_STRIP_PARALLEL_BYTES_PER_COLOR_BYTE];
+} bench_ctx_t;
+
+// one bus word per slot, every bit picked from its lane separately
+static void encode_ref(void *arg)
+{
+    bench_ctx_t *ctx = arg;
+    uint8_t *out = ctx->out;
+    for (size_t i = 0; i < ctx->leds * BENCH_BYTES_PER_PIXEL; i++) {
+        for (int n = 0; n < 8; n++) {
+            uint8_t data = 0;
+            for (int lane = 0; lane < LED_STRIP_PARALLEL_MAX_LANES; lane++) {
+                data |= ((ctx->lanes[lane][i] >> (7 - n)) & 1) << lane;
+            }
+            *out++ = 0xFF;
+            *out++ = data;
+            *out++ = 0;
+        }
+    }
+    host_clobber(ctx->out);
+}
+
+static void encode_kernel(void *arg)
+{
+    bench_ctx_t *ctx = arg;
+    led_strip_parallel_encode(ctx->lanes, ctx->leds * BENCH_BYTES_PER_PIXEL, NULL, ctx->out);
+    host_clobber(ctx->out);
+}
+
+// the stand-in bus completes the transaction without copying
+static void refresh_strip(void *arg)
+{
+    bench_ctx_t *ctx = arg;
+    led_strip_refresh(ctx->strip);
+}
+
+typedef struct {
+    const char *name;
+    void (*fn)(void *arg);
+} bench_case_t;
+
+static const bench_case_t bench_cases[] = {
+    {"encode bit by bit", encode_ref},
+    {"encode transpose8", encode_kernel},
+    {"refresh (driver)", refresh_strip},
+};
+
+static void bench_layout(bench_ctx_t *ctx, uint32_t leds, uint32_t frames, int rounds)
+{
+    ctx->leds = leds;
+    led_strip_config_t strip_config = {
+        .max_leds = leds,
+        .led_model = LED_MODEL_WS2812,
+        .color_component_format = LED_STRIP_COLOR_COMPONENT_FMT_GRB,
+    };
+    led_strip_parallel_config_t parallel_config = {
+        .data_gpio_nums = {2, 4, 5, 12, 13, 14, 15, 18},
+        .num_strips = LED_STRIP_PARALLEL_MAX_STRIPS,
+        .wr_gpio_num = 25,
+        .dc_gpio_num = 26,
+    };
+    HOST_CHECK_EQ(led_strip_new_parallel_device(&strip_config, &parallel_config, &ctx->strip), ESP_OK);
+    for (int n = 0; n < LED_STRIP_PARALLEL_MAX_STRIPS; n++) {
+        HOST_CHECK_EQ(led_strip_set_pixels(ctx->strip, n * leds, leds, ctx->colors[n]), ESP_OK);
+    }
+
+    double wire_us = leds * BENCH_BYTES_PER_PIXEL * LED_STRIP_PARALLEL_BYTES_PER_COLOR_BYTE * BENCH_SLOT_NS / 1000.0;
+    double ref_ns = 0;
+    for (size_t k = 0; k < sizeof(bench_cases) / sizeof(bench_cases[0]); k++) {
+        double ns = host_bench_run(bench_cases[k].fn, ctx, frames, rounds);
+        if (bench_cases[k].fn == encode_ref) {
+            ref_ns = ns;
+        }
+        printf("8x%-4lu %-18s %10.1f %8.2fx %9.2f%%\n", (unsigned long)leds, bench_cases[k].name,
+               ns / 1000, ref_ns / ns, ns / 10 / wire_us);
+    }
+    led_strip_del(ctx->strip);
+}
+
+int main(int argc, char **argv)
+{
+    static bench_ctx_t ctx;
+    bool quick = host_bench_quick(argc, argv);
+    uint32_t frames = quick ? BENCH_QUICK_FRAMES : BENCH_FRAMES;
+    int rounds = quick ? 1 : BENCH_ROUNDS;
+
+    for (int n = 0; n < LED_STRIP_PARALLEL_MAX_STRIPS; n++) {
+        for (size_t i = 0; i < sizeof(ctx.colors[n]); i++) {
+            ctx.colors[n][i] = (uint8_t)(i * 7 + n * 31 + (i >> 8));
+        }
+        ctx.lanes[n] = ctx.colors[n];
+    }
+    // the kernel output must match the bit-by-bit one before it is timed
+    ctx.leds = BENCH_MAX_LEDS;
+    static uint8_t expected[sizeof(ctx.out)];
+    encode_ref(&ctx);
+    memcpy(expected, ctx.out, sizeof(expected));
+    encode_kernel(&ctx);
+    HOST_CHECK(memcmp(expected, ctx.out, sizeof(expected)) == 0);
+
+    printf("%-6s %-18s %10s %9s %10s\n", "strips", "case", "us/frame", "speedup", "of wire");
+    for (size_t i = 0; i < sizeof(bench_led_counts) / sizeof(bench_led_counts[0]); i++) {
+        bench_layout(&ctx, bench_led_counts[i], frames, rounds);
+    }
+    return host_test_finish("bench_led_strip_parallel_kernel");
+}
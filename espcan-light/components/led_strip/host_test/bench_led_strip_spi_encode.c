@@ -0,0 +1,251 @@
+// SPI backend encoding: the bytes sent on MOSI must match the original bit-by-bit encoder exactly,
+// in both the pre-encoded and the chunked mode and for every color byte value.
+// Then the cost of encoding a frame with the original encoder and with the pattern table is compared.
+#include <stdio.h>
+#include <string.h>
+#include "host_test.h"
+#include "host_idf.h"
+#include "led_strip.h"
+
+#define BENCH_FRAMES 2000
+#define BENCH_ROUNDS 5
+#define BENCH_QUICK_FRAMES 20
+#define BENCH_MAX_LEDS 1800
+#define SPI_BYTES_PER_COLOR_BYTE 3
+
+static const uint32_t bench_led_counts[] = {900, 1800};
+
+// the encoder the SPI backend used before the pattern table, the buf must be zero-initialized
+static void ref_spi_bit(uint8_t data, uint8_t *buf)
+{
+    *(buf + 2) |= data & BIT(0) ? BIT(2) | BIT(1) : BIT(2);
+    *(buf + 2) |= data & BIT(1) ? BIT(5) | BIT(4) : BIT(5);
+    *(buf + 2) |= data & BIT(2) ? BIT(7) : 0x00;
+    *(buf + 1) |= BIT(0);
+    *(buf + 1) |= data & BIT(3) ? BIT(3) | BIT(2) : BIT(3);
+    *(buf + 1) |= data & BIT(4) ? BIT(6) | BIT(5) : BIT(6);
+    *(buf + 0) |= data & BIT(5) ? BIT(1) | BIT(0) : BIT(1);
+    *(buf + 0) |= data & BIT(6) ? BIT(4) | BIT(3) : BIT(4);
+    *(buf + 0) |= data & BIT(7) ? BIT(7) | BIT(6) : BIT(7);
+}
+
+// the original set_pixel body: clear the pixel slot, then encode every component at its wire position
+static void ref_set_pixel(uint8_t *frame, led_color_component_format_t fmt, uint32_t index, const uint8_t *rgbw)
+{
+    uint32_t bytes_per_pixel = fmt.format.num_components;
+    uint8_t *pixel = frame + index * bytes_per_pixel * SPI_BYTES_PER_COLOR_BYTE;
+    memset(pixel, 0, bytes_per_pixel * SPI_BYTES_PER_COLOR_BYTE);
+    ref_spi_bit(rgbw[0], &pixel[SPI_BYTES_PER_COLOR_BYTE * fmt.format.r_pos]);
+    ref_spi_bit(rgbw[1], &pixel[SPI_BYTES_PER_COLOR_BYTE * fmt.format.g_pos]);
+    ref_spi_bit(rgbw[2], &pixel[SPI_BYTES_PER_COLOR_BYTE * fmt.format.b_pos]);
+    if (bytes_per_pixel > 3) {
+        ref_spi_bit(rgbw[3], &pixel[SPI_BYTES_PER_COLOR_BYTE * fmt.format.w_pos]);
+    }
+}
+
+static void ref_encode_frame(uint8_t *frame, led_color_component_format_t fmt, uint32_t leds, const uint8_t *colors)
+{
+    for (uint32_t i = 0; i < leds; i++) {
+        ref_set_pixel(frame, fmt, i, colors + i * fmt.format.num_components);
+    }
+}
+
+typedef struct {
+    const char *name;
+    led_color_component_format_t fmt;
+    uint32_t chunk_leds;
+} spi_case_t;
+
+static const spi_case_t spi_cases[] = {
+    {"GRB", LED_STRIP_COLOR_COMPONENT_FMT_GRB, 0},
+    {"RGB", LED_STRIP_COLOR_COMPONENT_FMT_RGB, 0},  // input already in wire order: whole span converted at once
+    {"GRBW", LED_STRIP_COLOR_COMPONENT_FMT_GRBW, 0},
+    {"GRB chunked", LED_STRIP_COLOR_COMPONENT_FMT_GRB, 64},
+    {"RGB chunked", LED_STRIP_COLOR_COMPONENT_FMT_RGB, 100},
+    {"GRBW chunked", LED_STRIP_COLOR_COMPONENT_FMT_GRBW, 37},
+};
+
+static esp_err_t new_spi_strip(led_color_component_format_t fmt, uint32_t leds, uint32_t chunk_leds, led_strip_handle_t *strip)
+{
+    led_strip_config_t strip_config = {
+        .strip_gpio_num = 18,
+        .max_leds = leds,
+        .led_model = LED_MODEL_WS2812,
+        .color_component_format = fmt,
+    };
+    led_strip_spi_config_t spi_config = {
+        .spi_bus = SPI2_HOST,
+        .chunk_leds = chunk_leds,
+        .flags.with_dma = true,
+    };
+    return led_strip_new_spi_device(&strip_config, &spi_config, strip);
+}
+
+// refresh and compare the MOSI bytes of the frame with the reference encoding
+static void check_frame(led_strip_handle_t strip, const uint8_t *expected, size_t size)
+{
+    spi_device_handle_t dev = host_spi_last_device();
+    size_t sent_size = 0;
+    host_spi_clear_output(dev);
+    HOST_CHECK_EQ(led_strip_refresh(strip), ESP_OK);
+    const uint8_t *sent = host_spi_output(dev, &sent_size);
+    HOST_CHECK_EQ(sent_size, size);
+    HOST_CHECK(sent_size == size && memcmp(sent, expected, size) == 0);
+}
+
+static void test_bit_exact(const spi_case_t *c)
+{
+    enum { LEDS = 300 };
+    static uint8_t colors[LEDS * 4];
+    static uint8_t expected[LEDS * 4 * SPI_BYTES_PER_COLOR_BYTE];
+    uint32_t bpp = c->fmt.format.num_components;
+    size_t frame_size = LEDS * bpp * SPI_BYTES_PER_COLOR_BYTE;
+    led_strip_handle_t strip = NULL;
+    HOST_CHECK_EQ(new_spi_strip(c->fmt, LEDS, c->chunk_leds, &strip), ESP_OK);
+    if (strip == NULL) {
+        return;
+    }
+
+    // every byte value appears in every component position
+    for (uint32_t i = 0; i < LEDS * bpp; i++) {
+        colors[i] = (uint8_t)(i * 7 + i / 256);
+    }
+    HOST_CHECK_EQ(led_strip_set_pixels(strip, 0, LEDS, colors), ESP_OK);
+    ref_encode_frame(expected, c->fmt, LEDS, colors);
+    check_frame(strip, expected, frame_size);
+
+    // single pixels and a partial fill on top of the span
+    const uint8_t pixel[4] = {0x81, 0x7E, 0x00, 0xFF};
+    for (uint32_t i = 0; i < LEDS; i += 13) {
+        if (bpp > 3) {
+            HOST_CHECK_EQ(led_strip_set_pixel_rgbw(strip, i, pixel[0], pixel[1], pixel[2], pixel[3]), ESP_OK);
+            ref_set_pixel(expected, c->fmt, i, pixel);
+        } else {
+            HOST_CHECK_EQ(led_strip_set_pixel(strip, i, pixel[0], pixel[1], pixel[2]), ESP_OK);
+            ref_set_pixel(expected, c->fmt, i, pixel);
+        }
+    }
+    HOST_CHECK_EQ(led_strip_fill(strip, 50, 120, 0x12, 0xA5, 0x5A), ESP_OK);
+    const uint8_t fill[4] = {0x12, 0xA5, 0x5A, 0x00};
+    for (uint32_t i = 50; i < 170; i++) {
+        ref_set_pixel(expected, c->fmt, i, fill);
+    }
+    check_frame(strip, expected, frame_size);
+
+    // clear sends an all-zero frame
+    static const uint8_t zero[4];
+    for (uint32_t i = 0; i < LEDS; i++) {
+        ref_set_pixel(expected, c->fmt, i, zero);
+    }
+    spi_device_handle_t dev = host_spi_last_device();
+    size_t sent_size = 0;
+    host_spi_clear_output(dev);
+    HOST_CHECK_EQ(led_strip_clear(strip), ESP_OK);
+    const uint8_t *sent = host_spi_output(dev, &sent_size);
+    HOST_CHECK(sent_size == frame_size && memcmp(sent, expected, frame_size) == 0);
+
+    HOST_CHECK_EQ(led_strip_del(strip), ESP_OK);
+}
+
+typedef struct {
+    led_strip_handle_t strip;
+    uint32_t leds;
+    uint8_t colors[BENCH_MAX_LEDS * 3];
+    uint8_t frame[BENCH_MAX_LEDS * 3 * SPI_BYTES_PER_COLOR_BYTE];
+} bench_ctx_t;
+
+static void encode_ref(void *arg)
+{
+    bench_ctx_t *ctx = arg;
+    ref_encode_frame(ctx->frame, LED_STRIP_COLOR_COMPONENT_FMT_GRB, ctx->leds, ctx->colors);
+    host_clobber(ctx->frame);
+}
+
+static void encode_set_pixel(void *arg)
+{
+    bench_ctx_t *ctx = arg;
+    for (uint32_t i = 0; i < ctx->leds; i++) {
+        const uint8_t *c = &ctx->colors[i * 3];
+        led_strip_set_pixel(ctx->strip, i, c[0], c[1], c[2]);
+    }
+}
+
+static void encode_set_pixels(void *arg)
+{
+    bench_ctx_t *ctx = arg;
+    led_strip_set_pixels(ctx->strip, 0, ctx->leds, ctx->colors);
+}
+
+// what clear did before the table: zero the buffer, then encode 0 byte by byte
+static void clear_ref(void *arg)
+{
+    bench_ctx_t *ctx = arg;
+    size_t len = ctx->leds * 3;
+    memset(ctx->frame, 0, len * SPI_BYTES_PER_COLOR_BYTE);
+    for (size_t i = 0; i < len; i++) {
+        ref_spi_bit(0, &ctx->frame[i * SPI_BYTES_PER_COLOR_BYTE]);
+    }
+    host_clobber(ctx->frame);
+}
+
+// clear also refreshes, the stand-in SPI completes it without copying
+static void clear_strip(void *arg)
+{
+    bench_ctx_t *ctx = arg;
+    led_strip_clear(ctx->strip);
+}
+
+typedef struct {
+    const char *name;
+    void (*fn)(void *arg);
+} bench_case_t;
+
+static const bench_case_t bench_cases[] = {
+    {"encode original", encode_ref},
+    {"set_pixel (table)", encode_set_pixel},
+    {"set_pixels (table)", encode_set_pixels},
+    {"clear original", clear_ref},
+    {"clear (table)", clear_strip},
+};
+
+static void bench_layout(bench_ctx_t *ctx, uint32_t leds, uint32_t frames, int rounds)
+{
+    ctx->leds = leds;
+    HOST_CHECK_EQ(new_spi_strip(LED_STRIP_COLOR_COMPONENT_FMT_GRB, leds, 0, &ctx->strip), ESP_OK);
+    double ref_ns = 0;
+    for (size_t k = 0; k < sizeof(bench_cases) / sizeof(bench_cases[0]); k++) {
+        double ns = host_bench_run(bench_cases[k].fn, ctx, frames, rounds);
+        // the original encoder is the reference of the cases after it
+        if (bench_cases[k].fn == encode_ref || bench_cases[k].fn == clear_ref) {
+            ref_ns = ns;
+        }
+        printf("%5lu  %-20s %10.1f %9.2f %8.2fx\n", (unsigned long)leds, bench_cases[k].name,
+               ns / 1000, ns / leds, ref_ns / ns);
+    }
+    led_strip_del(ctx->strip);
+}
+
+int main(int argc, char **argv)
+{
+    static bench_ctx_t ctx;
+    bool quick = host_bench_quick(argc, argv);
+    uint32_t frames = quick ? BENCH_QUICK_FRAMES : BENCH_FRAMES;
+    int rounds = quick ? 1 : BENCH_ROUNDS;
+
+    host_spi_set_capture(true);
+    for (size_t i = 0; i < sizeof(spi_cases) / sizeof(spi_cases[0]); i++) {
+        int failures = host_test_failures;
+        test_bit_exact(&spi_cases[i]);
+        printf("bit-exact %-14s %s\n", spi_cases[i].name, host_test_failures == failures ? "ok" : "FAILED");
+    }
+
+    host_spi_set_capture(false);
+    for (uint32_t i = 0; i < sizeof(ctx.colors); i++) {
+        ctx.colors[i] = (uint8_t)(i * 7 + (i >> 8));
+    }
+    printf("%5s  %-20s %10s %9s %9s\n", "leds", "case", "us/frame", "ns/led", "speedup");
+    for (size_t i = 0; i < sizeof(bench_led_counts) / sizeof(bench_led_counts[0]); i++) {
+        bench_layout(&ctx, bench_led_counts[i], frames, rounds);
+    }
+    return host_test_finish("bench_led_strip_spi_encode");
+}
@@ -0,0 +1,170 @@
+// Frame rate of the two 900-LED WS2812 strips of espcan-light, with and without RMT streaming mode.
+// The strips go through the real driver; the RMT stand-in keeps each frame on the line for the time of its
+// encoded symbols (virtual time), queues frames behind each other and calls the trans-done callback when
+// the line gets free.
+//
+// Each frame mirrors the compositor's transmit task: wait until the strip's pixel buffer is free, upload the
+// pixels, then start both strips. The CPU time of the upload (per strip) and of rmt_enable/rmt_disable (each)
+// is not measured on target, so it is swept here. Without streaming the upload and the channel re-arm run
+// after the previous frame has left the line; in streaming mode they overlap with it.
+// Runs uncapped and at the highest effect rate of espcan-light (33 fps).
+#include <stdio.h>
+#include <string.h>
+#include "host_test.h"
+#include "host_idf.h"
+#include "esp_timer.h"
+#include "led_strip.h"
+
+#define SIM_STRIPS 2
+#define SIM_LEDS 900
+#define SIM_QUEUE_DEPTH 2           // LED_STREAM_QUEUE_DEPTH in main.c
+#define SIM_WARMUP_FRAMES 10
+#define SIM_FRAMES 200
+#define SIM_TARGET_FPS 33           // PURPLE_CHASE_FPS / BREATHING_FPS in main.c
+
+typedef struct {
+    const char *name;
+    uint32_t upload_us;             // per strip and frame
+    uint32_t reconfig_us;           // rmt_enable and rmt_disable, each
+} sim_case_t;
+
+static const sim_case_t sim_cases[] = {
+    {"no CPU time", 0, 0},
+    {"upload 300us, re-arm 50us", 300, 50},
+    {"upload 1500us, re-arm 200us", 1500, 200},
+};
+
+typedef struct {
+    double fps;
+    double line_busy;               // share of the time the first strip's line is sending
+    uint32_t wire_frame_us;
+    uint32_t max_gap_us;            // streaming mode only
+} sim_result_t;
+
+static uint8_t s_colors[SIM_LEDS * 3];
+
+static void run(const sim_case_t *sim, bool streaming, uint32_t fps, sim_result_t *result)
+{
+    led_strip_handle_t strips[SIM_STRIPS] = {NULL};
+    rmt_channel_handle_t channels[SIM_STRIPS] = {NULL};
+    led_strip_config_t strip_config = {
+        .max_leds = SIM_LEDS,
+        .color_component_format = LED_STRIP_COLOR_COMPONENT_FMT_GRB,
+        .led_model = LED_MODEL_WS2812,
+        .flags.high_depth = true,
+    };
+    led_strip_rmt_config_t rmt_config = {
+        .clk_src = RMT_CLK_SRC_DEFAULT,
+        .resolution_hz = 10 * 1000 * 1000,
+        .mem_block_symbols = 64,
+        .trans_queue_depth = SIM_QUEUE_DEPTH,
+        .flags.streaming = streaming,
+    };
+
+    memset(result, 0, sizeof(*result));
+    host_timer_use_virtual_time(0);
+    host_rmt_set_wire_time(true, sim->reconfig_us, sim->reconfig_us);
+    for (int i = 0; i < SIM_STRIPS; i++) {
+        strip_config.strip_gpio_num = 18 - i;
+        HOST_CHECK_EQ(led_strip_new_rmt_device(&strip_config, &rmt_config, &strips[i]), ESP_OK);
+        if (strips[i] == NULL) {
+            goto out;
+        }
+        channels[i] = host_rmt_last_channel();
+    }
+
+    int64_t period_us = fps ? 1000000 / fps : 0;
+    int64_t start_us = 0;
+    uint64_t start_wire_us = 0;
+    for (int frame = 0; frame < SIM_WARMUP_FRAMES + SIM_FRAMES; frame++) {
+        if (frame == SIM_WARMUP_FRAMES) {
+            start_us = esp_timer_get_time();
+            start_wire_us = host_rmt_wire_us(channels[0]);
+        }
+        // the render task hands over a new frame every period
+        int64_t due_us = frame * period_us;
+        if (esp_timer_get_time() < due_us) {
+            host_timer_advance(due_us - esp_timer_get_time());
+        }
+        memset(s_colors, frame, sizeof(s_colors));
+        for (int i = 0; i < SIM_STRIPS; i++) {
+            HOST_CHECK_EQ(led_strip_wait_refresh_done(strips[i], -1), ESP_OK);
+            host_timer_advance(sim->upload_us);
+            HOST_CHECK_EQ(led_strip_set_pixels(strips[i], 0, SIM_LEDS, s_colors), ESP_OK);
+        }
+        for (int i = 0; i < SIM_STRIPS; i++) {
+            HOST_CHECK_EQ(led_strip_refresh_async(strips[i]), ESP_OK);
+        }
+    }
+    // the next frame could be handed over now
+    int64_t elapsed_us = esp_timer_get_time() - start_us;
+    uint64_t wire_us = host_rmt_wire_us(channels[0]) - start_wire_us;
+    result->fps = SIM_FRAMES * 1e6 / elapsed_us;
+    result->line_busy = (double)wire_us / elapsed_us;
+    result->wire_frame_us = (uint32_t)(wire_us / SIM_FRAMES);
+
+    for (int i = 0; i < SIM_STRIPS; i++) {
+        if (streaming) {
+            led_strip_rmt_stream_stats_t stats;
+            HOST_CHECK_EQ(led_strip_rmt_get_stream_stats(strips[i], &stats), ESP_OK);
+            HOST_CHECK_EQ(stats.frames_queued, SIM_WARMUP_FRAMES + SIM_FRAMES);
+            HOST_CHECK(stats.max_queue_len <= SIM_QUEUE_DEPTH);
+            if (stats.max_gap_us > result->max_gap_us) {
+                result->max_gap_us = stats.max_gap_us;
+            }
+        }
+        // every queued frame reaches the line
+        HOST_CHECK_EQ(led_strip_refresh(strips[i]), ESP_OK);
+        HOST_CHECK_EQ(host_rmt_frames(channels[i]), SIM_WARMUP_FRAMES + SIM_FRAMES + 1);
+    }
+out:
+    for (int i = 0; i < SIM_STRIPS; i++) {
+        if (strips[i]) {
+            HOST_CHECK_EQ(led_strip_del(strips[i]), ESP_OK);
+        }
+    }
+    host_rmt_set_wire_time(false, 0, 0);
+}
+
+static void sim_rate(uint32_t fps)
+{
+    if (fps) {
+        printf("\n%lu fps target", (unsigned long)fps);
+    } else {
+        printf("\nuncapped");
+    }
+    printf(", %d strips x %d LEDs, queue depth %d\n", SIM_STRIPS, SIM_LEDS, SIM_QUEUE_DEPTH);
+    printf("%-30s %12s %12s %8s %10s %12s\n", "case", "blocking", "streaming", "gain", "line busy", "max gap");
+    for (size_t c = 0; c < sizeof(sim_cases) / sizeof(sim_cases[0]); c++) {
+        const sim_case_t *sim = &sim_cases[c];
+        sim_result_t blocking;
+        sim_result_t streaming;
+        run(sim, false, fps, &blocking);
+        run(sim, true, fps, &streaming);
+        printf("%-30s %8.2f fps %8.2f fps %+7.1f%% %4.1f%%/%4.1f%% %10luus\n", sim->name,
+               blocking.fps, streaming.fps, (streaming.fps / blocking.fps - 1) * 100,
+               blocking.line_busy * 100, streaming.line_busy * 100, (unsigned long)streaming.max_gap_us);
+
+        HOST_CHECK_EQ(blocking.wire_frame_us, streaming.wire_frame_us);
+        if (fps) {
+            // both modes keep up with the effect rate, the gain is headroom only
+            HOST_CHECK(blocking.fps > fps * 0.995 && blocking.fps < fps * 1.005);
+            HOST_CHECK(streaming.fps > fps * 0.995 && streaming.fps < fps * 1.005);
+            continue;
+        }
+        // streaming keeps the line busy back to back, the blocking mode pays the upload and the re-arm every frame
+        HOST_CHECK(streaming.line_busy > 0.995 && streaming.line_busy < 1.005);
+        HOST_CHECK_EQ(streaming.max_gap_us, 0);
+        uint32_t serial_us = 2 * sim->upload_us + 2 * sim->reconfig_us + sim->reconfig_us;
+        double expected_fps = 1e6 / (blocking.wire_frame_us + serial_us);
+        HOST_CHECK(blocking.fps > expected_fps * 0.995 && blocking.fps < expected_fps * 1.005);
+        HOST_CHECK(serial_us == 0 || streaming.fps > blocking.fps);
+    }
+}
+
+int main(void)
+{
+    sim_rate(0);
+    sim_rate(SIM_TARGET_FPS);
+    return host_test_finish("sim_led_strip_stream");
+}
@@ -0,0 +1,120 @@
+// Temporal dithering of 16-bit components: over 256 frames the 8-bit output must add up to the 16-bit value,
+// each frame may only send one of the two 8-bit levels around it, and a monotonic curve must stay monotonic.
+// The same is checked on the bytes an RMT strip in high depth mode hands to the channel.
+#include <stdio.h>
+#include <string.h>
+#include "host_test.h"
+#include "host_idf.h"
+#include "led_strip.h"
+#include "led_strip_dither.h"
+
+#define TEST_PERIOD 256             // frames after which the residual is back to its start value
+#define TEST_LEDS 300
+
+// run `frames` frames of one component, returns the sum of the output, false in `steady` if a frame
+// sent something else than the two 8-bit levels around the value
+static uint32_t dither_sum(uint16_t value, const uint16_t *curve, int frames, bool *steady)
+{
+    uint8_t residual = 0;
+    uint32_t sum = 0;
+    for (int f = 0; f < frames; f++) {
+        uint8_t out;
+        led_strip_dither_encode(&value, &residual, curve, &out, 1);
+        if (!curve && out != value >> 8 && out != (value >> 8) + 1) {
+            *steady = false;
+        }
+        sum += out;
+    }
+    return sum;
+}
+
+static void test_average(void)
+{
+    int errors = 0;
+    bool steady = true;
+    for (uint32_t value = 0; value <= 0xFFFF; value++) {
+        uint32_t sum = dither_sum(value, NULL, TEST_PERIOD, &steady);
+        // above 0xFF00 the output saturates at 255 instead of wrapping
+        uint32_t expected = value <= 0xFF00 ? value : 0xFF00;
+        errors += sum != expected;
+    }
+    HOST_CHECK_EQ(errors, 0);
+    HOST_CHECK(steady);
+}
+
+static void test_curve(void)
+{
+    uint16_t curve[LED_STRIP_DITHER_CURVE_POINTS];
+    for (int i = 0; i < LED_STRIP_DITHER_CURVE_POINTS; i++) {
+        uint32_t x = i * 256 > 0xFFFF ? 0xFFFF : i * 256;
+        curve[i] = (uint16_t)(x * x / 0xFFFF);
+    }
+    bool steady = true;
+    uint32_t previous = 0;
+    int errors = 0;
+    for (uint32_t value = 0; value <= 0xFFFF; value += 7) {
+        uint32_t sum = dither_sum(value, curve, TEST_PERIOD, &steady);
+        errors += sum < previous;
+        previous = sum;
+    }
+    HOST_CHECK_EQ(errors, 0);
+    HOST_CHECK_EQ(dither_sum(0, curve, TEST_PERIOD, &steady), 0);
+    HOST_CHECK_EQ(dither_sum(0xFFFF, curve, TEST_PERIOD, &steady), 0xFF00);
+}
+
+// slow breathing at low brightness: values between two 8-bit levels must still be told apart on the wire
+static void test_rmt_strip(void)
+{
+    static uint16_t colors[TEST_LEDS * 3];
+    static uint32_t sums[TEST_LEDS * 3];
+    led_strip_config_t strip_config = {
+        .strip_gpio_num = 18,
+        .max_leds = TEST_LEDS,
+        .led_model = LED_MODEL_WS2812,
+        .color_component_format = LED_STRIP_COLOR_COMPONENT_FMT_RGB,
+        .flags.high_depth = true,
+    };
+    led_strip_rmt_config_t rmt_config = {0};
+    led_strip_handle_t strip = NULL;
+    HOST_CHECK_EQ(led_strip_new_rmt_device(&strip_config, &rmt_config, &strip), ESP_OK);
+    if (strip == NULL) {
+        return;
+    }
+    rmt_channel_handle_t channel = host_rmt_last_channel();
+
+    // every component a different value below 8-bit level 4, RGB is sent in input order
+    for (size_t i = 0; i < TEST_LEDS * 3; i++) {
+        colors[i] = (uint16_t)(i * 3);
+    }
+    HOST_CHECK_EQ(led_strip_set_pixels_16(strip, 0, TEST_LEDS, colors), ESP_OK);
+    memset(sums, 0, sizeof(sums));
+    int bad_size = 0;
+    for (int f = 0; f < TEST_PERIOD; f++) {
+        size_t size = 0;
+        HOST_CHECK_EQ(led_strip_refresh(strip), ESP_OK);
+        const uint8_t *payload = host_rmt_last_payload(channel, &size);
+        if (size != sizeof(sums) / sizeof(sums[0])) {
+            bad_size++;
+            continue;
+        }
+        for (size_t i = 0; i < size; i++) {
+            sums[i] += payload[i];
+        }
+    }
+    HOST_CHECK_EQ(bad_size, 0);
+    int errors = 0;
+    for (size_t i = 0; i < TEST_LEDS * 3; i++) {
+        errors += sums[i] != colors[i];
+    }
+    HOST_CHECK_EQ(errors, 0);
+    HOST_CHECK_EQ(led_strip_del(strip), ESP_OK);
+}
+
+int main(void)
+{
+    test_average();
+    test_curve();
+    host_rmt_set_capture(true);
+    test_rmt_strip();
+    return host_test_finish("test_led_strip_dither");
+}
@@ -0,0 +1,237 @@
+// Parallel backend: the transposition kernel is compared with a bit-by-bit reference, then the bus bytes
+// of whole frames are split back into the waveform of every GPIO and decoded like a strip would (100 = 0, 110 = 1).
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "host_test.h"
+#include "host_idf.h"
+#include "led_strip.h"
+#include "led_strip_parallel_kernel.h"
+
+#define TEST_LEDS 50
+#define TEST_BYTES_PER_PIXEL 3
+#define TEST_STRIP_BYTES (TEST_LEDS * TEST_BYTES_PER_PIXEL)
+#define TEST_SLOT_NS 400            // one bus byte at 2.5MHz
+#define TEST_RESET_NS 280000        // longest reset time of the supported LEDs
+#define TEST_RANDOM_ROUNDS 100000
+
+// bus bit N goes to data_gpio_nums[N], shuffled so a lane swap can't go unnoticed
+static const int test_gpios[LED_STRIP_PARALLEL_MAX_STRIPS] = {21, 5, 18, 4, 23, 2, 19, 15};
+
+static uint32_t s_rand = 0x2545F491;
+
+static uint8_t next_rand(void)
+{
+    s_rand ^= s_rand << 13;
+    s_rand ^= s_rand >> 17;
+    s_rand ^= s_rand << 5;
+    return (uint8_t)s_rand;
+}
+
+static void ref_transpose8(const uint8_t in[8], uint8_t out[8])
+{
+    for (int n = 0; n < 8; n++) {
+        out[n] = 0;
+        for (int lane = 0; lane < 8; lane++) {
+            out[n] |= ((in[lane] >> (7 - n)) & 1) << lane;
+        }
+    }
+}
+
+static void ref_encode(const uint8_t *const lanes[8], size_t len, const uint8_t *table, uint8_t *out)
+{
+    for (size_t i = 0; i < len; i++) {
+        for (int n = 0; n < 8; n++) {
+            uint8_t high = 0;
+            uint8_t data = 0;
+            for (int lane = 0; lane < 8; lane++) {
+                if (lanes[lane] == NULL) {
+                    continue;
+                }
+                uint8_t value = table ? table[lanes[lane][i]] : lanes[lane][i];
+                high |= 1 << lane;
+                data |= ((value >> (7 - n)) & 1) << lane;
+            }
+            *out++ = high;
+            *out++ = data;
+            *out++ = 0;
+        }
+    }
+}
+
+static void test_transpose8(void)
+{
+    uint8_t in[8];
+    uint8_t out[8];
+    uint8_t expected[8];
+    int errors = 0;
+    // every single bit, then random matrices
+    for (int lane = 0; lane < 8; lane++) {
+        for (int bit = 0; bit < 8; bit++) {
+            memset(in, 0, sizeof(in));
+            in[lane] = 1 << bit;
+            led_strip_parallel_transpose8(in, out);
+            ref_transpose8(in, expected);
+            errors += memcmp(out, expected, sizeof(out)) != 0;
+        }
+    }
+    for (int round = 0; round < TEST_RANDOM_ROUNDS; round++) {
+        for (int lane = 0; lane < 8; lane++) {
+            in[lane] = next_rand();
+        }
+        led_strip_parallel_transpose8(in, out);
+        ref_transpose8(in, expected);
+        errors += memcmp(out, expected, sizeof(out)) != 0;
+    }
+    HOST_CHECK_EQ(errors, 0);
+}
+
+static void test_encode(void)
+{
+    enum { LEN = 97 };
+    static uint8_t data[8][LEN];
+    static uint8_t out[LEN * LED_STRIP_PARALLEL_BYTES_PER_COLOR_BYTE];
+    static uint8_t expected[LEN * LED_STRIP_PARALLEL_BYTES_PER_COLOR_BYTE];
+    uint8_t table[256];
+    for (int i = 0; i < 256; i++) {
+        table[i] = (uint8_t)(i * i / 255);
+    }
+    for (int lane = 0; lane < 8; lane++) {
+        for (int i = 0; i < LEN; i++) {
+            data[lane][i] = next_rand();
+        }
+    }
+
+    // all lanes, some lanes unused, with and without a table
+    static const uint8_t lane_masks[] = {0xFF, 0x01, 0x80, 0x5A, 0x07};
+    for (size_t m = 0; m < sizeof(lane_masks); m++) {
+        const uint8_t *lanes[8] = {0};
+        for (int lane = 0; lane < 8; lane++) {
+            lanes[lane] = lane_masks[m] & (1 << lane) ? data[lane] : NULL;
+        }
+        for (int t = 0; t < 2; t++) {
+            memset(out, 0xEE, sizeof(out));
+            led_strip_parallel_encode(lanes, LEN, t ? table : NULL, out);
+            ref_encode(lanes, LEN, t ? table : NULL, expected);
+            HOST_CHECK(memcmp(out, expected, sizeof(out)) == 0);
+        }
+    }
+}
+
+// bus bit that drives `gpio`
+static int gpio_bit(esp_lcd_panel_io_handle_t io, int gpio)
+{
+    for (int bit = 0; bit < 8; bit++) {
+        if (host_lcd_data_gpio(io, bit) == gpio) {
+            return bit;
+        }
+    }
+    return -1;
+}
+
+// decode the waveform of one bus bit: `len` color bytes, then the line must stay low long enough to latch
+// returns false if a bit is not 100/110 or the line doesn't stay low
+static bool decode_lane(const uint8_t *bus, size_t size, int bit, size_t len, uint8_t *out)
+{
+    size_t slots = len * 8 * LED_STRIP_PARALLEL_SLOTS_PER_BIT;
+    if (size < slots) {
+        return false;
+    }
+    for (size_t i = 0; i < len; i++) {
+        uint8_t value = 0;
+        for (int n = 0; n < 8; n++) {
+            const uint8_t *slot = bus + (i * 8 + n) * LED_STRIP_PARALLEL_SLOTS_PER_BIT;
+            int s0 = (slot[0] >> bit) & 1;
+            int s1 = (slot[1] >> bit) & 1;
+            int s2 = (slot[2] >> bit) & 1;
+            if (s0 != 1 || s2 != 0) {
+                return false;
+            }
+            value = value << 1 | s1;
+        }
+        out[i] = value;
+    }
+    size_t low = 0;
+    for (size_t i = slots; i < size; i++) {
+        if ((bus[i] >> bit) & 1) {
+            return false;
+        }
+        low++;
+    }
+    return low * TEST_SLOT_NS >= TEST_RESET_NS;
+}
+
+static void test_strip_waveform(uint32_t num_strips)
+{
+    static uint8_t colors[LED_STRIP_PARALLEL_MAX_STRIPS * TEST_STRIP_BYTES];
+    static uint8_t decoded[TEST_STRIP_BYTES];
+    led_strip_config_t strip_config = {
+        .max_leds = TEST_LEDS,
+        .led_model = LED_MODEL_WS2812,
+        .color_component_format = LED_STRIP_COLOR_COMPONENT_FMT_GRB,
+    };
+    led_strip_parallel_config_t parallel_config = {
+        .num_strips = num_strips,
+        .wr_gpio_num = 25,
+        .dc_gpio_num = 26,
+    };
+    memcpy(parallel_config.data_gpio_nums, test_gpios, sizeof(test_gpios));
+    led_strip_handle_t strip = NULL;
+    HOST_CHECK_EQ(led_strip_new_parallel_device(&strip_config, &parallel_config, &strip), ESP_OK);
+    if (strip == NULL) {
+        return;
+    }
+    esp_lcd_panel_io_handle_t io = host_lcd_last_io();
+
+    // RGB input, pixel i of strip n at n * TEST_LEDS + i
+    for (size_t i = 0; i < num_strips * TEST_STRIP_BYTES; i++) {
+        colors[i] = next_rand();
+    }
+    HOST_CHECK_EQ(led_strip_set_pixels(strip, 0, num_strips * TEST_LEDS, colors), ESP_OK);
+
+    for (int frame = 0; frame < 2; frame++) {
+        size_t size = 0;
+        uint32_t transactions = host_lcd_transactions(io);
+        host_lcd_clear_output(io);
+        HOST_CHECK_EQ(led_strip_refresh(strip), ESP_OK);
+        // the whole frame and the reset time go in one transaction, there is no gap in between
+        HOST_CHECK_EQ(host_lcd_transactions(io) - transactions, 1);
+        const uint8_t *bus = host_lcd_output(io, &size);
+
+        for (uint32_t n = 0; n < LED_STRIP_PARALLEL_MAX_STRIPS; n++) {
+            int bit = gpio_bit(io, test_gpios[n]);
+            HOST_CHECK(bit >= 0);
+            if (bit < 0) {
+                continue;
+            }
+            if (n >= num_strips) {
+                // unused lanes stay low
+                bool low = true;
+                for (size_t i = 0; i < size; i++) {
+                    low = low && !((bus[i] >> bit) & 1);
+                }
+                HOST_CHECK(low);
+                continue;
+            }
+            HOST_CHECK(decode_lane(bus, size, bit, TEST_STRIP_BYTES, decoded));
+            int errors = 0;
+            for (uint32_t i = 0; i < TEST_LEDS; i++) {
+                const uint8_t *rgb = &colors[(n * TEST_LEDS + i) * 3];
+                errors += decoded[i * 3] != rgb[1] || decoded[i * 3 + 1] != rgb[0] || decoded[i * 3 + 2] != rgb[2];
+            }
+            HOST_CHECK_EQ(errors, 0);
+        }
+    }
+    HOST_CHECK_EQ(led_strip_del(strip), ESP_OK);
+}
+
+int main(void)
+{
+    test_transpose8();
+    test_encode();
+    host_lcd_set_capture(true);
+    test_strip_waveform(LED_STRIP_PARALLEL_MAX_STRIPS);
+    test_strip_waveform(3);
+    test_strip_waveform(1);
+    return host_test_finish("test_led_strip_parallel");
+}
@@ -0,0 +1,188 @@
+// SPI backend in lazy encoding mode: the chunks must reach MOSI in order, and when the line goes idle
+// in the middle of a frame (injected underrun) the frame must be sent again from the first LED.
+// The MOSI bytes are decoded back to color bytes (100 = 0, 110 = 1), independent of the driver's pattern table.
+#include <stdio.h>
+#include <string.h>
+#include "host_test.h"
+#include "host_idf.h"
+#include "led_strip.h"
+
+#define TEST_LEDS 640
+#define TEST_CHUNK_LEDS 64
+#define TEST_BYTES_PER_PIXEL 3
+#define SPI_BYTES_PER_COLOR_BYTE 3
+#define TEST_FRAME_BYTES (TEST_LEDS * TEST_BYTES_PER_PIXEL)
+#define TEST_CHUNK_BYTES (TEST_CHUNK_LEDS * TEST_BYTES_PER_PIXEL)
+
+static uint8_t s_colors[TEST_FRAME_BYTES];   // RGB, as passed to set_pixels
+static uint8_t s_wire[TEST_FRAME_BYTES];     // GRB, as expected on the wire
+static uint8_t s_decoded[4 * TEST_FRAME_BYTES];
+
+// decode the MOSI bytes to color bytes, returns the number of color bytes or -1 if a symbol is not 100/110
+static int decode_output(const uint8_t *mosi, size_t size, uint8_t *out)
+{
+    if (size % SPI_BYTES_PER_COLOR_BYTE) {
+        return -1;
+    }
+    for (size_t i = 0; i < size / SPI_BYTES_PER_COLOR_BYTE; i++) {
+        uint32_t bits = (uint32_t)mosi[i * 3] << 16 | (uint32_t)mosi[i * 3 + 1] << 8 | mosi[i * 3 + 2];
+        uint8_t value = 0;
+        for (int b = 7; b >= 0; b--) {
+            uint32_t symbol = (bits >> (b * 3)) & 0x07;
+            if (symbol != 0x04 && symbol != 0x06) {
+                return -1;
+            }
+            value = value << 1 | (symbol == 0x06);
+        }
+        out[i] = value;
+    }
+    return size / SPI_BYTES_PER_COLOR_BYTE;
+}
+
+static esp_err_t new_chunked_strip(uint32_t leds, led_strip_handle_t *strip)
+{
+    led_strip_config_t strip_config = {
+        .strip_gpio_num = 18,
+        .max_leds = leds,
+        .led_model = LED_MODEL_WS2812,
+        .color_component_format = LED_STRIP_COLOR_COMPONENT_FMT_GRB,
+    };
+    led_strip_spi_config_t spi_config = {
+        .spi_bus = SPI2_HOST,
+        .chunk_leds = TEST_CHUNK_LEDS,
+        .flags.with_dma = true,
+    };
+    return led_strip_new_spi_device(&strip_config, &spi_config, strip);
+}
+
+// refresh once and decode what was sent, returns the number of color bytes
+static int refresh_and_decode(led_strip_handle_t strip)
+{
+    spi_device_handle_t dev = host_spi_last_device();
+    size_t size = 0;
+    host_spi_clear_output(dev);
+    HOST_CHECK_EQ(led_strip_refresh(strip), ESP_OK);
+    const uint8_t *mosi = host_spi_output(dev, &size);
+    HOST_CHECK(size <= sizeof(s_decoded) * SPI_BYTES_PER_COLOR_BYTE);
+    int len = decode_output(mosi, size, s_decoded);
+    HOST_CHECK(len >= 0);
+    return len;
+}
+
+static void check_stats(led_strip_handle_t strip, uint32_t frames, uint32_t underruns, uint32_t restarts)
+{
+    led_strip_spi_chunk_stats_t stats;
+    HOST_CHECK_EQ(led_strip_spi_get_chunk_stats(strip, &stats), ESP_OK);
+    HOST_CHECK_EQ(stats.frames, frames);
+    HOST_CHECK_EQ(stats.underruns, underruns);
+    HOST_CHECK_EQ(stats.restarts, restarts);
+}
+
+// the line went idle after `sent_chunks` chunks: that part latched, then the whole frame follows
+static void check_restarted_frame(int len, uint32_t sent_chunks)
+{
+    size_t partial = sent_chunks * TEST_CHUNK_BYTES;
+    HOST_CHECK_EQ(len, (int)(partial + TEST_FRAME_BYTES));
+    if (len == (int)(partial + TEST_FRAME_BYTES)) {
+        HOST_CHECK(memcmp(s_decoded, s_wire, partial) == 0);
+        HOST_CHECK(memcmp(s_decoded + partial, s_wire, TEST_FRAME_BYTES) == 0);
+    }
+}
+
+static void test_underrun_restart(void)
+{
+    led_strip_handle_t strip = NULL;
+    HOST_CHECK_EQ(new_chunked_strip(TEST_LEDS, &strip), ESP_OK);
+    if (strip == NULL) {
+        return;
+    }
+    spi_device_handle_t dev = host_spi_last_device();
+    HOST_CHECK_EQ(led_strip_set_pixels(strip, 0, TEST_LEDS, s_colors), ESP_OK);
+
+    // no underrun: every chunk once, in order
+    int len = refresh_and_decode(strip);
+    HOST_CHECK_EQ(len, TEST_FRAME_BYTES);
+    HOST_CHECK(len == TEST_FRAME_BYTES && memcmp(s_decoded, s_wire, TEST_FRAME_BYTES) == 0);
+    HOST_CHECK_EQ(host_spi_transactions(dev), TEST_LEDS / TEST_CHUNK_LEDS);
+    check_stats(strip, 1, 0, 0);
+
+    // the task comes back after 5 chunks are sent: the frame starts again
+    host_spi_inject_underrun(dev, 5, 1);
+    check_restarted_frame(refresh_and_decode(strip), 5);
+    check_stats(strip, 2, 1, 1);
+
+    // the first two chunks are queued together, the underrun is found before the third one
+    host_spi_inject_underrun(dev, 2, 1);
+    check_restarted_frame(refresh_and_decode(strip), 2);
+    check_stats(strip, 3, 2, 2);
+
+    // underrun again in the restarted frame: it is finished as is, only one restart per refresh
+    host_spi_inject_underrun(dev, 5, 2);
+    check_restarted_frame(refresh_and_decode(strip), 5);
+    check_stats(strip, 4, 4, 3);
+
+    // back to normal
+    len = refresh_and_decode(strip);
+    HOST_CHECK(len == TEST_FRAME_BYTES && memcmp(s_decoded, s_wire, TEST_FRAME_BYTES) == 0);
+    check_stats(strip, 5, 4, 3);
+
+    HOST_CHECK_EQ(led_strip_del(strip), ESP_OK);
+}
+
+// a strip of at most two chunks is queued at once, there is no point where the line could idle
+static void test_short_strip(void)
+{
+    enum { LEDS = TEST_CHUNK_LEDS + 10 };
+    led_strip_handle_t strip = NULL;
+    HOST_CHECK_EQ(new_chunked_strip(LEDS, &strip), ESP_OK);
+    if (strip == NULL) {
+        return;
+    }
+    HOST_CHECK_EQ(led_strip_set_pixels(strip, 0, LEDS, s_colors), ESP_OK);
+    host_spi_inject_underrun(host_spi_last_device(), 0, 1);
+    int len = refresh_and_decode(strip);
+    HOST_CHECK(len == LEDS * TEST_BYTES_PER_PIXEL && memcmp(s_decoded, s_wire, LEDS * TEST_BYTES_PER_PIXEL) == 0);
+    check_stats(strip, 1, 0, 0);
+    HOST_CHECK_EQ(led_strip_del(strip), ESP_OK);
+}
+
+static void test_stats_args(void)
+{
+    led_strip_spi_chunk_stats_t stats;
+    led_strip_handle_t strip = NULL;
+    led_strip_config_t strip_config = {
+        .strip_gpio_num = 18,
+        .max_leds = 16,
+        .led_model = LED_MODEL_WS2812,
+    };
+    led_strip_spi_config_t spi_config = {
+        .spi_bus = SPI2_HOST,
+    };
+    HOST_CHECK_EQ(led_strip_new_spi_device(&strip_config, &spi_config, &strip), ESP_OK);
+    if (strip == NULL) {
+        return;
+    }
+    // the whole strip is kept encoded, there are no chunks
+    HOST_CHECK_EQ(led_strip_spi_get_chunk_stats(strip, &stats), ESP_ERR_INVALID_STATE);
+    HOST_CHECK_EQ(led_strip_spi_get_chunk_stats(strip, NULL), ESP_ERR_INVALID_ARG);
+    HOST_CHECK_EQ(led_strip_del(strip), ESP_OK);
+}
+
+int main(void)
+{
+    for (uint32_t i = 0; i < TEST_LEDS; i++) {
+        uint8_t *rgb = &s_colors[i * 3];
+        rgb[0] = (uint8_t)(i * 7);
+        rgb[1] = (uint8_t)(i * 13 + 1);
+        rgb[2] = (uint8_t)(255 - i);
+        s_wire[i * 3 + 0] = rgb[1];
+        s_wire[i * 3 + 1] = rgb[0];
+        s_wire[i * 3 + 2] = rgb[2];
+    }
+
+    host_spi_set_capture(true);
+    test_underrun_restart();
+    test_short_strip();
+    test_stats_args();
+    return host_test_finish("test_led_strip_spi_chunks");
+}
@@ -9,6 +9,7 @@
 #include "esp_err.h"
 #include "led_strip_rmt.h"
 #include "led_strip_spi.h"
+#include "led_strip_parallel.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -50,6 +51,57 @@ esp_err_t led_strip_set_pixel(led_strip_handle_t strip, uint32_t index, uint32_t
  */
 esp_err_t led_strip_set_pixel_rgbw(led_strip_handle_t strip, uint32_t index, uint32_t red, uint32_t green, uint32_t blue, uint32_t white);
 
+/**
+ * @brief Set colors for a contiguous range of pixels
+ *
+ * @note Much cheaper than calling `led_strip_set_pixel` for every pixel, the range is checked only once
+ *
+ * @param strip: LED strip
+ * @param start: index of the first pixel to set
+ * @param count: number of pixels to set
+ * @param colors: packed colors in R,G,B order (R,G,B,W for strips with a white component), one entry per pixel
+ *
+ * @return
+ *      - ESP_OK: Set pixels successfully
+ *      - ESP_ERR_INVALID_ARG: Set pixels failed because of invalid parameters
+ *      - ESP_FAIL: Set pixels failed because other error occurred
+ */
+esp_err_t led_strip_set_pixels(led_strip_handle_t strip, uint32_t start, uint32_t count, const uint8_t *colors);
+
+/**
+ * @brief Set the same RGB color for a contiguous range of pixels
+ *
+ * @note The white component (if any) is cleared, same as `led_strip_set_pixel`
+ *
+ * @param strip: LED strip
+ * @param start: index of the first pixel to set
+ * @param count: number of pixels to set
+ * @param red: red part of color
+ * @param green: green part of color
+ * @param blue: blue part of color
+ *
+ * @return
+ *      - ESP_OK: Fill pixels successfully
+ *      - ESP_ERR_INVALID_ARG: Fill pixels failed because of invalid parameters
+ *      - ESP_FAIL: Fill pixels failed because other error occurred
+ */
+esp_err_t led_strip_fill(led_strip_handle_t strip, uint32_t start, uint32_t count, uint32_t red, uint32_t green, uint32_t blue);
+
+/**
+ * @brief Copy all pixels of another strip into this strip
+ *
+ * @note Both strips must be created by the same backend (RMT or SPI), with the same length and color component format
+ *
+ * @param strip: LED strip to write
+ * @param src: LED strip to copy from
+ *
+ * @return
+ *      - ESP_OK: Mirror pixels successfully
+ *      - ESP_ERR_INVALID_ARG: Mirror pixels failed because the strips are not compatible
+ *      - ESP_FAIL: Mirror pixels failed because other error occurred
+ */
+esp_err_t led_strip_mirror(led_strip_handle_t strip, led_strip_handle_t src);
+
 /**
  * @brief Set HSV for a specific pixel
  *
@@ -80,6 +132,142 @@ esp_err_t led_strip_set_pixel_hsv(led_strip_handle_t strip, uint32_t index, uint
  */
 esp_err_t led_strip_refresh(led_strip_handle_t strip);
 
+/**
+ * @brief Start flushing memory colors to LEDs, return without waiting for the transfer to finish
+ *
+ * @note Several strips can be refreshed in parallel by calling this function for each of them,
+ *       followed by `led_strip_wait_refresh_done`
+ * @note Don't modify the pixels of the strip until `led_strip_wait_refresh_done` returns ESP_OK
+ * @note With the SPI backend and `chunk_leds` set, the chunks are encoded while the ones before them are on the wire,
+ *       so this function only returns once the last chunk is queued, which blocks for nearly the whole frame.
+ *       When refreshing several strips in parallel, start such a strip after the others
+ *
+ * @param strip: LED strip
+ *
+ * @return
+ *      - ESP_OK: Refresh started successfully
+ *      - ESP_FAIL: Refresh failed because some other error occurred
+ */
+esp_err_t led_strip_refresh_async(led_strip_handle_t strip);
+
+/**
+ * @brief Wait for the refresh started by `led_strip_refresh_async` to finish
+ *
+ * @param strip: LED strip
+ * @param timeout_ms: timeout value for waiting, -1 means wait forever
+ *
+ * @return
+ *      - ESP_OK: Refresh finished (or no refresh was in progress)
+ *      - ESP_ERR_TIMEOUT: Refresh is still in progress after timeout
+ *      - ESP_FAIL: Wait failed because some other error occurred
+ */
+esp_err_t led_strip_wait_refresh_done(led_strip_handle_t strip, int32_t timeout_ms);
+
+/**
+ * @brief Set the global brightness of LED strip
+ *
+ * @note The brightness is applied together with the gamma through a 256-entry table when the pixels are encoded,
+ *       the pixel buffer keeps the full-brightness colors. The table is only rebuilt when the value changes.
+ * @note The SPI backend supports it only with `chunk_leds` set, as it otherwise encodes the pixels when they are written
+ *
+ * @param strip: LED strip
+ * @param brightness: brightness, 255 means full brightness
+ *
+ * @return
+ *      - ESP_OK: Set brightness successfully
+ *      - ESP_ERR_INVALID_ARG: Set brightness failed because of invalid argument
+ *      - ESP_ERR_NOT_SUPPORTED: Set brightness failed because the backend can't apply it at encode time
+ */
+esp_err_t led_strip_set_brightness(led_strip_handle_t strip, uint8_t brightness);
+
+/**
+ * @brief Set the gamma correction of LED strip
+ *
+ * @note Applied through the same table as `led_strip_set_brightness`
+ *
+ * @param strip: LED strip
+ * @param gamma: gamma exponent, 1.0 means linear (no correction), 2.2~2.8 is typical for WS2812
+ *
+ * @return
+ *      - ESP_OK: Set gamma successfully
+ *      - ESP_ERR_INVALID_ARG: Set gamma failed because of invalid argument
+ *      - ESP_ERR_NOT_SUPPORTED: Set gamma failed because the backend can't apply it at encode time
+ */
+esp_err_t led_strip_set_gamma(led_strip_handle_t strip, float gamma);
+
+/**
+ * @brief Set 16-bit colors for a contiguous range of pixels
+ *
+ * @note Only available when the strip is created with `flags.high_depth`. The colors are dithered down to 8 bits
+ *       every refresh, so keep refreshing the strip (e.g. at a fixed frame rate) even when the colors don't change
+ * @note The 8-bit pixel APIs can still be used on such strips, their values are expanded to 16 bits
+ *
+ * @param strip: LED strip
+ * @param start: index of the first pixel to set
+ * @param count: number of pixels to set
+ * @param colors: packed 16-bit colors in R,G,B order (R,G,B,W for strips with a white component), one entry per pixel
+ *
+ * @return
+ *      - ESP_OK: Set pixels successfully
+ *      - ESP_ERR_INVALID_ARG: Set pixels failed because of invalid parameters
+ *      - ESP_ERR_NOT_SUPPORTED: Set pixels failed because the strip is not in high depth mode
+ */
+esp_err_t led_strip_set_pixels_16(led_strip_handle_t strip, uint32_t start, uint32_t count, const uint16_t *colors);
+
+/**
+ * @brief Set the same 16-bit RGB color for a contiguous range of pixels
+ *
+ * @note Only available when the strip is created with `flags.high_depth`, see `led_strip_set_pixels_16`
+ * @note The white component (if any) is cleared, same as `led_strip_fill`
+ *
+ * @param strip: LED strip
+ * @param start: index of the first pixel to set
+ * @param count: number of pixels to set
+ * @param red: red part of color
+ * @param green: green part of color
+ * @param blue: blue part of color
+ *
+ * @return
+ *      - ESP_OK: Fill pixels successfully
+ *      - ESP_ERR_INVALID_ARG: Fill pixels failed because of invalid parameters
+ *      - ESP_ERR_NOT_SUPPORTED: Fill pixels failed because the strip is not in high depth mode
+ */
+esp_err_t led_strip_fill_16(led_strip_handle_t strip, uint32_t start, uint32_t count, uint16_t red, uint16_t green, uint16_t blue);
+
+/**
+ * @brief Set the power budget of LED strip
+ *
+ * @note The sum of the color components is tracked as the pixels are written, so estimating a frame doesn't need
+ *       an extra pass over the pixel buffer. When the estimate of a frame exceeds the budget, one uniform scale is folded
+ *       into the color table at refresh time, the pixel buffer keeps the requested colors.
+ * @note The estimate is linear in the component values, which makes it an upper bound when a gamma above 1.0 is set
+ * @note The SPI backend supports it only with `chunk_leds` set, see `led_strip_set_brightness`
+ *
+ * @param strip: LED strip
+ * @param config: power budget configuration, takes effect from the next refresh
+ *
+ * @return
+ *      - ESP_OK: Set power budget successfully
+ *      - ESP_ERR_INVALID_ARG: Set power budget failed because of invalid argument
+ *      - ESP_ERR_NOT_SUPPORTED: Set power budget failed because the backend doesn't track the pixel sum
+ */
+esp_err_t led_strip_set_power_limit(led_strip_handle_t strip, const led_strip_power_config_t *config);
+
+/**
+ * @brief Get the estimated current draw of the last refreshed frame
+ *
+ * @note The estimate is made even when no budget is set, using the default per-component current if none is configured
+ *
+ * @param strip: LED strip
+ * @param[out] ret_stats: power telemetry
+ *
+ * @return
+ *      - ESP_OK: Get power stats successfully
+ *      - ESP_ERR_INVALID_ARG: Get power stats failed because of invalid argument
+ *      - ESP_ERR_NOT_SUPPORTED: Get power stats failed because the backend doesn't track the pixel sum
+ */
+esp_err_t led_strip_get_power_stats(led_strip_handle_t strip, led_strip_power_stats_t *ret_stats);
+
 /**
  * @brief Clear LED strip (turn off all LEDs)
  *
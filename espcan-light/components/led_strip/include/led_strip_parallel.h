@@ -0,0 +1,52 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "led_strip_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LED_STRIP_PARALLEL_MAX_STRIPS 8 /*!< Number of strips one parallel bus can drive */
+
+/**
+ * @brief LED Strip parallel (I80 bus) specific configuration
+ */
+typedef struct {
+    int data_gpio_nums[LED_STRIP_PARALLEL_MAX_STRIPS]; /*!< GPIO of each strip. The bus is always 8 bits wide, so unused lanes still need a GPIO, they are kept low */
+    uint32_t num_strips;        /*!< Number of strips connected to the bus: 1~8 */
+    int wr_gpio_num;            /*!< GPIO of the bus write clock, required by the peripheral but not connected to the strips */
+    int dc_gpio_num;            /*!< GPIO of the bus data/command line, required by the peripheral but not connected to the strips */
+} led_strip_parallel_config_t;
+
+/**
+ * @brief Create LED strips driven together by one parallel I80 bus
+ *
+ * @note The returned handle covers all strips: `max_leds` in `led_config` is the length of each strip,
+ *       and pixel `index` of strip `n` is addressed as `n * max_leds + index`
+ * @note The raw pixels are transposed into the bus waveform of the whole frame at refresh time, and sent with the reset time
+ *       in a single DMA transaction, so the lines never idle in the middle of a frame.
+ *       The waveform takes `max_leds * bytes_per_pixel * 24 + 750` bytes of internal DMA memory whatever the number of strips,
+ *       e.g. 65550 bytes for 900 GRB LEDs per strip.
+ *
+ * @param led_config LED strip configuration, shared by all strips
+ * @param parallel_config Parallel bus specific configuration
+ * @param ret_strip Returned LED strip handle
+ * @return
+ *      - ESP_OK: create LED strip handle successfully
+ *      - ESP_ERR_INVALID_ARG: create LED strip handle failed because of invalid argument
+ *      - ESP_ERR_NOT_SUPPORTED: create LED strip handle failed because of unsupported configuration
+ *      - ESP_ERR_NO_MEM: create LED strip handle failed because of out of memory
+ *      - ESP_FAIL: create LED strip handle failed because some other error
+ */
+esp_err_t led_strip_new_parallel_device(const led_strip_config_t *led_config, const led_strip_parallel_config_t *parallel_config, led_strip_handle_t *ret_strip);
+
+#ifdef __cplusplus
+}
+#endif
@@ -22,12 +22,28 @@ typedef struct {
     rmt_clock_source_t clk_src; /*!< RMT clock source */
     uint32_t resolution_hz;     /*!< RMT tick resolution, if set to zero, a default resolution (10MHz) will be applied */
     size_t mem_block_symbols;   /*!< How many RMT symbols can one RMT channel hold at one time. Set to 0 will fallback to use the default size. */
+    size_t trans_queue_depth;   /*!< How many frames can be queued in the RMT driver. Set to 0 will fallback to use the default depth (4).
+                                     In streaming mode, each queued frame takes its own copy of the pixel buffer */
     /*!< Extra RMT specific driver flags */
     struct led_strip_rmt_extra_config {
         uint32_t with_dma: 1;   /*!< Use DMA to transmit data */
+        uint32_t streaming: 1;  /*!< Keep the RMT channel enabled and queue frames back to back.
+                                     The pixels are copied at `led_strip_refresh_async`, so they can be modified right after it returns */
     } flags;                    /*!< Extra driver flags */
 } led_strip_rmt_config_t;
 
+/**
+ * @brief Statistics of an RMT strip in streaming mode
+ */
+typedef struct {
+    uint32_t frames_queued;     /*!< Frames handed to the RMT driver */
+    uint32_t frames_done;       /*!< Frames fully transmitted */
+    uint32_t queue_len;         /*!< Frames waiting or being transmitted at the moment */
+    uint32_t max_queue_len;     /*!< Peak of `queue_len` since the last read */
+    uint32_t last_gap_us;       /*!< Idle time of the line before the latest frame, 0 if it was queued behind another frame */
+    uint32_t max_gap_us;        /*!< Peak of `last_gap_us` since the last read */
+} led_strip_rmt_stream_stats_t;
+
 /**
  * @brief Create LED strip based on RMT TX channel
  *
@@ -42,6 +58,20 @@ typedef struct {
  */
 esp_err_t led_strip_new_rmt_device(const led_strip_config_t *led_config, const led_strip_rmt_config_t *rmt_config, led_strip_handle_t *ret_strip);
 
+/**
+ * @brief Get the queue statistics of an RMT strip in streaming mode
+ *
+ * @note The peak values are reset after reading
+ *
+ * @param strip LED strip created by `led_strip_new_rmt_device` with `flags.streaming` set
+ * @param ret_stats Returned statistics
+ * @return
+ *      - ESP_OK: get statistics successfully
+ *      - ESP_ERR_INVALID_ARG: get statistics failed because of invalid argument
+ *      - ESP_ERR_INVALID_STATE: get statistics failed because the strip is not in streaming mode
+ */
+esp_err_t led_strip_rmt_get_stream_stats(led_strip_handle_t strip, led_strip_rmt_stream_stats_t *ret_stats);
+
 #ifdef __cplusplus
 }
 #endif
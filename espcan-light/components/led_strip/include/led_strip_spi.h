@@ -20,15 +20,36 @@ extern "C" {
 typedef struct {
     spi_clock_source_t clk_src; /*!< SPI clock source */
     spi_host_device_t spi_bus;  /*!< SPI bus ID. Which buses are available depends on the specific chip */
+    uint32_t chunk_leds;        /*!< Number of LEDs encoded per transaction at refresh time. If set to 0, the whole strip is kept encoded in memory.
+                                     Otherwise only the raw pixels are kept, and the SPI waveform is encoded into three DMA chunks of this size while transmitting */
     struct {
         uint32_t with_dma: 1;   /*!< Use DMA to transmit data */
     } flags;                    /*!< Extra driver flags */
 } led_strip_spi_config_t;
 
+/**
+ * @brief Statistics of an SPI strip in lazy encoding mode
+ */
+typedef struct {
+    uint32_t frames;            /*!< Frames refreshed */
+    uint32_t underruns;         /*!< Times all queued chunks were done before the next one was queued, the line was idle in the middle of a frame */
+    uint32_t restarts;          /*!< Frames sent again from the start after an underrun, at most one per refresh */
+} led_strip_spi_chunk_stats_t;
+
 /**
  * @brief Create LED strip based on SPI MOSI channel
  *
  * @note Although only the MOSI line is used for generating the signal, the whole SPI bus can't be used for other purposes.
+ * @note With `chunk_leds` set, the chunks are sent as separate transactions, and the line stays low if one isn't queued in time.
+ *       A chunk takes `chunk_leds * bytes_per_pixel * 9.6us` on the wire (28.8us per GRB LED). While one is encoded, one is on the wire
+ *       and another one is queued behind it, so the refresh task can be kept off the CPU for about one chunk time before
+ *       the line idles. `led_strip_refresh_async` returns once the last chunk is queued. The LEDs take an idle line of 50-280us (depending on the model) as a reset and latch a partial frame,
+ *       so the driver sends the frame again from the start when it finds the line idle, see `led_strip_spi_get_chunk_stats`.
+ *       Pick `chunk_leds` so that one chunk time covers the longest time the refresh task can be preempted:
+ *       `chunk_leds >= max_latency_us / (bytes_per_pixel * 9.6)`. E.g. with the task above the other busy tasks of its core,
+ *       only interrupts delay it and 32 GRB LEDs (0.9ms per chunk, 864 bytes of DMA memory for the three chunks) leave a wide margin. Sharing the core with
+ *       a busy task of the same priority means waiting one tick (10ms at 100Hz) and needs about 350 GRB LEDs per chunk,
+ *       at which point keeping the whole strip encoded (`chunk_leds` = 0) costs less memory for strips up to about 1500 LEDs.
  *
  * @param led_config LED strip configuration
  * @param spi_config SPI specific configuration
@@ -42,6 +63,18 @@ typedef struct {
  */
 esp_err_t led_strip_new_spi_device(const led_strip_config_t *led_config, const led_strip_spi_config_t *spi_config, led_strip_handle_t *ret_strip);
 
+/**
+ * @brief Get the chunk statistics of an SPI strip in lazy encoding mode
+ *
+ * @param strip LED strip created by `led_strip_new_spi_device` with `chunk_leds` set
+ * @param ret_stats Returned statistics
+ * @return
+ *      - ESP_OK: get statistics successfully
+ *      - ESP_ERR_INVALID_ARG: get statistics failed because of invalid argument
+ *      - ESP_ERR_INVALID_STATE: get statistics failed because the strip is not in lazy encoding mode
+ */
+esp_err_t led_strip_spi_get_chunk_stats(led_strip_handle_t strip, led_strip_spi_chunk_stats_t *ret_stats);
+
 #ifdef __cplusplus
 }
 #endif
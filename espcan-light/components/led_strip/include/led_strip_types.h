@@ -62,9 +62,30 @@ typedef struct {
     /*!< LED strip extra driver flags */
     struct led_strip_extra_flags {
         uint32_t invert_out: 1; /*!< Invert output signal */
+        uint32_t high_depth: 1; /*!< Keep 16 bits per color component and dither them down to 8 bits while encoding.
+                                     The strip needs to be refreshed continuously for the dithering to average out */
     } flags; /*!< Extra driver flags */
 } led_strip_config_t;
 
+/**
+ * @brief LED strip power budget configuration
+ */
+typedef struct {
+    uint32_t budget_ma;  /*!< Current budget of the strip in mA, frames estimated above it are scaled down uniformly. 0 means no limit */
+    uint32_t channel_ma; /*!< Current drawn by one color component at full scale in mA. If set to 0, it will fallback to 12mA (WS2812) */
+    uint32_t idle_ma;    /*!< Current drawn by the whole strip with all LEDs off in mA */
+} led_strip_power_config_t;
+
+/**
+ * @brief LED strip power telemetry
+ */
+typedef struct {
+    uint32_t estimated_ma;   /*!< Estimated current of the last refreshed frame before limiting, in mA */
+    uint32_t output_ma;      /*!< Estimated current of the last refreshed frame after limiting, in mA */
+    uint8_t scale;           /*!< Scale applied to the last refreshed frame, 255 means not limited */
+    uint32_t limited_frames; /*!< Number of frames that have been scaled down since the strip was created */
+} led_strip_power_stats_t;
+
 #ifdef __cplusplus
 }
 #endif
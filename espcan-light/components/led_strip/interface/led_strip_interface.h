@@ -13,6 +13,8 @@ extern "C" {
 #endif
 
 typedef struct led_strip_t led_strip_t; /*!< Type of LED strip */
+typedef struct led_strip_color_lut_t led_strip_color_lut_t; /*!< Type of the per-strip color table, see `led_strip_set_brightness` */
+typedef struct led_strip_power_t led_strip_power_t; /*!< Type of the per-strip power model, see `led_strip_set_power_limit` */
 
 /**
  * @brief LED strip interface definition
@@ -51,6 +53,51 @@ struct led_strip_t {
      */
     esp_err_t (*set_pixel_rgbw)(led_strip_t *strip, uint32_t index, uint32_t red, uint32_t green, uint32_t blue, uint32_t white);
 
+    /**
+     * @brief Set colors for a contiguous range of pixels
+     *
+     * @param strip: LED strip
+     * @param start: index of the first pixel to set
+     * @param count: number of pixels to set
+     * @param colors: packed colors in R,G,B order (R,G,B,W for strips with a white component), one entry per pixel
+     *
+     * @return
+     *      - ESP_OK: Set pixels successfully
+     *      - ESP_ERR_INVALID_ARG: Set pixels failed because of invalid parameters
+     *      - ESP_FAIL: Set pixels failed because other error occurred
+     */
+    esp_err_t (*set_pixels)(led_strip_t *strip, uint32_t start, uint32_t count, const uint8_t *colors);
+
+    /**
+     * @brief Set the same RGB color for a contiguous range of pixels, the white component (if any) is cleared
+     *
+     * @param strip: LED strip
+     * @param start: index of the first pixel to set
+     * @param count: number of pixels to set
+     * @param red: red part of color
+     * @param green: green part of color
+     * @param blue: blue part of color
+     *
+     * @return
+     *      - ESP_OK: Fill pixels successfully
+     *      - ESP_ERR_INVALID_ARG: Fill pixels failed because of invalid parameters
+     *      - ESP_FAIL: Fill pixels failed because other error occurred
+     */
+    esp_err_t (*fill)(led_strip_t *strip, uint32_t start, uint32_t count, uint32_t red, uint32_t green, uint32_t blue);
+
+    /**
+     * @brief Copy all pixels of another strip into this strip
+     *
+     * @param strip: LED strip to write
+     * @param src: LED strip to copy from, must use the same backend, length and color component format
+     *
+     * @return
+     *      - ESP_OK: Mirror pixels successfully
+     *      - ESP_ERR_INVALID_ARG: Mirror pixels failed because the strips are not compatible
+     *      - ESP_FAIL: Mirror pixels failed because other error occurred
+     */
+    esp_err_t (*mirror)(led_strip_t *strip, const led_strip_t *src);
+
     /**
      * @brief Refresh memory colors to LEDs
      *
@@ -66,6 +113,33 @@ struct led_strip_t {
      */
     esp_err_t (*refresh)(led_strip_t *strip);
 
+    /**
+     * @brief Start flushing memory colors to LEDs without waiting for the transfer to finish
+     *
+     * @param strip: LED strip
+     *
+     * @return
+     *      - ESP_OK: Refresh started successfully
+     *      - ESP_FAIL: Refresh failed because some other error occurred
+     *
+     * @note:
+     *      The pixel buffer is still being read by the hardware, don't modify pixels before `wait_refresh_done` returns.
+     */
+    esp_err_t (*refresh_async)(led_strip_t *strip);
+
+    /**
+     * @brief Wait for the refresh started by `refresh_async` to finish
+     *
+     * @param strip: LED strip
+     * @param timeout_ms: timeout value for waiting, -1 means wait forever
+     *
+     * @return
+     *      - ESP_OK: Refresh finished (or no refresh was in progress)
+     *      - ESP_ERR_TIMEOUT: Refresh is still in progress after timeout
+     *      - ESP_FAIL: Wait failed because some other error occurred
+     */
+    esp_err_t (*wait_refresh_done)(led_strip_t *strip, int32_t timeout_ms);
+
     /**
      * @brief Clear LED strip (turn off all LEDs)
      *
@@ -88,6 +162,62 @@ struct led_strip_t {
      *      - ESP_FAIL: Free resources failed because error occurred
      */
     esp_err_t (*del)(led_strip_t *strip);
+
+    /**
+     * @brief Get the color table applied when the pixels are encoded
+     *
+     * @param strip: LED strip
+     *
+     * @return
+     *      - The color table of the strip
+     *      - NULL if the backend can't apply a table at encode time
+     */
+    led_strip_color_lut_t *(*get_color_lut)(led_strip_t *strip);
+
+    /**
+     * @brief Set 16-bit colors for a contiguous range of pixels
+     *
+     * @note Only set by backends when the strip is created with `flags.high_depth`, NULL otherwise
+     *
+     * @param strip: LED strip
+     * @param start: index of the first pixel to set
+     * @param count: number of pixels to set
+     * @param colors: packed 16-bit colors in R,G,B order (R,G,B,W for strips with a white component), one entry per pixel
+     *
+     * @return
+     *      - ESP_OK: Set pixels successfully
+     *      - ESP_ERR_INVALID_ARG: Set pixels failed because of invalid parameters
+     */
+    esp_err_t (*set_pixels16)(led_strip_t *strip, uint32_t start, uint32_t count, const uint16_t *colors);
+
+    /**
+     * @brief Set the same 16-bit RGB color for a contiguous range of pixels, the white component (if any) is cleared
+     *
+     * @note Only set by backends when the strip is created with `flags.high_depth`, NULL otherwise
+     *
+     * @param strip: LED strip
+     * @param start: index of the first pixel to set
+     * @param count: number of pixels to set
+     * @param red: red part of color
+     * @param green: green part of color
+     * @param blue: blue part of color
+     *
+     * @return
+     *      - ESP_OK: Fill pixels successfully
+     *      - ESP_ERR_INVALID_ARG: Fill pixels failed because of invalid parameters
+     */
+    esp_err_t (*fill16)(led_strip_t *strip, uint32_t start, uint32_t count, uint16_t red, uint16_t green, uint16_t blue);
+
+    /**
+     * @brief Get the power model updated while the pixels are written
+     *
+     * @param strip: LED strip
+     *
+     * @return
+     *      - The power model of the strip
+     *      - NULL if the backend doesn't track the pixel values
+     */
+    led_strip_power_t *(*get_power)(led_strip_t *strip);
 };
 
 #ifdef __cplusplus
@@ -7,6 +7,8 @@
 #include "esp_check.h"
 #include "led_strip.h"
 #include "led_strip_interface.h"
+#include "led_strip_color_lut.h"
+#include "led_strip_power.h"
 
 static const char *TAG = "led_strip";
 
@@ -75,12 +77,99 @@ esp_err_t led_strip_set_pixel_rgbw(led_strip_handle_t strip, uint32_t index, uin
     return strip->set_pixel_rgbw(strip, index, red, green, blue, white);
 }
 
+esp_err_t led_strip_set_pixels(led_strip_handle_t strip, uint32_t start, uint32_t count, const uint8_t *colors)
+{
+    ESP_RETURN_ON_FALSE(strip && colors, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    return strip->set_pixels(strip, start, count, colors);
+}
+
+esp_err_t led_strip_fill(led_strip_handle_t strip, uint32_t start, uint32_t count, uint32_t red, uint32_t green, uint32_t blue)
+{
+    ESP_RETURN_ON_FALSE(strip, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    return strip->fill(strip, start, count, red, green, blue);
+}
+
+esp_err_t led_strip_mirror(led_strip_handle_t strip, led_strip_handle_t src)
+{
+    ESP_RETURN_ON_FALSE(strip && src, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    // pixel buffers can only be copied between strips of the same backend
+    ESP_RETURN_ON_FALSE(strip->mirror == src->mirror, ESP_ERR_INVALID_ARG, TAG, "strips use different backends");
+    return strip->mirror(strip, src);
+}
+
 esp_err_t led_strip_refresh(led_strip_handle_t strip)
 {
     ESP_RETURN_ON_FALSE(strip, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
     return strip->refresh(strip);
 }
 
+esp_err_t led_strip_refresh_async(led_strip_handle_t strip)
+{
+    ESP_RETURN_ON_FALSE(strip, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    return strip->refresh_async(strip);
+}
+
+esp_err_t led_strip_wait_refresh_done(led_strip_handle_t strip, int32_t timeout_ms)
+{
+    ESP_RETURN_ON_FALSE(strip, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    return strip->wait_refresh_done(strip, timeout_ms);
+}
+
+esp_err_t led_strip_set_brightness(led_strip_handle_t strip, uint8_t brightness)
+{
+    ESP_RETURN_ON_FALSE(strip, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    led_strip_color_lut_t *lut = strip->get_color_lut ? strip->get_color_lut(strip) : NULL;
+    ESP_RETURN_ON_FALSE(lut, ESP_ERR_NOT_SUPPORTED, TAG, "backend doesn't support color table");
+    led_strip_color_lut_update(lut, brightness, lut->gamma);
+    return ESP_OK;
+}
+
+esp_err_t led_strip_set_gamma(led_strip_handle_t strip, float gamma)
+{
+    ESP_RETURN_ON_FALSE(strip && gamma > 0, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    led_strip_color_lut_t *lut = strip->get_color_lut ? strip->get_color_lut(strip) : NULL;
+    ESP_RETURN_ON_FALSE(lut, ESP_ERR_NOT_SUPPORTED, TAG, "backend doesn't support color table");
+    led_strip_color_lut_update(lut, lut->brightness, gamma);
+    return ESP_OK;
+}
+
+esp_err_t led_strip_set_pixels_16(led_strip_handle_t strip, uint32_t start, uint32_t count, const uint16_t *colors)
+{
+    ESP_RETURN_ON_FALSE(strip && colors, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(strip->set_pixels16, ESP_ERR_NOT_SUPPORTED, TAG, "strip is not in high depth mode");
+    return strip->set_pixels16(strip, start, count, colors);
+}
+
+esp_err_t led_strip_fill_16(led_strip_handle_t strip, uint32_t start, uint32_t count, uint16_t red, uint16_t green, uint16_t blue)
+{
+    ESP_RETURN_ON_FALSE(strip, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(strip->fill16, ESP_ERR_NOT_SUPPORTED, TAG, "strip is not in high depth mode");
+    return strip->fill16(strip, start, count, red, green, blue);
+}
+
+esp_err_t led_strip_set_power_limit(led_strip_handle_t strip, const led_strip_power_config_t *config)
+{
+    ESP_RETURN_ON_FALSE(strip && config, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    led_strip_power_t *power = strip->get_power ? strip->get_power(strip) : NULL;
+    ESP_RETURN_ON_FALSE(power, ESP_ERR_NOT_SUPPORTED, TAG, "backend doesn't track power");
+    power->budget_ma = config->budget_ma;
+    power->channel_ma = config->channel_ma ? config->channel_ma : LED_STRIP_POWER_DEFAULT_CHANNEL_MA;
+    power->idle_ma = config->idle_ma;
+    return ESP_OK;
+}
+
+esp_err_t led_strip_get_power_stats(led_strip_handle_t strip, led_strip_power_stats_t *ret_stats)
+{
+    ESP_RETURN_ON_FALSE(strip && ret_stats, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    led_strip_power_t *power = strip->get_power ? strip->get_power(strip) : NULL;
+    ESP_RETURN_ON_FALSE(power, ESP_ERR_NOT_SUPPORTED, TAG, "backend doesn't track power");
+    ret_stats->estimated_ma = power->estimated_ma;
+    ret_stats->output_ma = power->output_ma;
+    ret_stats->scale = power->scale;
+    ret_stats->limited_frames = power->limited_frames;
+    return ESP_OK;
+}
+
 esp_err_t led_strip_clear(led_strip_handle_t strip)
 {
     ESP_RETURN_ON_FALSE(strip, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
@@ -0,0 +1,87 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <math.h>
+#include <stdlib.h>
+#include "led_strip_color_lut.h"
+
+void led_strip_color_lut_init(led_strip_color_lut_t *lut)
+{
+    lut->brightness = 255;
+    lut->limit = 255;
+    lut->gamma = 1.0f;
+    lut->identity = true;
+    for (int i = 0; i < 256; i++) {
+        lut->base[i] = i;
+        lut->table[i] = i;
+    }
+}
+
+// scale the cached brightness/gamma tables by the power limiter, rounded down to stay within the budget
+static void led_strip_color_lut_apply_limit(led_strip_color_lut_t *lut)
+{
+    uint32_t limit = lut->limit;
+    lut->identity = limit == 255 && lut->brightness == 255 && lut->gamma == 1.0f;
+
+    for (int i = 0; i < 256; i++) {
+        lut->table[i] = lut->base[i] * limit / 255;
+    }
+    if (lut->curve) {
+        for (int i = 0; i < LED_STRIP_DITHER_CURVE_POINTS; i++) {
+            lut->curve[i] = lut->curve_base[i] * limit / 255;
+        }
+    }
+}
+
+static void led_strip_color_lut_rebuild(led_strip_color_lut_t *lut)
+{
+    uint32_t brightness = lut->brightness;
+    float gamma = lut->gamma;
+
+    for (int i = 0; i < 256; i++) {
+        // gamma first, so the dimmed output keeps the same curve
+        float level = gamma == 1.0f ? i : 255.0f * powf(i / 255.0f, gamma);
+        lut->base[i] = (uint8_t)(level * brightness / 255.0f + 0.5f);
+    }
+    if (lut->curve) {
+        // point i is the output for input i << 8, the last point stands for 0x10000
+        for (int i = 0; i < LED_STRIP_DITHER_CURVE_POINTS; i++) {
+            float level = gamma == 1.0f ? i * 256.0f : 65536.0f * powf(i / 256.0f, gamma);
+            level = level * brightness / 255.0f + 0.5f;
+            lut->curve_base[i] = level > 65535.0f ? 65535 : (uint16_t)level;
+        }
+    }
+    led_strip_color_lut_apply_limit(lut);
+}
+
+bool led_strip_color_lut_alloc_curve(led_strip_color_lut_t *lut)
+{
+    lut->curve = calloc(2 * LED_STRIP_DITHER_CURVE_POINTS, sizeof(uint16_t));
+    if (!lut->curve) {
+        return false;
+    }
+    lut->curve_base = lut->curve + LED_STRIP_DITHER_CURVE_POINTS;
+    led_strip_color_lut_rebuild(lut);
+    return true;
+}
+
+void led_strip_color_lut_update(led_strip_color_lut_t *lut, uint8_t brightness, float gamma)
+{
+    if (brightness == lut->brightness && gamma == lut->gamma) {
+        return;
+    }
+    lut->brightness = brightness;
+    lut->gamma = gamma;
+    led_strip_color_lut_rebuild(lut);
+}
+
+void led_strip_color_lut_set_limit(led_strip_color_lut_t *lut, uint8_t limit)
+{
+    if (limit == lut->limit) {
+        return;
+    }
+    lut->limit = limit;
+    led_strip_color_lut_apply_limit(lut);
+}
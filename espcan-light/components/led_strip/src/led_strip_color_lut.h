@@ -0,0 +1,91 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "led_strip_interface.h"
+#include "led_strip_dither.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Per-strip table applied to every color byte when the pixels are encoded
+ *
+ * Brightness and gamma are baked into `base` (and `curve_base`), which is only rebuilt when either of them changes.
+ * The power limiter may change its scale every frame, so it's applied on top of the cached tables with an integer
+ * multiply per entry.
+ */
+struct led_strip_color_lut_t {
+    uint8_t brightness; /*!< Global brightness, 255 is full brightness */
+    uint8_t limit;      /*!< Extra scale set by the power limiter, 255 if not limited */
+    float gamma;        /*!< Gamma exponent, 1.0 is linear */
+    bool identity;      /*!< Brightness 255, no limit and gamma 1.0, bytes are sent unchanged */
+    uint8_t table[256]; /*!< Output byte for every input byte, brightness, gamma and limit fused */
+    uint8_t base[256];  /*!< Output byte for every input byte, brightness and gamma only */
+    uint16_t *curve;    /*!< Same transform as `table` for 16-bit pixels, `LED_STRIP_DITHER_CURVE_POINTS` points.
+                             Only allocated in high depth mode by `led_strip_color_lut_alloc_curve`, NULL otherwise */
+    uint16_t *curve_base; /*!< Same transform as `base` for 16-bit pixels, allocated in the same block as `curve` */
+};
+
+/**
+ * @brief Initialize the table to full brightness and linear gamma
+ */
+void led_strip_color_lut_init(led_strip_color_lut_t *lut);
+
+/**
+ * @brief Allocate the 16-bit curves used in high depth mode and fill them for the current settings
+ *
+ * @note Both curves live in one allocation, release it with `free(lut->curve)`
+ *
+ * @return true on success, false if out of memory
+ */
+bool led_strip_color_lut_alloc_curve(led_strip_color_lut_t *lut);
+
+/**
+ * @brief Rebuild the tables, does nothing if neither brightness nor gamma changed
+ */
+void led_strip_color_lut_update(led_strip_color_lut_t *lut, uint8_t brightness, float gamma);
+
+/**
+ * @brief Set the scale of the power limiter, applied on top of the brightness. Does nothing if it didn't change
+ *
+ * @note Only rescales the cached tables with integers, cheap enough to be called for every frame
+ */
+void led_strip_color_lut_set_limit(led_strip_color_lut_t *lut, uint8_t limit);
+
+/**
+ * @brief Get the table to apply, NULL if the bytes can be sent unchanged
+ */
+static inline const uint8_t *led_strip_color_lut_table(const led_strip_color_lut_t *lut)
+{
+    return lut->identity ? NULL : lut->table;
+}
+
+/**
+ * @brief Get the 16-bit curve to apply, NULL if the components can be dithered unchanged
+ */
+static inline const uint16_t *led_strip_color_lut_curve(const led_strip_color_lut_t *lut)
+{
+    return lut->identity ? NULL : lut->curve;
+}
+
+/**
+ * @brief Copy `len` color bytes through the table
+ */
+static inline void led_strip_color_lut_map(const uint8_t *table, const uint8_t *src, uint8_t *dst, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        dst[i] = table[src[i]];
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,25 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include "led_strip_dither.h"
+
+void led_strip_dither_encode(const uint16_t *src, uint8_t *residual, const uint16_t *curve, uint8_t *out, size_t len)
+{
+    // one sequential pass over the three arrays, integer only
+    for (size_t i = 0; i < len; i++) {
+        uint32_t value = src[i];
+        if (curve) {
+            // the curve is monotonic, so the interpolation never goes below the lower point
+            uint32_t index = value >> 8;
+            value = curve[index] + (((curve[index + 1] - curve[index]) * (value & 0xFF)) >> 8);
+        }
+        value += residual[i];
+        if (value > 0xFFFF) {
+            value = 0xFFFF;
+        }
+        out[i] = value >> 8;
+        residual[i] = value & 0xFF;
+    }
+}
@@ -0,0 +1,37 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// The kernel only depends on the C library, so it can be built and checked on the host as well
+
+// number of points of the 16-bit brightness/gamma curve, one per high byte plus the end point
+#define LED_STRIP_DITHER_CURVE_POINTS 257
+
+/**
+ * @brief Reduce 16-bit color components to 8 bits with temporal dithering
+ *
+ * The low byte that can't be sent in this frame is carried over to the same component of the next frame,
+ * so over a few frames the average output matches the 16-bit value.
+ *
+ * @param[in] src 16-bit color components in wire order
+ * @param[in,out] residual Fraction carried over from the previous frame, one byte per component, zero-initialized
+ * @param[in] curve Brightness/gamma curve with `LED_STRIP_DITHER_CURVE_POINTS` points, linearly interpolated.
+ *                  NULL to dither the components unchanged
+ * @param[out] out 8-bit color components to send
+ * @param[in] len Number of color components
+ */
+void led_strip_dither_encode(const uint16_t *src, uint8_t *residual, const uint16_t *curve, uint8_t *out, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
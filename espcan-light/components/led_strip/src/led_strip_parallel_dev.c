@@ -0,0 +1,330 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <sys/cdefs.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_heap_caps.h"
+#include "esp_lcd_panel_io.h"
+#include "led_strip.h"
+#include "led_strip_interface.h"
+#include "led_strip_parallel_kernel.h"
+#include "led_strip_color_lut.h"
+
+#define LED_STRIP_PARALLEL_DEFAULT_RESOLUTION (2.5 * 1000 * 1000) // 2.5MHz bus clock, 400ns per slot
+#define LED_STRIP_PARALLEL_TRANS_QUEUE_SIZE 1 // one transaction per frame
+#define LED_STRIP_PARALLEL_RESET_US 300 // keep the lines low after each frame, long enough for the newer WS2812 variants
+
+static const char *TAG = "led_strip_parallel";
+
+typedef struct {
+    led_strip_t base;
+    esp_lcd_i80_bus_handle_t bus;
+    esp_lcd_panel_io_handle_t io;
+    uint32_t strip_len;         // LEDs of each strip
+    uint32_t num_strips;
+    uint8_t bytes_per_pixel;
+    led_color_component_format_t component_fmt;
+    led_strip_color_lut_t color_lut;
+    uint8_t *frame_buf;         // bus waveform of the whole frame, followed by the reset time (kept zero)
+    size_t frame_size;          // bytes of frame_buf, including the reset time
+    uint32_t trans_pending;     // number of queued transactions not yet reported done
+    SemaphoreHandle_t trans_done; // given by the bus ISR once per finished transaction
+    uint8_t pixel_buf[];        // raw pixels in wire order, strip after strip
+} led_strip_parallel_obj;
+
+static bool IRAM_ATTR led_strip_parallel_on_trans_done(esp_lcd_panel_io_handle_t panel_io, esp_lcd_panel_io_event_data_t *edata, void *user_ctx)
+{
+    led_strip_parallel_obj *parallel_strip = (led_strip_parallel_obj *)user_ctx;
+    BaseType_t need_yield = pdFALSE;
+    xSemaphoreGiveFromISR(parallel_strip->trans_done, &need_yield);
+    return need_yield == pdTRUE;
+}
+
+static esp_err_t led_strip_parallel_set_pixel(led_strip_t *strip, uint32_t index, uint32_t red, uint32_t green, uint32_t blue)
+{
+    led_strip_parallel_obj *parallel_strip = __containerof(strip, led_strip_parallel_obj, base);
+    ESP_RETURN_ON_FALSE(index < parallel_strip->strip_len * parallel_strip->num_strips, ESP_ERR_INVALID_ARG, TAG, "index out of maximum number of LEDs");
+
+    led_color_component_format_t component_fmt = parallel_strip->component_fmt;
+    uint32_t start = index * parallel_strip->bytes_per_pixel;
+    uint8_t *pixel_buf = parallel_strip->pixel_buf;
+
+    pixel_buf[start + component_fmt.format.r_pos] = red & 0xFF;
+    pixel_buf[start + component_fmt.format.g_pos] = green & 0xFF;
+    pixel_buf[start + component_fmt.format.b_pos] = blue & 0xFF;
+    if (component_fmt.format.num_components > 3) {
+        pixel_buf[start + component_fmt.format.w_pos] = 0;
+    }
+
+    return ESP_OK;
+}
+
+static esp_err_t led_strip_parallel_set_pixel_rgbw(led_strip_t *strip, uint32_t index, uint32_t red, uint32_t green, uint32_t blue, uint32_t white)
+{
+    led_strip_parallel_obj *parallel_strip = __containerof(strip, led_strip_parallel_obj, base);
+    led_color_component_format_t component_fmt = parallel_strip->component_fmt;
+    ESP_RETURN_ON_FALSE(index < parallel_strip->strip_len * parallel_strip->num_strips, ESP_ERR_INVALID_ARG, TAG, "index out of maximum number of LEDs");
+    ESP_RETURN_ON_FALSE(component_fmt.format.num_components == 4, ESP_ERR_INVALID_ARG, TAG, "led doesn't have 4 components");
+
+    uint32_t start = index * parallel_strip->bytes_per_pixel;
+    uint8_t *pixel_buf = parallel_strip->pixel_buf;
+
+    pixel_buf[start + component_fmt.format.r_pos] = red & 0xFF;
+    pixel_buf[start + component_fmt.format.g_pos] = green & 0xFF;
+    pixel_buf[start + component_fmt.format.b_pos] = blue & 0xFF;
+    pixel_buf[start + component_fmt.format.w_pos] = white & 0xFF;
+
+    return ESP_OK;
+}
+
+static esp_err_t led_strip_parallel_set_pixels(led_strip_t *strip, uint32_t start, uint32_t count, const uint8_t *colors)
+{
+    led_strip_parallel_obj *parallel_strip = __containerof(strip, led_strip_parallel_obj, base);
+    uint32_t total_leds = parallel_strip->strip_len * parallel_strip->num_strips;
+    ESP_RETURN_ON_FALSE(start <= total_leds && count <= total_leds - start, ESP_ERR_INVALID_ARG, TAG,
+                        "pixel range out of maximum number of LEDs");
+
+    led_color_component_format_t component_fmt = parallel_strip->component_fmt;
+    uint8_t bytes_per_pixel = parallel_strip->bytes_per_pixel;
+    uint32_t r_pos = component_fmt.format.r_pos;
+    uint32_t g_pos = component_fmt.format.g_pos;
+    uint32_t b_pos = component_fmt.format.b_pos;
+    uint32_t w_pos = component_fmt.format.w_pos;
+    uint8_t *pixel = parallel_strip->pixel_buf + start * bytes_per_pixel;
+
+    for (uint32_t i = 0; i < count; i++) {
+        pixel[r_pos] = colors[0];
+        pixel[g_pos] = colors[1];
+        pixel[b_pos] = colors[2];
+        if (bytes_per_pixel > 3) {
+            pixel[w_pos] = colors[3];
+        }
+        pixel += bytes_per_pixel;
+        colors += bytes_per_pixel;
+    }
+
+    return ESP_OK;
+}
+
+static esp_err_t led_strip_parallel_fill(led_strip_t *strip, uint32_t start, uint32_t count, uint32_t red, uint32_t green, uint32_t blue)
+{
+    led_strip_parallel_obj *parallel_strip = __containerof(strip, led_strip_parallel_obj, base);
+    uint32_t total_leds = parallel_strip->strip_len * parallel_strip->num_strips;
+    ESP_RETURN_ON_FALSE(start <= total_leds && count <= total_leds - start, ESP_ERR_INVALID_ARG, TAG,
+                        "pixel range out of maximum number of LEDs");
+    if (count == 0) {
+        return ESP_OK;
+    }
+
+    // write the first pixel, then keep doubling the filled part with memcpy
+    ESP_RETURN_ON_ERROR(led_strip_parallel_set_pixel(strip, start, red, green, blue), TAG, "set first pixel failed");
+    uint8_t *buf = parallel_strip->pixel_buf + start * parallel_strip->bytes_per_pixel;
+    size_t total = count * parallel_strip->bytes_per_pixel;
+    size_t filled = parallel_strip->bytes_per_pixel;
+    while (filled < total) {
+        size_t chunk = filled < total - filled ? filled : total - filled;
+        memcpy(buf + filled, buf, chunk);
+        filled += chunk;
+    }
+
+    return ESP_OK;
+}
+
+static esp_err_t led_strip_parallel_mirror(led_strip_t *strip, const led_strip_t *src)
+{
+    led_strip_parallel_obj *parallel_strip = __containerof(strip, led_strip_parallel_obj, base);
+    const led_strip_parallel_obj *src_strip = __containerof(src, led_strip_parallel_obj, base);
+    ESP_RETURN_ON_FALSE(src_strip->strip_len == parallel_strip->strip_len && src_strip->num_strips == parallel_strip->num_strips &&
+                        src_strip->component_fmt.format_id == parallel_strip->component_fmt.format_id,
+                        ESP_ERR_INVALID_ARG, TAG, "strips have different length or color format");
+
+    memcpy(parallel_strip->pixel_buf, src_strip->pixel_buf, parallel_strip->strip_len * parallel_strip->num_strips * parallel_strip->bytes_per_pixel);
+    return ESP_OK;
+}
+
+static esp_err_t led_strip_parallel_wait_refresh_done(led_strip_t *strip, int32_t timeout_ms)
+{
+    led_strip_parallel_obj *parallel_strip = __containerof(strip, led_strip_parallel_obj, base);
+    TickType_t ticks_to_wait = timeout_ms < 0 ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+
+    while (parallel_strip->trans_pending) {
+        if (xSemaphoreTake(parallel_strip->trans_done, ticks_to_wait) != pdTRUE) {
+            return ESP_ERR_TIMEOUT;
+        }
+        parallel_strip->trans_pending--;
+    }
+    return ESP_OK;
+}
+
+// transpose the whole frame, then send it with the reset time in a single transaction
+// the DMA streams the transaction without a break, so the lines can't idle in the middle of a frame and latch part of it
+// returns once the frame is queued, so the raw pixels can be changed again
+static esp_err_t led_strip_parallel_refresh_async(led_strip_t *strip)
+{
+    led_strip_parallel_obj *parallel_strip = __containerof(strip, led_strip_parallel_obj, base);
+    size_t strip_bytes = parallel_strip->strip_len * parallel_strip->bytes_per_pixel;
+    const uint8_t *lanes[LED_STRIP_PARALLEL_MAX_LANES] = {0};
+
+    // the frame buffer is reused, so the previous frame must be done first
+    ESP_RETURN_ON_ERROR(led_strip_parallel_wait_refresh_done(strip, -1), TAG, "wait previous refresh failed");
+    for (uint32_t i = 0; i < parallel_strip->num_strips; i++) {
+        lanes[i] = parallel_strip->pixel_buf + i * strip_bytes;
+    }
+    led_strip_parallel_encode(lanes, strip_bytes, led_strip_color_lut_table(&parallel_strip->color_lut), parallel_strip->frame_buf);
+    ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_color(parallel_strip->io, -1, parallel_strip->frame_buf, parallel_strip->frame_size),
+                        TAG, "transmit pixels by I80 bus failed");
+    parallel_strip->trans_pending++;
+    return ESP_OK;
+}
+
+static esp_err_t led_strip_parallel_refresh(led_strip_t *strip)
+{
+    ESP_RETURN_ON_ERROR(led_strip_parallel_refresh_async(strip), TAG, "start refresh failed");
+    return led_strip_parallel_wait_refresh_done(strip, -1);
+}
+
+static esp_err_t led_strip_parallel_clear(led_strip_t *strip)
+{
+    led_strip_parallel_obj *parallel_strip = __containerof(strip, led_strip_parallel_obj, base);
+    // Write zero to turn off all leds
+    memset(parallel_strip->pixel_buf, 0, parallel_strip->strip_len * parallel_strip->num_strips * parallel_strip->bytes_per_pixel);
+    return led_strip_parallel_refresh(strip);
+}
+
+static esp_err_t led_strip_parallel_del(led_strip_t *strip)
+{
+    led_strip_parallel_obj *parallel_strip = __containerof(strip, led_strip_parallel_obj, base);
+
+    ESP_RETURN_ON_ERROR(led_strip_parallel_wait_refresh_done(strip, -1), TAG, "wait previous refresh failed");
+    ESP_RETURN_ON_ERROR(esp_lcd_panel_io_del(parallel_strip->io), TAG, "delete I80 panel IO failed");
+    ESP_RETURN_ON_ERROR(esp_lcd_del_i80_bus(parallel_strip->bus), TAG, "delete I80 bus failed");
+
+    vSemaphoreDelete(parallel_strip->trans_done);
+    free(parallel_strip->frame_buf);
+    free(parallel_strip);
+    return ESP_OK;
+}
+
+static led_strip_color_lut_t *led_strip_parallel_get_color_lut(led_strip_t *strip)
+{
+    led_strip_parallel_obj *parallel_strip = __containerof(strip, led_strip_parallel_obj, base);
+    return &parallel_strip->color_lut;
+}
+
+esp_err_t led_strip_new_parallel_device(const led_strip_config_t *led_config, const led_strip_parallel_config_t *parallel_config, led_strip_handle_t *ret_strip)
+{
+    led_strip_parallel_obj *parallel_strip = NULL;
+    esp_err_t ret = ESP_OK;
+    ESP_GOTO_ON_FALSE(led_config && parallel_config && ret_strip, ESP_ERR_INVALID_ARG, err, TAG, "invalid argument");
+    ESP_GOTO_ON_FALSE(parallel_config->num_strips >= 1 && parallel_config->num_strips <= LED_STRIP_PARALLEL_MAX_STRIPS,
+                      ESP_ERR_INVALID_ARG, err, TAG, "invalid number of strips: %"PRIu32, parallel_config->num_strips);
+    // the idle level of the bus is low, an inverted output can't be generated
+    ESP_GOTO_ON_FALSE(!led_config->flags.invert_out, ESP_ERR_NOT_SUPPORTED, err, TAG, "invert output is not supported");
+    ESP_GOTO_ON_FALSE(!led_config->flags.high_depth, ESP_ERR_NOT_SUPPORTED, err, TAG, "high depth mode is not supported");
+    led_color_component_format_t component_fmt = led_config->color_component_format;
+    // If R/G/B order is not specified, set default GRB order as fallback
+    if (component_fmt.format_id == 0) {
+        component_fmt = LED_STRIP_COLOR_COMPONENT_FMT_GRB;
+    }
+    // check the validation of the color component format
+    uint8_t mask = 0;
+    if (component_fmt.format.num_components == 3) {
+        mask = BIT(component_fmt.format.r_pos) | BIT(component_fmt.format.g_pos) | BIT(component_fmt.format.b_pos);
+        // Check for invalid values
+        ESP_RETURN_ON_FALSE(mask == 0x07, ESP_ERR_INVALID_ARG, TAG, "invalid order argument");
+    } else if (component_fmt.format.num_components == 4) {
+        mask = BIT(component_fmt.format.r_pos) | BIT(component_fmt.format.g_pos) | BIT(component_fmt.format.b_pos) | BIT(component_fmt.format.w_pos);
+        // Check for invalid values
+        ESP_RETURN_ON_FALSE(mask == 0x0F, ESP_ERR_INVALID_ARG, TAG, "invalid order argument");
+    } else {
+        ESP_RETURN_ON_FALSE(false, ESP_ERR_INVALID_ARG, TAG, "invalid number of color components: %d", component_fmt.format.num_components);
+    }
+    uint8_t bytes_per_pixel = component_fmt.format.num_components;
+    // every lane takes one bit of the same bus word, so the waveform size doesn't depend on the number of strips
+    // the bus clock is not a whole number of MHz, scale before dividing
+    size_t reset_size = (size_t)(LED_STRIP_PARALLEL_RESET_US * LED_STRIP_PARALLEL_DEFAULT_RESOLUTION / 1000000);
+    size_t frame_size = led_config->max_leds * bytes_per_pixel * LED_STRIP_PARALLEL_BYTES_PER_COLOR_BYTE + reset_size;
+
+    // only the waveform is transmitted, the raw pixels can stay in any memory
+    parallel_strip = calloc(1, sizeof(led_strip_parallel_obj) + parallel_config->num_strips * led_config->max_leds * bytes_per_pixel);
+    ESP_GOTO_ON_FALSE(parallel_strip, ESP_ERR_NO_MEM, err, TAG, "no mem for parallel strip");
+    // the reset time at the end is never written, it stays low
+    parallel_strip->frame_buf = heap_caps_calloc(1, frame_size, MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA);
+    ESP_GOTO_ON_FALSE(parallel_strip->frame_buf, ESP_ERR_NO_MEM, err, TAG, "no mem for parallel frame");
+    parallel_strip->trans_done = xSemaphoreCreateCounting(LED_STRIP_PARALLEL_TRANS_QUEUE_SIZE, 0);
+    ESP_GOTO_ON_FALSE(parallel_strip->trans_done, ESP_ERR_NO_MEM, err, TAG, "no mem for semaphore");
+
+    esp_lcd_i80_bus_config_t bus_config = {
+        .clk_src = LCD_CLK_SRC_DEFAULT,
+        .dc_gpio_num = parallel_config->dc_gpio_num,
+        .wr_gpio_num = parallel_config->wr_gpio_num,
+        .bus_width = 8,
+        .max_transfer_bytes = frame_size,
+    };
+    for (int i = 0; i < LED_STRIP_PARALLEL_MAX_STRIPS; i++) {
+        bus_config.data_gpio_nums[i] = parallel_config->data_gpio_nums[i];
+    }
+    ESP_GOTO_ON_ERROR(esp_lcd_new_i80_bus(&bus_config, &parallel_strip->bus), err, TAG, "create I80 bus failed");
+
+    esp_lcd_panel_io_i80_config_t io_config = {
+        .cs_gpio_num = -1,
+        .pclk_hz = LED_STRIP_PARALLEL_DEFAULT_RESOLUTION,
+        .trans_queue_depth = LED_STRIP_PARALLEL_TRANS_QUEUE_SIZE,
+        .on_color_trans_done = led_strip_parallel_on_trans_done,
+        .user_ctx = parallel_strip,
+        .lcd_cmd_bits = 8,
+        .lcd_param_bits = 8,
+        .dc_levels = {
+            .dc_idle_level = 0,
+            .dc_cmd_level = 0,
+            .dc_dummy_level = 0,
+            .dc_data_level = 1,
+        },
+    };
+    ESP_GOTO_ON_ERROR(esp_lcd_new_panel_io_i80(parallel_strip->bus, &io_config, &parallel_strip->io), err, TAG, "create I80 panel IO failed");
+
+    parallel_strip->component_fmt = component_fmt;
+    parallel_strip->bytes_per_pixel = bytes_per_pixel;
+    parallel_strip->strip_len = led_config->max_leds;
+    parallel_strip->num_strips = parallel_config->num_strips;
+    parallel_strip->frame_size = frame_size;
+    led_strip_color_lut_init(&parallel_strip->color_lut);
+    parallel_strip->base.set_pixel = led_strip_parallel_set_pixel;
+    parallel_strip->base.set_pixel_rgbw = led_strip_parallel_set_pixel_rgbw;
+    parallel_strip->base.set_pixels = led_strip_parallel_set_pixels;
+    parallel_strip->base.fill = led_strip_parallel_fill;
+    parallel_strip->base.mirror = led_strip_parallel_mirror;
+    parallel_strip->base.refresh = led_strip_parallel_refresh;
+    parallel_strip->base.refresh_async = led_strip_parallel_refresh_async;
+    parallel_strip->base.wait_refresh_done = led_strip_parallel_wait_refresh_done;
+    parallel_strip->base.clear = led_strip_parallel_clear;
+    parallel_strip->base.del = led_strip_parallel_del;
+    parallel_strip->base.get_color_lut = led_strip_parallel_get_color_lut;
+
+    *ret_strip = &parallel_strip->base;
+    return ESP_OK;
+err:
+    if (parallel_strip) {
+        if (parallel_strip->io) {
+            esp_lcd_panel_io_del(parallel_strip->io);
+        }
+        if (parallel_strip->bus) {
+            esp_lcd_del_i80_bus(parallel_strip->bus);
+        }
+        if (parallel_strip->trans_done) {
+            vSemaphoreDelete(parallel_strip->trans_done);
+        }
+        free(parallel_strip->frame_buf);
+        free(parallel_strip);
+    }
+    return ret;
+}
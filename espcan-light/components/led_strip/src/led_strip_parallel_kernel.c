@@ -0,0 +1,68 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include "led_strip_parallel_kernel.h"
+
+void led_strip_parallel_transpose8(const uint8_t in[LED_STRIP_PARALLEL_MAX_LANES], uint8_t out[8])
+{
+    // rows are loaded from the highest lane, so that lane N ends up in bit N of every output word
+    uint32_t x = ((uint32_t)in[7] << 24) | ((uint32_t)in[6] << 16) | ((uint32_t)in[5] << 8) | in[4];
+    uint32_t y = ((uint32_t)in[3] << 24) | ((uint32_t)in[2] << 16) | ((uint32_t)in[1] << 8) | in[0];
+    uint32_t t;
+
+    // swap 1x1 bit blocks, then 2x2, then 4x4 (Hacker's Delight, transpose8rS32)
+    t = (x ^ (x >> 7)) & 0x00AA00AA;
+    x = x ^ t ^ (t << 7);
+    t = (y ^ (y >> 7)) & 0x00AA00AA;
+    y = y ^ t ^ (t << 7);
+
+    t = (x ^ (x >> 14)) & 0x0000CCCC;
+    x = x ^ t ^ (t << 14);
+    t = (y ^ (y >> 14)) & 0x0000CCCC;
+    y = y ^ t ^ (t << 14);
+
+    t = (x & 0xF0F0F0F0) | ((y >> 4) & 0x0F0F0F0F);
+    y = ((x << 4) & 0xF0F0F0F0) | (y & 0x0F0F0F0F);
+    x = t;
+
+    out[0] = x >> 24;
+    out[1] = x >> 16;
+    out[2] = x >> 8;
+    out[3] = x;
+    out[4] = y >> 24;
+    out[5] = y >> 16;
+    out[6] = y >> 8;
+    out[7] = y;
+}
+
+void led_strip_parallel_encode(const uint8_t *const lanes[LED_STRIP_PARALLEL_MAX_LANES], size_t len, const uint8_t *table, uint8_t *out)
+{
+    uint8_t lane_mask = 0;
+    for (int lane = 0; lane < LED_STRIP_PARALLEL_MAX_LANES; lane++) {
+        if (lanes[lane]) {
+            lane_mask |= 1 << lane;
+        }
+    }
+
+    uint8_t in[LED_STRIP_PARALLEL_MAX_LANES];
+    uint8_t bits[8];
+    for (size_t i = 0; i < len; i++) {
+        for (int lane = 0; lane < LED_STRIP_PARALLEL_MAX_LANES; lane++) {
+            in[lane] = lanes[lane] ? lanes[lane][i] : 0;
+        }
+        if (table) {
+            for (int lane = 0; lane < LED_STRIP_PARALLEL_MAX_LANES; lane++) {
+                in[lane] = table[in[lane]];
+            }
+        }
+        led_strip_parallel_transpose8(in, bits);
+        for (int n = 0; n < 8; n++) {
+            out[0] = lane_mask; // every active lane starts the bit high
+            out[1] = bits[n];   // stays high only for the lanes sending a 1
+            out[2] = 0;
+            out += LED_STRIP_PARALLEL_SLOTS_PER_BIT;
+        }
+    }
+}
@@ -0,0 +1,43 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// The kernel only depends on the C library, so it can be built and checked on the host as well
+
+#define LED_STRIP_PARALLEL_MAX_LANES 8
+// each color bit is sent as 3 slots: high, data, low. 0 -> 100, 1 -> 110
+#define LED_STRIP_PARALLEL_SLOTS_PER_BIT 3
+// output bytes (one bus word of 8 lanes each) for one color byte of every lane
+#define LED_STRIP_PARALLEL_BYTES_PER_COLOR_BYTE (8 * LED_STRIP_PARALLEL_SLOTS_PER_BIT)
+
+/**
+ * @brief Transpose an 8x8 bit matrix
+ *
+ * @param[in] in One byte of each lane, in[lane]
+ * @param[out] out One word per bit, MSB first: bit `lane` of out[n] is bit (7 - n) of in[lane]
+ */
+void led_strip_parallel_transpose8(const uint8_t in[LED_STRIP_PARALLEL_MAX_LANES], uint8_t out[8]);
+
+/**
+ * @brief Interleave the color bytes of up to 8 lanes into the parallel bus waveform
+ *
+ * @param[in] lanes Color bytes of each lane in wire order, NULL for unused lanes (they stay low)
+ * @param[in] len Number of color bytes to encode from every lane
+ * @param[in] table 256-entry table every color byte is passed through, NULL to send the bytes unchanged
+ * @param[out] out Output buffer, must hold `len * LED_STRIP_PARALLEL_BYTES_PER_COLOR_BYTE` bytes
+ */
+void led_strip_parallel_encode(const uint8_t *const lanes[LED_STRIP_PARALLEL_MAX_LANES], size_t len, const uint8_t *table, uint8_t *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,31 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <string.h>
+#include "led_strip_power.h"
+
+void led_strip_power_init(led_strip_power_t *power, uint32_t full_scale)
+{
+    memset(power, 0, sizeof(led_strip_power_t));
+    power->full_scale = full_scale;
+    power->channel_ma = LED_STRIP_POWER_DEFAULT_CHANNEL_MA;
+    power->scale = 255;
+}
+
+uint8_t led_strip_power_update(led_strip_power_t *power, uint8_t brightness)
+{
+    uint32_t dynamic_ma = (uint64_t)power->channel_sum * power->channel_ma * brightness / ((uint64_t)power->full_scale * 255);
+    uint8_t scale = 255;
+
+    power->estimated_ma = power->idle_ma + dynamic_ma;
+    if (power->budget_ma && power->estimated_ma > power->budget_ma) {
+        // only the LED current can be scaled, the idle current stays; round down to stay within the budget
+        scale = power->budget_ma > power->idle_ma ? (power->budget_ma - power->idle_ma) * 255 / dynamic_ma : 0;
+        power->limited_frames++;
+    }
+    power->output_ma = power->idle_ma + dynamic_ma * scale / 255;
+    power->scale = scale;
+    return scale;
+}
@@ -0,0 +1,80 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "led_strip_types.h"
+#include "led_strip_interface.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LED_STRIP_POWER_DEFAULT_CHANNEL_MA 12 // full-scale current of one WS2812/SK6812 color channel
+
+/**
+ * @brief Per-strip power model
+ *
+ * Backends keep `channel_sum` up to date while the pixels are written, by subtracting the old value of every
+ * color component they overwrite and adding the new one. The frame current is then known at encode time
+ * without another pass over the pixels.
+ */
+struct led_strip_power_t {
+    uint32_t channel_sum;   /*!< Sum of all color components in the pixel buffer */
+    uint32_t full_scale;    /*!< Value of a color component at full scale: 255, or 65535 in high depth mode */
+    uint32_t budget_ma;     /*!< Current budget, 0 if the limiter is disabled */
+    uint32_t channel_ma;    /*!< Current of one color channel at full scale */
+    uint32_t idle_ma;       /*!< Current of the whole strip with all LEDs off */
+    uint32_t estimated_ma;  /*!< Estimated draw of the last frame before limiting */
+    uint32_t output_ma;     /*!< Estimated draw of the last frame after limiting */
+    uint32_t limited_frames;/*!< Number of frames scaled down */
+    uint8_t scale;          /*!< Scale applied to the last frame, 255 if not limited */
+};
+
+/**
+ * @brief Initialize the model with the limiter disabled
+ */
+void led_strip_power_init(led_strip_power_t *power, uint32_t full_scale);
+
+/**
+ * @brief Estimate the draw of the frame about to be encoded and work out the scale that keeps it within the budget
+ *
+ * @note The estimate is linear in the component values, so with a gamma above 1.0 it's an upper bound
+ *
+ * @param power Power model of the strip
+ * @param brightness Global brightness applied at encode time
+ * @return Scale to apply on top of the brightness, 255 if the frame is within the budget
+ */
+uint8_t led_strip_power_update(led_strip_power_t *power, uint8_t brightness);
+
+/**
+ * @brief Sum of `len` 8-bit color components
+ */
+static inline uint32_t led_strip_power_sum(const uint8_t *data, size_t len)
+{
+    uint32_t sum = 0;
+    for (size_t i = 0; i < len; i++) {
+        sum += data[i];
+    }
+    return sum;
+}
+
+/**
+ * @brief Sum of `len` 16-bit color components
+ */
+static inline uint32_t led_strip_power_sum16(const uint16_t *data, size_t len)
+{
+    uint32_t sum = 0;
+    for (size_t i = 0; i < len; i++) {
+        sum += data[i];
+    }
+    return sum;
+}
+
+#ifdef __cplusplus
+}
+#endif
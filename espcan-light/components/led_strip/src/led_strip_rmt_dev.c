@@ -6,12 +6,19 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/cdefs.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_attr.h"
 #include "esp_log.h"
 #include "esp_check.h"
+#include "esp_timer.h"
 #include "driver/rmt_tx.h"
 #include "led_strip.h"
 #include "led_strip_interface.h"
 #include "led_strip_rmt_encoder.h"
+#include "led_strip_color_lut.h"
+#include "led_strip_dither.h"
+#include "led_strip_power.h"
 
 #define LED_STRIP_RMT_DEFAULT_RESOLUTION 10000000 // 10MHz resolution
 #define LED_STRIP_RMT_DEFAULT_TRANS_QUEUE_SIZE 4
@@ -31,9 +38,87 @@ typedef struct {
     uint32_t strip_len;
     uint8_t bytes_per_pixel;
     led_color_component_format_t component_fmt;
+    bool refresh_pending;
+    led_strip_color_lut_t color_lut;
+    led_strip_power_t power;        // channel_sum follows every write to the pixel buffer
+    uint8_t *tx_buf;                // pixels passed through the color table or dithered, allocated on first use
+    uint16_t *pixel_buf16;          // high depth mode: 16 bits per color component, pixel_buf is not used
+    uint8_t *dither_residual;       // high depth mode: fraction not sent yet, one per color component
+    bool streaming;
+    uint8_t *frame_slots;           // streaming mode: one copy of the pixels per queued frame
+    uint32_t num_slots;
+    uint32_t next_slot;
+    SemaphoreHandle_t free_slots;   // given back by the trans-done callback
+    portMUX_TYPE stats_lock;
+    uint32_t frames_queued;
+    uint32_t frames_done;
+    int64_t last_done_us;
+    uint32_t max_queue_len;
+    uint32_t last_gap_us;
+    uint32_t max_gap_us;
     uint8_t pixel_buf[];
 } led_strip_rmt_obj;
 
+// store one color byte, `byte_index` counts color components from the start of the strip
+static inline void led_strip_rmt_store(led_strip_rmt_obj *rmt_strip, uint32_t byte_index, uint8_t data)
+{
+    led_strip_power_t *power = &rmt_strip->power;
+    if (rmt_strip->pixel_buf16) {
+        // 0xFF expands to 0xFFFF, so full scale stays full scale
+        uint16_t value = data * 257;
+        power->channel_sum = power->channel_sum - rmt_strip->pixel_buf16[byte_index] + value;
+        rmt_strip->pixel_buf16[byte_index] = value;
+    } else {
+        power->channel_sum = power->channel_sum - rmt_strip->pixel_buf[byte_index] + data;
+        rmt_strip->pixel_buf[byte_index] = data;
+    }
+}
+
+// sum of the color components of `count` pixels from `start`
+static uint32_t led_strip_rmt_sum(led_strip_rmt_obj *rmt_strip, uint32_t start, uint32_t count)
+{
+    size_t offset = start * rmt_strip->bytes_per_pixel;
+    size_t len = count * rmt_strip->bytes_per_pixel;
+    if (rmt_strip->pixel_buf16) {
+        return led_strip_power_sum16(rmt_strip->pixel_buf16 + offset, len);
+    }
+    return led_strip_power_sum(rmt_strip->pixel_buf + offset, len);
+}
+
+// start of the pixel buffer in use and the size of one pixel in it
+static inline uint8_t *led_strip_rmt_buf(led_strip_rmt_obj *rmt_strip, size_t *pixel_size)
+{
+    if (rmt_strip->pixel_buf16) {
+        *pixel_size = rmt_strip->bytes_per_pixel * sizeof(uint16_t);
+        return (uint8_t *)rmt_strip->pixel_buf16;
+    }
+    *pixel_size = rmt_strip->bytes_per_pixel;
+    return rmt_strip->pixel_buf;
+}
+
+// copy pixel `start` over the following pixels, keep doubling the filled part with memcpy
+static void led_strip_rmt_repeat_pixel(led_strip_rmt_obj *rmt_strip, uint32_t start, uint32_t count)
+{
+    led_strip_power_t *power = &rmt_strip->power;
+    uint32_t pixel_sum = led_strip_rmt_sum(rmt_strip, start, 1);
+    if (count == rmt_strip->strip_len) {
+        power->channel_sum = pixel_sum * count;
+    } else {
+        // only the overwritten range is read, the first pixel is already accounted for
+        power->channel_sum = power->channel_sum - led_strip_rmt_sum(rmt_strip, start + 1, count - 1) + pixel_sum * (count - 1);
+    }
+
+    size_t pixel_size = 0;
+    uint8_t *buf = led_strip_rmt_buf(rmt_strip, &pixel_size) + start * pixel_size;
+    size_t total = count * pixel_size;
+    size_t filled = pixel_size;
+    while (filled < total) {
+        size_t chunk = filled < total - filled ? filled : total - filled;
+        memcpy(buf + filled, buf, chunk);
+        filled += chunk;
+    }
+}
+
 static esp_err_t led_strip_rmt_set_pixel(led_strip_t *strip, uint32_t index, uint32_t red, uint32_t green, uint32_t blue)
 {
     led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
@@ -41,13 +126,12 @@ static esp_err_t led_strip_rmt_set_pixel(led_strip_t *strip, uint32_t index, uin
 
     led_color_component_format_t component_fmt = rmt_strip->component_fmt;
     uint32_t start = index * rmt_strip->bytes_per_pixel;
-    uint8_t *pixel_buf = rmt_strip->pixel_buf;
 
-    pixel_buf[start + component_fmt.format.r_pos] = red & 0xFF;
-    pixel_buf[start + component_fmt.format.g_pos] = green & 0xFF;
-    pixel_buf[start + component_fmt.format.b_pos] = blue & 0xFF;
+    led_strip_rmt_store(rmt_strip, start + component_fmt.format.r_pos, red & 0xFF);
+    led_strip_rmt_store(rmt_strip, start + component_fmt.format.g_pos, green & 0xFF);
+    led_strip_rmt_store(rmt_strip, start + component_fmt.format.b_pos, blue & 0xFF);
     if (component_fmt.format.num_components > 3) {
-        pixel_buf[start + component_fmt.format.w_pos] = 0;
+        led_strip_rmt_store(rmt_strip, start + component_fmt.format.w_pos, 0);
     }
 
     return ESP_OK;
@@ -61,48 +145,355 @@ static esp_err_t led_strip_rmt_set_pixel_rgbw(led_strip_t *strip, uint32_t index
     ESP_RETURN_ON_FALSE(component_fmt.format.num_components == 4, ESP_ERR_INVALID_ARG, TAG, "led doesn't have 4 components");
 
     uint32_t start = index * rmt_strip->bytes_per_pixel;
-    uint8_t *pixel_buf = rmt_strip->pixel_buf;
 
-    pixel_buf[start + component_fmt.format.r_pos] = red & 0xFF;
-    pixel_buf[start + component_fmt.format.g_pos] = green & 0xFF;
-    pixel_buf[start + component_fmt.format.b_pos] = blue & 0xFF;
-    pixel_buf[start + component_fmt.format.w_pos] = white & 0xFF;
+    led_strip_rmt_store(rmt_strip, start + component_fmt.format.r_pos, red & 0xFF);
+    led_strip_rmt_store(rmt_strip, start + component_fmt.format.g_pos, green & 0xFF);
+    led_strip_rmt_store(rmt_strip, start + component_fmt.format.b_pos, blue & 0xFF);
+    led_strip_rmt_store(rmt_strip, start + component_fmt.format.w_pos, white & 0xFF);
 
     return ESP_OK;
 }
 
-static esp_err_t led_strip_rmt_refresh(led_strip_t *strip)
+static esp_err_t led_strip_rmt_set_pixels(led_strip_t *strip, uint32_t start, uint32_t count, const uint8_t *colors)
+{
+    led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
+    ESP_RETURN_ON_FALSE(start <= rmt_strip->strip_len && count <= rmt_strip->strip_len - start, ESP_ERR_INVALID_ARG, TAG,
+                        "pixel range out of maximum number of LEDs");
+
+    led_color_component_format_t component_fmt = rmt_strip->component_fmt;
+    uint32_t r_pos = component_fmt.format.r_pos;
+    uint32_t g_pos = component_fmt.format.g_pos;
+    uint32_t b_pos = component_fmt.format.b_pos;
+    uint8_t *pixel = rmt_strip->pixel_buf + start * rmt_strip->bytes_per_pixel;
+
+    uint32_t removed = 0;
+    uint32_t added = 0;
+    if (rmt_strip->pixel_buf16) {
+        uint32_t byte_index = start * rmt_strip->bytes_per_pixel;
+        for (uint32_t i = 0; i < count; i++) {
+            led_strip_rmt_store(rmt_strip, byte_index + r_pos, colors[0]);
+            led_strip_rmt_store(rmt_strip, byte_index + g_pos, colors[1]);
+            led_strip_rmt_store(rmt_strip, byte_index + b_pos, colors[2]);
+            if (component_fmt.format.num_components > 3) {
+                led_strip_rmt_store(rmt_strip, byte_index + component_fmt.format.w_pos, colors[3]);
+            }
+            byte_index += rmt_strip->bytes_per_pixel;
+            colors += rmt_strip->bytes_per_pixel;
+        }
+    } else if (component_fmt.format.num_components > 3) {
+        uint32_t w_pos = component_fmt.format.w_pos;
+        for (uint32_t i = 0; i < count; i++) {
+            removed += pixel[0] + pixel[1] + pixel[2] + pixel[3];
+            added += colors[0] + colors[1] + colors[2] + colors[3];
+            pixel[r_pos] = colors[0];
+            pixel[g_pos] = colors[1];
+            pixel[b_pos] = colors[2];
+            pixel[w_pos] = colors[3];
+            pixel += 4;
+            colors += 4;
+        }
+    } else {
+        for (uint32_t i = 0; i < count; i++) {
+            removed += pixel[0] + pixel[1] + pixel[2];
+            added += colors[0] + colors[1] + colors[2];
+            pixel[r_pos] = colors[0];
+            pixel[g_pos] = colors[1];
+            pixel[b_pos] = colors[2];
+            pixel += 3;
+            colors += 3;
+        }
+    }
+    rmt_strip->power.channel_sum = rmt_strip->power.channel_sum - removed + added;
+
+    return ESP_OK;
+}
+
+static esp_err_t led_strip_rmt_fill(led_strip_t *strip, uint32_t start, uint32_t count, uint32_t red, uint32_t green, uint32_t blue)
+{
+    led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
+    ESP_RETURN_ON_FALSE(start <= rmt_strip->strip_len && count <= rmt_strip->strip_len - start, ESP_ERR_INVALID_ARG, TAG,
+                        "pixel range out of maximum number of LEDs");
+    if (count == 0) {
+        return ESP_OK;
+    }
+
+    // write the first pixel, then keep doubling the filled part with memcpy
+    ESP_RETURN_ON_ERROR(led_strip_rmt_set_pixel(strip, start, red, green, blue), TAG, "set first pixel failed");
+    led_strip_rmt_repeat_pixel(rmt_strip, start, count);
+
+    return ESP_OK;
+}
+
+static esp_err_t led_strip_rmt_set_pixels16(led_strip_t *strip, uint32_t start, uint32_t count, const uint16_t *colors)
+{
+    led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
+    ESP_RETURN_ON_FALSE(start <= rmt_strip->strip_len && count <= rmt_strip->strip_len - start, ESP_ERR_INVALID_ARG, TAG,
+                        "pixel range out of maximum number of LEDs");
+
+    led_color_component_format_t component_fmt = rmt_strip->component_fmt;
+    uint16_t *pixel = rmt_strip->pixel_buf16 + start * rmt_strip->bytes_per_pixel;
+    size_t len = count * rmt_strip->bytes_per_pixel;
+    rmt_strip->power.channel_sum = rmt_strip->power.channel_sum - led_strip_power_sum16(pixel, len) + led_strip_power_sum16(colors, len);
+    for (uint32_t i = 0; i < count; i++) {
+        pixel[component_fmt.format.r_pos] = colors[0];
+        pixel[component_fmt.format.g_pos] = colors[1];
+        pixel[component_fmt.format.b_pos] = colors[2];
+        if (component_fmt.format.num_components > 3) {
+            pixel[component_fmt.format.w_pos] = colors[3];
+        }
+        pixel += rmt_strip->bytes_per_pixel;
+        colors += rmt_strip->bytes_per_pixel;
+    }
+
+    return ESP_OK;
+}
+
+static esp_err_t led_strip_rmt_fill16(led_strip_t *strip, uint32_t start, uint32_t count, uint16_t red, uint16_t green, uint16_t blue)
+{
+    led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
+    ESP_RETURN_ON_FALSE(start <= rmt_strip->strip_len && count <= rmt_strip->strip_len - start, ESP_ERR_INVALID_ARG, TAG,
+                        "pixel range out of maximum number of LEDs");
+    if (count == 0) {
+        return ESP_OK;
+    }
+
+    uint16_t color[4] = {red, green, blue, 0};
+    led_strip_rmt_set_pixels16(strip, start, 1, color);
+    led_strip_rmt_repeat_pixel(rmt_strip, start, count);
+
+    return ESP_OK;
+}
+
+static esp_err_t led_strip_rmt_mirror(led_strip_t *strip, const led_strip_t *src)
+{
+    led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
+    const led_strip_rmt_obj *src_strip = __containerof(src, led_strip_rmt_obj, base);
+    ESP_RETURN_ON_FALSE(src_strip->strip_len == rmt_strip->strip_len &&
+                        src_strip->component_fmt.format_id == rmt_strip->component_fmt.format_id &&
+                        !src_strip->pixel_buf16 == !rmt_strip->pixel_buf16,
+                        ESP_ERR_INVALID_ARG, TAG, "strips have different length, color format or depth");
+
+    size_t pixel_size = 0;
+    uint8_t *buf = led_strip_rmt_buf(rmt_strip, &pixel_size);
+    const uint8_t *src_buf = src_strip->pixel_buf16 ? (const uint8_t *)src_strip->pixel_buf16 : src_strip->pixel_buf;
+    memcpy(buf, src_buf, rmt_strip->strip_len * pixel_size);
+    rmt_strip->power.channel_sum = src_strip->power.channel_sum;
+    return ESP_OK;
+}
+
+static bool IRAM_ATTR led_strip_rmt_on_trans_done(rmt_channel_handle_t tx_chan, const rmt_tx_done_event_data_t *edata, void *user_ctx)
+{
+    led_strip_rmt_obj *rmt_strip = (led_strip_rmt_obj *)user_ctx;
+    BaseType_t need_yield = pdFALSE;
+
+    portENTER_CRITICAL_ISR(&rmt_strip->stats_lock);
+    rmt_strip->frames_done++;
+    rmt_strip->last_done_us = esp_timer_get_time();
+    portEXIT_CRITICAL_ISR(&rmt_strip->stats_lock);
+    // the oldest frame slot can be reused now
+    xSemaphoreGiveFromISR(rmt_strip->free_slots, &need_yield);
+    return need_yield == pdTRUE;
+}
+
+// write the bytes to send: dithered from the 16-bit pixels, or passed through the color table
+static void led_strip_rmt_render(led_strip_rmt_obj *rmt_strip, uint8_t *out)
+{
+    size_t frame_size = rmt_strip->strip_len * rmt_strip->bytes_per_pixel;
+    if (rmt_strip->pixel_buf16) {
+        led_strip_dither_encode(rmt_strip->pixel_buf16, rmt_strip->dither_residual,
+                                led_strip_color_lut_curve(&rmt_strip->color_lut), out, frame_size);
+        return;
+    }
+    const uint8_t *table = led_strip_color_lut_table(&rmt_strip->color_lut);
+    if (table) {
+        led_strip_color_lut_map(table, rmt_strip->pixel_buf, out, frame_size);
+    } else {
+        memcpy(out, rmt_strip->pixel_buf, frame_size);
+    }
+}
+
+// estimate the draw of the frame and fold the limiter scale into the color table
+static void led_strip_rmt_apply_power(led_strip_rmt_obj *rmt_strip)
+{
+    uint8_t limit = led_strip_power_update(&rmt_strip->power, rmt_strip->color_lut.brightness);
+    led_strip_color_lut_set_limit(&rmt_strip->color_lut, limit);
+}
+
+static esp_err_t led_strip_rmt_stream_frame(led_strip_rmt_obj *rmt_strip)
+{
+    rmt_transmit_config_t tx_conf = {
+        .loop_count = 0,
+    };
+    size_t frame_size = rmt_strip->strip_len * rmt_strip->bytes_per_pixel;
+
+    // block only when every slot is still queued in the driver
+    ESP_RETURN_ON_FALSE(xSemaphoreTake(rmt_strip->free_slots, portMAX_DELAY) == pdTRUE, ESP_FAIL, TAG, "take frame slot failed");
+    uint8_t *frame = rmt_strip->frame_slots + rmt_strip->next_slot * frame_size;
+    led_strip_rmt_render(rmt_strip, frame);
+
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&rmt_strip->stats_lock);
+    uint32_t queue_len = rmt_strip->frames_queued - rmt_strip->frames_done;
+    // the line only idles when the queue has drained before this frame
+    rmt_strip->last_gap_us = (queue_len == 0 && rmt_strip->frames_done) ? (uint32_t)(now - rmt_strip->last_done_us) : 0;
+    if (rmt_strip->last_gap_us > rmt_strip->max_gap_us) {
+        rmt_strip->max_gap_us = rmt_strip->last_gap_us;
+    }
+    if (queue_len + 1 > rmt_strip->max_queue_len) {
+        rmt_strip->max_queue_len = queue_len + 1;
+    }
+    rmt_strip->frames_queued++;
+    portEXIT_CRITICAL(&rmt_strip->stats_lock);
+
+    esp_err_t ret = rmt_transmit(rmt_strip->rmt_chan, rmt_strip->strip_encoder, frame, frame_size, &tx_conf);
+    if (ret != ESP_OK) {
+        portENTER_CRITICAL(&rmt_strip->stats_lock);
+        rmt_strip->frames_queued--;
+        portEXIT_CRITICAL(&rmt_strip->stats_lock);
+        xSemaphoreGive(rmt_strip->free_slots);
+        ESP_LOGE(TAG, "transmit pixels by RMT failed");
+        return ret;
+    }
+    rmt_strip->next_slot = (rmt_strip->next_slot + 1) % rmt_strip->num_slots;
+    return ESP_OK;
+}
+
+static esp_err_t led_strip_rmt_wait_refresh_done(led_strip_t *strip, int32_t timeout_ms)
+{
+    led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
+    // in streaming mode the queued frames have their own copy, the pixel buffer is never busy
+    if (!rmt_strip->refresh_pending || rmt_strip->streaming) {
+        return ESP_OK;
+    }
+
+    esp_err_t ret = rmt_tx_wait_all_done(rmt_strip->rmt_chan, timeout_ms);
+    if (ret == ESP_ERR_TIMEOUT) {
+        // still transmitting, keep the channel enabled
+        return ret;
+    }
+    ESP_RETURN_ON_ERROR(ret, TAG, "flush RMT channel failed");
+    rmt_strip->refresh_pending = false;
+    ESP_RETURN_ON_ERROR(rmt_disable(rmt_strip->rmt_chan), TAG, "disable RMT channel failed");
+    return ESP_OK;
+}
+
+static esp_err_t led_strip_rmt_refresh_async(led_strip_t *strip)
 {
     led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
     rmt_transmit_config_t tx_conf = {
         .loop_count = 0,
     };
 
+    if (rmt_strip->streaming) {
+        led_strip_rmt_apply_power(rmt_strip);
+        return led_strip_rmt_stream_frame(rmt_strip);
+    }
+    // the previous frame must be fully sent before the channel is re-armed
+    ESP_RETURN_ON_ERROR(led_strip_rmt_wait_refresh_done(strip, -1), TAG, "wait previous refresh failed");
+    led_strip_rmt_apply_power(rmt_strip);
+    size_t frame_size = rmt_strip->strip_len * rmt_strip->bytes_per_pixel;
+    const uint8_t *payload = rmt_strip->pixel_buf;
+    if (rmt_strip->pixel_buf16 || led_strip_color_lut_table(&rmt_strip->color_lut)) {
+        if (!rmt_strip->tx_buf) {
+            rmt_strip->tx_buf = malloc(frame_size);
+            ESP_RETURN_ON_FALSE(rmt_strip->tx_buf, ESP_ERR_NO_MEM, TAG, "no mem for encoded pixels");
+        }
+        led_strip_rmt_render(rmt_strip, rmt_strip->tx_buf);
+        payload = rmt_strip->tx_buf;
+    }
     ESP_RETURN_ON_ERROR(rmt_enable(rmt_strip->rmt_chan), TAG, "enable RMT channel failed");
-    ESP_RETURN_ON_ERROR(rmt_transmit(rmt_strip->rmt_chan, rmt_strip->strip_encoder, rmt_strip->pixel_buf,
-                                     rmt_strip->strip_len * rmt_strip->bytes_per_pixel, &tx_conf), TAG, "transmit pixels by RMT failed");
-    ESP_RETURN_ON_ERROR(rmt_tx_wait_all_done(rmt_strip->rmt_chan, -1), TAG, "flush RMT channel failed");
-    ESP_RETURN_ON_ERROR(rmt_disable(rmt_strip->rmt_chan), TAG, "disable RMT channel failed");
+    esp_err_t ret = rmt_transmit(rmt_strip->rmt_chan, rmt_strip->strip_encoder, payload, frame_size, &tx_conf);
+    if (ret != ESP_OK) {
+        rmt_disable(rmt_strip->rmt_chan);
+        ESP_LOGE(TAG, "transmit pixels by RMT failed");
+        return ret;
+    }
+    rmt_strip->refresh_pending = true;
     return ESP_OK;
 }
 
+static esp_err_t led_strip_rmt_refresh(led_strip_t *strip)
+{
+    led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
+    ESP_RETURN_ON_ERROR(led_strip_rmt_refresh_async(strip), TAG, "start refresh failed");
+    if (rmt_strip->streaming) {
+        return rmt_tx_wait_all_done(rmt_strip->rmt_chan, -1);
+    }
+    return led_strip_rmt_wait_refresh_done(strip, -1);
+}
+
 static esp_err_t led_strip_rmt_clear(led_strip_t *strip)
 {
     led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
+    // Don't touch the pixel buffer while it's being transmitted
+    ESP_RETURN_ON_ERROR(led_strip_rmt_wait_refresh_done(strip, -1), TAG, "wait previous refresh failed");
     // Write zero to turn off all leds
-    memset(rmt_strip->pixel_buf, 0, rmt_strip->strip_len * rmt_strip->bytes_per_pixel);
+    size_t pixel_size = 0;
+    memset(led_strip_rmt_buf(rmt_strip, &pixel_size), 0, rmt_strip->strip_len * pixel_size);
+    if (rmt_strip->dither_residual) {
+        memset(rmt_strip->dither_residual, 0, rmt_strip->strip_len * rmt_strip->bytes_per_pixel);
+    }
+    rmt_strip->power.channel_sum = 0;
+    if (rmt_strip->streaming) {
+        // just queue the dark frame behind the others, no need to wait for it
+        return led_strip_rmt_refresh_async(strip);
+    }
     return led_strip_rmt_refresh(strip);
 }
 
 static esp_err_t led_strip_rmt_del(led_strip_t *strip)
 {
     led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
+    ESP_RETURN_ON_ERROR(led_strip_rmt_wait_refresh_done(strip, -1), TAG, "wait previous refresh failed");
+    if (rmt_strip->streaming) {
+        ESP_RETURN_ON_ERROR(rmt_tx_wait_all_done(rmt_strip->rmt_chan, -1), TAG, "flush RMT channel failed");
+        ESP_RETURN_ON_ERROR(rmt_disable(rmt_strip->rmt_chan), TAG, "disable RMT channel failed");
+    }
     ESP_RETURN_ON_ERROR(rmt_del_channel(rmt_strip->rmt_chan), TAG, "delete RMT channel failed");
     ESP_RETURN_ON_ERROR(rmt_del_encoder(rmt_strip->strip_encoder), TAG, "delete strip encoder failed");
+    if (rmt_strip->free_slots) {
+        vSemaphoreDelete(rmt_strip->free_slots);
+    }
+    free(rmt_strip->frame_slots);
+    free(rmt_strip->tx_buf);
+    free(rmt_strip->pixel_buf16);
+    free(rmt_strip->dither_residual);
+    free(rmt_strip->color_lut.curve);
     free(rmt_strip);
     return ESP_OK;
 }
 
+static led_strip_color_lut_t *led_strip_rmt_get_color_lut(led_strip_t *strip)
+{
+    led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
+    return &rmt_strip->color_lut;
+}
+
+static led_strip_power_t *led_strip_rmt_get_power(led_strip_t *strip)
+{
+    led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
+    return &rmt_strip->power;
+}
+
+esp_err_t led_strip_rmt_get_stream_stats(led_strip_handle_t strip, led_strip_rmt_stream_stats_t *ret_stats)
+{
+    ESP_RETURN_ON_FALSE(strip && ret_stats && strip->del == led_strip_rmt_del, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
+    ESP_RETURN_ON_FALSE(rmt_strip->streaming, ESP_ERR_INVALID_STATE, TAG, "strip is not in streaming mode");
+
+    portENTER_CRITICAL(&rmt_strip->stats_lock);
+    ret_stats->frames_queued = rmt_strip->frames_queued;
+    ret_stats->frames_done = rmt_strip->frames_done;
+    ret_stats->queue_len = rmt_strip->frames_queued - rmt_strip->frames_done;
+    ret_stats->max_queue_len = rmt_strip->max_queue_len;
+    ret_stats->last_gap_us = rmt_strip->last_gap_us;
+    ret_stats->max_gap_us = rmt_strip->max_gap_us;
+    rmt_strip->max_queue_len = 0;
+    rmt_strip->max_gap_us = 0;
+    portEXIT_CRITICAL(&rmt_strip->stats_lock);
+    return ESP_OK;
+}
+
 esp_err_t led_strip_new_rmt_device(const led_strip_config_t *led_config, const led_strip_rmt_config_t *rmt_config, led_strip_handle_t *ret_strip)
 {
     led_strip_rmt_obj *rmt_strip = NULL;
@@ -126,10 +517,20 @@ esp_err_t led_strip_new_rmt_device(const led_strip_config_t *led_config, const l
     } else {
         ESP_RETURN_ON_FALSE(false, ESP_ERR_INVALID_ARG, TAG, "invalid number of color components: %d", component_fmt.format.num_components);
     }
-    // TODO: we assume each color component is 8 bits, may need to support other configurations in the future, e.g. 10bits per color component?
+    // each color component is sent as 8 bits, high depth mode keeps 16 bits in memory and dithers them at encode time
     uint8_t bytes_per_pixel = component_fmt.format.num_components;
-    rmt_strip = calloc(1, sizeof(led_strip_rmt_obj) + led_config->max_leds * bytes_per_pixel);
+    bool high_depth = led_config->flags.high_depth;
+    rmt_strip = calloc(1, sizeof(led_strip_rmt_obj) + (high_depth ? 0 : led_config->max_leds * bytes_per_pixel));
     ESP_GOTO_ON_FALSE(rmt_strip, ESP_ERR_NO_MEM, err, TAG, "no mem for rmt strip");
+    led_strip_color_lut_init(&rmt_strip->color_lut);
+    led_strip_power_init(&rmt_strip->power, high_depth ? 0xFFFF : 0xFF);
+    if (high_depth) {
+        rmt_strip->pixel_buf16 = calloc(led_config->max_leds * bytes_per_pixel, sizeof(uint16_t));
+        ESP_GOTO_ON_FALSE(rmt_strip->pixel_buf16, ESP_ERR_NO_MEM, err, TAG, "no mem for 16-bit pixels");
+        rmt_strip->dither_residual = calloc(led_config->max_leds, bytes_per_pixel);
+        ESP_GOTO_ON_FALSE(rmt_strip->dither_residual, ESP_ERR_NO_MEM, err, TAG, "no mem for dither residual");
+        ESP_GOTO_ON_FALSE(led_strip_color_lut_alloc_curve(&rmt_strip->color_lut), ESP_ERR_NO_MEM, err, TAG, "no mem for 16-bit color curve");
+    }
     uint32_t resolution = rmt_config->resolution_hz ? rmt_config->resolution_hz : LED_STRIP_RMT_DEFAULT_RESOLUTION;
 
     // for backward compatibility, if the user does not set the clk_src, use the default value
@@ -142,12 +543,16 @@ esp_err_t led_strip_new_rmt_device(const led_strip_config_t *led_config, const l
     if (rmt_config->mem_block_symbols) {
         mem_block_symbols = rmt_config->mem_block_symbols;
     }
+    size_t trans_queue_depth = LED_STRIP_RMT_DEFAULT_TRANS_QUEUE_SIZE;
+    if (rmt_config->trans_queue_depth) {
+        trans_queue_depth = rmt_config->trans_queue_depth;
+    }
     rmt_tx_channel_config_t rmt_chan_config = {
         .clk_src = clk_src,
         .gpio_num = led_config->strip_gpio_num,
         .mem_block_symbols = mem_block_symbols,
         .resolution_hz = resolution,
-        .trans_queue_depth = LED_STRIP_RMT_DEFAULT_TRANS_QUEUE_SIZE,
+        .trans_queue_depth = trans_queue_depth,
         .flags.with_dma = rmt_config->flags.with_dma,
         .flags.invert_out = led_config->flags.invert_out,
     };
@@ -159,14 +564,43 @@ esp_err_t led_strip_new_rmt_device(const led_strip_config_t *led_config, const l
     };
     ESP_GOTO_ON_ERROR(rmt_new_led_strip_encoder(&strip_encoder_conf, &rmt_strip->strip_encoder), err, TAG, "create LED strip encoder failed");
 
+    if (rmt_config->flags.streaming) {
+        rmt_strip->frame_slots = calloc(trans_queue_depth, led_config->max_leds * bytes_per_pixel);
+        ESP_GOTO_ON_FALSE(rmt_strip->frame_slots, ESP_ERR_NO_MEM, err, TAG, "no mem for frame slots");
+        rmt_strip->free_slots = xSemaphoreCreateCounting(trans_queue_depth, trans_queue_depth);
+        ESP_GOTO_ON_FALSE(rmt_strip->free_slots, ESP_ERR_NO_MEM, err, TAG, "no mem for frame slot semaphore");
+        rmt_strip->num_slots = trans_queue_depth;
+        portMUX_INITIALIZE(&rmt_strip->stats_lock);
+
+        rmt_tx_event_callbacks_t cbs = {
+            .on_trans_done = led_strip_rmt_on_trans_done,
+        };
+        // the callbacks must be registered before the channel is enabled
+        ESP_GOTO_ON_ERROR(rmt_tx_register_event_callbacks(rmt_strip->rmt_chan, &cbs, rmt_strip), err, TAG, "register RMT callbacks failed");
+        // the channel stays enabled for the whole life of the strip
+        ESP_GOTO_ON_ERROR(rmt_enable(rmt_strip->rmt_chan), err, TAG, "enable RMT channel failed");
+        rmt_strip->streaming = true;
+    }
+
     rmt_strip->component_fmt = component_fmt;
     rmt_strip->bytes_per_pixel = bytes_per_pixel;
     rmt_strip->strip_len = led_config->max_leds;
     rmt_strip->base.set_pixel = led_strip_rmt_set_pixel;
     rmt_strip->base.set_pixel_rgbw = led_strip_rmt_set_pixel_rgbw;
+    rmt_strip->base.set_pixels = led_strip_rmt_set_pixels;
+    rmt_strip->base.fill = led_strip_rmt_fill;
+    rmt_strip->base.mirror = led_strip_rmt_mirror;
     rmt_strip->base.refresh = led_strip_rmt_refresh;
+    rmt_strip->base.refresh_async = led_strip_rmt_refresh_async;
+    rmt_strip->base.wait_refresh_done = led_strip_rmt_wait_refresh_done;
     rmt_strip->base.clear = led_strip_rmt_clear;
     rmt_strip->base.del = led_strip_rmt_del;
+    rmt_strip->base.get_color_lut = led_strip_rmt_get_color_lut;
+    rmt_strip->base.get_power = led_strip_rmt_get_power;
+    if (high_depth) {
+        rmt_strip->base.set_pixels16 = led_strip_rmt_set_pixels16;
+        rmt_strip->base.fill16 = led_strip_rmt_fill16;
+    }
 
     *ret_strip = &rmt_strip->base;
     return ESP_OK;
@@ -178,6 +612,14 @@ err:
         if (rmt_strip->strip_encoder) {
             rmt_del_encoder(rmt_strip->strip_encoder);
         }
+        if (rmt_strip->free_slots) {
+            vSemaphoreDelete(rmt_strip->free_slots);
+        }
+        free(rmt_strip->frame_slots);
+        free(rmt_strip->tx_buf);
+        free(rmt_strip->pixel_buf16);
+        free(rmt_strip->dither_residual);
+        free(rmt_strip->color_lut.curve);
         free(rmt_strip);
     }
     return ret;
@@ -5,19 +5,28 @@
  */
 #include <stdlib.h>
 #include <string.h>
+#include <stdbool.h>
 #include <sys/cdefs.h>
+#include "freertos/FreeRTOS.h"
 #include "esp_log.h"
 #include "esp_check.h"
 #include "esp_rom_gpio.h"
 #include "soc/spi_periph.h"
 #include "led_strip.h"
 #include "led_strip_interface.h"
+#include "led_strip_color_lut.h"
+#include "led_strip_dither.h"
+#include "led_strip_power.h"
 
 #define LED_STRIP_SPI_DEFAULT_RESOLUTION (2.5 * 1000 * 1000) // 2.5MHz resolution
 #define LED_STRIP_SPI_DEFAULT_TRANS_QUEUE_SIZE 4
 
 #define SPI_BYTES_PER_COLOR_BYTE 3
 #define SPI_BITS_PER_COLOR_BYTE (SPI_BYTES_PER_COLOR_BYTE * 8)
+#define SPI_CHUNK_NUM 3 // chunks used by the lazy encoding mode: one on the wire, one queued behind it, one being encoded
+#define SPI_CHUNK_LEAD 2 // chunks encoded before the first one is queued, so there is always one queued behind the one on the wire
+#define LED_STRIP_SPI_RESET_US 300 // low time that surely latches the strip, long enough for the newer WS2812 variants
+#define LED_STRIP_SPI_MAX_RESTARTS 1 // frame restarts per refresh after an underrun, the frame is finished torn after that
 
 static const char *TAG = "led_strip_spi";
 
@@ -27,7 +36,21 @@ typedef struct {
     spi_device_handle_t spi_device;
     uint32_t strip_len;
     uint8_t bytes_per_pixel;
+    uint8_t buf_bytes_per_color; // bytes that one color byte takes in the pixel buffer: 1 for raw pixels, 2 for 16-bit ones, 3 for encoded ones
     led_color_component_format_t component_fmt;
+    uint32_t chunk_leds;        // LEDs per chunk in lazy encoding mode, 0 if the whole strip is kept encoded
+    led_strip_color_lut_t color_lut; // only applied in lazy encoding mode
+    led_strip_power_t power;    // only tracked in lazy encoding mode
+    uint8_t *chunk_buf[SPI_CHUNK_NUM];
+    uint8_t next_chunk;
+    uint8_t trans_pending;      // number of queued transactions whose result hasn't been fetched
+    spi_transaction_t tx_trans[SPI_CHUNK_NUM]; // must stay valid until the queued transaction is done
+    uint32_t frames;            // lazy encoding mode: frames refreshed
+    uint32_t underruns;         // lazy encoding mode: times the line went idle in the middle of a frame
+    uint32_t restarts;          // lazy encoding mode: frames sent again from the start after an underrun
+    uint16_t *pixel_buf16;      // high depth mode: 16 bits per color component, pixel_buf is not used
+    uint8_t *dither_residual;   // high depth mode: fraction not sent yet, one per color component
+    uint8_t *dither_buf;        // high depth mode: dithered bytes of the chunk being encoded
     uint8_t pixel_buf[];
 } led_strip_spi_obj;
 
@@ -47,21 +70,112 @@ static void __led_strip_spi_bit(uint8_t data, uint8_t *buf)
     *(buf + 0) |= data & BIT(7) ? BIT(7) | BIT(6) : BIT(7);
 }
 
+// SPI pattern of every color byte value, generated once from __led_strip_spi_bit
+static uint8_t s_spi_pattern_lut[256][SPI_BYTES_PER_COLOR_BYTE];
+static bool s_spi_pattern_lut_ready = false;
+
+static void led_strip_spi_init_lut(void)
+{
+    if (s_spi_pattern_lut_ready) {
+        return;
+    }
+    for (int data = 0; data < 256; data++) {
+        memset(s_spi_pattern_lut[data], 0, SPI_BYTES_PER_COLOR_BYTE);
+        __led_strip_spi_bit(data, s_spi_pattern_lut[data]);
+    }
+    s_spi_pattern_lut_ready = true;
+}
+
+// write the SPI pattern of one color byte, no need to zero-initialize the buf
+static inline void led_strip_spi_put(uint8_t data, uint8_t *buf)
+{
+    const uint8_t *pattern = s_spi_pattern_lut[data];
+    buf[0] = pattern[0];
+    buf[1] = pattern[1];
+    buf[2] = pattern[2];
+}
+
+// write the SPI pattern of the same color byte for `len` bytes: one pattern, then keep doubling with memcpy
+static void led_strip_spi_fill_bytes(uint8_t data, size_t len, uint8_t *buf)
+{
+    size_t total = len * SPI_BYTES_PER_COLOR_BYTE;
+    if (total == 0) {
+        return;
+    }
+    led_strip_spi_put(data, buf);
+    size_t filled = SPI_BYTES_PER_COLOR_BYTE;
+    while (filled < total) {
+        size_t chunk = filled < total - filled ? filled : total - filled;
+        memcpy(buf + filled, buf, chunk);
+        filled += chunk;
+    }
+}
+
+// convert a span of color bytes (already in wire order) to SPI patterns
+static void led_strip_spi_encode_bytes(const uint8_t *data, size_t len, uint8_t *buf)
+{
+    for (size_t i = 0; i < len; i++) {
+        led_strip_spi_put(data[i], buf);
+        buf += SPI_BYTES_PER_COLOR_BYTE;
+    }
+}
+
+// same as led_strip_spi_encode_bytes, passing every byte through the color table first
+static void led_strip_spi_encode_bytes_lut(const uint8_t *data, size_t len, const uint8_t *table, uint8_t *buf)
+{
+    for (size_t i = 0; i < len; i++) {
+        led_strip_spi_put(table[data[i]], buf);
+        buf += SPI_BYTES_PER_COLOR_BYTE;
+    }
+}
+
+// store one color byte to the pixel buffer, `byte_index` counts color bytes from the start of the strip
+static inline void led_strip_spi_store(led_strip_spi_obj *spi_strip, uint32_t byte_index, uint8_t data)
+{
+    led_strip_power_t *power = &spi_strip->power;
+    if (spi_strip->pixel_buf16) {
+        // 0xFF expands to 0xFFFF, so full scale stays full scale
+        uint16_t value = data * 257;
+        power->channel_sum = power->channel_sum - spi_strip->pixel_buf16[byte_index] + value;
+        spi_strip->pixel_buf16[byte_index] = value;
+    } else if (spi_strip->chunk_leds) {
+        power->channel_sum = power->channel_sum - spi_strip->pixel_buf[byte_index] + data;
+        spi_strip->pixel_buf[byte_index] = data;
+    } else {
+        led_strip_spi_put(data, &spi_strip->pixel_buf[byte_index * SPI_BYTES_PER_COLOR_BYTE]);
+    }
+}
+
+// start of the pixel buffer in use, a pixel takes `bytes_per_pixel * buf_bytes_per_color` bytes in it
+static inline uint8_t *led_strip_spi_buf(led_strip_spi_obj *spi_strip)
+{
+    return spi_strip->pixel_buf16 ? (uint8_t *)spi_strip->pixel_buf16 : spi_strip->pixel_buf;
+}
+
+// sum of the color components of `count` pixels from `start`, only valid in lazy encoding mode
+static uint32_t led_strip_spi_sum(led_strip_spi_obj *spi_strip, uint32_t start, uint32_t count)
+{
+    size_t offset = start * spi_strip->bytes_per_pixel;
+    size_t len = count * spi_strip->bytes_per_pixel;
+    if (spi_strip->pixel_buf16) {
+        return led_strip_power_sum16(spi_strip->pixel_buf16 + offset, len);
+    }
+    return led_strip_power_sum(spi_strip->pixel_buf + offset, len);
+}
+
 static esp_err_t led_strip_spi_set_pixel(led_strip_t *strip, uint32_t index, uint32_t red, uint32_t green, uint32_t blue)
 {
     led_strip_spi_obj *spi_strip = __containerof(strip, led_strip_spi_obj, base);
     ESP_RETURN_ON_FALSE(index < spi_strip->strip_len, ESP_ERR_INVALID_ARG, TAG, "index out of maximum number of LEDs");
-    // 3 pixels take 72bits(9bytes)
-    uint32_t start = index * spi_strip->bytes_per_pixel * SPI_BYTES_PER_COLOR_BYTE;
-    uint8_t *pixel_buf = spi_strip->pixel_buf;
+    // 3 pixels take 72bits(9bytes) once encoded
+    uint32_t start = index * spi_strip->bytes_per_pixel;
     led_color_component_format_t component_fmt = spi_strip->component_fmt;
-    memset(pixel_buf + start, 0, spi_strip->bytes_per_pixel * SPI_BYTES_PER_COLOR_BYTE);
 
-    __led_strip_spi_bit(red, &pixel_buf[start + SPI_BYTES_PER_COLOR_BYTE * component_fmt.format.r_pos]);
-    __led_strip_spi_bit(green, &pixel_buf[start + SPI_BYTES_PER_COLOR_BYTE * component_fmt.format.g_pos]);
-    __led_strip_spi_bit(blue, &pixel_buf[start + SPI_BYTES_PER_COLOR_BYTE * component_fmt.format.b_pos]);
+    led_strip_spi_store(spi_strip, start + component_fmt.format.r_pos, red);
+    led_strip_spi_store(spi_strip, start + component_fmt.format.g_pos, green);
+    led_strip_spi_store(spi_strip, start + component_fmt.format.b_pos, blue);
     if (component_fmt.format.num_components > 3) {
-        __led_strip_spi_bit(0, &pixel_buf[start + SPI_BYTES_PER_COLOR_BYTE * component_fmt.format.w_pos]);
+        led_strip_spi_store(spi_strip, start + component_fmt.format.w_pos, 0);
     }
 
     return ESP_OK;
@@ -74,42 +188,307 @@ static esp_err_t led_strip_spi_set_pixel_rgbw(led_strip_t *strip, uint32_t index
     ESP_RETURN_ON_FALSE(index < spi_strip->strip_len, ESP_ERR_INVALID_ARG, TAG, "index out of maximum number of LEDs");
     ESP_RETURN_ON_FALSE(component_fmt.format.num_components == 4, ESP_ERR_INVALID_ARG, TAG, "led doesn't have 4 components");
 
-    // LED_PIXEL_FORMAT_GRBW takes 96bits(12bytes)
-    uint32_t start = index * spi_strip->bytes_per_pixel * SPI_BYTES_PER_COLOR_BYTE;
-    uint8_t *pixel_buf = spi_strip->pixel_buf;
-    memset(pixel_buf + start, 0, spi_strip->bytes_per_pixel * SPI_BYTES_PER_COLOR_BYTE);
+    // LED_PIXEL_FORMAT_GRBW takes 96bits(12bytes) once encoded
+    uint32_t start = index * spi_strip->bytes_per_pixel;
 
-    __led_strip_spi_bit(red, &pixel_buf[start + SPI_BYTES_PER_COLOR_BYTE * component_fmt.format.r_pos]);
-    __led_strip_spi_bit(green, &pixel_buf[start + SPI_BYTES_PER_COLOR_BYTE * component_fmt.format.g_pos]);
-    __led_strip_spi_bit(blue, &pixel_buf[start + SPI_BYTES_PER_COLOR_BYTE * component_fmt.format.b_pos]);
-    __led_strip_spi_bit(white, &pixel_buf[start + SPI_BYTES_PER_COLOR_BYTE * component_fmt.format.w_pos]);
+    led_strip_spi_store(spi_strip, start + component_fmt.format.r_pos, red);
+    led_strip_spi_store(spi_strip, start + component_fmt.format.g_pos, green);
+    led_strip_spi_store(spi_strip, start + component_fmt.format.b_pos, blue);
+    led_strip_spi_store(spi_strip, start + component_fmt.format.w_pos, white);
 
     return ESP_OK;
 }
 
-static esp_err_t led_strip_spi_refresh(led_strip_t *strip)
+static esp_err_t led_strip_spi_set_pixels(led_strip_t *strip, uint32_t start, uint32_t count, const uint8_t *colors)
+{
+    led_strip_spi_obj *spi_strip = __containerof(strip, led_strip_spi_obj, base);
+    ESP_RETURN_ON_FALSE(start <= spi_strip->strip_len && count <= spi_strip->strip_len - start, ESP_ERR_INVALID_ARG, TAG,
+                        "pixel range out of maximum number of LEDs");
+
+    led_color_component_format_t component_fmt = spi_strip->component_fmt;
+    uint8_t bytes_per_pixel = spi_strip->bytes_per_pixel;
+    uint32_t r_offset = component_fmt.format.r_pos;
+    uint32_t g_offset = component_fmt.format.g_pos;
+    uint32_t b_offset = component_fmt.format.b_pos;
+    uint32_t w_offset = component_fmt.format.w_pos;
+    uint32_t byte_index = start * bytes_per_pixel;
+
+    // input order matches the wire order (RGB/RGBW), convert the whole span at once
+    if (!spi_strip->pixel_buf16 && r_offset == 0 && g_offset == 1 && b_offset == 2 && (bytes_per_pixel == 3 || w_offset == 3)) {
+        if (spi_strip->chunk_leds) {
+            size_t len = count * bytes_per_pixel;
+            spi_strip->power.channel_sum = spi_strip->power.channel_sum - led_strip_power_sum(spi_strip->pixel_buf + byte_index, len) +
+                                           led_strip_power_sum(colors, len);
+            memcpy(spi_strip->pixel_buf + byte_index, colors, len);
+        } else {
+            led_strip_spi_encode_bytes(colors, count * bytes_per_pixel, spi_strip->pixel_buf + byte_index * SPI_BYTES_PER_COLOR_BYTE);
+        }
+        return ESP_OK;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        led_strip_spi_store(spi_strip, byte_index + r_offset, colors[0]);
+        led_strip_spi_store(spi_strip, byte_index + g_offset, colors[1]);
+        led_strip_spi_store(spi_strip, byte_index + b_offset, colors[2]);
+        if (bytes_per_pixel > 3) {
+            led_strip_spi_store(spi_strip, byte_index + w_offset, colors[3]);
+        }
+        byte_index += bytes_per_pixel;
+        colors += bytes_per_pixel;
+    }
+
+    return ESP_OK;
+}
+
+// copy pixel `start` over the following pixels, keep doubling the filled part with memcpy
+static void led_strip_spi_repeat_pixel(led_strip_spi_obj *spi_strip, uint32_t start, uint32_t count)
+{
+    if (spi_strip->chunk_leds) {
+        led_strip_power_t *power = &spi_strip->power;
+        uint32_t pixel_sum = led_strip_spi_sum(spi_strip, start, 1);
+        if (count == spi_strip->strip_len) {
+            power->channel_sum = pixel_sum * count;
+        } else {
+            // only the overwritten range is read, the first pixel is already accounted for
+            power->channel_sum = power->channel_sum - led_strip_spi_sum(spi_strip, start + 1, count - 1) + pixel_sum * (count - 1);
+        }
+    }
+
+    size_t pixel_size = spi_strip->bytes_per_pixel * spi_strip->buf_bytes_per_color;
+    uint8_t *buf = led_strip_spi_buf(spi_strip) + start * pixel_size;
+    size_t total = count * pixel_size;
+    size_t filled = pixel_size;
+    while (filled < total) {
+        size_t chunk = filled < total - filled ? filled : total - filled;
+        memcpy(buf + filled, buf, chunk);
+        filled += chunk;
+    }
+}
+
+static esp_err_t led_strip_spi_fill(led_strip_t *strip, uint32_t start, uint32_t count, uint32_t red, uint32_t green, uint32_t blue)
+{
+    led_strip_spi_obj *spi_strip = __containerof(strip, led_strip_spi_obj, base);
+    ESP_RETURN_ON_FALSE(start <= spi_strip->strip_len && count <= spi_strip->strip_len - start, ESP_ERR_INVALID_ARG, TAG,
+                        "pixel range out of maximum number of LEDs");
+    if (count == 0) {
+        return ESP_OK;
+    }
+
+    // encode the first pixel, then keep doubling the filled part with memcpy
+    ESP_RETURN_ON_ERROR(led_strip_spi_set_pixel(strip, start, red, green, blue), TAG, "set first pixel failed");
+    led_strip_spi_repeat_pixel(spi_strip, start, count);
+
+    return ESP_OK;
+}
+
+static esp_err_t led_strip_spi_set_pixels16(led_strip_t *strip, uint32_t start, uint32_t count, const uint16_t *colors)
+{
+    led_strip_spi_obj *spi_strip = __containerof(strip, led_strip_spi_obj, base);
+    ESP_RETURN_ON_FALSE(start <= spi_strip->strip_len && count <= spi_strip->strip_len - start, ESP_ERR_INVALID_ARG, TAG,
+                        "pixel range out of maximum number of LEDs");
+
+    led_color_component_format_t component_fmt = spi_strip->component_fmt;
+    uint16_t *pixel = spi_strip->pixel_buf16 + start * spi_strip->bytes_per_pixel;
+    size_t len = count * spi_strip->bytes_per_pixel;
+    spi_strip->power.channel_sum = spi_strip->power.channel_sum - led_strip_power_sum16(pixel, len) + led_strip_power_sum16(colors, len);
+    for (uint32_t i = 0; i < count; i++) {
+        pixel[component_fmt.format.r_pos] = colors[0];
+        pixel[component_fmt.format.g_pos] = colors[1];
+        pixel[component_fmt.format.b_pos] = colors[2];
+        if (component_fmt.format.num_components > 3) {
+            pixel[component_fmt.format.w_pos] = colors[3];
+        }
+        pixel += spi_strip->bytes_per_pixel;
+        colors += spi_strip->bytes_per_pixel;
+    }
+
+    return ESP_OK;
+}
+
+static esp_err_t led_strip_spi_fill16(led_strip_t *strip, uint32_t start, uint32_t count, uint16_t red, uint16_t green, uint16_t blue)
+{
+    led_strip_spi_obj *spi_strip = __containerof(strip, led_strip_spi_obj, base);
+    ESP_RETURN_ON_FALSE(start <= spi_strip->strip_len && count <= spi_strip->strip_len - start, ESP_ERR_INVALID_ARG, TAG,
+                        "pixel range out of maximum number of LEDs");
+    if (count == 0) {
+        return ESP_OK;
+    }
+
+    uint16_t color[4] = {red, green, blue, 0};
+    led_strip_spi_set_pixels16(strip, start, 1, color);
+    led_strip_spi_repeat_pixel(spi_strip, start, count);
+
+    return ESP_OK;
+}
+
+static esp_err_t led_strip_spi_mirror(led_strip_t *strip, const led_strip_t *src)
 {
     led_strip_spi_obj *spi_strip = __containerof(strip, led_strip_spi_obj, base);
-    spi_transaction_t tx_conf;
-    memset(&tx_conf, 0, sizeof(tx_conf));
+    const led_strip_spi_obj *src_strip = __containerof(src, led_strip_spi_obj, base);
+    ESP_RETURN_ON_FALSE(src_strip->strip_len == spi_strip->strip_len &&
+                        src_strip->component_fmt.format_id == spi_strip->component_fmt.format_id &&
+                        src_strip->buf_bytes_per_color == spi_strip->buf_bytes_per_color,
+                        ESP_ERR_INVALID_ARG, TAG, "strips have different length, color format or encoding mode");
+
+    // both buffers use the same layout (raw, 16-bit or already encoded), copying them is enough
+    memcpy(led_strip_spi_buf(spi_strip), led_strip_spi_buf((led_strip_spi_obj *)src_strip), spi_strip->strip_len * spi_strip->bytes_per_pixel * spi_strip->buf_bytes_per_color);
+    spi_strip->power.channel_sum = src_strip->power.channel_sum;
+    return ESP_OK;
+}
 
-    tx_conf.length = spi_strip->strip_len * spi_strip->bytes_per_pixel * SPI_BITS_PER_COLOR_BYTE;
-    tx_conf.tx_buffer = spi_strip->pixel_buf;
-    tx_conf.rx_buffer = NULL;
-    ESP_RETURN_ON_ERROR(spi_device_transmit(spi_strip->spi_device, &tx_conf), TAG, "transmit pixels by SPI failed");
+static esp_err_t led_strip_spi_wait_refresh_done(led_strip_t *strip, int32_t timeout_ms)
+{
+    led_strip_spi_obj *spi_strip = __containerof(strip, led_strip_spi_obj, base);
+    TickType_t ticks_to_wait = timeout_ms < 0 ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+    spi_transaction_t *done_trans = NULL;
 
+    while (spi_strip->trans_pending) {
+        esp_err_t ret = spi_device_get_trans_result(spi_strip->spi_device, &done_trans, ticks_to_wait);
+        if (ret == ESP_ERR_TIMEOUT) {
+            return ret;
+        }
+        ESP_RETURN_ON_ERROR(ret, TAG, "get SPI transaction result failed");
+        spi_strip->trans_pending--;
+    }
     return ESP_OK;
 }
 
+// encode `len` color bytes from `offset` into the chunk buffer of `slot`, and prepare its transaction
+static void led_strip_spi_encode_chunk(led_strip_spi_obj *spi_strip, uint8_t slot, size_t offset, size_t len)
+{
+    const uint8_t *table = led_strip_color_lut_table(&spi_strip->color_lut);
+    spi_transaction_t *tx_conf = &spi_strip->tx_trans[slot];
+
+    if (spi_strip->pixel_buf16) {
+        led_strip_dither_encode(spi_strip->pixel_buf16 + offset, spi_strip->dither_residual + offset,
+                                led_strip_color_lut_curve(&spi_strip->color_lut), spi_strip->dither_buf, len);
+        led_strip_spi_encode_bytes(spi_strip->dither_buf, len, spi_strip->chunk_buf[slot]);
+    } else if (table) {
+        led_strip_spi_encode_bytes_lut(spi_strip->pixel_buf + offset, len, table, spi_strip->chunk_buf[slot]);
+    } else {
+        led_strip_spi_encode_bytes(spi_strip->pixel_buf + offset, len, spi_strip->chunk_buf[slot]);
+    }
+    memset(tx_conf, 0, sizeof(spi_transaction_t));
+    tx_conf->length = len * SPI_BITS_PER_COLOR_BYTE;
+    tx_conf->tx_buffer = spi_strip->chunk_buf[slot];
+}
+
+static esp_err_t led_strip_spi_queue_chunk(led_strip_spi_obj *spi_strip, uint8_t slot)
+{
+    ESP_RETURN_ON_ERROR(spi_device_queue_trans(spi_strip->spi_device, &spi_strip->tx_trans[slot], portMAX_DELAY), TAG, "transmit pixels by SPI failed");
+    spi_strip->trans_pending++;
+    return ESP_OK;
+}
+
+// fetch the results of the chunks already sent, without waiting
+static void led_strip_spi_collect_done(led_strip_spi_obj *spi_strip)
+{
+    spi_transaction_t *done_trans = NULL;
+    while (spi_strip->trans_pending && spi_device_get_trans_result(spi_strip->spi_device, &done_trans, 0) == ESP_OK) {
+        spi_strip->trans_pending--;
+    }
+}
+
+// encode the raw pixels chunk by chunk, while the chunks before them are being transmitted
+// the first SPI_CHUNK_LEAD chunks are encoded before the transfer starts, so while a chunk is encoded,
+// one chunk is on the wire and another one is queued behind it
+// if all queued chunks are done before the next one is queued, the line has been idle in the middle of the frame
+// and the strip may have latched a partial frame, so the frame is sent again from the start after a reset
+// returns once the last chunk is queued, so the raw pixels can be changed again
+static esp_err_t led_strip_spi_refresh_chunked(led_strip_spi_obj *spi_strip)
+{
+    size_t total = spi_strip->strip_len * spi_strip->bytes_per_pixel;
+    size_t chunk_size = spi_strip->chunk_leds * spi_strip->bytes_per_pixel;
+    spi_transaction_t *done_trans = NULL;
+    int restarts = 0;
+
+    spi_strip->frames++;
+restart:
+    // the previous frame is done, all the chunks are free
+    spi_strip->next_chunk = 0;
+    size_t offset = 0;
+    for (uint8_t slot = 0; slot < SPI_CHUNK_LEAD && offset < total; slot++) {
+        size_t len = total - offset < chunk_size ? total - offset : chunk_size;
+        led_strip_spi_encode_chunk(spi_strip, slot, offset, len);
+        offset += len;
+        spi_strip->next_chunk = slot + 1;
+    }
+    for (uint8_t slot = 0; slot < spi_strip->next_chunk; slot++) {
+        ESP_RETURN_ON_ERROR(led_strip_spi_queue_chunk(spi_strip, slot), TAG, "queue chunk failed");
+    }
+
+    while (offset < total) {
+        // all chunks are in flight, the oldest one must finish before it can be encoded again
+        if (spi_strip->trans_pending == SPI_CHUNK_NUM) {
+            ESP_RETURN_ON_ERROR(spi_device_get_trans_result(spi_strip->spi_device, &done_trans, portMAX_DELAY), TAG, "get SPI transaction result failed");
+            spi_strip->trans_pending--;
+        }
+        uint8_t slot = spi_strip->next_chunk;
+        size_t len = total - offset < chunk_size ? total - offset : chunk_size;
+        led_strip_spi_encode_chunk(spi_strip, slot, offset, len);
+
+        led_strip_spi_collect_done(spi_strip);
+        if (spi_strip->trans_pending == 0) {
+            spi_strip->underruns++;
+            if (restarts < LED_STRIP_SPI_MAX_RESTARTS) {
+                restarts++;
+                spi_strip->restarts++;
+                // make sure the strip has latched the partial frame, so the next one starts from the first LED
+                // in high depth mode the chunks sent already are dithered once more, which only moves their residual on
+                esp_rom_delay_us(LED_STRIP_SPI_RESET_US);
+                goto restart;
+            }
+        }
+        ESP_RETURN_ON_ERROR(led_strip_spi_queue_chunk(spi_strip, slot), TAG, "queue chunk failed");
+        spi_strip->next_chunk = (slot + 1) % SPI_CHUNK_NUM;
+        offset += len;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t led_strip_spi_refresh_async(led_strip_t *strip)
+{
+    led_strip_spi_obj *spi_strip = __containerof(strip, led_strip_spi_obj, base);
+    spi_transaction_t *tx_conf = &spi_strip->tx_trans[0];
+
+    // the transaction descriptors are reused, so the previous frame must be done first
+    ESP_RETURN_ON_ERROR(led_strip_spi_wait_refresh_done(strip, -1), TAG, "wait previous refresh failed");
+    if (spi_strip->chunk_leds) {
+        // estimate the draw of the frame and fold the limiter scale into the color table
+        uint8_t limit = led_strip_power_update(&spi_strip->power, spi_strip->color_lut.brightness);
+        led_strip_color_lut_set_limit(&spi_strip->color_lut, limit);
+        return led_strip_spi_refresh_chunked(spi_strip);
+    }
+    memset(tx_conf, 0, sizeof(spi_transaction_t));
+    tx_conf->length = spi_strip->strip_len * spi_strip->bytes_per_pixel * SPI_BITS_PER_COLOR_BYTE;
+    tx_conf->tx_buffer = spi_strip->pixel_buf;
+    tx_conf->rx_buffer = NULL;
+    ESP_RETURN_ON_ERROR(spi_device_queue_trans(spi_strip->spi_device, tx_conf, portMAX_DELAY), TAG, "transmit pixels by SPI failed");
+    spi_strip->trans_pending = 1;
+
+    return ESP_OK;
+}
+
+static esp_err_t led_strip_spi_refresh(led_strip_t *strip)
+{
+    ESP_RETURN_ON_ERROR(led_strip_spi_refresh_async(strip), TAG, "start refresh failed");
+    return led_strip_spi_wait_refresh_done(strip, -1);
+}
+
 static esp_err_t led_strip_spi_clear(led_strip_t *strip)
 {
     led_strip_spi_obj *spi_strip = __containerof(strip, led_strip_spi_obj, base);
+    // Don't touch the pixel buffer while it's being transmitted
+    ESP_RETURN_ON_ERROR(led_strip_spi_wait_refresh_done(strip, -1), TAG, "wait previous refresh failed");
     //Write zero to turn off all leds
-    memset(spi_strip->pixel_buf, 0, spi_strip->strip_len * spi_strip->bytes_per_pixel * SPI_BYTES_PER_COLOR_BYTE);
-    uint8_t *buf = spi_strip->pixel_buf;
-    for (int index = 0; index < spi_strip->strip_len * spi_strip->bytes_per_pixel; index++) {
-        __led_strip_spi_bit(0, buf);
-        buf += SPI_BYTES_PER_COLOR_BYTE;
+    spi_strip->power.channel_sum = 0;
+    if (spi_strip->pixel_buf16) {
+        memset(spi_strip->pixel_buf16, 0, spi_strip->strip_len * spi_strip->bytes_per_pixel * sizeof(uint16_t));
+        memset(spi_strip->dither_residual, 0, spi_strip->strip_len * spi_strip->bytes_per_pixel);
+    } else if (spi_strip->chunk_leds) {
+        memset(spi_strip->pixel_buf, 0, spi_strip->strip_len * spi_strip->bytes_per_pixel);
+    } else {
+        led_strip_spi_fill_bytes(0, spi_strip->strip_len * spi_strip->bytes_per_pixel, spi_strip->pixel_buf);
     }
 
     return led_strip_spi_refresh(strip);
@@ -119,13 +498,47 @@ static esp_err_t led_strip_spi_del(led_strip_t *strip)
 {
     led_strip_spi_obj *spi_strip = __containerof(strip, led_strip_spi_obj, base);
 
+    ESP_RETURN_ON_ERROR(led_strip_spi_wait_refresh_done(strip, -1), TAG, "wait previous refresh failed");
     ESP_RETURN_ON_ERROR(spi_bus_remove_device(spi_strip->spi_device), TAG, "delete spi device failed");
     ESP_RETURN_ON_ERROR(spi_bus_free(spi_strip->spi_host), TAG, "free spi bus failed");
 
+    for (int i = 0; i < SPI_CHUNK_NUM; i++) {
+        free(spi_strip->chunk_buf[i]);
+    }
+    free(spi_strip->pixel_buf16);
+    free(spi_strip->dither_residual);
+    free(spi_strip->dither_buf);
+    free(spi_strip->color_lut.curve);
     free(spi_strip);
     return ESP_OK;
 }
 
+static led_strip_color_lut_t *led_strip_spi_get_color_lut(led_strip_t *strip)
+{
+    led_strip_spi_obj *spi_strip = __containerof(strip, led_strip_spi_obj, base);
+    // the pre-encoded buffer is written in set_pixel, there is no encode step left to apply the table
+    return spi_strip->chunk_leds ? &spi_strip->color_lut : NULL;
+}
+
+static led_strip_power_t *led_strip_spi_get_power(led_strip_t *strip)
+{
+    led_strip_spi_obj *spi_strip = __containerof(strip, led_strip_spi_obj, base);
+    // the pre-encoded buffer can't be summed cheaply
+    return spi_strip->chunk_leds ? &spi_strip->power : NULL;
+}
+
+esp_err_t led_strip_spi_get_chunk_stats(led_strip_handle_t strip, led_strip_spi_chunk_stats_t *ret_stats)
+{
+    ESP_RETURN_ON_FALSE(strip && ret_stats && strip->del == led_strip_spi_del, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    led_strip_spi_obj *spi_strip = __containerof(strip, led_strip_spi_obj, base);
+    ESP_RETURN_ON_FALSE(spi_strip->chunk_leds, ESP_ERR_INVALID_STATE, TAG, "strip is not in lazy encoding mode");
+
+    ret_stats->frames = spi_strip->frames;
+    ret_stats->underruns = spi_strip->underruns;
+    ret_stats->restarts = spi_strip->restarts;
+    return ESP_OK;
+}
+
 esp_err_t led_strip_new_spi_device(const led_strip_config_t *led_config, const led_strip_spi_config_t *spi_config, led_strip_handle_t *ret_strip)
 {
     led_strip_spi_obj *spi_strip = NULL;
@@ -149,16 +562,42 @@ esp_err_t led_strip_new_spi_device(const led_strip_config_t *led_config, const l
     } else {
         ESP_RETURN_ON_FALSE(false, ESP_ERR_INVALID_ARG, TAG, "invalid number of color components: %d", component_fmt.format.num_components);
     }
-    // TODO: we assume each color component is 8 bits, may need to support other configurations in the future, e.g. 10bits per color component?
+    // each color component is sent as 8 bits, high depth mode keeps 16 bits in memory and dithers them at encode time
     uint8_t bytes_per_pixel = component_fmt.format.num_components;
     uint32_t mem_caps = MALLOC_CAP_DEFAULT;
     if (spi_config->flags.with_dma) {
         // DMA buffer must be placed in internal SRAM
         mem_caps |= MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA;
     }
-    spi_strip = heap_caps_calloc(1, sizeof(led_strip_spi_obj) + led_config->max_leds * bytes_per_pixel * SPI_BYTES_PER_COLOR_BYTE, mem_caps);
-
-    ESP_GOTO_ON_FALSE(spi_strip, ESP_ERR_NO_MEM, err, TAG, "no mem for spi strip");
+    led_strip_spi_init_lut();
+    uint32_t chunk_leds = spi_config->chunk_leds < led_config->max_leds ? spi_config->chunk_leds : led_config->max_leds;
+    bool high_depth = led_config->flags.high_depth;
+    // the pre-encoded buffer has no encode step left to dither at
+    ESP_GOTO_ON_FALSE(!high_depth || chunk_leds, ESP_ERR_NOT_SUPPORTED, err, TAG, "high depth mode requires chunk_leds");
+    if (chunk_leds) {
+        // only the chunks are transmitted, the raw pixels can stay in any memory
+        spi_strip = calloc(1, sizeof(led_strip_spi_obj) + (high_depth ? 0 : led_config->max_leds * bytes_per_pixel));
+        ESP_GOTO_ON_FALSE(spi_strip, ESP_ERR_NO_MEM, err, TAG, "no mem for spi strip");
+        for (int i = 0; i < SPI_CHUNK_NUM; i++) {
+            spi_strip->chunk_buf[i] = heap_caps_calloc(1, chunk_leds * bytes_per_pixel * SPI_BYTES_PER_COLOR_BYTE, mem_caps);
+            ESP_GOTO_ON_FALSE(spi_strip->chunk_buf[i], ESP_ERR_NO_MEM, err, TAG, "no mem for spi chunk");
+        }
+        if (high_depth) {
+            spi_strip->pixel_buf16 = calloc(led_config->max_leds * bytes_per_pixel, sizeof(uint16_t));
+            ESP_GOTO_ON_FALSE(spi_strip->pixel_buf16, ESP_ERR_NO_MEM, err, TAG, "no mem for 16-bit pixels");
+            spi_strip->dither_residual = calloc(led_config->max_leds, bytes_per_pixel);
+            ESP_GOTO_ON_FALSE(spi_strip->dither_residual, ESP_ERR_NO_MEM, err, TAG, "no mem for dither residual");
+            spi_strip->dither_buf = malloc(chunk_leds * bytes_per_pixel);
+            ESP_GOTO_ON_FALSE(spi_strip->dither_buf, ESP_ERR_NO_MEM, err, TAG, "no mem for dither chunk");
+        }
+    } else {
+        spi_strip = heap_caps_calloc(1, sizeof(led_strip_spi_obj) + led_config->max_leds * bytes_per_pixel * SPI_BYTES_PER_COLOR_BYTE, mem_caps);
+        ESP_GOTO_ON_FALSE(spi_strip, ESP_ERR_NO_MEM, err, TAG, "no mem for spi strip");
+    }
+    led_strip_color_lut_init(&spi_strip->color_lut);
+    if (high_depth) {
+        ESP_GOTO_ON_FALSE(led_strip_color_lut_alloc_curve(&spi_strip->color_lut), ESP_ERR_NO_MEM, err, TAG, "no mem for 16-bit color curve");
+    }
 
     spi_strip->spi_host = spi_config->spi_bus;
     // for backward compatibility, if the user does not set the clk_src, use the default value
@@ -174,7 +613,7 @@ esp_err_t led_strip_new_spi_device(const led_strip_config_t *led_config, const l
         .sclk_io_num = -1,
         .quadwp_io_num = -1,
         .quadhd_io_num = -1,
-        .max_transfer_sz = led_config->max_leds * bytes_per_pixel * SPI_BYTES_PER_COLOR_BYTE,
+        .max_transfer_sz = (chunk_leds ? chunk_leds : led_config->max_leds) * bytes_per_pixel * SPI_BYTES_PER_COLOR_BYTE,
     };
     ESP_GOTO_ON_ERROR(spi_bus_initialize(spi_strip->spi_host, &spi_bus_cfg, spi_config->flags.with_dma ? SPI_DMA_CH_AUTO : SPI_DMA_DISABLED), err, TAG, "create SPI bus failed");
 
@@ -208,11 +647,25 @@ esp_err_t led_strip_new_spi_device(const led_strip_config_t *led_config, const l
     spi_strip->component_fmt = component_fmt;
     spi_strip->bytes_per_pixel = bytes_per_pixel;
     spi_strip->strip_len = led_config->max_leds;
+    spi_strip->chunk_leds = chunk_leds;
+    led_strip_power_init(&spi_strip->power, high_depth ? 0xFFFF : 0xFF);
+    spi_strip->buf_bytes_per_color = high_depth ? sizeof(uint16_t) : chunk_leds ? 1 : SPI_BYTES_PER_COLOR_BYTE;
     spi_strip->base.set_pixel = led_strip_spi_set_pixel;
     spi_strip->base.set_pixel_rgbw = led_strip_spi_set_pixel_rgbw;
+    spi_strip->base.set_pixels = led_strip_spi_set_pixels;
+    spi_strip->base.fill = led_strip_spi_fill;
+    spi_strip->base.mirror = led_strip_spi_mirror;
     spi_strip->base.refresh = led_strip_spi_refresh;
+    spi_strip->base.refresh_async = led_strip_spi_refresh_async;
+    spi_strip->base.wait_refresh_done = led_strip_spi_wait_refresh_done;
     spi_strip->base.clear = led_strip_spi_clear;
     spi_strip->base.del = led_strip_spi_del;
+    spi_strip->base.get_color_lut = led_strip_spi_get_color_lut;
+    spi_strip->base.get_power = led_strip_spi_get_power;
+    if (high_depth) {
+        spi_strip->base.set_pixels16 = led_strip_spi_set_pixels16;
+        spi_strip->base.fill16 = led_strip_spi_fill16;
+    }
 
     *ret_strip = &spi_strip->base;
     return ESP_OK;
@@ -224,6 +677,13 @@ err:
         if (spi_strip->spi_host) {
             spi_bus_free(spi_strip->spi_host);
         }
+        for (int i = 0; i < SPI_CHUNK_NUM; i++) {
+            free(spi_strip->chunk_buf[i]);
+        }
+        free(spi_strip->pixel_buf16);
+        free(spi_strip->dither_residual);
+        free(spi_strip->dither_buf);
+        free(spi_strip->color_lut.curve);
         free(spi_strip);
     }
     return ret;
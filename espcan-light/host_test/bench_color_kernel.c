@@ -0,0 +1,189 @@
+// 定点颜色运算基准测试: color_kernel与原来效果中的浮点写法逐像素比较
+// 浮点写法取自改为定点之前的main.c (分段色环、c * fade、c * intensity)
+// 先检查定点结果与浮点结果的误差，再输出每像素耗时
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "host_test.h"
+#include "color_kernel.h"
+
+#define BENCH_LEDS 900
+#define BENCH_ITERATIONS 2000       // 每轮处理的帧数
+#define BENCH_ROUNDS 5
+#define BENCH_QUICK_ITERATIONS 20
+#define BENCH_FADE_LEN 20           // 爆炸的最大半径
+
+typedef struct {
+    uint8_t hue;
+    float intensity;                // 浮点呼吸亮度 (0-1)
+    uint16_t intensity16;           // 同一亮度的0.16定点值
+    uint8_t colors[BENCH_LEDS][3];  // 被缩放的颜色
+    uint8_t out[BENCH_LEDS][3];
+    uint16_t out16[BENCH_LEDS][3];
+} bench_ctx_t;
+
+typedef struct {
+    const char *name;
+    void (*float_fn)(void *arg);
+    void (*fixed_fn)(void *arg);
+} bench_kernel_t;
+
+// 原简化版HSV色环，每个像素分三段计算
+static void rainbow_float(void *arg)
+{
+    bench_ctx_t *ctx = arg;
+    for (int i = 0; i < BENCH_LEDS; i++) {
+        uint8_t pos = (i * 256 / BENCH_LEDS + ctx->hue) & 0xFF;
+        uint8_t *rgb = ctx->out[i];
+        if (pos < 85) {
+            rgb[0] = 255 - pos * 3;
+            rgb[1] = pos * 3;
+            rgb[2] = 0;
+        } else if (pos < 170) {
+            pos -= 85;
+            rgb[0] = 0;
+            rgb[1] = 255 - pos * 3;
+            rgb[2] = pos * 3;
+        } else {
+            pos -= 170;
+            rgb[0] = pos * 3;
+            rgb[1] = 0;
+            rgb[2] = 255 - pos * 3;
+        }
+    }
+    host_clobber(ctx->out);
+}
+
+static void rainbow_fixed(void *arg)
+{
+    bench_ctx_t *ctx = arg;
+    for (int i = 0; i < BENCH_LEDS; i++) {
+        uint8_t pos = (i * 256 / BENCH_LEDS + ctx->hue) & 0xFF;
+        const uint8_t *rgb = color_rainbow_palette[pos];
+        ctx->out[i][0] = rgb[0];
+        ctx->out[i][1] = rgb[1];
+        ctx->out[i][2] = rgb[2];
+    }
+    host_clobber(ctx->out);
+}
+
+// 流星尾部和爆炸的线性衰减: 每个像素一个衰减系数
+static void fade_float(void *arg)
+{
+    bench_ctx_t *ctx = arg;
+    for (int i = 0; i < BENCH_LEDS; i++) {
+        int d = i % (BENCH_FADE_LEN + 1);
+        float fade = 1.0f - (d / (float)BENCH_FADE_LEN);
+        ctx->out[i][0] = ctx->colors[i][0] * fade;
+        ctx->out[i][1] = ctx->colors[i][1] * fade;
+        ctx->out[i][2] = ctx->colors[i][2] * fade;
+    }
+    host_clobber(ctx->out);
+}
+
+static void fade_fixed(void *arg)
+{
+    bench_ctx_t *ctx = arg;
+    for (int i = 0; i < BENCH_LEDS; i++) {
+        int d = i % (BENCH_FADE_LEN + 1);
+        color_scale_rgb(ctx->colors[i], color_fade_q8(d, BENCH_FADE_LEN), ctx->out[i]);
+    }
+    host_clobber(ctx->out);
+}
+
+// 呼吸亮度缩放 (变色呼吸灯按调色板颜色缩放)，定点版输出16位
+static void breath_float(void *arg)
+{
+    bench_ctx_t *ctx = arg;
+    for (int i = 0; i < BENCH_LEDS; i++) {
+        ctx->out[i][0] = ctx->colors[i][0] * ctx->intensity;
+        ctx->out[i][1] = ctx->colors[i][1] * ctx->intensity;
+        ctx->out[i][2] = ctx->colors[i][2] * ctx->intensity;
+    }
+    host_clobber(ctx->out);
+}
+
+static void breath_fixed(void *arg)
+{
+    bench_ctx_t *ctx = arg;
+    for (int i = 0; i < BENCH_LEDS; i++) {
+        color_scale_rgb16(ctx->colors[i], ctx->intensity16, ctx->out16[i]);
+    }
+    host_clobber(ctx->out16);
+}
+
+static const bench_kernel_t bench_kernels[] = {
+    {"rainbow", rainbow_float, rainbow_fixed},
+    {"fade", fade_float, fade_fixed},
+    {"breath", breath_float, breath_fixed},
+};
+
+// 定点结果与浮点结果比较: 色环完全相同，衰减误差不超过1，呼吸按16位比较
+static void check_accuracy(bench_ctx_t *ctx)
+{
+    static uint8_t expected[BENCH_LEDS][3];
+    for (int hue = 0; hue < 256; hue += 5) {
+        ctx->hue = hue;
+        rainbow_float(ctx);
+        memcpy(expected, ctx->out, sizeof(expected));
+        rainbow_fixed(ctx);
+        HOST_CHECK(memcmp(expected, ctx->out, sizeof(expected)) == 0);
+    }
+
+    int fade_errors = 0;
+    for (int d = 0; d <= BENCH_FADE_LEN; d++) {
+        for (int c = 0; c < 256; c++) {
+            uint8_t rgb[3] = {c, c, c};
+            uint8_t out[3];
+            color_scale_rgb(rgb, color_fade_q8(d, BENCH_FADE_LEN), out);
+            int reference = (int)(c * (1.0f - (d / (float)BENCH_FADE_LEN)));
+            fade_errors += abs(out[0] - reference) > 1;
+        }
+    }
+    HOST_CHECK_EQ(fade_errors, 0);
+
+    int breath_errors = 0;
+    for (uint32_t t = 0; t <= 1000; t += 10) {
+        float level = t / 1000.0f;
+        uint16_t scale = color_breath16(t, 1000);
+        for (int c = 0; c < 256; c++) {
+            uint8_t rgb[3] = {c, c, c};
+            uint16_t out[3];
+            color_scale_rgb16(rgb, scale, out);
+            double reference = c * 257.0 * level * level;
+            // 平方和缩放各截断一次，16位分量误差不超过3 (不到8位的1/80)
+            breath_errors += abs(out[0] - (int)reference) > 3;
+        }
+    }
+    HOST_CHECK_EQ(breath_errors, 0);
+}
+
+int main(int argc, char **argv)
+{
+    static bench_ctx_t ctx;
+    bool quick = host_bench_quick(argc, argv);
+    uint32_t iterations = quick ? BENCH_QUICK_ITERATIONS : BENCH_ITERATIONS;
+    int rounds = quick ? 1 : BENCH_ROUNDS;
+
+    color_kernel_init();
+    for (int i = 0; i < BENCH_LEDS; i++) {
+        const uint8_t *rgb = color_rainbow_palette[i & 0xFF];
+        ctx.colors[i][0] = rgb[0];
+        ctx.colors[i][1] = rgb[1];
+        ctx.colors[i][2] = rgb[2];
+    }
+    check_accuracy(&ctx);
+
+    ctx.hue = 37;
+    ctx.intensity = 0.6f * 0.6f;
+    ctx.intensity16 = color_breath16(600, 1000);
+    printf("%-8s %14s %14s %8s\n", "kernel", "float ns/pixel", "fixed ns/pixel", "speedup");
+    for (size_t k = 0; k < sizeof(bench_kernels) / sizeof(bench_kernels[0]); k++) {
+        const bench_kernel_t *kernel = &bench_kernels[k];
+        double float_ns = host_bench_run(kernel->float_fn, &ctx, iterations, rounds) / BENCH_LEDS;
+        double fixed_ns = host_bench_run(kernel->fixed_fn, &ctx, iterations, rounds) / BENCH_LEDS;
+        printf("%-8s %14.2f %14.2f %7.2fx\n", kernel->name, float_ns, fixed_ns, float_ns / fixed_ns);
+    }
+    return host_test_finish("bench_color_kernel");
+}
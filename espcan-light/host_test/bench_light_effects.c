@@ -0,0 +1,115 @@
+// 灯光效果基准测试: 效果绘制 + 合成器上传到两条内存灯带 (镜像同一画布，与main.c的布局相同)
+// 输出每个效果在不同灯带长度下的帧率、每像素耗时和每帧内存分配次数 (按效果函数的调用次数计)
+
+#include <stdio.h>
+#include <stdint.h>
+#include "host_test.h"
+#include "mock_led_strip.h"
+#include "compositor.h"
+#include "color_kernel.h"
+#include "light_effects.h"
+
+#define BENCH_SEED 0x12345678
+#define BENCH_FRAME_MS 30           // 每帧经过的时间 (与录制标准帧相同)
+#define BENCH_BRIGHTNESS 200
+#define BENCH_SPEED 128
+#define BENCH_FRAMES 1000           // 每轮的帧数
+#define BENCH_ROUNDS 5              // 取最快的一轮
+#define BENCH_QUICK_FRAMES 50
+#define BENCH_WARMUP_FRAMES 10      // 不计时的帧: 首帧可能分配中间缓冲区
+
+static const uint32_t bench_led_counts[] = {200, 900, 1800};
+
+typedef struct {
+    const char *name;
+    void (*render)(uint32_t elapsed_ms);
+} bench_effect_t;
+
+static void meteor_shower_bench(uint32_t elapsed_ms)
+{
+    meteor_shower_effect(elapsed_ms, BENCH_BRIGHTNESS);
+}
+
+static void random_explosion_bench(uint32_t elapsed_ms)
+{
+    random_explosion_effect(elapsed_ms, BENCH_BRIGHTNESS);
+}
+
+static void breathing_light_bench(uint32_t elapsed_ms)
+{
+    breathing_light_effect(elapsed_ms, BENCH_BRIGHTNESS);
+}
+
+static const bench_effect_t bench_effects[] = {
+    {"rainbow", rainbow_effect},
+    {"lightning", lightning_effect},
+    {"purple_chase", purple_chase_effect},
+    {"meteor_shower", meteor_shower_bench},
+    {"random_explosion", random_explosion_bench},
+    {"breathing_light", breathing_light_bench},
+    {"color_changing_breathing", color_changing_breathing_effect},
+};
+
+static void render_frame(void *arg)
+{
+    const bench_effect_t *effect = arg;
+    effect->render(BENCH_FRAME_MS);
+}
+
+static void bench_layout(uint32_t leds, uint32_t frames, int rounds)
+{
+    led_strip_handle_t strips[2];
+    for (int i = 0; i < 2; i++) {
+        HOST_CHECK_EQ(mock_led_strip_new(leds, 3, true, &strips[i]), ESP_OK);
+    }
+    const compositor_segment_t layout[] = {
+        {.strip = 0, .strip_start = 0, .canvas_start = 0, .length = leds, .reversed = false},
+        {.strip = 1, .strip_start = 0, .canvas_start = 0, .length = leds, .reversed = false},
+    };
+    HOST_CHECK_EQ(compositor_init(strips, 2, leds, leds, layout, 2), ESP_OK);
+    compositor_set_high_depth(true);
+
+    for (size_t e = 0; e < sizeof(bench_effects) / sizeof(bench_effects[0]); e++) {
+        const bench_effect_t *effect = &bench_effects[e];
+        light_effects_reset(BENCH_SEED);
+        compositor_clear();
+        for (int i = 0; i < BENCH_WARMUP_FRAMES; i++) {
+            effect->render(BENCH_FRAME_MS);
+        }
+
+        uint32_t refreshes = mock_led_strip_refreshes(strips[0]);
+        uint64_t allocs = host_alloc_count();
+        double ns_per_frame = host_bench_run(render_frame, (void *)effect, frames, rounds);
+        uint32_t calls = frames * rounds;
+        allocs = host_alloc_count() - allocs;
+        refreshes = mock_led_strip_refreshes(strips[0]) - refreshes;
+
+        printf("%5lu  %-26s %10.0f %9.2f %12.2f\n", (unsigned long)leds, effect->name,
+               1e9 / ns_per_frame, ns_per_frame / leds, (double)allocs / calls);
+        // 每帧最多输出一次 (闪电在画面不变时不输出)，渲染循环中不分配内存
+        HOST_CHECK(refreshes > 0 && refreshes <= calls);
+        HOST_CHECK_EQ(allocs, 0);
+    }
+
+    for (int i = 0; i < 2; i++) {
+        led_strip_del(strips[i]);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    bool quick = host_bench_quick(argc, argv);
+    uint32_t frames = quick ? BENCH_QUICK_FRAMES : BENCH_FRAMES;
+    int rounds = quick ? 1 : BENCH_ROUNDS;
+
+    color_kernel_init();
+    random_effect.enabled = 1;
+    random_effect.speed = BENCH_SPEED;
+    random_effect.brightness = BENCH_BRIGHTNESS;
+
+    printf("%5s  %-26s %10s %9s %12s\n", "leds", "effect", "frames/s", "ns/pixel", "allocs/frame");
+    for (size_t i = 0; i < sizeof(bench_led_counts) / sizeof(bench_led_counts[0]); i++) {
+        bench_layout(bench_led_counts[i], frames, rounds);
+    }
+    return host_test_finish("bench_light_effects");
+}
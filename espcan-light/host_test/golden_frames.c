@@ -0,0 +1,341 @@
+// 标准帧录制与比对 - 在主机上以固定种子运行所有效果，比对每帧输出到灯带的像素
+//
+// 用法:
+//     golden_frames record <文件>          录制标准帧 (只在有意改变效果输出时重新录制)
+//     golden_frames check <文件>           重放并与标准帧比对，输出不一致的帧和每个效果的渲染耗时
+//     golden_frames dump <效果> <帧号>     以十六进制输出一帧的16位像素，用于定位不一致的像素
+//
+// 灯带布局与main.c相同: 两条900像素的high_depth灯带镜像同一画布，每帧的CRC32按顺序覆盖两条灯带的16位颜色
+// (合成器上传后的结果，包括纯色帧的16位填充)
+//
+// 文件格式 (小端):
+//     头部   "GFR2", 种子, 每效果帧数, 帧间隔ms, 每条灯带LED数, 记录数     (每项uint32)
+//     记录   效果编号(uint8), 帧号(uint16), CRC32(uint32), 渲染耗时ns(uint32)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "esp_rom_crc.h"
+#include "host_test.h"
+#include "mock_led_strip.h"
+#include "compositor.h"
+#include "color_kernel.h"
+#include "light_effects.h"
+
+#define GOLDEN_MAGIC "GFR2"
+#define GOLDEN_SEED 0x12345678
+#define GOLDEN_FRAMES 200
+#define GOLDEN_FRAME_MS 30
+#define GOLDEN_STRIP_LEDS 900
+#define GOLDEN_NUM_STRIPS 2
+#define GOLDEN_BRIGHTNESS 200       // 带亮度参数的效果使用的亮度
+#define GOLDEN_SPEED 128            // 随机效果使用的速度参数
+#define GOLDEN_HEADER_SIZE 24
+#define GOLDEN_RECORD_SIZE 11
+#define GOLDEN_SHOWN_MISMATCHES 10  // 每个效果最多列出的不一致帧
+
+// 录制的效果列表，编号即在表中的位置 (只能在末尾追加，以保持与已有标准帧文件兼容)
+typedef struct {
+    const char *name;
+    void (*render)(uint32_t elapsed_ms);
+} recorded_effect_t;
+
+static void meteor_shower_recorded(uint32_t elapsed_ms)
+{
+    meteor_shower_effect(elapsed_ms, GOLDEN_BRIGHTNESS);
+}
+
+static void random_explosion_recorded(uint32_t elapsed_ms)
+{
+    random_explosion_effect(elapsed_ms, GOLDEN_BRIGHTNESS);
+}
+
+static void breathing_light_recorded(uint32_t elapsed_ms)
+{
+    breathing_light_effect(elapsed_ms, GOLDEN_BRIGHTNESS);
+}
+
+static const recorded_effect_t recorded_effects[] = {
+    {"rainbow", rainbow_effect},
+    {"lightning", lightning_effect},
+    {"purple_chase", purple_chase_effect},
+    {"meteor_shower", meteor_shower_recorded},
+    {"random_explosion", random_explosion_recorded},
+    {"breathing_light", breathing_light_recorded},
+    {"color_changing_breathing", color_changing_breathing_effect},
+};
+
+#define RECORDED_EFFECT_COUNT ((int)(sizeof(recorded_effects) / sizeof(recorded_effects[0])))
+
+typedef struct {
+    uint32_t crc;
+    uint32_t render_ns;
+} frame_record_t;
+
+typedef struct {
+    uint32_t seed;
+    uint32_t frames;
+    uint32_t frame_ms;
+    uint32_t leds;
+    frame_record_t records[RECORDED_EFFECT_COUNT][GOLDEN_FRAMES];
+} recording_t;
+
+static led_strip_handle_t strips[GOLDEN_NUM_STRIPS];
+
+static void setup_strips(void)
+{
+    static const compositor_segment_t layout[] = {
+        {.strip = 0, .strip_start = 0, .canvas_start = 0, .length = GOLDEN_STRIP_LEDS, .reversed = false},
+        {.strip = 1, .strip_start = 0, .canvas_start = 0, .length = GOLDEN_STRIP_LEDS, .reversed = false},
+    };
+    for (int i = 0; i < GOLDEN_NUM_STRIPS; i++) {
+        ESP_ERROR_CHECK(mock_led_strip_new(GOLDEN_STRIP_LEDS, 3, true, &strips[i]));
+    }
+    ESP_ERROR_CHECK(compositor_init(strips, GOLDEN_NUM_STRIPS, GOLDEN_STRIP_LEDS, GOLDEN_STRIP_LEDS,
+                                    layout, sizeof(layout) / sizeof(layout[0])));
+    compositor_set_high_depth(true);
+    color_kernel_init();
+    random_effect.enabled = 1;
+    random_effect.speed = GOLDEN_SPEED;
+    random_effect.brightness = GOLDEN_BRIGHTNESS;
+}
+
+static uint32_t strips_crc(void)
+{
+    uint32_t crc = 0;
+    for (int i = 0; i < GOLDEN_NUM_STRIPS; i++) {
+        crc = esp_rom_crc32_le(crc, (const uint8_t *)mock_led_strip_pixels16(strips[i]),
+                               GOLDEN_STRIP_LEDS * 3 * sizeof(uint16_t));
+    }
+    return crc;
+}
+
+// 从头运行一个效果，每帧调用on_frame (返回false时停止)
+static void replay_effect(int effect, bool (*on_frame)(int effect, uint32_t frame, uint32_t render_ns, void *ctx), void *ctx)
+{
+    light_effects_reset(GOLDEN_SEED);
+    compositor_clear();
+    for (int i = 0; i < GOLDEN_NUM_STRIPS; i++) {
+        led_strip_clear(strips[i]);
+    }
+    for (uint32_t frame = 0; frame < GOLDEN_FRAMES; frame++) {
+        uint64_t start = host_now_ns();
+        recorded_effects[effect].render(GOLDEN_FRAME_MS);
+        uint32_t render_ns = (uint32_t)(host_now_ns() - start);
+        if (!on_frame(effect, frame, render_ns, ctx)) {
+            return;
+        }
+    }
+}
+
+static bool record_frame(int effect, uint32_t frame, uint32_t render_ns, void *ctx)
+{
+    recording_t *rec = ctx;
+    rec->records[effect][frame] = (frame_record_t) {
+        .crc = strips_crc(),
+        .render_ns = render_ns,
+    };
+    return true;
+}
+
+static void run_all(recording_t *rec)
+{
+    rec->seed = GOLDEN_SEED;
+    rec->frames = GOLDEN_FRAMES;
+    rec->frame_ms = GOLDEN_FRAME_MS;
+    rec->leds = GOLDEN_STRIP_LEDS;
+    for (int effect = 0; effect < RECORDED_EFFECT_COUNT; effect++) {
+        replay_effect(effect, record_frame, rec);
+    }
+}
+
+static void put_u32(uint8_t *p, uint32_t v)
+{
+    p[0] = v;
+    p[1] = v >> 8;
+    p[2] = v >> 16;
+    p[3] = v >> 24;
+}
+
+static uint32_t get_u32(const uint8_t *p)
+{
+    return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static int save_recording(const recording_t *rec, const char *path)
+{
+    FILE *f = fopen(path, "wb");
+    if (f == NULL) {
+        perror(path);
+        return 1;
+    }
+    uint8_t header[GOLDEN_HEADER_SIZE];
+    memcpy(header, GOLDEN_MAGIC, 4);
+    put_u32(header + 4, rec->seed);
+    put_u32(header + 8, rec->frames);
+    put_u32(header + 12, rec->frame_ms);
+    put_u32(header + 16, rec->leds);
+    put_u32(header + 20, RECORDED_EFFECT_COUNT * rec->frames);
+    fwrite(header, 1, sizeof(header), f);
+    for (int effect = 0; effect < RECORDED_EFFECT_COUNT; effect++) {
+        for (uint32_t frame = 0; frame < rec->frames; frame++) {
+            uint8_t record[GOLDEN_RECORD_SIZE];
+            record[0] = effect;
+            record[1] = frame;
+            record[2] = frame >> 8;
+            put_u32(record + 3, rec->records[effect][frame].crc);
+            put_u32(record + 7, rec->records[effect][frame].render_ns);
+            fwrite(record, 1, sizeof(record), f);
+        }
+    }
+    return fclose(f) == 0 ? 0 : 1;
+}
+
+static int load_recording(recording_t *rec, const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        perror(path);
+        return 1;
+    }
+    uint8_t header[GOLDEN_HEADER_SIZE];
+    int ret = 1;
+    if (fread(header, 1, sizeof(header), f) != sizeof(header) || memcmp(header, GOLDEN_MAGIC, 4) != 0) {
+        fprintf(stderr, "%s: 不是标准帧文件\n", path);
+        goto out;
+    }
+    rec->seed = get_u32(header + 4);
+    rec->frames = get_u32(header + 8);
+    rec->frame_ms = get_u32(header + 12);
+    rec->leds = get_u32(header + 16);
+    if (rec->seed != GOLDEN_SEED || rec->frames != GOLDEN_FRAMES || rec->frame_ms != GOLDEN_FRAME_MS ||
+            rec->leds != GOLDEN_STRIP_LEDS) {
+        fprintf(stderr, "%s: 种子/帧数/帧间隔/LED数量与本程序不同，需要重新录制\n", path);
+        goto out;
+    }
+    memset(rec->records, 0xFF, sizeof(rec->records));
+    uint32_t count = get_u32(header + 20);
+    for (uint32_t i = 0; i < count; i++) {
+        uint8_t record[GOLDEN_RECORD_SIZE];
+        if (fread(record, 1, sizeof(record), f) != sizeof(record)) {
+            fprintf(stderr, "%s: 文件不完整\n", path);
+            goto out;
+        }
+        uint32_t frame = record[1] | record[2] << 8;
+        // 新增效果的帧在旧文件中不存在，比对时报告为不一致
+        if (record[0] < RECORDED_EFFECT_COUNT && frame < GOLDEN_FRAMES) {
+            rec->records[record[0]][frame].crc = get_u32(record + 3);
+            rec->records[record[0]][frame].render_ns = get_u32(record + 7);
+        }
+    }
+    ret = 0;
+out:
+    fclose(f);
+    return ret;
+}
+
+static int cmd_record(const char *path)
+{
+    static recording_t rec;
+    run_all(&rec);
+    if (save_recording(&rec, path) != 0) {
+        return 1;
+    }
+    printf("已保存 %d 个效果 x %d 帧的标准帧到 %s\n", RECORDED_EFFECT_COUNT, GOLDEN_FRAMES, path);
+    return 0;
+}
+
+static void frame_stats(const frame_record_t *records, uint32_t frames, double *avg_ns, uint32_t *max_ns)
+{
+    uint64_t sum = 0;
+    *max_ns = 0;
+    for (uint32_t i = 0; i < frames; i++) {
+        sum += records[i].render_ns;
+        *max_ns = records[i].render_ns > *max_ns ? records[i].render_ns : *max_ns;
+    }
+    *avg_ns = frames ? (double)sum / frames : 0;
+}
+
+static int cmd_check(const char *path)
+{
+    static recording_t golden;
+    static recording_t current;
+    if (load_recording(&golden, path) != 0) {
+        return 1;
+    }
+    run_all(&current);
+
+    // 渲染耗时为主机上的单帧耗时 (标准帧中的耗时来自录制时的机器)
+    printf("%-26s %6s %8s %20s %20s %8s\n", "效果", "帧数", "不一致", "标准 平均/最大ns", "当前 平均/最大ns", "加速");
+    for (int effect = 0; effect < RECORDED_EFFECT_COUNT; effect++) {
+        uint32_t mismatches[GOLDEN_SHOWN_MISMATCHES];
+        int num_mismatches = 0;
+        for (uint32_t frame = 0; frame < GOLDEN_FRAMES; frame++) {
+            if (current.records[effect][frame].crc != golden.records[effect][frame].crc) {
+                if (num_mismatches < GOLDEN_SHOWN_MISMATCHES) {
+                    mismatches[num_mismatches] = frame;
+                }
+                num_mismatches++;
+            }
+        }
+        double golden_avg, current_avg;
+        uint32_t golden_max, current_max;
+        frame_stats(golden.records[effect], GOLDEN_FRAMES, &golden_avg, &golden_max);
+        frame_stats(current.records[effect], GOLDEN_FRAMES, &current_avg, &current_max);
+        printf("%-26s %6d %8d %12.0f/%-7lu %12.0f/%-7lu %7.2fx\n", recorded_effects[effect].name, GOLDEN_FRAMES,
+               num_mismatches, golden_avg, (unsigned long)golden_max, current_avg, (unsigned long)current_max,
+               current_avg ? golden_avg / current_avg : 0);
+        if (num_mismatches) {
+            printf("    不一致的帧:");
+            for (int i = 0; i < num_mismatches && i < GOLDEN_SHOWN_MISMATCHES; i++) {
+                printf(" %lu", (unsigned long)mismatches[i]);
+            }
+            printf("%s (用dump %d <帧号>输出像素与改动前比对)\n", num_mismatches > GOLDEN_SHOWN_MISMATCHES ? " ..." : "", effect);
+        }
+        HOST_CHECK_EQ(num_mismatches, 0);
+    }
+    return host_test_finish("golden_frames");
+}
+
+static bool dump_frame(int effect, uint32_t frame, uint32_t render_ns, void *ctx)
+{
+    uint32_t wanted = *(const uint32_t *)ctx;
+    if (frame < wanted) {
+        return true;
+    }
+    for (int i = 0; i < GOLDEN_NUM_STRIPS; i++) {
+        const uint16_t *pixels = mock_led_strip_pixels16(strips[i]);
+        for (uint32_t led = 0; led < GOLDEN_STRIP_LEDS; led++) {
+            const uint16_t *rgb = &pixels[led * 3];
+            printf("%d %lu %04x %04x %04x\n", i, (unsigned long)led, rgb[0], rgb[1], rgb[2]);
+        }
+    }
+    return false;
+}
+
+static int cmd_dump(int effect, uint32_t frame)
+{
+    if (effect < 0 || effect >= RECORDED_EFFECT_COUNT || frame >= GOLDEN_FRAMES) {
+        fprintf(stderr, "效果编号0-%d，帧号0-%d\n", RECORDED_EFFECT_COUNT - 1, GOLDEN_FRAMES - 1);
+        return 1;
+    }
+    replay_effect(effect, dump_frame, &frame);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    setup_strips();
+    if (argc == 3 && strcmp(argv[1], "record") == 0) {
+        return cmd_record(argv[2]);
+    }
+    if (argc == 3 && strcmp(argv[1], "check") == 0) {
+        return cmd_check(argv[2]);
+    }
+    if (argc == 4 && strcmp(argv[1], "dump") == 0) {
+        return cmd_dump(atoi(argv[2]), strtoul(argv[3], NULL, 0));
+    }
+    fprintf(stderr, "用法: %s record <文件> | check <文件> | dump <效果> <帧号>\n", argv[0]);
+    return 2;
+}
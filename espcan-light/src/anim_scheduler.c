@@ -0,0 +1,97 @@
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "anim_scheduler.h"
+
+static const uint32_t hist_limits_ms[ANIM_HIST_BUCKETS - 1] = ANIM_HIST_LIMITS_MS;
+
+void anim_scheduler_set_fps(anim_scheduler_t *sched, uint32_t fps)
+{
+    TickType_t period = pdMS_TO_TICKS(1000 / (fps ? fps : 1));
+    sched->period_ticks = period ? period : 1;
+    sched->last_wake = xTaskGetTickCount();
+    sched->last_frame_us = esp_timer_get_time();
+}
+
+void anim_scheduler_init(anim_scheduler_t *sched, uint32_t fps)
+{
+    memset(sched, 0, sizeof(anim_scheduler_t));
+    sched->task = xTaskGetCurrentTaskHandle();
+    anim_scheduler_set_fps(sched, fps);
+}
+
+uint32_t anim_scheduler_begin_frame(anim_scheduler_t *sched)
+{
+    int64_t now = esp_timer_get_time();
+    uint32_t elapsed_ms = (uint32_t)((now - sched->last_frame_us) / 1000);
+
+    sched->frame_start_us = now;
+    sched->last_frame_us = now;
+    return elapsed_ms;
+}
+
+void anim_scheduler_end_frame(anim_scheduler_t *sched)
+{
+    anim_stats_t *stats = &sched->stats;
+    uint32_t frame_us = (uint32_t)(esp_timer_get_time() - sched->frame_start_us);
+    uint32_t frame_ms = frame_us / 1000;
+
+    // 记录帧耗时分布
+    int bucket = 0;
+    while (bucket < ANIM_HIST_BUCKETS - 1 && frame_ms >= hist_limits_ms[bucket]) {
+        bucket++;
+    }
+    stats->frame_time_hist[bucket]++;
+    if (frame_us > stats->max_frame_us) {
+        stats->max_frame_us = frame_us;
+    }
+    stats->frames++;
+
+    TickType_t now = xTaskGetTickCount();
+    TickType_t next_wake = sched->last_wake + sched->period_ticks;
+
+    if ((int32_t)(now - next_wake) >= 0) {
+        // 已错过本帧截止时间
+        stats->missed_deadlines++;
+
+        // 落后超过一个周期: 跳过错过的周期，从当前时间重新对齐
+        TickType_t behind = now - next_wake;
+        if (behind >= sched->period_ticks) {
+            stats->skipped_frames += behind / sched->period_ticks;
+        }
+        sched->last_wake = now;
+        sched->wake_requested = false;
+        return;
+    }
+
+    // 等到下一个帧周期或被提前唤醒；其它来源的通知 (合成器) 只会让循环多检查一次
+    while (!sched->wake_requested) {
+        int32_t remaining = (int32_t)(next_wake - xTaskGetTickCount());
+        if (remaining <= 0) {
+            break;
+        }
+        ulTaskNotifyTake(pdTRUE, (TickType_t)remaining);
+    }
+
+    if (sched->wake_requested) {
+        sched->wake_requested = false;
+        sched->last_wake = xTaskGetTickCount();
+    } else {
+        sched->last_wake = next_wake;
+    }
+}
+
+void anim_scheduler_wake(anim_scheduler_t *sched)
+{
+    sched->wake_requested = true;
+    if (sched->task) {
+        xTaskNotifyGive(sched->task);
+    }
+}
+
+void anim_scheduler_take_stats(anim_scheduler_t *sched, anim_stats_t *stats)
+{
+    *stats = sched->stats;
+    memset(&sched->stats, 0, sizeof(anim_stats_t));
+}
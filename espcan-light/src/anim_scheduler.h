@@ -0,0 +1,93 @@
+#ifndef ANIM_SCHEDULER_H
+#define ANIM_SCHEDULER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 帧耗时分布的分桶上限 (毫秒)，最后一个桶统计超出所有上限的帧
+#define ANIM_HIST_BUCKETS 6
+#define ANIM_HIST_LIMITS_MS {10, 20, 30, 50, 100}
+
+// 动画调度统计
+typedef struct {
+    uint32_t frames;                               // 已渲染帧数
+    uint32_t missed_deadlines;                     // 渲染+发送超出帧周期的帧数
+    uint32_t skipped_frames;                       // 因超时被跳过的帧周期数
+    uint32_t max_frame_us;                         // 最长帧耗时
+    uint32_t frame_time_hist[ANIM_HIST_BUCKETS];   // 帧耗时分布
+} anim_stats_t;
+
+// 动画调度器: 以固定帧率驱动效果，按实际经过的时间推进动画
+typedef struct {
+    TickType_t period_ticks;    // 目标帧周期
+    TickType_t last_wake;       // 上一个帧周期的起点 (vTaskDelayUntil使用)
+    int64_t last_frame_us;      // 上一帧开始渲染的时间
+    int64_t frame_start_us;     // 当前帧开始渲染的时间
+    TaskHandle_t task;          // 渲染任务 (anim_scheduler_wake通知)
+    volatile bool wake_requested; // 效果已切换，立即开始下一帧
+    anim_stats_t stats;
+} anim_scheduler_t;
+
+/**
+ * @brief 初始化调度器 (在渲染任务中调用)
+ *
+ * @param sched 调度器
+ * @param fps 目标帧率
+ */
+void anim_scheduler_init(anim_scheduler_t *sched, uint32_t fps);
+
+/**
+ * @brief 修改目标帧率并重新对齐帧周期 (切换效果时调用)
+ *
+ * @param sched 调度器
+ * @param fps 目标帧率
+ */
+void anim_scheduler_set_fps(anim_scheduler_t *sched, uint32_t fps);
+
+/**
+ * @brief 开始渲染一帧
+ *
+ * @param sched 调度器
+ * @return uint32_t 距上一帧开始经过的时间 (毫秒)，效果据此推进动画
+ */
+uint32_t anim_scheduler_begin_frame(anim_scheduler_t *sched);
+
+/**
+ * @brief 结束一帧并等待到下一个帧周期
+ *
+ * 帧耗时超过周期时记为错过截止时间；落后超过一整个周期时跳过错过的周期，
+ * 重新对齐到当前时间，而不是连续补发帧。
+ *
+ * @param sched 调度器
+ */
+void anim_scheduler_end_frame(anim_scheduler_t *sched);
+
+/**
+ * @brief 提前结束当前帧周期的等待，立即渲染下一帧 (可在其它任务中调用)
+ *
+ * 用于按生效时间切换效果: 新效果在切换时刻出现，而不是等到下一个帧周期。
+ * 帧周期从唤醒时刻重新对齐。
+ *
+ * @param sched 调度器
+ */
+void anim_scheduler_wake(anim_scheduler_t *sched);
+
+/**
+ * @brief 读取并清零统计数据
+ *
+ * @param sched 调度器
+ * @param stats 返回的统计数据
+ */
+void anim_scheduler_take_stats(anim_scheduler_t *sched, anim_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ANIM_SCHEDULER_H
@@ -0,0 +1,27 @@
+#include "color_kernel.h"
+
+uint8_t color_rainbow_palette[256][3];
+
+void color_kernel_init(void)
+{
+    // 彩虹调色板 (与原简化版HSV算法相同的三段色环)
+    for (int i = 0; i < 256; i++) {
+        uint8_t pos = i;
+        uint8_t *rgb = color_rainbow_palette[i];
+        if (pos < 85) {
+            rgb[0] = 255 - pos * 3;
+            rgb[1] = pos * 3;
+            rgb[2] = 0;
+        } else if (pos < 170) {
+            pos -= 85;
+            rgb[0] = 0;
+            rgb[1] = 255 - pos * 3;
+            rgb[2] = pos * 3;
+        } else {
+            pos -= 170;
+            rgb[0] = pos * 3;
+            rgb[1] = 0;
+            rgb[2] = 255 - pos * 3;
+        }
+    }
+}
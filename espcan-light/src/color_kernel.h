@@ -0,0 +1,79 @@
+#ifndef COLOR_KERNEL_H
+#define COLOR_KERNEL_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 8.8定点数的1.0
+#define COLOR_Q8_ONE 256
+
+// 彩虹调色板: 色环位置(0-255) -> RGB
+extern uint8_t color_rainbow_palette[256][3];
+
+/**
+ * @brief 生成调色板查找表 (启动时调用一次)
+ */
+void color_kernel_init(void);
+
+// 计算 num/den 的8.8定点值，超出1.0时饱和
+static inline uint16_t color_ratio_q8(uint32_t num, uint32_t den)
+{
+    if (den == 0 || num >= den) {
+        return COLOR_Q8_ONE;
+    }
+    return (uint16_t)((num << 8) / den);
+}
+
+// 计算 1 - num/den 的8.8定点值 (线性衰减)，超出范围时为0
+static inline uint16_t color_fade_q8(uint32_t num, uint32_t den)
+{
+    return COLOR_Q8_ONE - color_ratio_q8(num, den);
+}
+
+// 按8.8定点系数缩放单个颜色分量
+static inline uint8_t color_scale8(uint8_t value, uint16_t scale_q8)
+{
+    return (uint8_t)((value * scale_q8) >> 8);
+}
+
+// 按8.8定点系数缩放RGB颜色
+static inline void color_scale_rgb(const uint8_t *rgb, uint16_t scale_q8, uint8_t *out)
+{
+    out[0] = color_scale8(rgb[0], scale_q8);
+    out[1] = color_scale8(rgb[1], scale_q8);
+    out[2] = color_scale8(rgb[2], scale_q8);
+}
+
+// 呼吸曲线: (num/den)^2 的0.16定点值 (0-65535)，平方关系使亮度变化看起来更自然
+// 直接按时间计算，低亮度下也不会出现台阶
+static inline uint16_t color_breath16(uint32_t num, uint32_t den)
+{
+    if (den == 0 || num >= den) {
+        return 0xFFFF;
+    }
+    uint32_t level = (uint32_t)(((uint64_t)num << 16) / den);
+    return (uint16_t)((level * level) >> 16);
+}
+
+// 按0.16定点系数把8位颜色分量缩放为16位 (0xFF对应0xFFFF)
+static inline uint16_t color_scale16(uint8_t value, uint16_t scale)
+{
+    return (uint16_t)((value * 257u * scale) >> 16);
+}
+
+// 按0.16定点系数把RGB颜色缩放为16位
+static inline void color_scale_rgb16(const uint8_t *rgb, uint16_t scale, uint16_t *out)
+{
+    out[0] = color_scale16(rgb[0], scale);
+    out[1] = color_scale16(rgb[1], scale);
+    out[2] = color_scale16(rgb[2], scale);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // COLOR_KERNEL_H
@@ -0,0 +1,432 @@
+// 帧合成器 - 效果先绘制到内存中的离屏画布，每帧只向每条灯带发送一次
+//
+// 效果只绘制一张逻辑画布，物理灯带通过段映射 (偏移、反向、镜像) 从画布取像素。
+// 映射在初始化时展开为每条灯带的索引表，上传时每个像素只查一次表；
+// 正向连续映射整条灯带时直接从画布上传，镜像的多条灯带共享同一块画布，不需要重复绘制或复制。
+//
+// 启动流水线后，渲染任务 (生产者) 和发送任务 (消费者) 分别运行在两个核心上，
+// 通过两组画布轮换: 渲染任务绘制第N+1帧的同时，发送任务通过RMT发送第N帧。
+// 画布的交接只使用两个单调递增的序号 (单生产者/单消费者，无锁)。
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "compositor.h"
+
+static const char *TAG = "COMPOSITOR";
+
+#define COMP_UNMAPPED UINT16_MAX   // 索引表中没有映射到画布的LED (保持黑色)
+
+static led_strip_handle_t comp_strips[COMPOSITOR_MAX_STRIPS];
+static uint8_t *comp_canvas[COMPOSITOR_PIPELINE_SLOTS];
+static int comp_num_strips = 0;
+static uint32_t comp_leds = 0;              // 逻辑画布像素数
+static uint32_t comp_strip_leds = 0;        // 每条物理灯带的LED数
+
+// 每条物理灯带的映射: 每个LED对应的画布像素
+typedef struct {
+    uint16_t *index;        // 物理LED -> 画布像素，COMP_UNMAPPED为不显示
+    int32_t direct_offset;  // 整条灯带正向连续映射时的画布起点，否则为-1
+    bool covered;           // 每个LED都映射到画布 (纯色画布可以整条以16位颜色填充)
+    uint8_t *scratch;       // 非连续映射时按索引表收集像素的缓冲区 (只由发送方使用)
+} comp_strip_map_t;
+static comp_strip_map_t comp_maps[COMPOSITOR_MAX_STRIPS];
+static int comp_back = 0;                   // 渲染任务正在绘制的画布组
+static volatile uint8_t comp_brightness = 255;  // 请求的全局亮度
+static uint8_t comp_applied_brightness = 255;   // 已写入灯带查找表的亮度 (只由发送方访问)
+static bool comp_high_depth = false;        // 灯带支持16位颜色
+
+// 整条画布为同一16位颜色时记录该颜色，上传时代替8位画布
+typedef struct {
+    bool valid;
+    uint16_t rgb[3];
+} comp_fill16_t;
+static comp_fill16_t comp_fill16[COMPOSITOR_PIPELINE_SLOTS];
+
+// 流水线状态
+static TaskHandle_t comp_tx_task = NULL;
+static TaskHandle_t comp_render_task = NULL;
+static atomic_uint comp_submitted;          // 渲染任务已提交的帧数 (只由渲染任务写)
+static atomic_uint comp_released;           // 发送任务已取走并释放画布的帧数 (只由发送任务写)
+
+static portMUX_TYPE comp_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+static compositor_stats_t comp_stats;
+
+static void free_buffers(void)
+{
+    for (int slot = 0; slot < COMPOSITOR_PIPELINE_SLOTS; slot++) {
+        free(comp_canvas[slot]);
+        comp_canvas[slot] = NULL;
+    }
+    for (int i = 0; i < COMPOSITOR_MAX_STRIPS; i++) {
+        free(comp_maps[i].index);
+        free(comp_maps[i].scratch);
+        comp_maps[i].index = NULL;
+        comp_maps[i].scratch = NULL;
+    }
+}
+
+// 把段展开为每条灯带的索引表，并找出可以直接从画布上传的灯带
+static esp_err_t build_maps(int num_strips, uint32_t strip_leds, const compositor_segment_t *segments, int num_segments)
+{
+    for (int i = 0; i < num_strips; i++) {
+        comp_maps[i].index = malloc(strip_leds * sizeof(uint16_t));
+        if (comp_maps[i].index == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+        for (uint32_t j = 0; j < strip_leds; j++) {
+            comp_maps[i].index[j] = COMP_UNMAPPED;
+        }
+    }
+
+    // 同一LED被多个段覆盖时后面的段生效
+    for (int s = 0; s < num_segments; s++) {
+        const compositor_segment_t *seg = &segments[s];
+        uint16_t *index = comp_maps[seg->strip].index + seg->strip_start;
+        for (uint32_t j = 0; j < seg->length; j++) {
+            index[j] = seg->canvas_start + (seg->reversed ? seg->length - 1 - j : j);
+        }
+    }
+
+    for (int i = 0; i < num_strips; i++) {
+        comp_strip_map_t *map = &comp_maps[i];
+        map->direct_offset = map->index[0] == COMP_UNMAPPED ? -1 : map->index[0];
+        map->covered = true;
+        for (uint32_t j = 0; j < strip_leds; j++) {
+            if (map->index[j] == COMP_UNMAPPED) {
+                map->covered = false;
+            }
+            if (map->index[j] != map->index[0] + j) {
+                map->direct_offset = -1;
+            }
+        }
+        if (map->direct_offset < 0) {
+            map->scratch = malloc(strip_leds * COMPOSITOR_BYTES_PER_PIXEL);
+            if (map->scratch == NULL) {
+                return ESP_ERR_NO_MEM;
+            }
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t compositor_init(const led_strip_handle_t *strips, int num_strips, uint32_t strip_leds,
+                          uint32_t canvas_leds, const compositor_segment_t *segments, int num_segments)
+{
+    if (strips == NULL || num_strips <= 0 || num_strips > COMPOSITOR_MAX_STRIPS || strip_leds == 0 ||
+        canvas_leds == 0 || canvas_leds >= COMP_UNMAPPED || segments == NULL || num_segments <= 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (int s = 0; s < num_segments; s++) {
+        const compositor_segment_t *seg = &segments[s];
+        if (seg->strip < 0 || seg->strip >= num_strips ||
+            seg->strip_start + seg->length > strip_leds || seg->canvas_start + seg->length > canvas_leds) {
+            ESP_LOGE(TAG, "段%d超出灯带或画布范围", s);
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+    // 发送任务运行时不能更换画布
+    if (comp_tx_task != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // 重新初始化 (例如更换灯带长度) 时释放上一次的画布和映射表
+    free_buffers();
+    for (int slot = 0; slot < COMPOSITOR_PIPELINE_SLOTS; slot++) {
+        comp_canvas[slot] = calloc(canvas_leds, COMPOSITOR_BYTES_PER_PIXEL);
+        if (comp_canvas[slot] == NULL) {
+            ESP_LOGE(TAG, "画布%d内存分配失败", slot);
+            free_buffers();
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    if (build_maps(num_strips, strip_leds, segments, num_segments) != ESP_OK) {
+        ESP_LOGE(TAG, "映射表内存分配失败");
+        free_buffers();
+        return ESP_ERR_NO_MEM;
+    }
+
+    for (int i = 0; i < num_strips; i++) {
+        comp_strips[i] = strips[i];
+    }
+    comp_num_strips = num_strips;
+    comp_leds = canvas_leds;
+    comp_strip_leds = strip_leds;
+    comp_back = 0;
+    memset(comp_fill16, 0, sizeof(comp_fill16));
+    atomic_init(&comp_submitted, 0);
+    atomic_init(&comp_released, 0);
+    memset(&comp_stats, 0, sizeof(comp_stats));
+    ESP_LOGI(TAG, "合成器初始化成功: 画布%lu像素 x %d组, %d条灯带 x %lu像素, %d段映射",
+             (unsigned long)canvas_leds, COMPOSITOR_PIPELINE_SLOTS, num_strips,
+             (unsigned long)strip_leds, num_segments);
+    return ESP_OK;
+}
+
+uint8_t *compositor_canvas(void)
+{
+    // 调用者可能直接修改画布
+    comp_fill16[comp_back].valid = false;
+    return comp_canvas[comp_back];
+}
+
+uint32_t compositor_led_count(void)
+{
+    return comp_leds;
+}
+
+int compositor_strip_count(void)
+{
+    return comp_num_strips;
+}
+
+uint32_t compositor_strip_led_count(void)
+{
+    return comp_strip_leds;
+}
+
+void compositor_clear(void)
+{
+    memset(comp_canvas[comp_back], 0, comp_leds * COMPOSITOR_BYTES_PER_PIXEL);
+    comp_fill16[comp_back].valid = false;
+}
+
+void compositor_set_pixel(uint32_t index, uint8_t red, uint8_t green, uint8_t blue)
+{
+    if (index >= comp_leds) {
+        return;
+    }
+    uint8_t *pixel = comp_canvas[comp_back] + index * COMPOSITOR_BYTES_PER_PIXEL;
+    comp_fill16[comp_back].valid = false;
+    pixel[0] = red;
+    pixel[1] = green;
+    pixel[2] = blue;
+}
+
+void compositor_fill(uint8_t red, uint8_t green, uint8_t blue)
+{
+    uint8_t *canvas = comp_canvas[comp_back];
+    size_t total = comp_leds * COMPOSITOR_BYTES_PER_PIXEL;
+    comp_fill16[comp_back].valid = false;
+
+    // 写入第一个像素后倍增复制
+    canvas[0] = red;
+    canvas[1] = green;
+    canvas[2] = blue;
+    size_t filled = COMPOSITOR_BYTES_PER_PIXEL;
+    while (filled < total) {
+        size_t chunk = filled < total - filled ? filled : total - filled;
+        memcpy(canvas + filled, canvas, chunk);
+        filled += chunk;
+    }
+}
+
+void compositor_fill16(uint16_t red, uint16_t green, uint16_t blue)
+{
+    compositor_fill(red >> 8, green >> 8, blue >> 8);
+    comp_fill16_t *fill = &comp_fill16[comp_back];
+    fill->rgb[0] = red;
+    fill->rgb[1] = green;
+    fill->rgb[2] = blue;
+    fill->valid = true;
+}
+
+// 按映射得到物理灯带的像素: 连续映射时直接返回画布中的位置，否则按索引表收集到out
+static const uint8_t *map_strip(int slot, int strip, uint8_t *out)
+{
+    const comp_strip_map_t *map = &comp_maps[strip];
+    const uint8_t *canvas = comp_canvas[slot];
+    if (map->direct_offset >= 0) {
+        return canvas + map->direct_offset * COMPOSITOR_BYTES_PER_PIXEL;
+    }
+    for (uint32_t j = 0; j < comp_strip_leds; j++, out += COMPOSITOR_BYTES_PER_PIXEL) {
+        uint16_t index = map->index[j];
+        if (index == COMP_UNMAPPED) {
+            out[0] = out[1] = out[2] = 0;
+        } else {
+            const uint8_t *pixel = canvas + index * COMPOSITOR_BYTES_PER_PIXEL;
+            out[0] = pixel[0];
+            out[1] = pixel[1];
+            out[2] = pixel[2];
+        }
+    }
+    return out - comp_strip_leds * COMPOSITOR_BYTES_PER_PIXEL;
+}
+
+void compositor_read_strip(int strip, uint8_t *out)
+{
+    const uint8_t *pixels = map_strip(comp_back, strip, out);
+    if (pixels != out) {
+        memcpy(out, pixels, comp_strip_leds * COMPOSITOR_BYTES_PER_PIXEL);
+    }
+}
+
+// 等待上一帧发送完成，把一组画布上传到灯带缓冲区
+static uint32_t upload_slot(int slot)
+{
+    uint32_t wire_bytes = 0;
+    for (int i = 0; i < comp_num_strips; i++) {
+        // 收集像素不涉及灯带缓冲区，可以在等待上一帧发送时完成
+        const uint8_t *pixels = map_strip(slot, i, comp_maps[i].scratch);
+        // 灯带缓冲区在发送期间不能修改
+        led_strip_wait_refresh_done(comp_strips[i], -1);
+        const comp_fill16_t *fill = &comp_fill16[slot];
+        esp_err_t err;
+        if (comp_high_depth && fill->valid && comp_maps[i].covered) {
+            // 整条灯带都映射到纯色画布上，以16位颜色填充
+            err = led_strip_fill_16(comp_strips[i], 0, comp_strip_leds, fill->rgb[0], fill->rgb[1], fill->rgb[2]);
+        } else {
+            err = led_strip_set_pixels(comp_strips[i], 0, comp_strip_leds, pixels);
+        }
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "灯带%d上传失败: %s", i, esp_err_to_name(err));
+            continue;
+        }
+        wire_bytes += comp_strip_leds * COMPOSITOR_BYTES_PER_PIXEL;
+    }
+    return wire_bytes;
+}
+
+// 亮度变化时更新灯带的查找表，只在发送前调用，避免与编码并发
+static void apply_brightness(void)
+{
+    uint8_t brightness = comp_brightness;
+    if (brightness == comp_applied_brightness) {
+        return;
+    }
+    for (int i = 0; i < comp_num_strips; i++) {
+        esp_err_t err = led_strip_set_brightness(comp_strips[i], brightness);
+        if (err != ESP_OK) {
+            ESP_LOGW(TAG, "灯带%d设置亮度失败: %s", i, esp_err_to_name(err));
+        }
+    }
+    comp_applied_brightness = brightness;
+}
+
+// 启动所有灯带的发送 (不等待完成)，并记录统计
+static esp_err_t start_refresh(uint32_t wire_bytes, uint32_t upload_us)
+{
+    esp_err_t ret = ESP_OK;
+    uint32_t refreshes = 0;
+
+    apply_brightness();
+    for (int i = 0; i < comp_num_strips; i++) {
+        esp_err_t err = led_strip_refresh_async(comp_strips[i]);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "灯带%d刷新失败: %s", i, esp_err_to_name(err));
+            ret = err;
+            continue;
+        }
+        refreshes++;
+    }
+
+    portENTER_CRITICAL(&comp_stats_lock);
+    comp_stats.frames++;
+    comp_stats.refreshes += refreshes;
+    comp_stats.last_frame_wire_bytes = wire_bytes;
+    comp_stats.wire_bytes += wire_bytes;
+    comp_stats.upload_us += upload_us;
+    portEXIT_CRITICAL(&comp_stats_lock);
+    return ret;
+}
+
+// 发送任务: 取出已提交的画布，上传后立即释放给渲染任务，再启动发送
+static void compositor_tx_task(void *pvParameters)
+{
+    uint32_t consumed = 0;
+
+    while (1) {
+        if (consumed == atomic_load_explicit(&comp_submitted, memory_order_acquire)) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
+        }
+
+        int64_t start = esp_timer_get_time();
+        uint32_t wire_bytes = upload_slot(consumed % COMPOSITOR_PIPELINE_SLOTS);
+        uint32_t upload_us = (uint32_t)(esp_timer_get_time() - start);
+
+        // 画布内容已复制到灯带缓冲区，渲染任务可以重新使用这组画布
+        consumed++;
+        atomic_store_explicit(&comp_released, consumed, memory_order_release);
+        xTaskNotifyGive(comp_render_task);
+
+        start_refresh(wire_bytes, upload_us);
+    }
+}
+
+esp_err_t compositor_start_pipeline(BaseType_t tx_core)
+{
+    if (comp_num_strips == 0 || comp_tx_task != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    comp_render_task = xTaskGetCurrentTaskHandle();
+    if (xTaskCreatePinnedToCore(compositor_tx_task, "led_tx", 4096, NULL, 6, &comp_tx_task, tx_core) != pdPASS) {
+        ESP_LOGE(TAG, "创建发送任务失败");
+        return ESP_ERR_NO_MEM;
+    }
+    ESP_LOGI(TAG, "渲染/发送流水线已启动，发送任务运行在核心%d", (int)tx_core);
+    return ESP_OK;
+}
+
+void compositor_set_brightness(uint8_t brightness)
+{
+    comp_brightness = brightness;
+}
+
+void compositor_set_high_depth(bool enabled)
+{
+    comp_high_depth = enabled;
+}
+
+esp_err_t compositor_present(void)
+{
+    if (comp_tx_task == NULL) {
+        // 未启动流水线: 直接上传、发送并等待完成
+        int64_t start = esp_timer_get_time();
+        uint32_t wire_bytes = upload_slot(comp_back);
+        esp_err_t ret = start_refresh(wire_bytes, (uint32_t)(esp_timer_get_time() - start));
+        for (int i = 0; i < comp_num_strips; i++) {
+            led_strip_wait_refresh_done(comp_strips[i], -1);
+        }
+        return ret;
+    }
+
+    // 提交当前画布组给发送任务
+    uint32_t seq = atomic_load_explicit(&comp_submitted, memory_order_relaxed) + 1;
+    atomic_store_explicit(&comp_submitted, seq, memory_order_release);
+    xTaskNotifyGive(comp_tx_task);
+
+    // 等待下一组画布被发送任务释放
+    if (seq - atomic_load_explicit(&comp_released, memory_order_acquire) >= COMPOSITOR_PIPELINE_SLOTS) {
+        int64_t start = esp_timer_get_time();
+        while (seq - atomic_load_explicit(&comp_released, memory_order_acquire) >= COMPOSITOR_PIPELINE_SLOTS) {
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100));
+        }
+        uint32_t wait_us = (uint32_t)(esp_timer_get_time() - start);
+        portENTER_CRITICAL(&comp_stats_lock);
+        comp_stats.render_stalls++;
+        comp_stats.render_stall_us += wait_us;
+        portEXIT_CRITICAL(&comp_stats_lock);
+    }
+
+    // 新画布继承刚提交的内容，效果可以在上一帧的基础上继续绘制
+    int next = seq % COMPOSITOR_PIPELINE_SLOTS;
+    memcpy(comp_canvas[next], comp_canvas[comp_back], comp_leds * COMPOSITOR_BYTES_PER_PIXEL);
+    comp_fill16[next] = comp_fill16[comp_back];
+    comp_back = next;
+    return ESP_OK;
+}
+
+void compositor_take_stats(compositor_stats_t *stats)
+{
+    portENTER_CRITICAL(&comp_stats_lock);
+    *stats = comp_stats;
+    memset(&comp_stats, 0, sizeof(comp_stats));
+    portEXIT_CRITICAL(&comp_stats_lock);
+}
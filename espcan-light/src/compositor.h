@@ -0,0 +1,150 @@
+#ifndef COMPOSITOR_H
+#define COMPOSITOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_err.h"
+#include "led_strip.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define COMPOSITOR_MAX_STRIPS 2
+#define COMPOSITOR_BYTES_PER_PIXEL 3    // 画布为RGB888
+#define COMPOSITOR_PIPELINE_SLOTS 2     // 画布组数: 一组渲染，一组等待/上传
+
+// 物理灯带上的一段LED，显示逻辑画布上的一段连续像素
+// 多个段映射到同一段画布即为镜像，灯带共享画布，不需要重复绘制
+typedef struct {
+    int strip;              // 物理灯带编号 (compositor_init中strips数组的下标)
+    uint32_t strip_start;   // 段在物理灯带上的起始LED
+    uint32_t canvas_start;  // 段对应的画布起始像素
+    uint32_t length;        // 段的LED数量
+    bool reversed;          // 反向: 段的第一个LED显示对应画布范围的最后一个像素
+} compositor_segment_t;
+
+// 合成统计
+typedef struct {
+    uint32_t frames;                // 已输出帧数
+    uint32_t refreshes;             // 灯带刷新次数 (每帧每条灯带一次)
+    uint32_t last_frame_wire_bytes; // 最近一帧发送到灯带上的字节数
+    uint64_t wire_bytes;            // 累计发送字节数
+    uint32_t upload_us;             // 画布上传到灯带缓冲区的累计耗时
+    uint32_t render_stalls;         // 渲染任务等待空闲画布的次数
+    uint32_t render_stall_us;       // 渲染任务等待空闲画布的累计耗时
+} compositor_stats_t;
+
+/**
+ * @brief 初始化合成器，分配逻辑画布并按段生成每条灯带的映射表
+ *
+ * 效果只绘制逻辑画布，上传时每条灯带按映射表从画布取像素 (每个像素查一次表)，
+ * 没有被任何段覆盖的LED保持黑色。整条灯带正向连续映射时直接从画布上传。
+ * 启动流水线之前可以重复调用以更换布局，之前的画布和映射表会被释放。
+ *
+ * @param strips 灯带句柄数组
+ * @param num_strips 灯带数量 (不超过COMPOSITOR_MAX_STRIPS)
+ * @param strip_leds 每条灯带的LED数量
+ * @param canvas_leds 逻辑画布的像素数
+ * @param segments 段数组，同一LED被多个段覆盖时后面的段生效
+ * @param num_segments 段数量
+ * @return esp_err_t ESP_OK成功
+ */
+esp_err_t compositor_init(const led_strip_handle_t *strips, int num_strips, uint32_t strip_leds,
+                          uint32_t canvas_leds, const compositor_segment_t *segments, int num_segments);
+
+/**
+ * @brief 启动渲染/发送流水线
+ *
+ * 在调用线程之外创建固定在tx_core上的发送任务。启动后只有调用此函数的任务
+ * (渲染任务) 可以绘制和调用compositor_present。
+ *
+ * @param tx_core 发送任务运行的核心
+ * @return esp_err_t ESP_OK成功
+ */
+esp_err_t compositor_start_pipeline(BaseType_t tx_core);
+
+/**
+ * @brief 获取逻辑画布 (RGB888，compositor_led_count个像素)
+ */
+uint8_t *compositor_canvas(void);
+
+/**
+ * @brief 获取逻辑画布的像素数
+ */
+uint32_t compositor_led_count(void);
+
+/**
+ * @brief 获取物理灯带数量
+ */
+int compositor_strip_count(void);
+
+/**
+ * @brief 获取每条物理灯带的LED数量
+ */
+uint32_t compositor_strip_led_count(void);
+
+/**
+ * @brief 按映射读出当前画布在一条物理灯带上的像素 (RGB888，compositor_strip_led_count个像素)
+ */
+void compositor_read_strip(int strip, uint8_t *out);
+
+/**
+ * @brief 清空所有画布 (只清内存，不发送)
+ */
+void compositor_clear(void);
+
+/**
+ * @brief 在画布上设置像素，越界时忽略
+ */
+void compositor_set_pixel(uint32_t index, uint8_t red, uint8_t green, uint8_t blue);
+
+/**
+ * @brief 用同一颜色填充整张画布
+ */
+void compositor_fill(uint8_t red, uint8_t green, uint8_t blue);
+
+/**
+ * @brief 用16位精度的同一颜色填充整张画布 (每通道0-65535)
+ *
+ * 画布中保存高8位，灯带以high_depth模式创建时 (见compositor_set_high_depth) 上传完整的16位颜色，
+ * 由驱动在编码时抖动到8位，慢速渐变在低亮度下不会出现台阶。之后对画布的其他绘制会取消16位颜色。
+ * 只有每个LED都被段覆盖的灯带以16位上传，其他灯带使用8位颜色。
+ */
+void compositor_fill16(uint16_t red, uint16_t green, uint16_t blue);
+
+/**
+ * @brief 输出一帧，每条灯带只刷新一次
+ *
+ * 未启动流水线时上传所有画布，并行发送并等待完成。
+ * 启动流水线后只把画布交给发送任务，然后切换到另一组画布 (内容与刚提交的帧相同)，
+ * 只有在发送任务尚未取走上一帧时才会等待。
+ *
+ * @return esp_err_t ESP_OK成功
+ */
+esp_err_t compositor_present(void);
+
+/**
+ * @brief 设置全局亮度 (255为全亮)
+ *
+ * 亮度由灯带驱动在编码时通过查找表应用，画布保持全亮度颜色，
+ * 调节亮度不需要重新渲染。新亮度从下一次发送开始生效，可以在任意任务中调用。
+ */
+void compositor_set_brightness(uint8_t brightness);
+
+/**
+ * @brief 声明灯带是否以high_depth模式创建，开启后compositor_fill16的颜色以16位上传
+ */
+void compositor_set_high_depth(bool enabled);
+
+/**
+ * @brief 读取并清零统计数据
+ */
+void compositor_take_stats(compositor_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // COMPOSITOR_H
@@ -0,0 +1,472 @@
+// 灯光效果 - 只依赖帧合成器和颜色查找表，按经过的时间推进动画
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "esp_random.h"
+#include "compositor.h"
+#include "color_kernel.h"
+#include "light_effects.h"
+
+// 随机效果参数
+random_effect_params_t random_effect = {0};
+
+// 各效果在帧之间保留的状态
+typedef struct {
+    uint32_t hue_q8;            // 色相 (低8位为小数部分)
+} rainbow_state_t;
+
+typedef struct {
+    uint32_t dark_remaining_ms; // 剩余黑暗期
+    bool dark_pending;          // 下一帧进入黑暗期
+} lightning_state_t;
+
+typedef struct {
+    uint32_t position_q8;       // 追逐位置 (低8位为小数部分)
+} chase_state_t;
+
+typedef struct {
+    uint32_t last_meteor;
+    uint32_t step_q8;           // 未用完的移动量 (低8位为小数部分)
+    int meteor_positions[10];
+    uint8_t meteor_colors[10][3];
+} meteor_state_t;
+
+typedef struct {
+    uint32_t last_explosion;
+    uint32_t step_q8;           // 未用完的扩散量 (低8位为小数部分)
+    int explosion_center;
+    uint8_t explosion_size;
+    uint8_t explosion_color[3];
+} explosion_state_t;
+
+typedef struct {
+    uint32_t breath_ms;
+    int direction;              // 1 = 增加亮度, -1 = 减少亮度
+} breathing_state_t;
+
+typedef struct {
+    uint32_t breath_ms;
+    int direction;              // 1 = 增加亮度, -1 = 减少亮度
+    uint8_t hue;                // 色相值，用于颜色循环
+} color_breathing_state_t;
+
+typedef struct {
+    rainbow_state_t rainbow;
+    lightning_state_t lightning;
+    chase_state_t chase;
+    meteor_state_t meteor;
+    explosion_state_t explosion;
+    breathing_state_t breathing;
+    color_breathing_state_t color_breathing;
+} effects_state_t;
+
+#define EFFECTS_STATE_INIT {                                                    \
+    .meteor = {.meteor_positions = {-1, -1, -1, -1, -1, -1, -1, -1, -1, -1}},   \
+    .explosion = {.explosion_center = -1},                                      \
+    .breathing = {.direction = 1},                                              \
+    .color_breathing = {.direction = 1},                                        \
+}
+
+static effects_state_t fx = EFFECTS_STATE_INIT;
+
+// 固定种子时使用的伪随机数状态 (xorshift32)，为0时使用硬件随机数
+static uint32_t rng_state = 0;
+
+// 效果使用的随机数
+static uint32_t effect_random(void) {
+    if (rng_state == 0) {
+        return esp_random();
+    }
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+void light_effects_reset(uint32_t seed) {
+    static const effects_state_t initial_state = EFFECTS_STATE_INIT;
+    fx = initial_state;
+    random_effect.timer = 0;
+    rng_state = seed;
+}
+
+// 彩虹效果实现
+void rainbow_effect(uint32_t elapsed_ms) {
+    const int num_leds = compositor_led_count();
+    rainbow_state_t *st = &fx.rainbow;
+    
+    // 按经过的时间移动彩虹
+    st->hue_q8 += elapsed_ms * RAINBOW_HUE_PER_SEC * 256 / 1000;
+    uint8_t hue = (st->hue_q8 >> 8) & 0xFF;
+    
+    // 创建彩虹效果 (直接写入画布)
+    uint8_t *rgb = compositor_canvas();
+    for (int i = 0; i < num_leds; i++) {
+        // 计算每个LED的色调，形成彩虹
+        uint8_t pos = (i * 256 / num_leds + hue) & 0xFF;
+        
+        // 查表得到RGB
+        memcpy(rgb, color_rainbow_palette[pos], 3);
+        rgb += 3;
+    }
+    
+    // 更新显示
+    compositor_present();
+}
+
+// 闪电效果实现
+void lightning_effect(uint32_t elapsed_ms) {
+    const int num_leds = compositor_led_count();
+    lightning_state_t *st = &fx.lightning;
+    
+    // 黑暗期内保持熄灭
+    if (st->dark_remaining_ms > 0) {
+        st->dark_remaining_ms = (st->dark_remaining_ms > elapsed_ms) ? st->dark_remaining_ms - elapsed_ms : 0;
+        return;
+    }
+    
+    // 上一帧闪电已显示一个帧周期，进入黑暗期
+    if (st->dark_pending) {
+        st->dark_pending = false;
+        compositor_clear();
+        compositor_present();
+        st->dark_remaining_ms = LIGHTNING_DARK_MS;
+        return;
+    }
+    
+    // 先清空画布 (只清内存)
+    compositor_clear();
+    
+    // 随机生成闪电位置
+    int num_flashes = 3 + effect_random() % 4; // 3-6个闪电点
+    
+    for (int i = 0; i < num_flashes; i++) {
+        int pos = effect_random() % num_leds;
+        
+        // 设置闪电 - 随机选择白色或蓝白色
+        uint8_t intensity = 150 + effect_random() % 105; // 150-255
+        uint8_t is_blue = effect_random() % 2; // 0=白色闪电, 1=蓝色闪电
+        
+        if (is_blue) {
+            // 蓝白色闪电
+            compositor_set_pixel(pos, intensity/2, intensity/2, intensity);
+            
+            // 闪电周围有淡蓝色光晕
+            if (pos > 0) {
+                compositor_set_pixel(pos-1, 20, 20, 120);
+            }
+            if (pos < num_leds-1) {
+                compositor_set_pixel(pos+1, 20, 20, 120);
+            }
+        } else {
+            // 白色闪电
+            compositor_set_pixel(pos, intensity, intensity, intensity);
+            
+            // 闪电周围有淡白色光晕
+            if (pos > 0) {
+                compositor_set_pixel(pos-1, 100, 100, 100);
+            }
+            if (pos < num_leds-1) {
+                compositor_set_pixel(pos+1, 100, 100, 100);
+            }
+        }
+    }
+    
+    // 更新显示
+    compositor_present();
+    
+    // 随机决定是否有黑暗期
+    if (effect_random() % 5 == 0) {
+        st->dark_pending = true;
+    }
+}
+
+// 紫色追逐效果实现
+void purple_chase_effect(uint32_t elapsed_ms) {
+    const int num_leds = compositor_led_count();
+    chase_state_t *st = &fx.chase;
+    
+    // 按经过的时间移动追逐位置
+    st->position_q8 = (st->position_q8 + elapsed_ms * CHASE_LEDS_PER_SEC * 256 / 1000) % (num_leds << 8);
+    int position = st->position_q8 >> 8;
+    
+    // 先清空画布 (只清内存)
+    compositor_clear();
+    
+    // 追逐灯的长度
+    const int chase_length = 5;
+    
+    // 创建紫色追逐效果
+    for (int i = 0; i < chase_length; i++) {
+        int pos = (position + i) % num_leds;
+        // 根据距离头部的位置，亮度逐渐降低
+        uint8_t brightness = 255 - (i * 255 / chase_length);
+        compositor_set_pixel(pos, brightness, 0, brightness);
+    }
+    
+    // 更新显示
+    compositor_present();
+}
+
+// 随机流星效果实现
+void meteor_shower_effect(uint32_t elapsed_ms, uint8_t brightness) {
+    const int num_leds = compositor_led_count();
+    meteor_state_t *st = &fx.meteor;
+    
+    // 根据亮度调整效果
+    uint8_t max_brightness = brightness;
+    
+    // 先清空画布 (只清内存)
+    compositor_clear();
+    
+    // 随机生成新流星
+    random_effect.timer += elapsed_ms;
+    
+    // 按经过的时间计算本帧流星移动的LED数
+    st->step_q8 += elapsed_ms * METEOR_LEDS_PER_SEC * 256 / 1000;
+    int steps = st->step_q8 >> 8;
+    st->step_q8 &= 0xFF;
+    
+    // 每隔一段时间生成新流星
+    if (random_effect.timer - st->last_meteor > (300 - random_effect.speed) * RANDOM_EFFECT_TICK_MS) {
+        // 寻找空闲位置
+        for (int i = 0; i < 10; i++) {
+            if (st->meteor_positions[i] == -1) {
+                // 创建新流星
+                st->meteor_positions[i] = 0;
+                
+                // 随机颜色
+                uint8_t color_type = effect_random() % 5;
+                switch (color_type) {
+                    case 0: // 白色
+                        st->meteor_colors[i][0] = max_brightness;
+                        st->meteor_colors[i][1] = max_brightness;
+                        st->meteor_colors[i][2] = max_brightness;
+                        break;
+                    case 1: // 蓝色
+                        st->meteor_colors[i][0] = 0;
+                        st->meteor_colors[i][1] = 0;
+                        st->meteor_colors[i][2] = max_brightness;
+                        break;
+                    case 2: // 绿色
+                        st->meteor_colors[i][0] = 0;
+                        st->meteor_colors[i][1] = max_brightness;
+                        st->meteor_colors[i][2] = 0;
+                        break;
+                    case 3: // 红色
+                        st->meteor_colors[i][0] = max_brightness;
+                        st->meteor_colors[i][1] = 0;
+                        st->meteor_colors[i][2] = 0;
+                        break;
+                    case 4: // 紫色
+                        st->meteor_colors[i][0] = max_brightness;
+                        st->meteor_colors[i][1] = 0;
+                        st->meteor_colors[i][2] = max_brightness;
+                        break;
+                }
+                
+                st->last_meteor = random_effect.timer;
+                break;
+            }
+        }
+    }
+    
+    // 更新所有流星
+    for (int i = 0; i < 10; i++) {
+        if (st->meteor_positions[i] >= 0) {
+            // 流星头部
+            int pos = st->meteor_positions[i];
+            
+            if (pos < num_leds) {
+                // 设置流星头部
+                compositor_set_pixel(pos, 
+                                   st->meteor_colors[i][0], 
+                                   st->meteor_colors[i][1], 
+                                   st->meteor_colors[i][2]);
+                
+                // 流星尾部
+                for (int tail = 1; tail < 5; tail++) {
+                    if (pos - tail >= 0) {
+                        // 尾部亮度递减
+                        uint8_t tail_color[3];
+                        color_scale_rgb(st->meteor_colors[i], color_fade_q8(tail, 5), tail_color);
+                        compositor_set_pixel(pos - tail, 
+                                          tail_color[0], 
+                                          tail_color[1], 
+                                          tail_color[2]);
+                    }
+                }
+            }
+            
+            // 移动流星
+            st->meteor_positions[i] += steps;
+            
+            // 如果流星离开了LED条，则标记为空闲
+            if (st->meteor_positions[i] > num_leds + 5) {
+                st->meteor_positions[i] = -1;
+            }
+        }
+    }
+    
+    // 更新显示
+    compositor_present();
+}
+
+// 随机颜色爆炸效果
+void random_explosion_effect(uint32_t elapsed_ms, uint8_t brightness) {
+    const int num_leds = compositor_led_count();
+    explosion_state_t *st = &fx.explosion;
+    
+    // 先清空画布 (只清内存)
+    compositor_clear();
+    
+    // 计时器更新
+    random_effect.timer += elapsed_ms;
+    
+    // 按经过的时间计算本帧爆炸扩散的LED数
+    st->step_q8 += elapsed_ms * EXPLOSION_LEDS_PER_SEC * 256 / 1000;
+    int steps = st->step_q8 >> 8;
+    st->step_q8 &= 0xFF;
+    
+    // 如果没有活跃的爆炸或爆炸已经完成
+    if (st->explosion_center == -1 || st->explosion_size > 20) {
+        // 每隔一段时间生成新爆炸
+        if (random_effect.timer - st->last_explosion > (500 - random_effect.speed * 2) * RANDOM_EFFECT_TICK_MS) {
+            // 创建新爆炸
+            st->explosion_center = effect_random() % num_leds;
+            st->explosion_size = 0;
+            
+            // 随机颜色
+            uint8_t color_r = effect_random() % 256;
+            uint8_t color_g = effect_random() % 256;
+            uint8_t color_b = effect_random() % 256;
+            
+            // 确保颜色足够亮
+            while (color_r + color_g + color_b < 150) {
+                color_r = effect_random() % 256;
+                color_g = effect_random() % 256;
+                color_b = effect_random() % 256;
+            }
+            
+            // 应用亮度
+            st->explosion_color[0] = (color_r * brightness) / 255;
+            st->explosion_color[1] = (color_g * brightness) / 255;
+            st->explosion_color[2] = (color_b * brightness) / 255;
+            
+            st->last_explosion = random_effect.timer;
+        }
+    }
+    
+    // 如果有活跃的爆炸
+    if (st->explosion_center != -1) {
+        // 爆炸中心亮度最高
+        uint8_t color[3];
+        color_scale_rgb(st->explosion_color, color_fade_q8(st->explosion_size, 20), color);
+        compositor_set_pixel(st->explosion_center, 
+                           color[0], 
+                           color[1], 
+                           color[2]);
+        
+        // 爆炸向两侧扩散
+        for (int i = 1; i <= st->explosion_size; i++) {
+            // 计算衰减
+            color_scale_rgb(st->explosion_color, color_fade_q8(i, st->explosion_size), color);
+            
+            // 左侧
+            if (st->explosion_center - i >= 0) {
+                compositor_set_pixel(st->explosion_center - i, 
+                                   color[0], 
+                                   color[1], 
+                                   color[2]);
+            }
+            
+            // 右侧
+            if (st->explosion_center + i < num_leds) {
+                compositor_set_pixel(st->explosion_center + i, 
+                                   color[0], 
+                                   color[1], 
+                                   color[2]);
+            }
+        }
+        
+        // 增加爆炸尺寸
+        st->explosion_size += steps;
+        
+        // 如果爆炸完成
+        if (st->explosion_size > 20) {
+            st->explosion_center = -1; // 标记爆炸结束
+        }
+    }
+    
+    // 更新显示
+    compositor_present();
+}
+
+// 按经过的时间推进呼吸位置 (0 - BREATH_RAMP_MS 之间往返)
+static void advance_breath(uint32_t *breath_ms, int *direction, uint32_t elapsed_ms, bool *peaked) {
+    *peaked = false;
+    if (*direction > 0) {
+        *breath_ms += elapsed_ms;
+        if (*breath_ms >= BREATH_RAMP_MS) {
+            *breath_ms = BREATH_RAMP_MS;
+            *direction = -1;
+            *peaked = true;
+        }
+    } else {
+        *breath_ms = (*breath_ms > elapsed_ms) ? *breath_ms - elapsed_ms : 0;
+        if (*breath_ms == 0) {
+            *direction = 1;
+        }
+    }
+}
+
+// 呼吸灯效果实现
+void breathing_light_effect(uint32_t elapsed_ms, uint8_t brightness) {
+    breathing_state_t *st = &fx.breathing;
+    
+    // 呼吸灯的颜色 - 使用柔和的白色
+    static const uint8_t base_rgb[3] = {255, 220, 180};
+    
+    // 计算当前亮度 (16位平方曲线)，并应用主亮度参数
+    uint16_t intensity = (uint32_t)color_breath16(st->breath_ms, BREATH_RAMP_MS) * (brightness + 1) >> 8;
+    
+    // 设置所有LED为相同的呼吸亮度 (16位颜色，低亮度下由驱动抖动)
+    uint16_t rgb[3];
+    color_scale_rgb16(base_rgb, intensity, rgb);
+    compositor_fill16(rgb[0], rgb[1], rgb[2]);
+    
+    // 更新显示
+    compositor_present();
+    
+    // 按经过的时间更新呼吸位置
+    bool peaked;
+    advance_breath(&st->breath_ms, &st->direction, elapsed_ms, &peaked);
+}
+
+// 颜色变化的呼吸灯效果 (用于中性情绪状态)
+void color_changing_breathing_effect(uint32_t elapsed_ms) {
+    color_breathing_state_t *st = &fx.color_breathing;
+    
+    // 计算当前亮度 (16位平方曲线)
+    uint16_t intensity = color_breath16(st->breath_ms, BREATH_RAMP_MS);
+    
+    // 查调色板得到颜色并按亮度缩放为16位
+    uint16_t rgb[3];
+    color_scale_rgb16(color_rainbow_palette[st->hue], intensity, rgb);
+    
+    // 设置所有LED为相同的颜色和亮度
+    compositor_fill16(rgb[0], rgb[1], rgb[2]);
+    
+    // 更新显示
+    compositor_present();
+    
+    // 按经过的时间更新呼吸位置
+    bool peaked;
+    advance_breath(&st->breath_ms, &st->direction, elapsed_ms, &peaked);
+    
+    // 当达到最大亮度时，改变颜色
+    if (peaked) {
+        st->hue = (st->hue + 5) % 255;
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef LIGHT_EFFECTS_H
+#define LIGHT_EFFECTS_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 动画速度 (按经过的时间推进，与灯带长度和帧率无关)
+#define RAINBOW_HUE_PER_SEC 20      // 彩虹色相每秒移动量 (色环0-255)
+#define CHASE_LEDS_PER_SEC 33       // 追逐灯每秒移动的LED数
+#define METEOR_LEDS_PER_SEC 33      // 流星每秒移动的LED数
+#define EXPLOSION_LEDS_PER_SEC 33   // 爆炸每秒扩散的LED数
+#define BREATH_RAMP_MS 3000         // 呼吸灯从最暗到最亮的时间
+#define LIGHTNING_DARK_MS 160       // 闪电之间黑暗期的时长
+#define RANDOM_EFFECT_TICK_MS 30    // 随机效果间隔参数的时间单位
+
+// 随机效果参数
+typedef struct {
+    uint8_t enabled;    // 是否启用随机效果
+    uint8_t speed;      // 速度参数 (0-255)
+    uint8_t brightness; // 亮度参数 (0-255)
+    uint32_t timer;     // 效果计时器 (毫秒)
+} random_effect_params_t;
+
+extern random_effect_params_t random_effect;
+
+/**
+ * @brief 重置所有效果的内部状态
+ *
+ * @param seed 随机数种子。非0时效果使用确定的伪随机序列 (用于录制和比对标准帧)，
+ *             为0时使用硬件随机数
+ */
+void light_effects_reset(uint32_t seed);
+
+// 效果函数: 绘制一帧到合成器画布并输出，elapsed_ms为距上一帧经过的时间
+void rainbow_effect(uint32_t elapsed_ms);
+void lightning_effect(uint32_t elapsed_ms);
+void purple_chase_effect(uint32_t elapsed_ms);
+void meteor_shower_effect(uint32_t elapsed_ms, uint8_t brightness);
+void random_explosion_effect(uint32_t elapsed_ms, uint8_t brightness);
+void breathing_light_effect(uint32_t elapsed_ms, uint8_t brightness);
+void color_changing_breathing_effect(uint32_t elapsed_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LIGHT_EFFECTS_H
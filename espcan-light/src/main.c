@@ -12,6 +12,14 @@
 #include "led_strip.h"
 #include "esp_system.h"
 #include "esp_random.h"
+#include "esp_timer.h"
+#include "anim_scheduler.h"
+#include "color_kernel.h"
+#include "compositor.h"
+#include "light_effects.h"
+#include "espcan_protocol.h"
+#include "espcan_filter.h"
+#include "espcan_sync.h"
 
 // 定义CAN引脚
 #define CAN_TX_PIN GPIO_NUM_5
@@ -26,33 +34,36 @@
 #define WS2812_LEDS_COUNT_PER_STRIP 900  // 每个灯带900个LED
 #define WS2812_LEDS_TOTAL (WS2812_LEDS_COUNT_PER_STRIP * 2) // 总共1800个LED
 
-// CAN消息ID
-#define LED_CMD_ID 0x456      // LED控制命令ID
-#define EMOTION_CMD_ID 0x789  // 情绪状态命令ID
-#define RANDOM_CMD_ID 0xABC   // 随机效果命令ID
-
-// LED控制命令
-#define LED_CMD_OFF 0
-#define LED_CMD_ON 1
-
-// 情绪状态命令
-#define EMOTION_NEUTRAL 0    // 中性 - 呼吸灯切换颜色效果
-#define EMOTION_HAPPY 1      // 开心 - 彩虹效果
-#define EMOTION_SAD 2        // 伤心 - 紫色追逐
-#define EMOTION_SURPRISE 3   // 惊讶 - 闪电效果
-#define EMOTION_RANDOM 4     // 随机效果
-
-// 随机效果命令
-#define RANDOM_START 1     // 开始随机效果
-#define RANDOM_STOP 0      // 停止随机效果
-
-// 随机效果参数
-typedef struct {
-    uint8_t enabled;    // 是否启用随机效果
-    uint8_t speed;      // 速度参数 (0-255)
-    uint8_t brightness; // 亮度参数 (0-255)
-    uint32_t timer;     // 效果计时器
-} random_effect_params_t;
+// 动画目标帧率 (帧/秒)
+#define RAINBOW_FPS 20
+#define PURPLE_CHASE_FPS 33
+#define LIGHTNING_FPS 12
+#define BREATHING_FPS 33
+#define IDLE_FPS 5
+
+// 每个灯带可排队的帧数 (流式发送模式下每帧占用一份像素副本)
+#define LED_STREAM_QUEUE_DEPTH 2
+
+// 每条灯带的电流预算 (毫安)，超出时驱动在编码时统一降低整帧亮度
+#define LED_POWER_BUDGET_MA 10000   // 按每条灯带的供电能力调整，0为不限制
+#define LED_CHANNEL_MA 12           // WS2812单个颜色分量满值时的电流
+#define LED_IDLE_MA 0               // 灯带全灭时的静态电流 (未实测)
+
+#define ANIM_STATS_INTERVAL_MS 5000 // 动画统计输出间隔
+
+// 渲染任务和灯带发送任务分别运行的核心
+#define LED_RENDER_CORE 0
+#define LED_TX_CORE 1
+
+// 灯带布局: 效果绘制的逻辑画布如何映射到物理灯带
+// 两条灯带镜像显示同一画布 (共享画布，不重复绘制)。
+// 改为首尾相接的1800像素画布: LED_CANVAS_LEDS设为WS2812_LEDS_TOTAL，第二段的canvas_start设为900；
+// 灯带反向安装时把对应段的reversed设为true
+#define LED_CANVAS_LEDS WS2812_LEDS_COUNT_PER_STRIP
+static const compositor_segment_t led_layout[] = {
+    {.strip = 0, .strip_start = 0, .canvas_start = 0, .length = WS2812_LEDS_COUNT_PER_STRIP, .reversed = false},
+    {.strip = 1, .strip_start = 0, .canvas_start = 0, .length = WS2812_LEDS_COUNT_PER_STRIP, .reversed = false},
+};
 
 // 日志标签
 static const char *TAG = "LIGHT_CTRL";
@@ -60,22 +71,13 @@ static const char *TAG = "LIGHT_CTRL";
 // 当前情绪状态
 static uint8_t current_emotion = 0;
 
-// 随机效果参数
-static random_effect_params_t random_effect = {0};
+// 情绪动画调度器 (切换情绪时唤醒渲染任务)
+static anim_scheduler_t anim_sched;
 
 // LED灯带句柄
 led_strip_handle_t led_strip_1;
 led_strip_handle_t led_strip_2;
 
-// 函数声明
-void rainbow_effect(int delay_ms);
-void lightning_effect(int delay_ms);
-void purple_chase_effect(int delay_ms);
-void meteor_shower_effect(int delay_ms, uint8_t brightness);
-void random_explosion_effect(int delay_ms, uint8_t brightness);
-void breathing_light_effect(int delay_ms, uint8_t brightness);
-void color_changing_breathing_effect(int delay_ms);
-
 // TWAI配置
 static const twai_general_config_t g_config = {
     .mode = TWAI_MODE_NORMAL,
@@ -93,9 +95,6 @@ static const twai_general_config_t g_config = {
 // 波特率配置 (500Kbps)
 static const twai_timing_config_t t_config = TWAI_TIMING_CONFIG_500KBITS();
 
-// 过滤器配置 (接收所有消息)
-static const twai_filter_config_t f_config = TWAI_FILTER_CONFIG_ACCEPT_ALL();
-
 // 初始化WS2812灯带
 static void ws2812_init(void) {
     // 第一个LED灯带配置 (GPIO_18)
@@ -105,6 +104,7 @@ static void ws2812_init(void) {
         .color_component_format = LED_STRIP_COLOR_COMPONENT_FMT_GRB,
         .led_model = LED_MODEL_WS2812,
         .flags.invert_out = false,
+        .flags.high_depth = true,  // 16位颜色，编码时抖动到8位 (慢速呼吸在低亮度下平滑)
     };
 
     // 第二个LED灯带配置 (GPIO_17)
@@ -114,6 +114,7 @@ static void ws2812_init(void) {
         .color_component_format = LED_STRIP_COLOR_COMPONENT_FMT_GRB,
         .led_model = LED_MODEL_WS2812,
         .flags.invert_out = false,
+        .flags.high_depth = true,  // 16位颜色，编码时抖动到8位 (慢速呼吸在低亮度下平滑)
     };
 
     // RMT驱动配置
@@ -121,7 +122,9 @@ static void ws2812_init(void) {
         .clk_src = RMT_CLK_SRC_DEFAULT,
         .resolution_hz = 10 * 1000 * 1000, // 10MHz
         .mem_block_symbols = 64,
+        .trans_queue_depth = LED_STREAM_QUEUE_DEPTH,
         .flags.with_dma = false,  // 标准ESP32不支持DMA
+        .flags.streaming = true,  // 通道保持启用，帧在驱动队列中连续发送
     };
 
     // 创建第一个LED灯带驱动
@@ -130,6 +133,15 @@ static void ws2812_init(void) {
     // 创建第二个LED灯带驱动
     ESP_ERROR_CHECK(led_strip_new_rmt_device(&strip_config_2, &rmt_config, &led_strip_2));
     
+    // 限制每条灯带的电流，防止全白等高亮画面超出电源能力
+    led_strip_power_config_t power_config = {
+        .budget_ma = LED_POWER_BUDGET_MA,
+        .channel_ma = LED_CHANNEL_MA,
+        .idle_ma = LED_IDLE_MA,
+    };
+    ESP_ERROR_CHECK(led_strip_set_power_limit(led_strip_1, &power_config));
+    ESP_ERROR_CHECK(led_strip_set_power_limit(led_strip_2, &power_config));
+    
     // 初始清空灯带
     led_strip_clear(led_strip_1);
     led_strip_refresh(led_strip_1);
@@ -138,59 +150,53 @@ static void ws2812_init(void) {
     led_strip_refresh(led_strip_2);
 }
 
-// 清除所有LED
+// 清除所有LED (清空画布并输出一帧黑色)
 static void clear_leds(void) {
-    led_strip_clear(led_strip_1);
-    led_strip_refresh(led_strip_1);
+    compositor_clear();
+    compositor_present();
+}
+
+// 设置LED状态
+static void set_led_state(uint8_t state) {
+    gpio_set_level(LED_PIN, state);
     
-    led_strip_clear(led_strip_2);
-    led_strip_refresh(led_strip_2);
+    ESP_LOGI(TAG, "LED状态已设置为: %s", state ? "开启" : "关闭");
 }
 
 // 处理LED控制命令
-void handle_led_command(twai_message_t *message) {
-    if (message->data_length_code < 1) {
+static void handle_led_command(const twai_message_t *message, void *arg) {
+    espcan_led_cmd_t cmd;
+    if (espcan_decode_led_cmd(message, &cmd) != ESP_OK) {
         ESP_LOGE(TAG, "LED命令数据长度不足");
         return;
     }
     
-    uint8_t led_state = message->data[0];
-    
-    // 设置LED状态
-    gpio_set_level(LED_PIN, led_state);
-    
-    ESP_LOGI(TAG, "LED状态已设置为: %s", led_state ? "开启" : "关闭");
+    set_led_state(cmd.state);
 }
 
-// 处理情绪状态命令
-void handle_emotion_command(twai_message_t *message) {
-    if (message->data_length_code < 1) {
-        ESP_LOGE(TAG, "情绪状态命令数据长度不足");
-        return;
-    }
-    
-    uint8_t emotion_state = message->data[0];
+// 切换情绪状态
+static void set_emotion(uint8_t emotion_state) {
     current_emotion = emotion_state;
     
     // 根据情绪状态输出日志
     switch (emotion_state) {
-        case EMOTION_NEUTRAL:
+        case ESPCAN_EMOTION_NEUTRAL:
             ESP_LOGI(TAG, "情绪状态设置为: 中性 (呼吸灯切换颜色效果)");
             break;
             
-        case EMOTION_HAPPY:
+        case ESPCAN_EMOTION_HAPPY:
             ESP_LOGI(TAG, "情绪状态设置为: 开心 (彩虹效果)");
             break;
             
-        case EMOTION_SAD:
+        case ESPCAN_EMOTION_SAD:
             ESP_LOGI(TAG, "情绪状态设置为: 伤心 (紫色追逐)");
             break;
             
-        case EMOTION_SURPRISE:
+        case ESPCAN_EMOTION_SURPRISE:
             ESP_LOGI(TAG, "情绪状态设置为: 惊讶 (闪电效果)");
             break;
             
-        case EMOTION_RANDOM:
+        case ESPCAN_EMOTION_RANDOM:
             ESP_LOGI(TAG, "情绪状态设置为: 随机效果 (呼吸灯)");
             // 启用呼吸灯效果
             random_effect.enabled = 1;
@@ -200,33 +206,29 @@ void handle_emotion_command(twai_message_t *message) {
             
         default:
             ESP_LOGI(TAG, "情绪状态设置为: 未知");
-            clear_leds();
             break;
     }
+    
+    // 新效果立即开始渲染，不等当前帧周期结束
+    anim_scheduler_wake(&anim_sched);
 }
 
-// 处理随机效果命令
-void handle_random_command(twai_message_t *message) {
-    if (message->data_length_code < 1) {
-        ESP_LOGE(TAG, "随机效果命令数据长度不足");
+// 处理情绪状态命令
+static void handle_emotion_command(const twai_message_t *message, void *arg) {
+    espcan_emotion_cmd_t cmd;
+    if (espcan_decode_emotion_cmd(message, &cmd) != ESP_OK) {
+        ESP_LOGE(TAG, "情绪状态命令数据长度不足");
         return;
     }
     
-    uint8_t random_state = message->data[0];
+    set_emotion(cmd.emotion);
+}
+
+// 设置随机效果
+static void set_random_effect(uint8_t random_state, uint8_t speed, uint8_t brightness) {
     random_effect.enabled = random_state;
-    
-    // 如果有额外参数则解析
-    if (message->data_length_code >= 2) {
-        random_effect.speed = message->data[1];
-    } else {
-        random_effect.speed = 128; // 默认中等速度
-    }
-    
-    if (message->data_length_code >= 3) {
-        random_effect.brightness = message->data[2];
-    } else {
-        random_effect.brightness = 200; // 默认较高亮度
-    }
+    random_effect.speed = speed;
+    random_effect.brightness = brightness;
     
     // 重置计时器
     random_effect.timer = 0;
@@ -237,477 +239,217 @@ void handle_random_command(twai_message_t *message) {
              random_effect.brightness);
 }
 
-// 彩虹效果实现
-void rainbow_effect(int delay_ms) {
-    static uint8_t hue = 0;
-    
-    // 创建彩虹效果
-    for (int i = 0; i < WS2812_LEDS_COUNT_PER_STRIP; i++) {
-        // 计算每个LED的色调，形成彩虹
-        uint8_t pos = (i * 256 / WS2812_LEDS_COUNT_PER_STRIP + hue) & 0xFF;
-        
-        // 将HSV转换为RGB (简化版彩虹算法)
-        if (pos < 85) {
-            led_strip_set_pixel(led_strip_1, i, 255 - pos * 3, pos * 3, 0);
-            led_strip_set_pixel(led_strip_2, i, 255 - pos * 3, pos * 3, 0);
-        } else if (pos < 170) {
-            pos -= 85;
-            led_strip_set_pixel(led_strip_1, i, 0, 255 - pos * 3, pos * 3);
-            led_strip_set_pixel(led_strip_2, i, 0, 255 - pos * 3, pos * 3);
-        } else {
-            pos -= 170;
-            led_strip_set_pixel(led_strip_1, i, pos * 3, 0, 255 - pos * 3);
-            led_strip_set_pixel(led_strip_2, i, pos * 3, 0, 255 - pos * 3);
-        }
+// 处理随机效果命令
+static void handle_random_command(const twai_message_t *message, void *arg) {
+    // 没有携带的参数使用默认值: 中等速度、较高亮度
+    espcan_random_cmd_t cmd = {
+        .speed = 128,
+        .brightness = 200,
+    };
+    if (espcan_decode_random_cmd(message, &cmd) != ESP_OK) {
+        ESP_LOGE(TAG, "随机效果命令数据长度不足");
+        return;
     }
     
-    // 更新显示
-    led_strip_refresh(led_strip_1);
-    led_strip_refresh(led_strip_2);
-    
-    // 移动彩虹
-    hue += 1;
-    
-    // 延时
-    vTaskDelay(pdMS_TO_TICKS(delay_ms));
+    set_random_effect(cmd.state, cmd.speed, cmd.brightness);
 }
 
-// 闪电效果实现
-void lightning_effect(int delay_ms) {
-    // 先清空所有LED
-    clear_leds();
-    
-    // 随机生成闪电位置
-    int num_flashes = 3 + esp_random() % 4; // 3-6个闪电点
-    
-    for (int i = 0; i < num_flashes; i++) {
-        int pos = esp_random() % WS2812_LEDS_COUNT_PER_STRIP;
-        
-        // 设置闪电 - 随机选择白色或蓝白色
-        uint8_t intensity = 150 + esp_random() % 105; // 150-255
-        uint8_t is_blue = esp_random() % 2; // 0=白色闪电, 1=蓝色闪电
-        
-        if (is_blue) {
-            // 蓝白色闪电
-            led_strip_set_pixel(led_strip_1, pos, intensity/2, intensity/2, intensity);
-            led_strip_set_pixel(led_strip_2, pos, intensity/2, intensity/2, intensity);
-            
-            // 闪电周围有淡蓝色光晕
-            if (pos > 0) {
-                led_strip_set_pixel(led_strip_1, pos-1, 20, 20, 120);
-                led_strip_set_pixel(led_strip_2, pos-1, 20, 20, 120);
-            }
-            if (pos < WS2812_LEDS_COUNT_PER_STRIP-1) {
-                led_strip_set_pixel(led_strip_1, pos+1, 20, 20, 120);
-                led_strip_set_pixel(led_strip_2, pos+1, 20, 20, 120);
-            }
-        } else {
-            // 白色闪电
-            led_strip_set_pixel(led_strip_1, pos, intensity, intensity, intensity);
-            led_strip_set_pixel(led_strip_2, pos, intensity, intensity, intensity);
-            
-            // 闪电周围有淡白色光晕
-            if (pos > 0) {
-                led_strip_set_pixel(led_strip_1, pos-1, 100, 100, 100);
-                led_strip_set_pixel(led_strip_2, pos-1, 100, 100, 100);
-            }
-            if (pos < WS2812_LEDS_COUNT_PER_STRIP-1) {
-                led_strip_set_pixel(led_strip_1, pos+1, 100, 100, 100);
-                led_strip_set_pixel(led_strip_2, pos+1, 100, 100, 100);
-            }
-        }
-    }
-    
-    // 更新显示
-    led_strip_refresh(led_strip_1);
-    led_strip_refresh(led_strip_2);
+// 执行场景: 灯光节点使用情绪、LED和随机效果部分
+static void apply_scene(const void *data) {
+    const espcan_scene_t *scene = data;
     
-    // 闪电持续时间短
-    vTaskDelay(pdMS_TO_TICKS(delay_ms));
-    
-    // 随机决定是否有黑暗期
-    if (esp_random() % 5 == 0) {
-        clear_leds();
-        vTaskDelay(pdMS_TO_TICKS(delay_ms * 2));
-    }
+    ESP_LOGI(TAG, "场景 #%d 生效", scene->sequence);
+    set_led_state((scene->flags & ESPCAN_SCENE_LED_ON) ? 1 : 0);
+    set_random_effect((scene->flags & ESPCAN_SCENE_RANDOM_ON) ? 1 : 0,
+                      scene->random_speed, scene->random_brightness);
+    set_emotion(scene->emotion);
 }
 
-// 紫色追逐效果实现
-void purple_chase_effect(int delay_ms) {
-    static int position = 0;
-    
-    // 先清空所有LED
-    clear_leds();
-    
-    // 追逐灯的长度
-    const int chase_length = 5;
-    
-    // 创建紫色追逐效果
-    for (int i = 0; i < chase_length; i++) {
-        int pos = (position + i) % WS2812_LEDS_COUNT_PER_STRIP;
-        // 根据距离头部的位置，亮度逐渐降低
-        uint8_t brightness = 255 - (i * 255 / chase_length);
-        led_strip_set_pixel(led_strip_1, pos, brightness, 0, brightness);
-        led_strip_set_pixel(led_strip_2, pos, brightness, 0, brightness);
+// 处理场景命令: 带生效时间的场景到时间再执行，和其它节点同时切换
+static void handle_scene_command(const twai_message_t *message, void *arg) {
+    espcan_scene_t scene;
+    if (espcan_decode_scene(message, &scene) != ESP_OK) {
+        ESP_LOGE(TAG, "场景命令数据长度不足");
+        return;
     }
     
-    // 更新显示
-    led_strip_refresh(led_strip_1);
-    led_strip_refresh(led_strip_2);
-    
-    // 移动追逐位置
-    position = (position + 1) % WS2812_LEDS_COUNT_PER_STRIP;
-    
-    // 延时
-    vTaskDelay(pdMS_TO_TICKS(delay_ms));
+    if (scene.flags & ESPCAN_SCENE_TIMED) {
+        espcan_sync_run_at(scene.activate_tick, apply_scene, &scene, sizeof(scene));
+    } else {
+        apply_scene(&scene);
+    }
 }
 
-// 随机流星效果实现
-void meteor_shower_effect(int delay_ms, uint8_t brightness) {
-    static uint32_t last_meteor = 0;
-    static int meteor_positions[10] = {-1, -1, -1, -1, -1, -1, -1, -1, -1, -1};
-    static uint8_t meteor_colors[10][3] = {0};
-    
-    // 根据亮度调整效果
-    uint8_t max_brightness = brightness;
-    
-    // 先清空所有LED
-    clear_leds();
-    
-    // 随机生成新流星
-    random_effect.timer++;
-    
-    // 每隔一段时间生成新流星
-    if (random_effect.timer - last_meteor > (300 - random_effect.speed)) {
-        // 寻找空闲位置
-        for (int i = 0; i < 10; i++) {
-            if (meteor_positions[i] == -1) {
-                // 创建新流星
-                meteor_positions[i] = 0;
-                
-                // 随机颜色
-                uint8_t color_type = esp_random() % 5;
-                switch (color_type) {
-                    case 0: // 白色
-                        meteor_colors[i][0] = max_brightness;
-                        meteor_colors[i][1] = max_brightness;
-                        meteor_colors[i][2] = max_brightness;
-                        break;
-                    case 1: // 蓝色
-                        meteor_colors[i][0] = 0;
-                        meteor_colors[i][1] = 0;
-                        meteor_colors[i][2] = max_brightness;
-                        break;
-                    case 2: // 绿色
-                        meteor_colors[i][0] = 0;
-                        meteor_colors[i][1] = max_brightness;
-                        meteor_colors[i][2] = 0;
-                        break;
-                    case 3: // 红色
-                        meteor_colors[i][0] = max_brightness;
-                        meteor_colors[i][1] = 0;
-                        meteor_colors[i][2] = 0;
-                        break;
-                    case 4: // 紫色
-                        meteor_colors[i][0] = max_brightness;
-                        meteor_colors[i][1] = 0;
-                        meteor_colors[i][2] = max_brightness;
-                        break;
-                }
-                
-                last_meteor = random_effect.timer;
-                break;
-            }
-        }
+// 打印未注册的帧
+static void handle_unknown_frame(const twai_message_t *message, void *arg) {
+    if (message->rtr) {
+        ESP_LOGI(TAG, "[RTR] 请求长度: %d", message->data_length_code);
+        return;
     }
     
-    // 更新所有流星
-    for (int i = 0; i < 10; i++) {
-        if (meteor_positions[i] >= 0) {
-            // 流星头部
-            int pos = meteor_positions[i];
-            
-            if (pos < WS2812_LEDS_COUNT_PER_STRIP) {
-                // 设置流星头部
-                led_strip_set_pixel(led_strip_1, pos, 
-                                   meteor_colors[i][0], 
-                                   meteor_colors[i][1], 
-                                   meteor_colors[i][2]);
-                
-                // 流星尾部
-                for (int tail = 1; tail < 5; tail++) {
-                    if (pos - tail >= 0) {
-                        // 尾部亮度递减
-                        float fade = 1.0f - (tail / 5.0f);
-                        led_strip_set_pixel(led_strip_1, pos - tail, 
-                                          meteor_colors[i][0] * fade, 
-                                          meteor_colors[i][1] * fade, 
-                                          meteor_colors[i][2] * fade);
-                    }
-                }
-            }
-            
-            // 移动流星
-            meteor_positions[i]++;
-            
-            // 如果流星离开了LED条，则标记为空闲
-            if (meteor_positions[i] > WS2812_LEDS_COUNT_PER_STRIP + 5) {
-                meteor_positions[i] = -1;
-            }
-        }
+    // 打印ASCII数据
+    printf("数据 (ASCII): ");
+    for (int i = 0; i < message->data_length_code; i++) {
+        printf("%c", message->data[i]);
     }
+    printf("\n");
     
-    // 更新显示
-    led_strip_refresh(led_strip_1);
+    // 打印HEX格式数据
+    printf("数据 (HEX): ");
+    if (message->extd) {
+        printf("扩展帧 ");
+    } else {
+        printf("标准帧 ");
+    }
     
-    // 延时
-    vTaskDelay(pdMS_TO_TICKS(delay_ms));
+    printf("数据长度: %d 字节 - ", message->data_length_code);
+    for (int i = 0; i < message->data_length_code; i++) {
+        printf("0x%02X ", message->data[i]);
+    }
+    printf("\n");
 }
 
-// 随机颜色爆炸效果
-void random_explosion_effect(int delay_ms, uint8_t brightness) {
-    static uint32_t last_explosion = 0;
-    static int explosion_center = -1;
-    static uint8_t explosion_size = 0;
-    static uint8_t explosion_color[3] = {0};
-    
-    // 先清空所有LED
-    clear_leds();
-    
-    // 计时器更新
-    random_effect.timer++;
-    
-    // 如果没有活跃的爆炸或爆炸已经完成
-    if (explosion_center == -1 || explosion_size > 20) {
-        // 每隔一段时间生成新爆炸
-        if (random_effect.timer - last_explosion > (500 - random_effect.speed * 2)) {
-            // 创建新爆炸
-            explosion_center = esp_random() % WS2812_LEDS_COUNT_PER_STRIP;
-            explosion_size = 0;
-            
-            // 随机颜色
-            uint8_t color_r = esp_random() % 256;
-            uint8_t color_g = esp_random() % 256;
-            uint8_t color_b = esp_random() % 256;
-            
-            // 确保颜色足够亮
-            while (color_r + color_g + color_b < 150) {
-                color_r = esp_random() % 256;
-                color_g = esp_random() % 256;
-                color_b = esp_random() % 256;
-            }
-            
-            // 应用亮度
-            explosion_color[0] = (color_r * brightness) / 255;
-            explosion_color[1] = (color_g * brightness) / 255;
-            explosion_color[2] = (color_b * brightness) / 255;
-            
-            last_explosion = random_effect.timer;
-        }
+// 各情绪状态对应效果的目标帧率
+static uint32_t emotion_effect_fps(uint8_t emotion) {
+    switch (emotion) {
+        case ESPCAN_EMOTION_NEUTRAL:
+            return BREATHING_FPS;
+        case ESPCAN_EMOTION_HAPPY:
+            return RAINBOW_FPS;
+        case ESPCAN_EMOTION_SAD:
+            return PURPLE_CHASE_FPS;
+        case ESPCAN_EMOTION_SURPRISE:
+            return LIGHTNING_FPS;
+        case ESPCAN_EMOTION_RANDOM:
+            return random_effect.enabled ? BREATHING_FPS : IDLE_FPS;
+        default:
+            return IDLE_FPS;
     }
-    
-    // 如果有活跃的爆炸
-    if (explosion_center != -1) {
-        // 爆炸中心亮度最高
-        float center_brightness = 1.0f - (explosion_size / 20.0f);
-        led_strip_set_pixel(led_strip_1, explosion_center, 
-                           explosion_color[0] * center_brightness, 
-                           explosion_color[1] * center_brightness, 
-                           explosion_color[2] * center_brightness);
-        
-        // 爆炸向两侧扩散
-        for (int i = 1; i <= explosion_size; i++) {
-            // 计算衰减
-            float fade = 1.0f - (i / (float)explosion_size);
-            
-            // 左侧
-            if (explosion_center - i >= 0) {
-                led_strip_set_pixel(led_strip_1, explosion_center - i, 
-                                   explosion_color[0] * fade, 
-                                   explosion_color[1] * fade, 
-                                   explosion_color[2] * fade);
-            }
-            
-            // 右侧
-            if (explosion_center + i < WS2812_LEDS_COUNT_PER_STRIP) {
-                led_strip_set_pixel(led_strip_1, explosion_center + i, 
-                                   explosion_color[0] * fade, 
-                                   explosion_color[1] * fade, 
-                                   explosion_color[2] * fade);
-            }
+}
+
+// 输出动画调度统计
+static void report_animation_stats(anim_scheduler_t *sched) {
+    anim_stats_t stats;
+    anim_scheduler_take_stats(sched, &stats);
+    
+    espcan_sync_stats_t sync;
+    espcan_sync_get_stats(&sync);
+    ESP_LOGI(TAG, "时间同步: %s, 偏差%ldus, 频偏%ldppb, 样本%lu 丢弃%lu, 场景按时%lu 立即%lu",
+             sync.locked ? "已同步" : "未同步", (long)sync.last_error_us, (long)sync.drift_ppb,
+             (unsigned long)sync.samples, (unsigned long)sync.rejected,
+             (unsigned long)sync.scheduled, (unsigned long)sync.immediate);
+    
+    ESP_LOGI(TAG, "动画统计: %lu帧, 错过截止时间%lu, 跳过%lu帧, 最长帧%luus",
+             (unsigned long)stats.frames, (unsigned long)stats.missed_deadlines,
+             (unsigned long)stats.skipped_frames, (unsigned long)stats.max_frame_us);
+    ESP_LOGI(TAG, "帧耗时分布: <10ms:%lu <20ms:%lu <30ms:%lu <50ms:%lu <100ms:%lu >=100ms:%lu",
+             (unsigned long)stats.frame_time_hist[0], (unsigned long)stats.frame_time_hist[1],
+             (unsigned long)stats.frame_time_hist[2], (unsigned long)stats.frame_time_hist[3],
+             (unsigned long)stats.frame_time_hist[4], (unsigned long)stats.frame_time_hist[5]);
+    
+    compositor_stats_t comp;
+    compositor_take_stats(&comp);
+    ESP_LOGI(TAG, "灯带发送: %lu帧 %lu次刷新, 平均每帧%lu字节, 上传平均%luus, 渲染等待%lu次/%luus",
+             (unsigned long)comp.frames, (unsigned long)comp.refreshes,
+             (unsigned long)(comp.frames ? comp.wire_bytes / comp.frames : 0),
+             (unsigned long)(comp.frames ? comp.upload_us / comp.frames : 0),
+             (unsigned long)comp.render_stalls, (unsigned long)comp.render_stall_us);
+    
+    led_strip_handle_t strips[] = {led_strip_1, led_strip_2};
+    for (int i = 0; i < 2; i++) {
+        led_strip_power_stats_t power;
+        if (led_strip_get_power_stats(strips[i], &power) == ESP_OK) {
+            ESP_LOGI(TAG, "灯带%d功率: 估算%lumA, 限制后%lumA, 缩放%u/255, 累计限制%lu帧", i + 1,
+                     (unsigned long)power.estimated_ma, (unsigned long)power.output_ma,
+                     power.scale, (unsigned long)power.limited_frames);
         }
         
-        // 增加爆炸尺寸
-        explosion_size++;
-        
-        // 如果爆炸完成
-        if (explosion_size > 20) {
-            explosion_center = -1; // 标记爆炸结束
+        led_strip_rmt_stream_stats_t stream;
+        if (led_strip_rmt_get_stream_stats(strips[i], &stream) != ESP_OK) {
+            continue;
         }
+        ESP_LOGI(TAG, "灯带%d队列: 已发送%lu/%lu帧, 当前%lu帧, 峰值%lu帧, 帧间空闲%luus (峰值%luus)", i + 1,
+                 (unsigned long)stream.frames_done, (unsigned long)stream.frames_queued,
+                 (unsigned long)stream.queue_len, (unsigned long)stream.max_queue_len,
+                 (unsigned long)stream.last_gap_us, (unsigned long)stream.max_gap_us);
     }
-    
-    // 更新显示
-    led_strip_refresh(led_strip_1);
-    
-    // 延时
-    vTaskDelay(pdMS_TO_TICKS(delay_ms));
 }
 
-// 呼吸灯效果实现
-void breathing_light_effect(int delay_ms, uint8_t brightness) {
-    static float breath_level = 0.0f;
-    static int direction = 1;  // 1 = 增加亮度, -1 = 减少亮度
-    
-    // 呼吸灯的颜色 - 使用柔和的白色
-    uint8_t base_r = 255;
-    uint8_t base_g = 220;
-    uint8_t base_b = 180;
-    
-    // 计算当前亮度级别
-    float intensity = breath_level * breath_level; // 使用平方关系使变化看起来更自然
-    
-    // 应用主亮度参数
-    intensity = intensity * brightness / 255.0f;
-    
-    // 设置所有LED为相同的呼吸亮度
-    for (int i = 0; i < WS2812_LEDS_COUNT_PER_STRIP; i++) {
-        led_strip_set_pixel(led_strip_1, i, 
-                          base_r * intensity, 
-                          base_g * intensity, 
-                          base_b * intensity);
-        
-        led_strip_set_pixel(led_strip_2, i, 
-                          base_r * intensity, 
-                          base_g * intensity, 
-                          base_b * intensity);
-    }
-    
-    // 更新显示
-    led_strip_refresh(led_strip_1);
-    led_strip_refresh(led_strip_2);
+// 情绪灯光动画任务
+void emotion_animation_task(void *pvParameters) {
+    anim_scheduler_t *sched = &anim_sched;
+    uint32_t active_fps = IDLE_FPS;
+    int64_t last_report_us = esp_timer_get_time();
     
-    // 更新呼吸级别
-    breath_level += direction * 0.01f;
+    anim_scheduler_init(sched, active_fps);
     
-    // 改变方向
-    if (breath_level >= 1.0f) {
-        breath_level = 1.0f;
-        direction = -1;
-    } else if (breath_level <= 0.0f) {
-        breath_level = 0.0f;
-        direction = 1;
+    // 本任务负责渲染，发送交给另一个核心上的发送任务
+    if (compositor_start_pipeline(LED_TX_CORE) != ESP_OK) {
+        ESP_LOGW(TAG, "流水线启动失败，渲染和发送在同一任务中进行");
     }
     
-    // 延时
-    vTaskDelay(pdMS_TO_TICKS(delay_ms));
-}
-
-// 颜色变化的呼吸灯效果 (用于中性情绪状态)
-void color_changing_breathing_effect(int delay_ms) {
-    static float breath_level = 0.0f;
-    static int direction = 1;  // 1 = 增加亮度, -1 = 减少亮度
-    static uint8_t hue = 0;    // 色相值，用于颜色循环
-    
-    // 计算当前亮度级别
-    float intensity = breath_level * breath_level; // 使用平方关系使变化看起来更自然
-    
-    // 将HSV转换为RGB (简化版)
-    uint8_t r, g, b;
-    
-    if (hue < 85) {
-        r = 255 - hue * 3;
-        g = hue * 3;
-        b = 0;
-    } else if (hue < 170) {
-        hue -= 85;
-        r = 0;
-        g = 255 - hue * 3;
-        b = hue * 3;
-    } else {
-        hue -= 170;
-        r = hue * 3;
-        g = 0;
-        b = 255 - hue * 3;
-    }
-    
-    // 设置所有LED为相同的颜色和亮度
-    for (int i = 0; i < WS2812_LEDS_COUNT_PER_STRIP; i++) {
-        led_strip_set_pixel(led_strip_1, i, 
-                          r * intensity, 
-                          g * intensity, 
-                          b * intensity);
+    while (1) {
+        uint8_t emotion = current_emotion;
         
-        led_strip_set_pixel(led_strip_2, i, 
-                          r * intensity, 
-                          g * intensity, 
-                          b * intensity);
-    }
-    
-    // 更新显示
-    led_strip_refresh(led_strip_1);
-    led_strip_refresh(led_strip_2);
-    
-    // 更新呼吸级别
-    breath_level += direction * 0.01f;
-    
-    // 改变方向
-    if (breath_level >= 1.0f) {
-        breath_level = 1.0f;
-        direction = -1;
+        // 切换效果时调整目标帧率
+        uint32_t fps = emotion_effect_fps(emotion);
+        if (fps != active_fps) {
+            active_fps = fps;
+            anim_scheduler_set_fps(sched, fps);
+        }
+        
+        uint32_t elapsed_ms = anim_scheduler_begin_frame(sched);
+        
+        // 随机效果的亮度来自CAN命令，其它效果全亮；亮度变化不需要重新渲染
+        compositor_set_brightness(emotion == ESPCAN_EMOTION_RANDOM ? random_effect.brightness : 255);
         
-        // 当达到最大亮度时，改变颜色
-        hue = (hue + 5) % 255;
-    } else if (breath_level <= 0.0f) {
-        breath_level = 0.0f;
-        direction = 1;
-    }
-    
-    // 延时
-    vTaskDelay(pdMS_TO_TICKS(delay_ms));
-}
-
-// 情绪灯光动画任务
-void emotion_animation_task(void *pvParameters) {
-    while (1) {
         // 根据当前情绪状态设置灯光效果
-        switch (current_emotion) {
-            case EMOTION_NEUTRAL:
+        switch (emotion) {
+            case ESPCAN_EMOTION_NEUTRAL:
                 // 中性 - 呼吸灯切换颜色效果
-                color_changing_breathing_effect(30);
+                color_changing_breathing_effect(elapsed_ms);
                 break;
                 
-            case EMOTION_HAPPY:
+            case ESPCAN_EMOTION_HAPPY:
                 // 开心 - 彩虹效果
-                rainbow_effect(50);
+                rainbow_effect(elapsed_ms);
                 break;
                 
-            case EMOTION_SAD:
+            case ESPCAN_EMOTION_SAD:
                 // 伤心 - 紫色追逐
-                purple_chase_effect(30);
+                purple_chase_effect(elapsed_ms);
                 break;
                 
-            case EMOTION_SURPRISE:
+            case ESPCAN_EMOTION_SURPRISE:
                 // 惊讶 - 闪电效果
-                lightning_effect(80);
+                lightning_effect(elapsed_ms);
                 break;
                 
-            case EMOTION_RANDOM:
+            case ESPCAN_EMOTION_RANDOM:
                 // 随机效果 - 呼吸灯效果
                 if (random_effect.enabled) {
-                    // 使用呼吸灯效果替代原来的效果
-                    breathing_light_effect(30, random_effect.brightness);
+                    // 使用呼吸灯效果替代原来的效果，亮度由灯带驱动在发送时应用
+                    breathing_light_effect(elapsed_ms, 255);
                 } else {
                     clear_leds();
-                    vTaskDelay(pdMS_TO_TICKS(100));
                 }
                 break;
                 
             default:
                 // 默认状态 - 关闭灯
                 clear_leds();
-                vTaskDelay(pdMS_TO_TICKS(200));
                 break;
         }
+        
+        // 等待下一个帧周期
+        anim_scheduler_end_frame(sched);
+        
+        // 定期输出统计
+        int64_t now = esp_timer_get_time();
+        if (now - last_report_us >= ANIM_STATS_INTERVAL_MS * 1000LL) {
+            last_report_us = now;
+            report_animation_stats(sched);
+        }
     }
 }
 
@@ -717,11 +459,9 @@ void blink_can_ready(void) {
     for (int i = 0; i < 2; i++) {
         // 设置所有LED为绿色
         for (int j = 0; j < 5; j++) {
-            led_strip_set_pixel(led_strip_1, j, 0, 255, 0);  // 绿色
-            led_strip_set_pixel(led_strip_2, j, 0, 255, 0);  // 绿色
+            compositor_set_pixel(j, 0, 255, 0);  // 绿色
         }
-        led_strip_refresh(led_strip_1);
-        led_strip_refresh(led_strip_2);
+        compositor_present();
         vTaskDelay(pdMS_TO_TICKS(300));  // 亮300ms
         
         // 关闭所有LED
@@ -740,37 +480,53 @@ void app_main(void)
     // 初始化WS2812灯带
     ws2812_init();
     
+    // 初始化帧合成器
+    led_strip_handle_t strips[] = {led_strip_1, led_strip_2};
+    ESP_ERROR_CHECK(compositor_init(strips, 2, WS2812_LEDS_COUNT_PER_STRIP, LED_CANVAS_LEDS,
+                                    led_layout, sizeof(led_layout) / sizeof(led_layout[0])));
+    compositor_set_high_depth(true);  // 灯带以high_depth模式创建
+    
+    // 生成颜色查找表
+    color_kernel_init();
+    
     // 测试代码：设置几个固定颜色的LED，检查基本功能
     ESP_LOGI(TAG, "显示固定颜色测试 - 5秒");
     // 设置不同颜色块测试
-    for (int i = 0; i < WS2812_LEDS_COUNT_PER_STRIP && i < 20; i++) {
+    for (int i = 0; i < LED_CANVAS_LEDS && i < 20; i++) {
         if (i < 5) {
-            led_strip_set_pixel(led_strip_1, i, 255, 0, 0);   // 红色
-            led_strip_set_pixel(led_strip_2, i, 255, 0, 0);   // 红色
+            compositor_set_pixel(i, 255, 0, 0);   // 红色
         } else if (i < 10) {
-            led_strip_set_pixel(led_strip_1, i, 0, 255, 0);   // 绿色
-            led_strip_set_pixel(led_strip_2, i, 0, 255, 0);   // 绿色
+            compositor_set_pixel(i, 0, 255, 0);   // 绿色
         } else if (i < 15) {
-            led_strip_set_pixel(led_strip_1, i, 0, 0, 255);   // 蓝色
-            led_strip_set_pixel(led_strip_2, i, 0, 0, 255);   // 蓝色
+            compositor_set_pixel(i, 0, 0, 255);   // 蓝色
         } else {
-            led_strip_set_pixel(led_strip_1, i, 255, 255, 255); // 白色
-            led_strip_set_pixel(led_strip_2, i, 255, 255, 255); // 白色
+            compositor_set_pixel(i, 255, 255, 255); // 白色
         }
     }
-    led_strip_refresh(led_strip_1);
-    led_strip_refresh(led_strip_2);
+    compositor_present();
     
     // 延迟更长时间以便观察
     vTaskDelay(pdMS_TO_TICKS(5000));
     clear_leds();
     
     // 测试代码：设置一个固定的情绪状态进行测试
-    current_emotion = EMOTION_NEUTRAL; // 初始化为中性情绪效果
+    current_emotion = ESPCAN_EMOTION_NEUTRAL; // 初始化为中性情绪效果
+    
+    // 注册CAN消息处理函数
+    ESP_ERROR_CHECK(espcan_register_handler(ESPCAN_ID_LED_CMD, handle_led_command, NULL));
+    ESP_ERROR_CHECK(espcan_register_handler(ESPCAN_ID_EMOTION_CMD, handle_emotion_command, NULL));
+    ESP_ERROR_CHECK(espcan_register_handler(ESPCAN_ID_RANDOM_CMD, handle_random_command, NULL));
+    ESP_ERROR_CHECK(espcan_register_handler(ESPCAN_ID_SCENE, handle_scene_command, NULL));
+    espcan_set_default_handler(handle_unknown_frame, NULL);
+    ESP_ERROR_CHECK(espcan_sync_init());
+    
+    // 按注册的ID规划接收过滤器
+    espcan_filter_plan_t filter;
+    ESP_ERROR_CHECK(espcan_filter_plan_registered(&filter));
     
     // 安装TWAI驱动
     ESP_LOGI(TAG, "CAN接收端初始化中...");
-    ESP_ERROR_CHECK(twai_driver_install(&g_config, &t_config, &f_config));
+    ESP_ERROR_CHECK(twai_driver_install(&g_config, &t_config, &filter.config));
     ESP_LOGI(TAG, "TWAI驱动安装成功");
 
     // 启动TWAI驱动
@@ -782,7 +538,7 @@ void app_main(void)
     blink_can_ready();
     
     // 创建情绪动画任务
-    xTaskCreate(emotion_animation_task, "emotion_animation", 4096, NULL, 5, NULL);
+    xTaskCreatePinnedToCore(emotion_animation_task, "emotion_animation", 4096, NULL, 5, NULL, LED_RENDER_CORE);
 
     twai_message_t rx_message;
     
@@ -791,40 +547,13 @@ void app_main(void)
         esp_err_t result = twai_receive(&rx_message, pdMS_TO_TICKS(10000));
         
         if (result == ESP_OK) {
-            // 打印帧信息
-            ESP_LOGI(TAG, "接收到CAN帧 - ID: 0x%lX", (unsigned long)rx_message.identifier);
-            
-            // 检查消息类型
-            if (rx_message.identifier == LED_CMD_ID) {
-                handle_led_command(&rx_message);
-            } else if (rx_message.identifier == EMOTION_CMD_ID) {
-                handle_emotion_command(&rx_message);
-            } else if (rx_message.identifier == RANDOM_CMD_ID) {
-                handle_random_command(&rx_message);
-            } else if (rx_message.rtr) {
-                ESP_LOGI(TAG, "[RTR] 请求长度: %d", rx_message.data_length_code);
-            } else {
-                // 打印ASCII数据
-                printf("数据 (ASCII): ");
-                for (int i = 0; i < rx_message.data_length_code; i++) {
-                    printf("%c", rx_message.data[i]);
-                }
-                printf("\n");
-                
-                // 打印HEX格式数据
-                printf("数据 (HEX): ");
-                if (rx_message.extd) {
-                    printf("扩展帧 ");
-                } else {
-                    printf("标准帧 ");
-                }
-                
-                printf("数据长度: %d 字节 - ", rx_message.data_length_code);
-                for (int i = 0; i < rx_message.data_length_code; i++) {
-                    printf("0x%02X ", rx_message.data[i]);
-                }
-                printf("\n");
+            // 打印帧信息 (同步帧每秒一帧且需要立即取时间戳，不打印)
+            if (rx_message.identifier != ESPCAN_ID_TIME_SYNC) {
+                ESP_LOGI(TAG, "接收到CAN帧 - ID: 0x%lX", (unsigned long)rx_message.identifier);
             }
+            
+            // 按ID查表分发
+            espcan_dispatch(&rx_message);
         } else if (result == ESP_ERR_TIMEOUT) {
             ESP_LOGI(TAG, "等待接收超时，继续等待...");
         } else {
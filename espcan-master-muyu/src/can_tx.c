@@ -0,0 +1,191 @@
+// CAN发送调度: 调用者只把帧放进按ID划分的槽位，由独立任务发送
+//
+// 总线繁忙时，同一目标的旧命令在槽位中被新命令覆盖，不会排队发出过期的状态；
+// 串口解析和木鱼检测任务不再被twai_transmit阻塞。
+
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "can_tx.h"
+
+#define CAN_TX_TIMEOUT_MS 100   // 等待TWAI发送队列空位的时间
+#define CAN_TX_RETRY_MS 50      // 发送失败后重试前的等待 (总线关闭时避免空转)
+
+static const char *TAG = "CAN_TX";
+
+typedef struct {
+    bool used;
+    bool pending;               // 等待发送
+    twai_message_t message;     // 该ID最新的一帧
+    int64_t submit_us;          // 最新一帧的提交时间
+} can_tx_slot_t;
+
+static can_tx_slot_t slots[CAN_TX_SLOTS];
+
+// 待发送槽位的先后顺序 (每个槽位最多出现一次，不会溢出)
+static uint8_t order[CAN_TX_SLOTS];
+static uint32_t order_head = 0;
+static uint32_t order_count = 0;
+
+static can_tx_stats_t stats;
+static uint64_t total_latency_us = 0;
+
+static portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t tx_task = NULL;
+
+// 查找ID对应的槽位，没有时分配一个 (调用时持有锁)
+static can_tx_slot_t *find_slot(uint32_t identifier)
+{
+    can_tx_slot_t *free_slot = NULL;
+    for (int i = 0; i < CAN_TX_SLOTS; i++) {
+        if (slots[i].used && slots[i].message.identifier == identifier) {
+            return &slots[i];
+        }
+        if (!slots[i].used && free_slot == NULL) {
+            free_slot = &slots[i];
+        }
+    }
+    if (free_slot) {
+        free_slot->used = true;
+        free_slot->pending = false;
+    }
+    return free_slot;
+}
+
+// 把槽位加入待发送顺序 (调用时持有锁)；front为true时排在最前面 (发送失败重试)
+static void push_slot(can_tx_slot_t *slot, bool front)
+{
+    uint8_t index = slot - slots;
+    if (front) {
+        order_head = (order_head + CAN_TX_SLOTS - 1) % CAN_TX_SLOTS;
+        order[order_head] = index;
+    } else {
+        order[(order_head + order_count) % CAN_TX_SLOTS] = index;
+    }
+    order_count++;
+    slot->pending = true;
+
+    stats.depth = order_count;
+    if (order_count > stats.max_depth) {
+        stats.max_depth = order_count;
+    }
+}
+
+// 取出最早的待发送槽位 (调用时持有锁)
+static can_tx_slot_t *pop_slot(void)
+{
+    if (order_count == 0) {
+        return NULL;
+    }
+    can_tx_slot_t *slot = &slots[order[order_head]];
+    order_head = (order_head + 1) % CAN_TX_SLOTS;
+    order_count--;
+    slot->pending = false;
+    stats.depth = order_count;
+    return slot;
+}
+
+static void can_tx_task(void *pvParameters)
+{
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        while (1) {
+            twai_message_t message;
+            int64_t submit_us;
+
+            portENTER_CRITICAL(&lock);
+            can_tx_slot_t *slot = pop_slot();
+            if (slot) {
+                message = slot->message;
+                submit_us = slot->submit_us;
+            }
+            portEXIT_CRITICAL(&lock);
+
+            if (slot == NULL) {
+                break;
+            }
+
+            esp_err_t result = twai_transmit(&message, pdMS_TO_TICKS(CAN_TX_TIMEOUT_MS));
+
+            portENTER_CRITICAL(&lock);
+            if (result == ESP_OK) {
+                uint32_t latency_us = (uint32_t)(esp_timer_get_time() - submit_us);
+                stats.sent++;
+                total_latency_us += latency_us;
+                if (latency_us > stats.max_latency_us) {
+                    stats.max_latency_us = latency_us;
+                }
+            } else {
+                stats.failed++;
+                if (slot->pending) {
+                    // 发送期间已经有同ID的新命令，失败的旧帧不再重试
+                    stats.coalesced++;
+                } else {
+                    push_slot(slot, true);
+                }
+            }
+            portEXIT_CRITICAL(&lock);
+
+            if (result != ESP_OK) {
+                ESP_LOGW(TAG, "发送ID 0x%lX失败: %s", (unsigned long)message.identifier, esp_err_to_name(result));
+                vTaskDelay(pdMS_TO_TICKS(CAN_TX_RETRY_MS));
+            }
+        }
+    }
+}
+
+esp_err_t can_tx_init(UBaseType_t priority)
+{
+    if (tx_task) {
+        return ESP_OK;
+    }
+    if (xTaskCreate(can_tx_task, "can_tx_task", 3072, NULL, priority, &tx_task) != pdPASS) {
+        ESP_LOGE(TAG, "创建CAN发送任务失败");
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+esp_err_t can_tx_submit(const twai_message_t *message)
+{
+    if (tx_task == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    int64_t now_us = esp_timer_get_time();
+
+    portENTER_CRITICAL(&lock);
+    can_tx_slot_t *slot = find_slot(message->identifier);
+    if (slot == NULL) {
+        stats.rejected++;
+        portEXIT_CRITICAL(&lock);
+        return ESP_ERR_NO_MEM;
+    }
+
+    stats.submitted++;
+    if (slot->pending) {
+        stats.coalesced++;
+    } else {
+        push_slot(slot, false);
+    }
+    slot->message = *message;
+    slot->submit_us = now_us;
+    portEXIT_CRITICAL(&lock);
+
+    xTaskNotifyGive(tx_task);
+    return ESP_OK;
+}
+
+void can_tx_take_stats(can_tx_stats_t *out)
+{
+    portENTER_CRITICAL(&lock);
+    *out = stats;
+    out->avg_latency_us = stats.sent ? (uint32_t)(total_latency_us / stats.sent) : 0;
+    memset(&stats, 0, sizeof(stats));
+    stats.depth = order_count;
+    stats.max_depth = order_count;
+    total_latency_us = 0;
+    portEXIT_CRITICAL(&lock);
+}
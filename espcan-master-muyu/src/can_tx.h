@@ -0,0 +1,59 @@
+#ifndef CAN_TX_H
+#define CAN_TX_H
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "driver/twai.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 最多同时跟踪的消息ID数量 (每个ID一个待发送槽位)
+#define CAN_TX_SLOTS 8
+
+// CAN发送统计
+typedef struct {
+    uint32_t submitted;         // 提交的命令数
+    uint32_t sent;              // 交给TWAI驱动的帧数
+    uint32_t coalesced;         // 发送前被同ID新命令覆盖的旧命令数
+    uint32_t failed;            // 发送失败次数 (之后会重试)
+    uint32_t rejected;          // 槽位用完被拒绝的命令数
+    uint32_t depth;             // 当前待发送的ID数
+    uint32_t max_depth;         // 待发送ID数峰值
+    uint32_t avg_latency_us;    // 从提交到交给驱动的平均延迟
+    uint32_t max_latency_us;    // 最长延迟
+} can_tx_stats_t;
+
+/**
+ * @brief 创建CAN发送任务 (TWAI驱动启动后调用)
+ *
+ * @param priority 任务优先级
+ * @return esp_err_t
+ */
+esp_err_t can_tx_init(UBaseType_t priority);
+
+/**
+ * @brief 提交一帧待发送 (不阻塞)
+ *
+ * 每个ID只保留最新的一帧: 同一ID的旧帧还没发出时直接被覆盖，
+ * 不同ID按首次提交的顺序发送。
+ *
+ * @param message 待发送的帧
+ * @return ESP_OK 已提交; ESP_ERR_NO_MEM 槽位用完; ESP_ERR_INVALID_STATE 发送任务未创建
+ */
+esp_err_t can_tx_submit(const twai_message_t *message);
+
+/**
+ * @brief 读取并清零统计数据 (depth为当前值，不清零)
+ *
+ * @param stats 返回的统计数据
+ */
+void can_tx_take_stats(can_tx_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CAN_TX_H
@@ -9,6 +9,10 @@
 #include "driver/gpio.h"
 #include "driver/twai.h"
 #include "driver/uart.h"
+#include "espcan_protocol.h"
+#include "espcan_filter.h"
+#include "espcan_sync.h"
+#include "can_tx.h"
 
 // 定义CAN引脚
 #define CAN_TX_PIN GPIO_NUM_5
@@ -25,39 +29,22 @@
 #define UART_BUF_SIZE 1024           // 缓冲区大小
 #define UART_RX_TIMEOUT_MS 10        // 接收超时时间(毫秒)
 
-// 消息ID
-#define LED_CMD_ID 0x456          // LED控制命令ID
-#define EMOTION_CMD_ID 0x789      // 情绪状态命令ID
-#define RANDOM_CMD_ID 0xABC       // 随机效果命令ID
-#define MOTOR_CMD_ID 0x301        // 电机控制命令ID
-#define FOGGER_CMD_ID 0x321       // 雾化器控制命令ID
-#define WOODEN_FISH_HIT_ID 0x123  // 木鱼敲击事件ID
-
-// LED控制命令
-#define LED_CMD_OFF 0
-#define LED_CMD_ON 1
-
-// 情绪状态命令 - 与TouchDesigner映射对齐
-#define EMOTION_NEUTRAL 0  // 中性 - 呼吸灯切换颜色效果 - 音效：中性
-#define EMOTION_HAPPY 1    // 开心 - 彩虹效果 - 音效：开心
-#define EMOTION_SAD 2      // 伤心 - 紫色追逐效果 - 音效：小雨点，开启雾化器
-#define EMOTION_SURPRISE 3 // 惊讶 - 闪电效果 - 音效：打雷闪电，电机开启
-#define EMOTION_RANDOM 4   // 兼容性别名
-
-// 随机效果命令
-#define RANDOM_START 1     // 开始随机效果
-#define RANDOM_STOP 0      // 停止随机效果
-
-// 雾化器控制命令
-#define FOGGER_CMD_OFF 0   // 关闭雾化器
-#define FOGGER_CMD_ON 1    // 开启雾化器
+// 惊讶场景的电机速度
+#define SURPRISE_MOTOR_DUTY 200
+
+// 场景生效时间提前量: 覆盖发送排队和节点接收延迟 (毫秒)
+#define SCENE_LEAD_MS 40
+
+// CAN发送任务
+#define CAN_TX_TASK_PRIORITY 6       // 高于串口和木鱼任务，提交的命令尽快发出
+#define CAN_TX_STATS_INTERVAL_MS 10000 // 发送统计输出间隔
 
 // 日志标签
 static const char *TAG = "MASTER_MUYU";
 
 // 函数声明（解决编译顺序问题）
 void send_led_command(uint8_t led_state);
-void send_emotion_command(uint8_t emotion_state);
+void send_scene_command(uint8_t emotion_state);
 void send_random_command(uint8_t random_state, uint8_t param1, uint8_t param2);
 void send_motor_command(uint8_t pwm_duty, uint8_t on_off, uint8_t fade_mode);
 void send_fogger_command(uint8_t fogger_state);
@@ -75,7 +62,7 @@ static const twai_general_config_t g_config = {
     .rx_io = CAN_RX_PIN,
     .clkout_io = TWAI_IO_UNUSED,
     .bus_off_io = TWAI_IO_UNUSED,
-    .tx_queue_len = 5,
+    .tx_queue_len = 1,        // 待发送的命令由发送任务按ID合并，驱动队列只需衔接下一帧
     .rx_queue_len = 5,
     .alerts_enabled = TWAI_ALERT_NONE,
     .clkout_divider = 0,
@@ -85,176 +72,181 @@ static const twai_general_config_t g_config = {
 // 波特率配置 (500Kbps)
 static const twai_timing_config_t t_config = TWAI_TIMING_CONFIG_500KBITS();
 
-// 过滤器配置 (接收所有消息)
-static const twai_filter_config_t f_config = TWAI_FILTER_CONFIG_ACCEPT_ALL();
+// 当前场景 (只在串口任务中修改)。LED和随机效果由单独的命令设置，
+// 切换情绪时原样带上，避免场景覆盖用户手动设置的状态
+static espcan_scene_t current_scene = {
+    .emotion = ESPCAN_EMOTION_NEUTRAL,
+};
 
 // 发送LED控制命令
 void send_led_command(uint8_t led_state) {
+    // 配置LED控制消息
+    espcan_led_cmd_t cmd = {
+        .state = led_state,
+    };
     twai_message_t tx_message;
+    espcan_encode_led_cmd(&cmd, &tx_message);
     
-    // 配置LED控制消息
-    tx_message.identifier = LED_CMD_ID;
-    tx_message.extd = 0;      // 标准帧
-    tx_message.rtr = 0;       // 非远程帧
-    tx_message.ss = 1;        // 单次发送
-    tx_message.self = 0;      // 不是自发自收
-    tx_message.data_length_code = 1;
-    tx_message.data[0] = led_state;
+    // 提交到发送任务 (不阻塞)
+    esp_err_t result = can_tx_submit(&tx_message);
     
-    // 发送消息
-    esp_err_t result = twai_transmit(&tx_message, pdMS_TO_TICKS(1000));
+    // 记录到场景中，后续场景帧保持该状态
+    if (led_state) {
+        current_scene.flags |= ESPCAN_SCENE_LED_ON;
+    } else {
+        current_scene.flags &= ~ESPCAN_SCENE_LED_ON;
+    }
     
     if (result == ESP_OK) {
-        ESP_LOGI(TAG, "发送LED控制命令成功: %s", led_state ? "开启" : "关闭");
+        ESP_LOGI(TAG, "已提交LED控制命令: %s", led_state ? "开启" : "关闭");
     } else {
-        ESP_LOGE(TAG, "发送LED控制命令失败: %s", esp_err_to_name(result));
+        ESP_LOGE(TAG, "提交LED控制命令失败: %s", esp_err_to_name(result));
     }
 }
 
-// 发送情绪状态命令
-void send_emotion_command(uint8_t emotion_state) {
-    twai_message_t tx_message;
+// 发送场景命令: 情绪、雾化器、电机和灯光状态合并在一帧中，所有节点同时切换
+void send_scene_command(uint8_t emotion_state) {
+    espcan_scene_t *scene = &current_scene;
     
-    // 配置情绪状态消息
-    tx_message.identifier = EMOTION_CMD_ID;
-    tx_message.extd = 0;      // 标准帧
-    tx_message.rtr = 0;       // 非远程帧
-    tx_message.ss = 1;        // 单次发送
-    tx_message.self = 0;      // 不是自发自收
-    tx_message.data_length_code = 1;
-    tx_message.data[0] = emotion_state;
-    
-    // 发送消息
-    esp_err_t result = twai_transmit(&tx_message, pdMS_TO_TICKS(1000));
+    // 伤心开启雾化器，惊讶开启电机，其他情绪两者都关闭
+    scene->emotion = emotion_state;
+    scene->flags &= ~(ESPCAN_SCENE_FOGGER_ON | ESPCAN_SCENE_MOTOR_ON | ESPCAN_SCENE_MOTOR_GRADUAL);
+    scene->motor_duty = 0;
     
     const char* emotion_name;
     switch (emotion_state) {
-        case EMOTION_HAPPY:
+        case ESPCAN_EMOTION_HAPPY:
             emotion_name = "开心 (彩虹效果) 音效：开心";
             break;
-        case EMOTION_SAD:
+        case ESPCAN_EMOTION_SAD:
             emotion_name = "伤心 (紫色追逐效果) 音效：小雨点";
-            // 自动开启雾化器
-            send_fogger_command(FOGGER_CMD_ON);
+            scene->flags |= ESPCAN_SCENE_FOGGER_ON;
             break;
-        case EMOTION_SURPRISE:
+        case ESPCAN_EMOTION_SURPRISE:
             emotion_name = "惊讶 (闪电效果) 音效：打雷闪电";
-            // 自动开启电机
-            send_motor_command(200, 1, 0);  // PWM=200, 状态=启动, 模式=固定
+            scene->flags |= ESPCAN_SCENE_MOTOR_ON;  // 固定速度模式
+            scene->motor_duty = SURPRISE_MOTOR_DUTY;
             break;
-        case EMOTION_NEUTRAL:
+        case ESPCAN_EMOTION_NEUTRAL:
             emotion_name = "中性 (呼吸灯切换颜色效果) 音效：中性";
             break;
         default:
             emotion_name = "未知/关闭";
             break;
     }
+    scene->sequence++;
+    
+    // 生效时间留出发送和各节点接收的余量，所有节点在同一时刻切换
+    scene->flags |= ESPCAN_SCENE_TIMED;
+    scene->activate_tick = espcan_sync_tick(espcan_sync_now() + SCENE_LEAD_MS * 1000);
+    
+    twai_message_t tx_message;
+    espcan_encode_scene(scene, &tx_message);
+    
+    // 提交到发送任务 (不阻塞)
+    esp_err_t result = can_tx_submit(&tx_message);
     
     if (result == ESP_OK) {
-        ESP_LOGI(TAG, "发送情绪状态命令成功: %s 灯光：%s", 
-            emotion_state == EMOTION_HAPPY ? "开心" :
-            emotion_state == EMOTION_SAD ? "伤心" :
-            emotion_state == EMOTION_SURPRISE ? "惊讶" : 
-            emotion_state == EMOTION_NEUTRAL ? "中性" : "未知",
-            emotion_name);
+        ESP_LOGI(TAG, "已提交场景命令 #%d: %s 灯光：%s 雾化器：%s 电机：%d",
+            scene->sequence,
+            emotion_state == ESPCAN_EMOTION_HAPPY ? "开心" :
+            emotion_state == ESPCAN_EMOTION_SAD ? "伤心" :
+            emotion_state == ESPCAN_EMOTION_SURPRISE ? "惊讶" : 
+            emotion_state == ESPCAN_EMOTION_NEUTRAL ? "中性" : "未知",
+            emotion_name,
+            (scene->flags & ESPCAN_SCENE_FOGGER_ON) ? "开启" : "关闭",
+            scene->motor_duty);
     } else {
-        ESP_LOGE(TAG, "发送情绪状态命令失败: %s", esp_err_to_name(result));
+        ESP_LOGE(TAG, "提交场景命令失败: %s", esp_err_to_name(result));
     }
 }
 
 // 发送随机效果命令
 void send_random_command(uint8_t random_state, uint8_t param1, uint8_t param2) {
+    // 配置随机效果消息 (参数1: 速度、密度等，参数2: 亮度、颜色等)
+    espcan_random_cmd_t cmd = {
+        .state = random_state,
+        .speed = param1,
+        .brightness = param2,
+    };
     twai_message_t tx_message;
+    espcan_encode_random_cmd(&cmd, &tx_message);
     
-    // 配置随机效果消息
-    tx_message.identifier = RANDOM_CMD_ID;
-    tx_message.extd = 0;      // 标准帧
-    tx_message.rtr = 0;       // 非远程帧
-    tx_message.ss = 1;        // 单次发送
-    tx_message.self = 0;      // 不是自发自收
-    tx_message.data_length_code = 3;
-    tx_message.data[0] = random_state;
-    tx_message.data[1] = param1;  // 额外参数1（速度、密度等）
-    tx_message.data[2] = param2;  // 额外参数2（亮度、颜色等）
+    // 提交到发送任务 (不阻塞)
+    esp_err_t result = can_tx_submit(&tx_message);
     
-    // 发送消息
-    esp_err_t result = twai_transmit(&tx_message, pdMS_TO_TICKS(1000));
+    // 记录到场景中，后续场景帧保持该状态
+    if (random_state) {
+        current_scene.flags |= ESPCAN_SCENE_RANDOM_ON;
+    } else {
+        current_scene.flags &= ~ESPCAN_SCENE_RANDOM_ON;
+    }
+    current_scene.random_speed = param1;
+    current_scene.random_brightness = param2;
     
     if (result == ESP_OK) {
-        ESP_LOGI(TAG, "发送随机效果命令成功: %s (参数: %d, %d)", 
+        ESP_LOGI(TAG, "已提交随机效果命令: %s (参数: %d, %d)", 
                  random_state ? "开始" : "停止", param1, param2);
     } else {
-        ESP_LOGE(TAG, "发送随机效果命令失败: %s", esp_err_to_name(result));
+        ESP_LOGE(TAG, "提交随机效果命令失败: %s", esp_err_to_name(result));
     }
 }
 
 // 发送电机控制命令
 void send_motor_command(uint8_t pwm_duty, uint8_t on_off, uint8_t fade_mode) {
+    // 配置电机控制消息
+    espcan_motor_cmd_t cmd = {
+        .duty = pwm_duty,
+        .on_off = on_off,
+        .mode = fade_mode,
+    };
     twai_message_t tx_message;
+    espcan_encode_motor_cmd(&cmd, &tx_message);
     
-    // 配置电机控制消息
-    tx_message.identifier = MOTOR_CMD_ID;
-    tx_message.extd = 0;      // 标准帧
-    tx_message.rtr = 0;       // 非远程帧
-    tx_message.ss = 1;        // 单次发送
-    tx_message.self = 0;      // 不是自发自收
-    tx_message.data_length_code = 3;  // 更新为3字节
-    tx_message.data[0] = pwm_duty;  // PWM占空比(0-255)
-    tx_message.data[1] = on_off;    // 启停状态(0=停止,1=启动)
-    tx_message.data[2] = fade_mode; // 渐变模式(0=固定速度,1=渐变速度)
-    
-    // 发送消息
-    esp_err_t result = twai_transmit(&tx_message, pdMS_TO_TICKS(1000));
+    // 提交到发送任务 (不阻塞)
+    esp_err_t result = can_tx_submit(&tx_message);
     
     if (result == ESP_OK) {
-        ESP_LOGI(TAG, "发送电机控制命令成功: 占空比=%d, 状态=%s, 模式=%s", 
+        ESP_LOGI(TAG, "已提交电机控制命令: 占空比=%d, 状态=%s, 模式=%s", 
                  pwm_duty, on_off ? "启动" : "停止", fade_mode ? "渐变" : "固定");
     } else {
-        ESP_LOGE(TAG, "发送电机控制命令失败: %s", esp_err_to_name(result));
+        ESP_LOGE(TAG, "提交电机控制命令失败: %s", esp_err_to_name(result));
     }
 }
 
 // 发送雾化器控制命令
 void send_fogger_command(uint8_t fogger_state) {
-    twai_message_t tx_message;
-    
     // 配置雾化器控制消息
-    tx_message.identifier = FOGGER_CMD_ID;
-    tx_message.extd = 0;      // 标准帧
-    tx_message.rtr = 0;       // 非远程帧
-    tx_message.ss = 1;        // 单次发送
-    tx_message.self = 0;      // 不是自发自收
-    tx_message.data_length_code = 1;
-    tx_message.data[0] = fogger_state;
+    espcan_fogger_cmd_t cmd = {
+        .state = fogger_state,
+    };
+    twai_message_t tx_message;
+    espcan_encode_fogger_cmd(&cmd, &tx_message);
     
-    // 发送消息
-    esp_err_t result = twai_transmit(&tx_message, pdMS_TO_TICKS(1000));
+    // 提交到发送任务 (不阻塞)
+    esp_err_t result = can_tx_submit(&tx_message);
     
     if (result == ESP_OK) {
-        ESP_LOGI(TAG, "发送雾化器控制命令成功: %s", fogger_state ? "开启" : "关闭");
+        ESP_LOGI(TAG, "已提交雾化器控制命令: %s", fogger_state ? "开启" : "关闭");
     } else {
-        ESP_LOGE(TAG, "发送雾化器控制命令失败: %s", esp_err_to_name(result));
+        ESP_LOGE(TAG, "提交雾化器控制命令失败: %s", esp_err_to_name(result));
     }
 }
 
 // 发送木鱼敲击事件消息
 void send_wooden_fish_hit_event(void) {
-    twai_message_t tx_message;
-    
     // 配置木鱼敲击事件消息
-    tx_message.identifier = WOODEN_FISH_HIT_ID;
-    tx_message.extd = 0;      // 标准帧
-    tx_message.rtr = 0;       // 非远程帧
-    tx_message.ss = 1;        // 单次发送
-    tx_message.self = 0;      // 不是自发自收
-    tx_message.data_length_code = 1;
-    tx_message.data[0] = 1;   // 敲击事件
+    espcan_wooden_fish_hit_t hit = {
+        .event = ESPCAN_WOODEN_FISH_HIT,
+    };
+    twai_message_t tx_message;
+    espcan_encode_wooden_fish_hit(&hit, &tx_message);
     
-    // 发送消息
-    esp_err_t result = twai_transmit(&tx_message, pdMS_TO_TICKS(1000));
+    // 提交到发送任务 (不阻塞)
+    esp_err_t result = can_tx_submit(&tx_message);
     
     if (result == ESP_OK) {
-        ESP_LOGI(TAG, "发送木鱼敲击事件成功");
+        ESP_LOGI(TAG, "已提交木鱼敲击事件");
         
         // 通过UART也发送给TouchDesigner
         // 使用明确的格式并发送多次以确保接收
@@ -268,7 +260,7 @@ void send_wooden_fish_hit_event(void) {
         // vTaskDelay(pdMS_TO_TICKS(10));
         // uart_write_bytes(UART_NUM, hit_msg3, strlen(hit_msg3));
     } else {
-        ESP_LOGE(TAG, "发送木鱼敲击事件失败: %s", esp_err_to_name(result));
+        ESP_LOGE(TAG, "提交木鱼敲击事件失败: %s", esp_err_to_name(result));
     }
 }
 
@@ -355,18 +347,11 @@ void process_touchdesigner_command(const char* cmd) {
         // 特殊处理状态4 - 关闭所有子系统
         if (emotion_val == 4) {
             ESP_LOGI(TAG, "关闭所有子系统");
-            // 关闭LED灯带
-            send_emotion_command(EMOTION_NEUTRAL);  // 设为中性状态
-            send_led_command(LED_CMD_OFF);          // 关闭LED
-            
-            // 关闭雾化器
-            send_fogger_command(FOGGER_CMD_OFF);
-            
-            // 关闭电机
-            send_motor_command(0, 0, 0);  // PWM=0, 状态=停止, 模式=固定
-            
-            // 关闭随机效果
-            send_random_command(RANDOM_STOP, 0, 0);
+            // 关闭LED和随机效果，中性场景同时关闭雾化器和电机
+            current_scene.flags &= ~(ESPCAN_SCENE_LED_ON | ESPCAN_SCENE_RANDOM_ON);
+            current_scene.random_speed = 0;
+            current_scene.random_brightness = 0;
+            send_scene_command(ESPCAN_EMOTION_NEUTRAL);
             
             // 发送确认消息到TouchDesigner
             const char *shutdown_msg = "所有子系统已关闭\n";
@@ -393,19 +378,9 @@ void process_touchdesigner_command(const char* cmd) {
                 break;
         }
         
-        // 在切换到新状态之前，根据需要关闭特定子系统
-        if (emotion_val != EMOTION_SAD) {
-            // 不是伤心状态，确保雾化器关闭
-            send_fogger_command(FOGGER_CMD_OFF);
-        }
-        
-        if (emotion_val != EMOTION_SURPRISE) {
-            // 不是惊讶状态，确保电机关闭
-            send_motor_command(0, 0, 0);
-        }
-        
+        // 场景帧同时设置雾化器和电机，不需要先单独关闭
         ESP_LOGI(TAG, "设置情绪状态: %s", emotion_name);
-        send_emotion_command((uint8_t)emotion_val);
+        send_scene_command((uint8_t)emotion_val);
         return;
     }
     
@@ -414,18 +389,7 @@ void process_touchdesigner_command(const char* cmd) {
         // 情绪控制命令格式: "EMOTION:1" (0=中性, 1=开心, 2=伤心, 3=惊讶)
         int emotion_val = atoi(cmd + 8);
         if (emotion_val >= 0 && emotion_val <= 3) {
-            // 在切换到新状态之前，根据需要关闭特定子系统
-            if (emotion_val != EMOTION_SAD) {
-                // 不是伤心状态，确保雾化器关闭
-                send_fogger_command(FOGGER_CMD_OFF);
-            }
-            
-            if (emotion_val != EMOTION_SURPRISE) {
-                // 不是惊讶状态，确保电机关闭
-                send_motor_command(0, 0, 0);
-            }
-            
-            send_emotion_command((uint8_t)emotion_val);
+            send_scene_command((uint8_t)emotion_val);
         } else {
             ESP_LOGE(TAG, "情绪值无效: %d", emotion_val);
         }
@@ -435,34 +399,21 @@ void process_touchdesigner_command(const char* cmd) {
         
         if (strcmp(expr_type, "HAPPY") == 0) {
             ESP_LOGI(TAG, "设置表情: 开心");
-            // 确保关闭不需要的子系统
-            send_fogger_command(FOGGER_CMD_OFF);
-            send_motor_command(0, 0, 0);
-            send_emotion_command(EMOTION_HAPPY);
+            send_scene_command(ESPCAN_EMOTION_HAPPY);
         } else if (strcmp(expr_type, "SAD") == 0) {
             ESP_LOGI(TAG, "设置表情: 伤心");
-            // 确保关闭不需要的子系统
-            send_motor_command(0, 0, 0);
-            // 雾化器会在send_emotion_command中自动开启
-            send_emotion_command(EMOTION_SAD);
+            // 场景中开启雾化器
+            send_scene_command(ESPCAN_EMOTION_SAD);
         } else if (strcmp(expr_type, "SURPRISE") == 0) {
             ESP_LOGI(TAG, "设置表情: 惊讶");
-            // 确保关闭不需要的子系统
-            send_fogger_command(FOGGER_CMD_OFF);
-            // 电机会在send_emotion_command中自动开启
-            send_emotion_command(EMOTION_SURPRISE);
+            // 场景中开启电机
+            send_scene_command(ESPCAN_EMOTION_SURPRISE);
         } else if (strcmp(expr_type, "NEUTRAL") == 0) {
             ESP_LOGI(TAG, "设置表情: 中性");
-            // 确保关闭所有额外子系统
-            send_fogger_command(FOGGER_CMD_OFF);
-            send_motor_command(0, 0, 0);
-            send_emotion_command(EMOTION_NEUTRAL);
+            send_scene_command(ESPCAN_EMOTION_NEUTRAL);
         } else if (strcmp(expr_type, "UNKNOWN") == 0) {
             ESP_LOGI(TAG, "设置表情: 随机/中性");
-            // 确保关闭所有额外子系统
-            send_fogger_command(FOGGER_CMD_OFF);
-            send_motor_command(0, 0, 0);
-            send_emotion_command(EMOTION_NEUTRAL);
+            send_scene_command(ESPCAN_EMOTION_NEUTRAL);
         } else {
             ESP_LOGW(TAG, "未知表情类型: %s", expr_type);
         }
@@ -546,16 +497,88 @@ void uart_rx_task(void *pvParameters) {
     }
 }
 
+// 处理电机节点回复的状态
+static void handle_motor_status(const twai_message_t *message, void *arg) {
+    espcan_motor_status_t status;
+    if (espcan_decode_motor_status(message, &status) != ESP_OK) {
+        return;  // 其他主控发出的电机命令
+    }
+    ESP_LOGI(TAG, "电机状态: 占空比=%d, 状态=%s, 模式=%s",
+             status.duty, status.on_off ? "启动" : "停止", status.mode ? "渐变" : "固定");
+}
+
+// 处理雾化器节点回复的状态
+static void handle_fogger_status(const twai_message_t *message, void *arg) {
+    espcan_fogger_status_t status;
+    if (espcan_decode_fogger_status(message, &status) != ESP_OK) {
+        return;  // 其他主控发出的雾化器命令
+    }
+    ESP_LOGI(TAG, "雾化器状态: %s", status.state ? "开启" : "关闭");
+}
+
+// 打印其他帧
+static void handle_unknown_frame(const twai_message_t *message, void *arg) {
+    if (message->rtr) {
+        ESP_LOGI(TAG, "[RTR]");
+        return;
+    }
+    
+    // 打印ASCII数据
+    printf("数据: ");
+    for (int i = 0; i < message->data_length_code; i++) {
+        printf("%c", message->data[i]);
+    }
+    printf("\n");
+}
+
+// 发送时间同步帧 (自收，主控记录本帧的接收时间，在下一帧中发给节点)
+static void send_time_sync(void) {
+    twai_message_t tx_message;
+    esp_err_t result = espcan_sync_master_build(&tx_message);
+    if (result == ESP_OK) {
+        result = can_tx_submit(&tx_message);
+    }
+    if (result != ESP_OK) {
+        ESP_LOGW(TAG, "提交时间同步帧失败: %s", esp_err_to_name(result));
+    }
+}
+
+// 输出CAN发送统计
+static void report_can_tx_stats(void) {
+    can_tx_stats_t stats;
+    can_tx_take_stats(&stats);
+    
+    ESP_LOGI(TAG, "CAN发送统计: 提交%lu, 发送%lu, 合并丢弃%lu, 失败%lu, 拒绝%lu",
+             (unsigned long)stats.submitted, (unsigned long)stats.sent, (unsigned long)stats.coalesced,
+             (unsigned long)stats.failed, (unsigned long)stats.rejected);
+    ESP_LOGI(TAG, "CAN发送队列: 当前%lu, 峰值%lu, 延迟平均%luus 最长%luus",
+             (unsigned long)stats.depth, (unsigned long)stats.max_depth,
+             (unsigned long)stats.avg_latency_us, (unsigned long)stats.max_latency_us);
+}
+
 void app_main(void)
 {
+    // 注册CAN消息处理函数
+    ESP_ERROR_CHECK(espcan_register_handler(ESPCAN_ID_MOTOR_CMD, handle_motor_status, NULL));
+    ESP_ERROR_CHECK(espcan_register_handler(ESPCAN_ID_FOGGER_CMD, handle_fogger_status, NULL));
+    espcan_set_default_handler(handle_unknown_frame, NULL);
+    ESP_ERROR_CHECK(espcan_sync_master_init());
+    
+    // 按注册的ID规划接收过滤器
+    espcan_filter_plan_t filter;
+    ESP_ERROR_CHECK(espcan_filter_plan_registered(&filter));
+    
     // 安装TWAI驱动
     ESP_LOGI(TAG, "CAN发送端初始化中...");
-    ESP_ERROR_CHECK(twai_driver_install(&g_config, &t_config, &f_config));
+    ESP_ERROR_CHECK(twai_driver_install(&g_config, &t_config, &filter.config));
     ESP_LOGI(TAG, "TWAI驱动安装成功");
 
     // 启动TWAI驱动
     ESP_ERROR_CHECK(twai_start());
     ESP_LOGI(TAG, "TWAI驱动启动成功");
+    
+    // 创建CAN发送任务
+    ESP_ERROR_CHECK(can_tx_init(CAN_TX_TASK_PRIORITY));
     ESP_LOGI(TAG, "CAN发送端初始化完成，准备接收TouchDesigner命令...");
     
     // 初始化UART
@@ -615,28 +638,36 @@ void app_main(void)
 
     // 接收CAN消息变量
     twai_message_t rx_message;
+    TickType_t last_stats_tick = xTaskGetTickCount();
+    TickType_t last_sync_tick = xTaskGetTickCount();
+    const TickType_t sync_interval = pdMS_TO_TICKS(ESPCAN_SYNC_INTERVAL_MS);
 
     while (1) {
-        // 尝试接收来自其他设备的响应
-        esp_err_t result = twai_receive(&rx_message, pdMS_TO_TICKS(100));
+        // 接收来自其他设备的响应，最多等到下一个同步帧的发送时间。
+        // 循环中不再延时: 自收的同步帧要在到达后立即取时间戳
+        TickType_t elapsed = xTaskGetTickCount() - last_sync_tick;
+        esp_err_t result = twai_receive(&rx_message, elapsed < sync_interval ? sync_interval - elapsed : 0);
         
         if (result == ESP_OK) {
-            // 打印帧信息
-            ESP_LOGI(TAG, "接收到响应 - ID: 0x%lX", (unsigned long)rx_message.identifier);
-            
-            if (rx_message.rtr) {
-                ESP_LOGI(TAG, "[RTR]");
-            } else {
-                // 打印ASCII数据
-                printf("数据: ");
-                for (int i = 0; i < rx_message.data_length_code; i++) {
-                    printf("%c", rx_message.data[i]);
-                }
-                printf("\n");
+            // 打印帧信息 (同步帧每秒一帧，不打印)
+            if (rx_message.identifier != ESPCAN_ID_TIME_SYNC) {
+                ESP_LOGI(TAG, "接收到响应 - ID: 0x%lX", (unsigned long)rx_message.identifier);
             }
+            
+            // 按ID查表分发
+            espcan_dispatch(&rx_message);
         }
         
-        // 短暂延时
-        vTaskDelay(pdMS_TO_TICKS(10));
+        // 定期广播时间同步帧
+        if (xTaskGetTickCount() - last_sync_tick >= sync_interval) {
+            last_sync_tick = xTaskGetTickCount();
+            send_time_sync();
+        }
+        
+        // 定期输出CAN发送统计
+        if (xTaskGetTickCount() - last_stats_tick >= pdMS_TO_TICKS(CAN_TX_STATS_INTERVAL_MS)) {
+            last_stats_tick = xTaskGetTickCount();
+            report_can_tx_stats();
+        }
     }
 } 
\ No newline at end of file
@@ -21,6 +21,9 @@
 #include "driver/gpio.h"
 #include "driver/ledc.h"
 #include "driver/twai.h"
+#include "espcan_protocol.h"
+#include "espcan_filter.h"
+#include "espcan_sync.h"
 
 // 日志标签
 static const char *TAG = "MOTOR-FOGGER";
@@ -46,29 +49,6 @@ static const char *TAG = "MOTOR-FOGGER";
 // 继电器控制 (雾化器)
 #define RELAY_PIN CONFIG_FOGGER_RELAY_GPIO
 
-// CAN 消息ID
-#define MOTOR_CMD_ID CONFIG_CAN_MOTOR_ID
-#define FOGGER_CMD_ID CONFIG_CAN_FOGGER_ID
-#define EMOTION_CMD_ID 0x789      // 情绪状态命令ID
-
-// 电机控制命令
-#define CMD_PWM_INDEX           0                     // 占空比值在Data[0]
-#define CMD_ONOFF_INDEX         1                     // 启停命令在Data[1]
-
-// 雾化器控制命令
-#define FOGGER_CMD_OFF 0
-#define FOGGER_CMD_ON 1
-
-// 情绪状态定义
-#define EMOTION_NEUTRAL 0  // 中性
-#define EMOTION_HAPPY 1    // 开心
-#define EMOTION_SAD 2      // 伤心 - 触发雾化器
-#define EMOTION_SURPRISE 3 // 惊讶 - 触发电机
-
-// 电机渐变模式
-#define MOTOR_MODE_FIXED        0                     // 固定速度模式
-#define MOTOR_MODE_GRADUAL      1                     // 渐变速度模式
-
 // 电机状态
 static struct {
     uint8_t duty;                              // 当前占空比(0-255)
@@ -80,7 +60,7 @@ static struct {
 } motor_state = {
     .duty = 0,
     .is_running = 0,
-    .mode = MOTOR_MODE_FIXED,
+    .mode = ESPCAN_MOTOR_MODE_FIXED,
     .target_duty = 0,
     .direction = 1,
     .gradual_timer = 0
@@ -192,17 +172,16 @@ void set_fogger_state(uint8_t state) {
     gpio_set_level(RELAY_PIN, state);
     
     ESP_LOGI(TAG, "雾化器状态设置为: %s", state ? "开启" : "关闭");
-    
-    // 发送状态确认消息
+}
+
+// 发送雾化器状态确认消息
+static void send_fogger_status(void) {
+    espcan_fogger_status_t status = {
+        .state = fogger_state.is_on,
+        .ack = ESPCAN_STATUS_ACK,
+    };
     twai_message_t tx_message;
-    tx_message.identifier = FOGGER_CMD_ID;
-    tx_message.extd = 0;      // 标准帧
-    tx_message.rtr = 0;       // 非远程帧
-    tx_message.ss = 1;        // 单次发送
-    tx_message.self = 0;      // 不是自发自收
-    tx_message.data_length_code = 2;
-    tx_message.data[0] = state;   // 当前状态
-    tx_message.data[1] = 0x01;    // 确认标志
+    espcan_encode_fogger_status(&status, &tx_message);
     
     twai_transmit(&tx_message, pdMS_TO_TICKS(100));
 }
@@ -218,11 +197,12 @@ static void can_init(void)
     // 波特率配置 (500Kbps)
     twai_timing_config_t t_config = TWAI_TIMING_CONFIG_500KBITS();
     
-    // 过滤器配置 - 接收电机、雾化器和情绪状态命令
-    twai_filter_config_t f_config = TWAI_FILTER_CONFIG_ACCEPT_ALL();
+    // 按注册的ID规划接收过滤器
+    espcan_filter_plan_t filter;
+    ESP_ERROR_CHECK(espcan_filter_plan_registered(&filter));
     
     // 安装TWAI驱动
-    ESP_ERROR_CHECK(twai_driver_install(&g_config, &t_config, &f_config));
+    ESP_ERROR_CHECK(twai_driver_install(&g_config, &t_config, &filter.config));
     
     // 启动TWAI驱动
     ESP_ERROR_CHECK(twai_start());
@@ -239,7 +219,7 @@ void gradual_speed_task(void *pvParameters)
     
     while (1) {
         // 检查是否处于渐变模式且电机运行中
-        if (motor_state.mode == MOTOR_MODE_GRADUAL && motor_state.is_running) {
+        if (motor_state.mode == ESPCAN_MOTOR_MODE_GRADUAL && motor_state.is_running) {
             // 获取当前占空比
             current_duty = motor_state.duty;
             
@@ -300,35 +280,13 @@ void gradual_speed_task(void *pvParameters)
     }
 }
 
-// 处理收到的电机控制命令
-static void process_motor_command(twai_message_t *message)
+// 设置电机占空比、启停和运行模式
+static void set_motor_state(uint8_t pwm_duty, uint8_t on_off, uint8_t mode)
 {
-    // 检查消息长度
-    if (message->data_length_code < 2) {
-        ESP_LOGW(TAG, "收到无效电机控制命令 (数据长度不足)");
-        return;
-    }
-    
-    // 获取PWM占空比
-    uint8_t pwm_duty = message->data[CMD_PWM_INDEX];
-    
-    // 获取启停命令
-    uint8_t on_off = message->data[CMD_ONOFF_INDEX] ? 1 : 0;
-    
-    // 获取额外参数 - 模式
-    uint8_t mode = MOTOR_MODE_FIXED;  // 默认固定模式
-    if (message->data_length_code >= 3) {
-        mode = message->data[2] ? MOTOR_MODE_GRADUAL : MOTOR_MODE_FIXED;
-    }
-    
-    ESP_LOGI(TAG, "收到电机控制命令 - 占空比: %d, 状态: %s, 模式: %s", 
-             pwm_duty, on_off ? "启动" : "停止", 
-             mode ? "渐变" : "固定");
-    
     // 设置运行模式
     motor_state.mode = mode;
     
-    if (mode == MOTOR_MODE_GRADUAL) {
+    if (mode == ESPCAN_MOTOR_MODE_GRADUAL) {
         // 渐变模式 - 设置目标占空比
         motor_state.target_duty = pwm_duty;
         
@@ -344,58 +302,81 @@ static void process_motor_command(twai_message_t *message)
     
     // 控制SSR状态
     set_ssr_state(on_off);
+}
+
+// 处理收到的电机控制命令
+static void process_motor_command(const twai_message_t *message, void *arg)
+{
+    // 没有携带模式时默认固定模式
+    espcan_motor_cmd_t cmd = {
+        .mode = ESPCAN_MOTOR_MODE_FIXED,
+    };
+    if (espcan_decode_motor_cmd(message, &cmd) != ESP_OK) {
+        ESP_LOGW(TAG, "收到无效CAN命令 (数据长度不足)");
+        return;
+    }
+    
+    uint8_t pwm_duty = cmd.duty;
+    uint8_t on_off = cmd.on_off ? 1 : 0;
+    uint8_t mode = cmd.mode ? ESPCAN_MOTOR_MODE_GRADUAL : ESPCAN_MOTOR_MODE_FIXED;
+    
+    ESP_LOGI(TAG, "收到电机控制命令 - 占空比: %d, 状态: %s, 模式: %s", 
+             pwm_duty, on_off ? "启动" : "停止", 
+             mode ? "渐变" : "固定");
+    
+    set_motor_state(pwm_duty, on_off, mode);
     
     // 发送状态确认消息
+    espcan_motor_status_t status = {
+        .duty = motor_state.duty,
+        .on_off = on_off,
+        .mode = mode,
+        .ack = ESPCAN_STATUS_ACK,
+    };
     twai_message_t tx_message;
-    tx_message.identifier = MOTOR_CMD_ID;
-    tx_message.extd = 0;      // 标准帧
-    tx_message.rtr = 0;       // 非远程帧
-    tx_message.ss = 1;        // 单次发送
-    tx_message.self = 0;      // 不是自发自收
-    tx_message.data_length_code = 4;
-    tx_message.data[0] = motor_state.duty;   // 当前占空比
-    tx_message.data[1] = on_off;             // 当前状态
-    tx_message.data[2] = mode;               // 当前模式
-    tx_message.data[3] = 0x01;               // 确认标志
+    espcan_encode_motor_status(&status, &tx_message);
     
     twai_transmit(&tx_message, pdMS_TO_TICKS(100));
 }
 
 // 处理接收到的雾化器控制命令
-void process_fogger_command(twai_message_t *message) {
-    if (message->data_length_code < 1) {
+static void process_fogger_command(const twai_message_t *message, void *arg) {
+    espcan_fogger_cmd_t cmd;
+    if (espcan_decode_fogger_cmd(message, &cmd) != ESP_OK) {
         ESP_LOGW(TAG, "收到无效雾化器命令 (数据长度不足)");
         return;
     }
     
-    uint8_t fogger_cmd = message->data[0];
-    ESP_LOGI(TAG, "收到雾化器控制命令: %s", fogger_cmd ? "开启" : "关闭");
+    ESP_LOGI(TAG, "收到雾化器控制命令: %s", cmd.state ? "开启" : "关闭");
     
-    // 设置雾化器状态
-    set_fogger_state(fogger_cmd);
+    // 设置雾化器状态并回复
+    set_fogger_state(cmd.state);
+    send_fogger_status();
 }
 
 // 处理情绪状态命令
-void process_emotion_command(twai_message_t *message) {
-    if (message->data_length_code < 1) {
+static void process_emotion_command(const twai_message_t *message, void *arg) {
+    espcan_emotion_cmd_t cmd;
+    if (espcan_decode_emotion_cmd(message, &cmd) != ESP_OK) {
         ESP_LOGW(TAG, "收到无效情绪状态命令 (数据长度不足)");
         return;
     }
     
-    uint8_t emotion = message->data[0];
+    uint8_t emotion = cmd.emotion;
     ESP_LOGI(TAG, "收到情绪状态命令: %d", emotion);
     
     // 根据情绪状态触发不同设备
     switch (emotion) {
-        case EMOTION_SAD:  // 伤心 - 触发雾化器
+        case ESPCAN_EMOTION_SAD:  // 伤心 - 触发雾化器
             ESP_LOGI(TAG, "检测到伤心情绪，激活雾化器");
             set_fogger_state(1);  // 开启雾化器
+            send_fogger_status();
             break;
             
-        case EMOTION_SURPRISE:  // 惊讶 - 触发电机
+        case ESPCAN_EMOTION_SURPRISE:  // 惊讶 - 触发电机
             ESP_LOGI(TAG, "检测到惊讶情绪，激活电机");
             // 电机使用渐变模式，中等速度
-            motor_state.mode = MOTOR_MODE_GRADUAL;
+            motor_state.mode = ESPCAN_MOTOR_MODE_GRADUAL;
             motor_state.target_duty = 180;  // 中高速
             motor_state.direction = 1;      // 增加方向
             set_pwm_duty(30);              // 从低速开始
@@ -408,10 +389,53 @@ void process_emotion_command(twai_message_t *message) {
     }
 }
 
+// 执行场景: 电机和雾化器部分 (不回复状态)
+static void apply_scene(const void *data) {
+    const espcan_scene_t *scene = data;
+    
+    uint8_t on_off = (scene->flags & ESPCAN_SCENE_MOTOR_ON) ? 1 : 0;
+    uint8_t mode = (scene->flags & ESPCAN_SCENE_MOTOR_GRADUAL) ? ESPCAN_MOTOR_MODE_GRADUAL : ESPCAN_MOTOR_MODE_FIXED;
+    
+    ESP_LOGI(TAG, "收到场景命令 #%d - 电机: %d/%s/%s, 雾化器: %s", scene->sequence,
+             scene->motor_duty, on_off ? "启动" : "停止", mode ? "渐变" : "固定",
+             (scene->flags & ESPCAN_SCENE_FOGGER_ON) ? "开启" : "关闭");
+    
+    set_motor_state(scene->motor_duty, on_off, mode);
+    set_fogger_state((scene->flags & ESPCAN_SCENE_FOGGER_ON) ? 1 : 0);
+}
+
+// 处理场景命令 (带TIMED标志时按生效时间执行)
+static void process_scene_command(const twai_message_t *message, void *arg) {
+    espcan_scene_t scene;
+    if (espcan_decode_scene(message, &scene) != ESP_OK) {
+        ESP_LOGW(TAG, "收到无效场景命令 (数据长度不足)");
+        return;
+    }
+    
+    if (scene.flags & ESPCAN_SCENE_TIMED) {
+        espcan_sync_run_at(scene.activate_tick, apply_scene, &scene, sizeof(scene));
+    } else {
+        apply_scene(&scene);
+    }
+}
+
+// 记录未注册的帧
+static void handle_unknown_frame(const twai_message_t *message, void *arg) {
+    ESP_LOGW(TAG, "收到未知ID消息: 0x%lx", (unsigned long)message->identifier);
+}
+
 void app_main(void)
 {
     ESP_LOGI(TAG, "ESP32 电机和雾化器控制系统初始化中...");
     
+    // 注册CAN消息处理函数
+    ESP_ERROR_CHECK(espcan_register_handler(ESPCAN_ID_MOTOR_CMD, process_motor_command, NULL));
+    ESP_ERROR_CHECK(espcan_register_handler(ESPCAN_ID_FOGGER_CMD, process_fogger_command, NULL));
+    ESP_ERROR_CHECK(espcan_register_handler(ESPCAN_ID_EMOTION_CMD, process_emotion_command, NULL));
+    ESP_ERROR_CHECK(espcan_register_handler(ESPCAN_ID_SCENE, process_scene_command, NULL));
+    espcan_set_default_handler(handle_unknown_frame, NULL);
+    ESP_ERROR_CHECK(espcan_sync_init());
+    
     // 初始化外设
     pwm_init();
     ssr_init();
@@ -423,7 +447,7 @@ void app_main(void)
     
     ESP_LOGI(TAG, "系统初始化完成，等待CAN控制命令...");
     ESP_LOGI(TAG, "电机控制ID: 0x%lX, 雾化器控制ID: 0x%lX, 情绪状态ID: 0x%lX", 
-             (unsigned long)MOTOR_CMD_ID, (unsigned long)FOGGER_CMD_ID, (unsigned long)EMOTION_CMD_ID);
+             (unsigned long)ESPCAN_ID_MOTOR_CMD, (unsigned long)ESPCAN_ID_FOGGER_CMD, (unsigned long)ESPCAN_ID_EMOTION_CMD);
     
     // CAN消息接收缓冲区
     twai_message_t rx_message;
@@ -434,22 +458,11 @@ void app_main(void)
         esp_err_t result = twai_receive(&rx_message, pdMS_TO_TICKS(100));
         
         if (result == ESP_OK) {
-            // 根据消息ID分发处理
-            if (rx_message.identifier == MOTOR_CMD_ID) {
-                process_motor_command(&rx_message);
-            } else if (rx_message.identifier == FOGGER_CMD_ID) {
-                process_fogger_command(&rx_message);
-            } else if (rx_message.identifier == EMOTION_CMD_ID) {
-                process_emotion_command(&rx_message);
-            } else {
-                ESP_LOGW(TAG, "收到未知ID消息: 0x%lx", (unsigned long)rx_message.identifier);
-            }
+            // 按ID查表分发
+            espcan_dispatch(&rx_message);
         } else if (result != ESP_ERR_TIMEOUT) {
             // 忽略超时错误
             ESP_LOGE(TAG, "CAN接收错误: %s", esp_err_to_name(result));
         }
-        
-        // 短暂延时
-        vTaskDelay(pdMS_TO_TICKS(10));
     }
 }
@@ -18,6 +18,9 @@
 #include "driver/gpio.h"
 #include "driver/ledc.h"
 #include "driver/twai.h"
+#include "espcan_protocol.h"
+#include "espcan_filter.h"
+#include "espcan_sync.h"
 
 // 日志标签
 static const char *TAG = "espcan-motor";
@@ -39,15 +42,6 @@ static const char *TAG = "espcan-motor";
 // CAN 引脚配置
 #define CAN_TX_GPIO             CONFIG_CAN_TX_GPIO    // CAN TX引脚
 #define CAN_RX_GPIO             CONFIG_CAN_RX_GPIO    // CAN RX引脚
-#define CAN_CONTROL_ID          CONFIG_CAN_CONTROL_ID // 控制命令CAN ID
-
-// CAN 命令结构
-#define CMD_PWM_INDEX           0                     // 占空比值在Data[0]
-#define CMD_ONOFF_INDEX         1                     // 启停命令在Data[1]
-
-// 电机渐变模式
-#define MOTOR_MODE_FIXED        0                     // 固定速度模式
-#define MOTOR_MODE_GRADUAL      1                     // 渐变速度模式
 
 // 电机状态
 static struct {
@@ -60,7 +54,7 @@ static struct {
 } motor_state = {
     .duty = 0,
     .is_running = 0,
-    .mode = MOTOR_MODE_FIXED,
+    .mode = ESPCAN_MOTOR_MODE_FIXED,
     .target_duty = 0,
     .direction = 1,
     .gradual_timer = 0
@@ -204,21 +198,24 @@ static void can_init(void)
     // 设置CAN总线速率
     twai_timing_config_t t_config = get_can_timing_config(CONFIG_CAN_BITRATE);
     
-    // 过滤器配置 - 只接收特定ID的消息
-    twai_filter_config_t f_config = {
-        .acceptance_code = (CAN_CONTROL_ID << 21),
-        .acceptance_mask = ~(0x7FF << 21),  // 只匹配11位ID
-        .single_filter = true
-    };
+    // 按注册的ID规划接收过滤器
+    espcan_filter_plan_t filter;
+    ESP_ERROR_CHECK(espcan_filter_plan_registered(&filter));
     
     // 安装TWAI驱动
-    ESP_ERROR_CHECK(twai_driver_install(&g_config, &t_config, &f_config));
+    ESP_ERROR_CHECK(twai_driver_install(&g_config, &t_config, &filter.config));
     
     // 启动TWAI驱动
     ESP_ERROR_CHECK(twai_start());
     
     ESP_LOGI(TAG, "CAN控制器初始化完成，TX: %d, RX: %d, 速率: %dkbps, 监听ID: 0x%lx", 
-             CAN_TX_GPIO, CAN_RX_GPIO, CONFIG_CAN_BITRATE, (unsigned long)CAN_CONTROL_ID);
+             CAN_TX_GPIO, CAN_RX_GPIO, CONFIG_CAN_BITRATE, (unsigned long)ESPCAN_ID_MOTOR_CMD);
+}
+
+// 记录未注册的帧
+static void handle_unknown_frame(const twai_message_t *message, void *arg)
+{
+    ESP_LOGW(TAG, "收到未知ID消息: 0x%lx", (unsigned long)message->identifier);
 }
 
 // 电机渐变速度任务
@@ -229,7 +226,7 @@ void gradual_speed_task(void *pvParameters)
     
     while (1) {
         // 检查是否处于渐变模式且电机运行中
-        if (motor_state.mode == MOTOR_MODE_GRADUAL && motor_state.is_running) {
+        if (motor_state.mode == ESPCAN_MOTOR_MODE_GRADUAL && motor_state.is_running) {
             // 获取当前占空比
             current_duty = motor_state.duty;
             
@@ -290,35 +287,13 @@ void gradual_speed_task(void *pvParameters)
     }
 }
 
-// 处理收到的CAN控制命令
-static void process_can_command(twai_message_t *message)
+// 设置电机占空比、启停和运行模式
+static void set_motor_state(uint8_t pwm_duty, uint8_t on_off, uint8_t mode)
 {
-    // 检查消息长度
-    if (message->data_length_code < 2) {
-        ESP_LOGW(TAG, "收到无效CAN命令 (数据长度不足)");
-        return;
-    }
-    
-    // 获取PWM占空比
-    uint8_t pwm_duty = message->data[CMD_PWM_INDEX];
-    
-    // 获取启停命令
-    uint8_t on_off = message->data[CMD_ONOFF_INDEX] ? 1 : 0;
-    
-    // 获取额外参数 - 模式
-    uint8_t mode = MOTOR_MODE_FIXED;  // 默认固定模式
-    if (message->data_length_code >= 3) {
-        mode = message->data[2] ? MOTOR_MODE_GRADUAL : MOTOR_MODE_FIXED;
-    }
-    
-    ESP_LOGI(TAG, "收到CAN控制命令 - 占空比: %d, 状态: %s, 模式: %s", 
-             pwm_duty, on_off ? "启动" : "停止", 
-             mode ? "渐变" : "固定");
-    
     // 设置运行模式
     motor_state.mode = mode;
     
-    if (mode == MOTOR_MODE_GRADUAL) {
+    if (mode == ESPCAN_MOTOR_MODE_GRADUAL) {
         // 渐变模式 - 设置目标占空比
         motor_state.target_duty = pwm_duty;
         
@@ -334,27 +309,83 @@ static void process_can_command(twai_message_t *message)
     
     // 控制SSR状态
     set_ssr_state(on_off);
+}
+
+// 处理收到的CAN控制命令
+static void process_can_command(const twai_message_t *message, void *arg)
+{
+    // 没有携带模式时默认固定模式
+    espcan_motor_cmd_t cmd = {
+        .mode = ESPCAN_MOTOR_MODE_FIXED,
+    };
+    if (espcan_decode_motor_cmd(message, &cmd) != ESP_OK) {
+        ESP_LOGW(TAG, "收到无效CAN命令 (数据长度不足)");
+        return;
+    }
+    
+    uint8_t pwm_duty = cmd.duty;
+    uint8_t on_off = cmd.on_off ? 1 : 0;
+    uint8_t mode = cmd.mode ? ESPCAN_MOTOR_MODE_GRADUAL : ESPCAN_MOTOR_MODE_FIXED;
+    
+    ESP_LOGI(TAG, "收到CAN控制命令 - 占空比: %d, 状态: %s, 模式: %s", 
+             pwm_duty, on_off ? "启动" : "停止", 
+             mode ? "渐变" : "固定");
+    
+    set_motor_state(pwm_duty, on_off, mode);
     
     // 发送状态确认消息
+    espcan_motor_status_t status = {
+        .duty = motor_state.duty,
+        .on_off = on_off,
+        .mode = mode,
+        .ack = ESPCAN_STATUS_ACK,
+    };
     twai_message_t tx_message;
-    tx_message.identifier = CAN_CONTROL_ID;
-    tx_message.extd = 0;      // 标准帧
-    tx_message.rtr = 0;       // 非远程帧
-    tx_message.ss = 1;        // 单次发送
-    tx_message.self = 0;      // 不是自发自收
-    tx_message.data_length_code = 4;
-    tx_message.data[0] = motor_state.duty;   // 当前占空比
-    tx_message.data[1] = on_off;             // 当前状态
-    tx_message.data[2] = mode;               // 当前模式
-    tx_message.data[3] = 0x01;               // 确认标志
+    espcan_encode_motor_status(&status, &tx_message);
     
     twai_transmit(&tx_message, pdMS_TO_TICKS(100));
 }
 
+// 执行场景: 电机部分
+static void apply_scene(const void *data)
+{
+    const espcan_scene_t *scene = data;
+    
+    uint8_t on_off = (scene->flags & ESPCAN_SCENE_MOTOR_ON) ? 1 : 0;
+    uint8_t mode = (scene->flags & ESPCAN_SCENE_MOTOR_GRADUAL) ? ESPCAN_MOTOR_MODE_GRADUAL : ESPCAN_MOTOR_MODE_FIXED;
+    
+    ESP_LOGI(TAG, "收到场景命令 #%d - 占空比: %d, 状态: %s, 模式: %s", scene->sequence,
+             scene->motor_duty, on_off ? "启动" : "停止", mode ? "渐变" : "固定");
+    
+    set_motor_state(scene->motor_duty, on_off, mode);
+}
+
+// 处理场景命令 (带TIMED标志时按生效时间执行)
+static void process_scene_command(const twai_message_t *message, void *arg)
+{
+    espcan_scene_t scene;
+    if (espcan_decode_scene(message, &scene) != ESP_OK) {
+        ESP_LOGW(TAG, "收到无效场景命令 (数据长度不足)");
+        return;
+    }
+    
+    if (scene.flags & ESPCAN_SCENE_TIMED) {
+        espcan_sync_run_at(scene.activate_tick, apply_scene, &scene, sizeof(scene));
+    } else {
+        apply_scene(&scene);
+    }
+}
+
 void app_main(void)
 {
     ESP_LOGI(TAG, "ESP32 + PWM 调速 + CAN 控制 + DC SSR 启停系统启动...");
     
+    // 注册CAN消息处理函数
+    ESP_ERROR_CHECK(espcan_register_handler(ESPCAN_ID_MOTOR_CMD, process_can_command, NULL));
+    ESP_ERROR_CHECK(espcan_register_handler(ESPCAN_ID_SCENE, process_scene_command, NULL));
+    espcan_set_default_handler(handle_unknown_frame, NULL);
+    ESP_ERROR_CHECK(espcan_sync_init());
+    
     // 初始化外设
     pwm_init();
     ssr_init();
@@ -374,18 +405,11 @@ void app_main(void)
         esp_err_t result = twai_receive(&rx_message, pdMS_TO_TICKS(100));
         
         if (result == ESP_OK) {
-            // 检查消息ID
-            if (rx_message.identifier == CAN_CONTROL_ID) {
-                process_can_command(&rx_message);
-            } else {
-                ESP_LOGW(TAG, "收到未知ID消息: 0x%lx", (unsigned long)rx_message.identifier);
-            }
+            // 按ID查表分发
+            espcan_dispatch(&rx_message);
         } else if (result != ESP_ERR_TIMEOUT) {
             // 忽略超时错误
             ESP_LOGE(TAG, "CAN接收错误: %s", esp_err_to_name(result));
         }
-        
-        // 短暂延时
-        vTaskDelay(pdMS_TO_TICKS(10));
     }
 } 
\ No newline at end of file
@@ -8,6 +8,9 @@
 #include "esp_log.h"
 #include "driver/gpio.h"
 #include "driver/twai.h"
+#include "espcan_protocol.h"
+#include "espcan_filter.h"
+#include "espcan_sync.h"
 
 // 定义CAN引脚
 #define CAN_TX_PIN CONFIG_CAN_TX_GPIO
@@ -20,16 +23,8 @@
 #define HAPPY_SOUND_PIN CONFIG_HAPPY_SOUND_GPIO    // GPIO18 - 开心音效
 #define RANDOM_SOUND_PIN CONFIG_RANDOM_SOUND_GPIO  // GPIO17 - 随机音效
 
-// 消息ID
-#define EMOTION_CMD_ID CONFIG_CAN_EMOTION_ID  // 情绪状态命令ID
-#define WOODEN_FISH_HIT_ID CONFIG_WOODEN_FISH_HIT_ID  // 木鱼敲击事件ID
-
-// 情绪状态命令
-#define EMOTION_HAPPY 1    // 开心
-#define EMOTION_SAD 2      // 伤心 - 小雨点
-#define EMOTION_SURPRISE 3 // 惊讶 - 打雷闪电
-#define EMOTION_RANDOM 4   // 随机效果
-#define WOODFISH_HIT 5     // 木鱼敲击
+// 木鱼敲击音效 (与情绪状态共用control_sounds，取协议中不用的值)
+#define WOODFISH_HIT 5
 
 // 日志标签
 static const char *TAG = "SOUND_CTRL";
@@ -63,9 +58,6 @@ static const twai_general_config_t g_config = {
 // 波特率配置 (500Kbps)
 static const twai_timing_config_t t_config = TWAI_TIMING_CONFIG_500KBITS();
 
-// 过滤器配置 (接收情绪状态命令)
-static const twai_filter_config_t f_config = TWAI_FILTER_CONFIG_ACCEPT_ALL();
-
 // 初始化声音控制GPIO
 void sound_gpio_init(void) {
     gpio_config_t io_conf = {
@@ -103,8 +95,8 @@ void control_sounds(uint8_t emotion) {
     
     // 检查特殊音效是否正在播放中
     bool check_woodfish = (emotion == WOODFISH_HIT && woodfish_sound_active);
-    bool check_happy = (emotion == EMOTION_HAPPY && happy_sound_active);
-    bool check_random = (emotion == EMOTION_RANDOM && random_sound_active);
+    bool check_happy = (emotion == ESPCAN_EMOTION_HAPPY && happy_sound_active);
+    bool check_random = (emotion == ESPCAN_EMOTION_RANDOM && random_sound_active);
     
     // 如果特定音效正在播放且还未结束，跳过这次触发
     if (check_woodfish && (current_time - last_woodfish_sound_time < SOUND_DURATION_MS)) {
@@ -133,22 +125,22 @@ void control_sounds(uint8_t emotion) {
     if (!woodfish_sound_active || (emotion != WOODFISH_HIT && emotion != 0)) {
         gpio_set_level(WOODFISH_SOUND_PIN, 1); // 高电平无效
     }
-    if (!happy_sound_active || (emotion != EMOTION_HAPPY && emotion != 0)) {
+    if (!happy_sound_active || (emotion != ESPCAN_EMOTION_HAPPY && emotion != 0)) {
         gpio_set_level(HAPPY_SOUND_PIN, 1); // 高电平无效
     }
-    if (!random_sound_active || (emotion != EMOTION_RANDOM && emotion != 0)) {
+    if (!random_sound_active || (emotion != ESPCAN_EMOTION_RANDOM && emotion != 0)) {
         gpio_set_level(RANDOM_SOUND_PIN, 1); // 高电平无效
     }
     
     // 对于即时音效（不需要跟踪播放时间的），直接关闭
-    if (emotion != EMOTION_SURPRISE && emotion != EMOTION_SAD) {
+    if (emotion != ESPCAN_EMOTION_SURPRISE && emotion != ESPCAN_EMOTION_SAD) {
         gpio_set_level(THUNDER_SOUND_PIN, 1); // 高电平无效
         gpio_set_level(RAIN_SOUND_PIN, 1);    // 高电平无效
     }
     
     // 根据情绪状态控制声音
     switch (emotion) {
-        case EMOTION_HAPPY:
+        case ESPCAN_EMOTION_HAPPY:
             // 开心 - 开心音效
             if (!happy_sound_active) {
                 ESP_LOGI(TAG, "触发开心音效");
@@ -158,19 +150,19 @@ void control_sounds(uint8_t emotion) {
             }
             break;
             
-        case EMOTION_SAD:
+        case ESPCAN_EMOTION_SAD:
             // 伤心 - 小雨点音效
             ESP_LOGI(TAG, "触发小雨点音效");
             gpio_set_level(RAIN_SOUND_PIN, 0); // 低电平有效
             break;
             
-        case EMOTION_SURPRISE:
+        case ESPCAN_EMOTION_SURPRISE:
             // 惊讶 - 打雷闪电音效
             ESP_LOGI(TAG, "触发打雷闪电音效");
             gpio_set_level(THUNDER_SOUND_PIN, 0); // 低电平有效
             break;
             
-        case EMOTION_RANDOM:
+        case ESPCAN_EMOTION_RANDOM:
             // 随机效果 - 随机音效
             if (!random_sound_active) {
                 ESP_LOGI(TAG, "触发随机音效");
@@ -197,14 +189,15 @@ void control_sounds(uint8_t emotion) {
 }
 
 // 处理木鱼敲击事件
-void handle_woodfish_hit(twai_message_t *message) {
-    if (message->data_length_code < 1) {
+static void handle_woodfish_hit(const twai_message_t *message, void *arg) {
+    espcan_wooden_fish_hit_t hit;
+    if (espcan_decode_wooden_fish_hit(message, &hit) != ESP_OK) {
         ESP_LOGE(TAG, "木鱼敲击事件数据长度不足");
         return;
     }
     
     // 检查数据内容，确认是敲击事件
-    if (message->data[0] == 1) {
+    if (hit.event == ESPCAN_WOODEN_FISH_HIT) {
         ESP_LOGI(TAG, "收到木鱼敲击事件");
         
         // 触发木鱼敲击音效
@@ -243,33 +236,26 @@ void sound_timeout_task(void *pvParameters) {
     }
 }
 
-// 处理情绪状态命令
-void handle_emotion_command(twai_message_t *message) {
-    if (message->data_length_code < 1) {
-        ESP_LOGE(TAG, "情绪状态命令数据长度不足");
-        return;
-    }
-    
-    uint8_t emotion_state = message->data[0];
-    
+// 切换情绪状态并播放对应音效
+static void set_emotion(uint8_t emotion_state) {
     // 更新当前情绪状态
     current_emotion = emotion_state;
     
     // 根据情绪状态输出日志
     switch (emotion_state) {
-        case EMOTION_HAPPY:
+        case ESPCAN_EMOTION_HAPPY:
             ESP_LOGI(TAG, "情绪状态设置为: 开心 (开心音效)");
             break;
             
-        case EMOTION_SAD:
+        case ESPCAN_EMOTION_SAD:
             ESP_LOGI(TAG, "情绪状态设置为: 伤心 (小雨点音效)");
             break;
             
-        case EMOTION_SURPRISE:
+        case ESPCAN_EMOTION_SURPRISE:
             ESP_LOGI(TAG, "情绪状态设置为: 惊讶 (打雷闪电音效)");
             break;
             
-        case EMOTION_RANDOM:
+        case ESPCAN_EMOTION_RANDOM:
             ESP_LOGI(TAG, "情绪状态设置为: 随机效果 (随机音效)");
             break;
             
@@ -282,11 +268,55 @@ void handle_emotion_command(twai_message_t *message) {
     control_sounds(emotion_state);
 }
 
+// 处理情绪状态命令
+static void handle_emotion_command(const twai_message_t *message, void *arg) {
+    espcan_emotion_cmd_t cmd;
+    if (espcan_decode_emotion_cmd(message, &cmd) != ESP_OK) {
+        ESP_LOGE(TAG, "情绪状态命令数据长度不足");
+        return;
+    }
+    
+    set_emotion(cmd.emotion);
+}
+
+// 执行场景: 声音节点只使用情绪部分
+static void apply_scene(const void *data) {
+    const espcan_scene_t *scene = data;
+    
+    ESP_LOGI(TAG, "场景 #%d", scene->sequence);
+    set_emotion(scene->emotion);
+}
+
+// 处理场景命令: 音效和灯光同时开始，按生效时间播放
+static void handle_scene_command(const twai_message_t *message, void *arg) {
+    espcan_scene_t scene;
+    if (espcan_decode_scene(message, &scene) != ESP_OK) {
+        ESP_LOGE(TAG, "场景命令数据长度不足");
+        return;
+    }
+    
+    if (scene.flags & ESPCAN_SCENE_TIMED) {
+        espcan_sync_run_at(scene.activate_tick, apply_scene, &scene, sizeof(scene));
+    } else {
+        apply_scene(&scene);
+    }
+}
+
 void app_main(void)
 {
+    // 注册CAN消息处理函数
+    ESP_ERROR_CHECK(espcan_register_handler(ESPCAN_ID_EMOTION_CMD, handle_emotion_command, NULL));
+    ESP_ERROR_CHECK(espcan_register_handler(ESPCAN_ID_SCENE, handle_scene_command, NULL));
+    ESP_ERROR_CHECK(espcan_register_handler(ESPCAN_ID_WOODEN_FISH_HIT, handle_woodfish_hit, NULL));
+    ESP_ERROR_CHECK(espcan_sync_init());
+    
+    // 按注册的ID规划接收过滤器
+    espcan_filter_plan_t filter;
+    ESP_ERROR_CHECK(espcan_filter_plan_registered(&filter));
+    
     // 安装TWAI驱动
     ESP_LOGI(TAG, "声音控制器初始化中...");
-    ESP_ERROR_CHECK(twai_driver_install(&g_config, &t_config, &f_config));
+    ESP_ERROR_CHECK(twai_driver_install(&g_config, &t_config, &filter.config));
     ESP_LOGI(TAG, "TWAI驱动安装成功");
 
     // 启动TWAI驱动
@@ -300,8 +330,8 @@ void app_main(void)
     xTaskCreate(sound_timeout_task, "sound_timeout_task", 2048, NULL, 5, NULL);
     
     ESP_LOGI(TAG, "声音控制器初始化完成，等待情绪状态命令...");
-    ESP_LOGI(TAG, "情绪状态命令ID: 0x%lX", (unsigned long)EMOTION_CMD_ID);
-    ESP_LOGI(TAG, "木鱼敲击事件ID: 0x%lX", (unsigned long)WOODEN_FISH_HIT_ID);
+    ESP_LOGI(TAG, "情绪状态命令ID: 0x%lX", (unsigned long)ESPCAN_ID_EMOTION_CMD);
+    ESP_LOGI(TAG, "木鱼敲击事件ID: 0x%lX", (unsigned long)ESPCAN_ID_WOODEN_FISH_HIT);
     
     // 接收CAN消息变量
     twai_message_t rx_message;
@@ -311,18 +341,13 @@ void app_main(void)
         esp_err_t result = twai_receive(&rx_message, pdMS_TO_TICKS(1000));
         
         if (result == ESP_OK) {
-            // 打印帧信息
-            ESP_LOGI(TAG, "接收到CAN帧 - ID: 0x%lX", (unsigned long)rx_message.identifier);
-            
-            // 检查消息类型
-            if (rx_message.identifier == EMOTION_CMD_ID) {
-                handle_emotion_command(&rx_message);
-            } else if (rx_message.identifier == WOODEN_FISH_HIT_ID) {
-                handle_woodfish_hit(&rx_message);
+            // 打印帧信息 (同步帧不打印，避免延迟取时间戳)
+            if (rx_message.identifier != ESPCAN_ID_TIME_SYNC) {
+                ESP_LOGI(TAG, "接收到CAN帧 - ID: 0x%lX", (unsigned long)rx_message.identifier);
             }
+            
+            // 按ID查表分发
+            espcan_dispatch(&rx_message);
         }
-        
-        // 短暂延时
-        vTaskDelay(pdMS_TO_TICKS(10));
     }
 } 
\ No newline at end of file
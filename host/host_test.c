@@ -0,0 +1,84 @@
+// 主机测试工具的实现，内存分配通过链接器--wrap计数 (见CMakeLists.txt)
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "host_test.h"
+
+int host_test_failures = 0;
+static uint64_t s_allocs = 0;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t n, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void __real_free(void *ptr);
+
+void *__wrap_malloc(size_t size)
+{
+    s_allocs++;
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t n, size_t size)
+{
+    s_allocs++;
+    return __real_calloc(n, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+    s_allocs++;
+    return __real_realloc(ptr, size);
+}
+
+void __wrap_free(void *ptr)
+{
+    __real_free(ptr);
+}
+
+uint64_t host_alloc_count(void)
+{
+    return s_allocs;
+}
+
+uint64_t host_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+double host_bench_run(void (*fn)(void *arg), void *arg, uint32_t iterations, int rounds)
+{
+    uint64_t best = UINT64_MAX;
+    for (int round = 0; round < rounds; round++) {
+        uint64_t start = host_now_ns();
+        for (uint32_t i = 0; i < iterations; i++) {
+            fn(arg);
+        }
+        uint64_t elapsed = host_now_ns() - start;
+        if (elapsed < best) {
+            best = elapsed;
+        }
+    }
+    return (double)best / iterations;
+}
+
+bool host_bench_quick(int argc, char **argv)
+{
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--quick") == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int host_test_finish(const char *name)
+{
+    if (host_test_failures) {
+        fprintf(stderr, "%s: %d check(s) failed\n", name, host_test_failures);
+        return 1;
+    }
+    printf("%s: all checks passed\n", name);
+    return 0;
+}
@@ -0,0 +1,86 @@
+// 错误码名称、ESP_ERROR_CHECK和日志输出
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_system.h"
+
+#define LOG_TAG_LEVELS_MAX 16
+
+typedef struct {
+    const char *tag;
+    esp_log_level_t level;
+} log_tag_level_t;
+
+static esp_log_level_t s_default_level = ESP_LOG_WARN;
+static log_tag_level_t s_tag_levels[LOG_TAG_LEVELS_MAX];
+static int s_num_tag_levels = 0;
+
+const char *esp_err_to_name(esp_err_t code)
+{
+    switch (code) {
+    case ESP_OK: return "ESP_OK";
+    case ESP_FAIL: return "ESP_FAIL";
+    case ESP_ERR_NO_MEM: return "ESP_ERR_NO_MEM";
+    case ESP_ERR_INVALID_ARG: return "ESP_ERR_INVALID_ARG";
+    case ESP_ERR_INVALID_STATE: return "ESP_ERR_INVALID_STATE";
+    case ESP_ERR_INVALID_SIZE: return "ESP_ERR_INVALID_SIZE";
+    case ESP_ERR_NOT_FOUND: return "ESP_ERR_NOT_FOUND";
+    case ESP_ERR_NOT_SUPPORTED: return "ESP_ERR_NOT_SUPPORTED";
+    case ESP_ERR_TIMEOUT: return "ESP_ERR_TIMEOUT";
+    default: return "UNKNOWN ERROR";
+    }
+}
+
+void _esp_error_check_failed(esp_err_t rc, const char *file, int line, const char *function, const char *expression)
+{
+    fprintf(stderr, "ESP_ERROR_CHECK failed: esp_err_t 0x%x (%s) at %s:%d\nfunction: %s\nexpression: %s\n",
+            rc, esp_err_to_name(rc), file, line, function, expression);
+    abort();
+}
+
+void esp_restart(void)
+{
+    fprintf(stderr, "esp_restart called\n");
+    abort();
+}
+
+void esp_log_level_set(const char *tag, esp_log_level_t level)
+{
+    if (strcmp(tag, "*") == 0) {
+        s_default_level = level;
+        s_num_tag_levels = 0;
+        return;
+    }
+    for (int i = 0; i < s_num_tag_levels; i++) {
+        if (strcmp(s_tag_levels[i].tag, tag) == 0) {
+            s_tag_levels[i].level = level;
+            return;
+        }
+    }
+    if (s_num_tag_levels < LOG_TAG_LEVELS_MAX) {
+        s_tag_levels[s_num_tag_levels++] = (log_tag_level_t) {
+            .tag = tag,
+            .level = level,
+        };
+    }
+}
+
+void esp_log_write(esp_log_level_t level, const char *tag, const char *format, ...)
+{
+    esp_log_level_t enabled = s_default_level;
+    for (int i = 0; i < s_num_tag_levels; i++) {
+        if (strcmp(s_tag_levels[i].tag, tag) == 0) {
+            enabled = s_tag_levels[i].level;
+        }
+    }
+    if (level > enabled) {
+        return;
+    }
+    va_list args;
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+}
@@ -0,0 +1,159 @@
+// I80总线替身: 传输立即完成，开启记录时保存总线上发出的字节
+#include <stdlib.h>
+#include <string.h>
+#include "esp_lcd_panel_io.h"
+#include "host_idf.h"
+
+struct esp_lcd_i80_bus_t {
+    size_t bus_width;
+    size_t max_transfer_bytes;
+    int data_gpio_nums[ESP_LCD_I80_BUS_WIDTH_MAX];
+    esp_lcd_panel_io_handle_t io;
+};
+
+struct esp_lcd_panel_io_t {
+    esp_lcd_i80_bus_handle_t bus;
+    esp_lcd_panel_io_color_trans_done_cb_t on_color_trans_done;
+    void *user_ctx;
+    bool capture;
+    uint32_t transactions;
+    uint8_t *output;
+    size_t output_size;
+    size_t output_cap;
+};
+
+static bool s_capture = false;
+static esp_lcd_panel_io_handle_t s_last_io = NULL;
+
+esp_err_t esp_lcd_new_i80_bus(const esp_lcd_i80_bus_config_t *bus_config, esp_lcd_i80_bus_handle_t *ret_bus)
+{
+    // 替身只支持8位总线
+    if (bus_config == NULL || ret_bus == NULL || bus_config->bus_width != 8 || bus_config->max_transfer_bytes == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_lcd_i80_bus_handle_t bus = calloc(1, sizeof(struct esp_lcd_i80_bus_t));
+    if (bus == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    bus->bus_width = bus_config->bus_width;
+    bus->max_transfer_bytes = bus_config->max_transfer_bytes;
+    memcpy(bus->data_gpio_nums, bus_config->data_gpio_nums, sizeof(bus->data_gpio_nums));
+    *ret_bus = bus;
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_del_i80_bus(esp_lcd_i80_bus_handle_t bus)
+{
+    if (bus == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (bus->io) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    free(bus);
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_new_panel_io_i80(esp_lcd_i80_bus_handle_t bus, const esp_lcd_panel_io_i80_config_t *io_config, esp_lcd_panel_io_handle_t *ret_io)
+{
+    if (bus == NULL || io_config == NULL || ret_io == NULL || io_config->trans_queue_depth == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    // 替身每条总线只支持一个设备
+    if (bus->io) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    esp_lcd_panel_io_handle_t io = calloc(1, sizeof(struct esp_lcd_panel_io_t));
+    if (io == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    io->bus = bus;
+    io->on_color_trans_done = io_config->on_color_trans_done;
+    io->user_ctx = io_config->user_ctx;
+    io->capture = s_capture;
+    bus->io = io;
+    s_last_io = io;
+    *ret_io = io;
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_io_del(esp_lcd_panel_io_handle_t io)
+{
+    if (io == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    io->bus->io = NULL;
+    if (s_last_io == io) {
+        s_last_io = NULL;
+    }
+    free(io->output);
+    free(io);
+    return ESP_OK;
+}
+
+static bool append_output(esp_lcd_panel_io_handle_t io, const uint8_t *data, size_t size)
+{
+    if (io->output_size + size > io->output_cap) {
+        size_t cap = io->output_cap ? io->output_cap : 4096;
+        while (cap < io->output_size + size) {
+            cap *= 2;
+        }
+        uint8_t *output = realloc(io->output, cap);
+        if (output == NULL) {
+            return false;
+        }
+        io->output = output;
+        io->output_cap = cap;
+    }
+    memcpy(io->output + io->output_size, data, size);
+    io->output_size += size;
+    return true;
+}
+
+esp_err_t esp_lcd_panel_io_tx_color(esp_lcd_panel_io_handle_t io, int lcd_cmd, const void *color, size_t color_size)
+{
+    // 只支持没有命令阶段的传输，一次传输不能超过总线的max_transfer_bytes
+    if (io == NULL || lcd_cmd >= 0 || color == NULL || color_size > io->bus->max_transfer_bytes) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (io->capture && !append_output(io, color, color_size)) {
+        return ESP_ERR_NO_MEM;
+    }
+    io->transactions++;
+    if (io->on_color_trans_done) {
+        esp_lcd_panel_io_event_data_t edata = {0};
+        io->on_color_trans_done(io, &edata, io->user_ctx);
+    }
+    return ESP_OK;
+}
+
+void host_lcd_set_capture(bool enabled)
+{
+    s_capture = enabled;
+}
+
+esp_lcd_panel_io_handle_t host_lcd_last_io(void)
+{
+    return s_last_io;
+}
+
+uint32_t host_lcd_transactions(esp_lcd_panel_io_handle_t io)
+{
+    return io->transactions;
+}
+
+int host_lcd_data_gpio(esp_lcd_panel_io_handle_t io, int bit)
+{
+    return io->bus->data_gpio_nums[bit];
+}
+
+const uint8_t *host_lcd_output(esp_lcd_panel_io_handle_t io, size_t *size)
+{
+    *size = io->output_size;
+    return io->output;
+}
+
+void host_lcd_clear_output(esp_lcd_panel_io_handle_t io)
+{
+    io->output_size = 0;
+}
@@ -0,0 +1,31 @@
+// 确定的伪随机数 (xorshift32)，每次运行的序列相同
+#include <string.h>
+#include "esp_random.h"
+#include "host_idf.h"
+
+static uint32_t s_state = 1;
+
+void host_random_seed(uint32_t seed)
+{
+    s_state = seed ? seed : 1;
+}
+
+uint32_t esp_random(void)
+{
+    s_state ^= s_state << 13;
+    s_state ^= s_state >> 17;
+    s_state ^= s_state << 5;
+    return s_state;
+}
+
+void esp_fill_random(void *buf, size_t len)
+{
+    uint8_t *out = buf;
+    while (len > 0) {
+        uint32_t word = esp_random();
+        size_t n = len < sizeof(word) ? len : sizeof(word);
+        memcpy(out, &word, n);
+        out += n;
+        len -= n;
+    }
+}
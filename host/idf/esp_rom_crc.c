@@ -0,0 +1,30 @@
+// 与ROM中esp_rom_crc32_le相同的标准CRC32 (多项式0xEDB88320，输入输出取反)
+#include <stdbool.h>
+#include "esp_rom_crc.h"
+
+static uint32_t s_table[256];
+static bool s_table_ready = false;
+
+static void build_table(void)
+{
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (crc & 1 ? 0xEDB88320u : 0);
+        }
+        s_table[i] = crc;
+    }
+    s_table_ready = true;
+}
+
+uint32_t esp_rom_crc32_le(uint32_t crc, uint8_t const *buf, uint32_t len)
+{
+    if (!s_table_ready) {
+        build_table();
+    }
+    crc = ~crc;
+    for (uint32_t i = 0; i < len; i++) {
+        crc = (crc >> 8) ^ s_table[(crc ^ buf[i]) & 0xFF];
+    }
+    return ~crc;
+}
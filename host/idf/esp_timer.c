@@ -0,0 +1,159 @@
+// esp_timer: 默认使用CLOCK_MONOTONIC，切换到虚拟时间后定时器由host_timer_advance触发
+#include <stdlib.h>
+#include <time.h>
+#include "esp_timer.h"
+#include "host_idf.h"
+
+struct esp_timer {
+    esp_timer_cb_t callback;
+    void *arg;
+    bool active;
+    int64_t due_us;
+    uint64_t period_us;         // 0为单次定时器
+    struct esp_timer *next;
+};
+
+static struct esp_timer *s_timers = NULL;
+static bool s_virtual = false;
+static int64_t s_virtual_us = 0;
+
+int64_t esp_timer_get_time(void)
+{
+    if (s_virtual) {
+        return s_virtual_us;
+    }
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *create_args, esp_timer_handle_t *out_handle)
+{
+    if (create_args == NULL || create_args->callback == NULL || out_handle == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    struct esp_timer *timer = calloc(1, sizeof(struct esp_timer));
+    if (timer == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    timer->callback = create_args->callback;
+    timer->arg = create_args->arg;
+    timer->next = s_timers;
+    s_timers = timer;
+    *out_handle = timer;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us)
+{
+    if (timer == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (timer->active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->active = true;
+    timer->period_us = 0;
+    timer->due_us = esp_timer_get_time() + (int64_t)timeout_us;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period)
+{
+    if (timer == NULL || period == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (timer->active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->active = true;
+    timer->period_us = period;
+    timer->due_us = esp_timer_get_time() + (int64_t)period;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer)
+{
+    if (timer == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!timer->active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->active = false;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer)
+{
+    if (timer == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (timer->active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    for (struct esp_timer **p = &s_timers; *p; p = &(*p)->next) {
+        if (*p == timer) {
+            *p = timer->next;
+            break;
+        }
+    }
+    free(timer);
+    return ESP_OK;
+}
+
+bool esp_timer_is_active(esp_timer_handle_t timer)
+{
+    return timer && timer->active;
+}
+
+void host_timer_use_virtual_time(int64_t start_us)
+{
+    s_virtual = true;
+    s_virtual_us = start_us;
+}
+
+bool host_timer_run_next(int64_t deadline_us)
+{
+    if (!s_virtual) {
+        return false;
+    }
+    struct esp_timer *first = NULL;
+    for (struct esp_timer *timer = s_timers; timer; timer = timer->next) {
+        if (timer->active && timer->due_us <= deadline_us && (first == NULL || timer->due_us < first->due_us)) {
+            first = timer;
+        }
+    }
+    if (first == NULL) {
+        return false;
+    }
+    host_timer_advance(first->due_us > s_virtual_us ? first->due_us - s_virtual_us : 0);
+    return true;
+}
+
+void host_timer_advance(int64_t delta_us)
+{
+    int64_t end_us = s_virtual_us + delta_us;
+    while (true) {
+        // 取最早到期的定时器，回调中可能重新启动或停止定时器
+        struct esp_timer *first = NULL;
+        for (struct esp_timer *timer = s_timers; timer; timer = timer->next) {
+            if (timer->active && timer->due_us <= end_us && (first == NULL || timer->due_us < first->due_us)) {
+                first = timer;
+            }
+        }
+        if (first == NULL) {
+            break;
+        }
+        if (first->due_us > s_virtual_us) {
+            s_virtual_us = first->due_us;
+        }
+        if (first->period_us) {
+            first->due_us += (int64_t)first->period_us;
+        } else {
+            first->active = false;
+        }
+        first->callback(first->arg);
+    }
+    s_virtual_us = end_us;
+}
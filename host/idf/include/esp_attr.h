@@ -0,0 +1,6 @@
+#pragma once
+
+// 主机上没有IRAM/DRAM之分
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define RTC_DATA_ATTR
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_rom_sys.h"    // IDF中由其他头文件间接包含
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 主机上没有GPIO矩阵，调用被忽略
+void esp_rom_gpio_connect_out_signal(uint32_t gpio_num, uint32_t signal_idx, bool out_inv, bool oen_inv);
+
+#ifdef __cplusplus
+}
+#endif
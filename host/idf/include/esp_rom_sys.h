@@ -0,0 +1,14 @@
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 主机上不等待
+void esp_rom_delay_us(uint32_t us);
+
+#ifdef __cplusplus
+}
+#endif
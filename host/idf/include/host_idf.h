@@ -0,0 +1,149 @@
+// 主机替身的控制接口: 测试和基准测试用来设置随机种子、推进虚拟时间、检查外设输出
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "driver/rmt_types.h"
+#include "driver/spi_master.h"
+#include "esp_lcd_panel_io.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 设置esp_random的种子 (启动时为1，每次运行的序列相同)
+ */
+void host_random_seed(uint32_t seed);
+
+/**
+ * @brief 切换到虚拟时间: esp_timer_get_time从start_us开始，只由host_timer_advance推进
+ *
+ * 默认使用CLOCK_MONOTONIC
+ */
+void host_timer_use_virtual_time(int64_t start_us);
+
+/**
+ * @brief 推进虚拟时间，途中到期的esp_timer定时器按到期顺序在调用线程中执行
+ */
+void host_timer_advance(int64_t delta_us);
+
+/**
+ * @brief 推进虚拟时间到不晚于deadline_us的下一个定时器并执行，没有这样的定时器或未使用虚拟时间时返回false
+ */
+bool host_timer_run_next(int64_t deadline_us);
+
+/**
+ * @brief vTaskDelay累计的节拍数 (主机上不睡眠)
+ */
+uint64_t host_task_delayed_ticks(void);
+
+/**
+ * @brief 设置新建RMT通道是否记录发送的数据和编码后的符号
+ *
+ * 记录时rmt_transmit会运行编码器，关闭时只调用发送完成回调 (基准测试不计入编码耗时)
+ */
+void host_rmt_set_capture(bool enabled);
+
+/**
+ * @brief 设置新建RMT通道是否按线路时序发送 (需先切换到虚拟时间)
+ *
+ * 每帧按编码出的符号时长占用线路，排在前一帧之后，发完时由虚拟时间的定时器调用发送完成回调；
+ * rmt_transmit在队列满时、rmt_tx_wait_all_done在线路忙时推进虚拟时间，
+ * rmt_enable和rmt_disable分别推进enable_us和disable_us (驱动重新配置通道的CPU时间)
+ */
+void host_rmt_set_wire_time(bool enabled, uint32_t enable_us, uint32_t disable_us);
+
+/**
+ * @brief 开启线路时序的通道累计占用线路的时间
+ */
+uint64_t host_rmt_wire_us(rmt_channel_handle_t channel);
+
+/**
+ * @brief 最近创建的RMT通道 (驱动内部创建的通道也能取到)
+ */
+rmt_channel_handle_t host_rmt_last_channel(void);
+
+/**
+ * @brief 通道已完成的发送次数
+ */
+uint32_t host_rmt_frames(rmt_channel_handle_t channel);
+
+/**
+ * @brief 通道最近一次发送的原始数据 (需开启记录)
+ */
+const uint8_t *host_rmt_last_payload(rmt_channel_handle_t channel, size_t *size);
+
+/**
+ * @brief 通道最近一次发送编码出的符号 (需开启记录)
+ */
+const rmt_symbol_word_t *host_rmt_last_symbols(rmt_channel_handle_t channel, size_t *num_symbols);
+
+/**
+ * @brief 设置新建SPI设备是否记录MOSI上发出的字节
+ */
+void host_spi_set_capture(bool enabled);
+
+/**
+ * @brief 最近添加的SPI设备 (驱动内部添加的设备也能取到)
+ */
+spi_device_handle_t host_spi_last_device(void);
+
+/**
+ * @brief 设备已完成的传输数
+ */
+uint32_t host_spi_transactions(spi_device_handle_t device);
+
+/**
+ * @brief 上次清空以来MOSI上发出的字节 (需开启记录)
+ */
+const uint8_t *host_spi_output(spi_device_handle_t device, size_t *size);
+
+/**
+ * @brief 清空记录的MOSI字节
+ */
+void host_spi_clear_output(spi_device_handle_t device);
+
+/**
+ * @brief 注入欠载: 每排队after_transactions个传输，下一次不等待的取结果发现排队的传输都已发完
+ *
+ * 如同任务被抢占的时间超过了排队传输的发送时间，总线在帧中间空闲，共触发times次
+ */
+void host_spi_inject_underrun(spi_device_handle_t device, uint32_t after_transactions, uint32_t times);
+
+/**
+ * @brief 设置新建I80设备是否记录总线上发出的字节
+ */
+void host_lcd_set_capture(bool enabled);
+
+/**
+ * @brief 最近创建的I80设备 (驱动内部创建的设备也能取到)
+ */
+esp_lcd_panel_io_handle_t host_lcd_last_io(void);
+
+/**
+ * @brief 设备已完成的传输数
+ */
+uint32_t host_lcd_transactions(esp_lcd_panel_io_handle_t io);
+
+/**
+ * @brief 总线字节的第bit位输出到的GPIO
+ */
+int host_lcd_data_gpio(esp_lcd_panel_io_handle_t io, int bit);
+
+/**
+ * @brief 上次清空以来总线上发出的字节 (需开启记录)
+ */
+const uint8_t *host_lcd_output(esp_lcd_panel_io_handle_t io, size_t *size);
+
+/**
+ * @brief 清空记录的总线字节
+ */
+void host_lcd_clear_output(esp_lcd_panel_io_handle_t io);
+
+#ifdef __cplusplus
+}
+#endif
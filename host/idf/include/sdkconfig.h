@@ -0,0 +1,5 @@
+#pragma once
+
+// 主机构建模拟ESP32目标
+#define CONFIG_IDF_TARGET_ESP32 1
+#define CONFIG_FREERTOS_HZ 100
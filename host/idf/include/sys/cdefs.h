@@ -0,0 +1,9 @@
+#pragma once
+
+#include_next <sys/cdefs.h>
+#include <stddef.h>
+
+// newlib的sys/cdefs.h提供的宏，glibc中没有
+#ifndef __containerof
+#define __containerof(ptr, type, member) ((type *)((char *)(ptr) - offsetof(type, member)))
+#endif
@@ -0,0 +1,429 @@
+// RMT发送通道替身: 发送立即完成，开启记录时运行编码器并保存编码出的符号
+//
+// 开启线路时序后 (需要虚拟时间)，每帧按编码出的符号时长占用线路，排在前一帧之后发送，
+// 发送完成回调由虚拟时间的esp_timer在线路空闲时刻调用；队列满时rmt_transmit、
+// rmt_tx_wait_all_done推进虚拟时间等待，rmt_enable/rmt_disable各占用设定的CPU时间
+#include <stdlib.h>
+#include <string.h>
+#include "driver/rmt_tx.h"
+#include "esp_timer.h"
+#include "host_idf.h"
+
+#define RMT_ENCODE_MAX_CALLS 1024   // 编码器一直不报告完成时放弃
+#define RMT_DEFAULT_QUEUE_DEPTH 4
+
+struct rmt_channel_t {
+    bool enabled;
+    bool capture;
+    rmt_tx_done_callback_t on_trans_done;
+    void *user_ctx;
+    uint32_t frames;
+    uint8_t *payload;
+    size_t payload_size;
+    rmt_symbol_word_t *symbols;
+    size_t num_symbols;
+    size_t symbols_cap;
+    // 线路时序
+    bool wire;
+    uint32_t resolution_hz;
+    uint32_t enable_us;
+    uint32_t disable_us;
+    esp_timer_handle_t done_timer;  // 在队首一帧发完的时刻到期
+    int64_t *done_us;               // 排队各帧的发完时刻 (环形队列)
+    size_t *done_symbols;
+    size_t queue_depth;
+    size_t queue_head;
+    size_t queue_len;
+    int64_t busy_until_us;          // 最后一帧的发完时刻
+    uint64_t wire_us;               // 线路累计发送时间
+};
+
+typedef struct {
+    rmt_encoder_t base;
+    rmt_symbol_word_t bit0;
+    rmt_symbol_word_t bit1;
+    bool msb_first;
+} rmt_bytes_encoder_t;
+
+static bool s_capture = false;
+static bool s_wire = false;
+static uint32_t s_enable_us = 0;
+static uint32_t s_disable_us = 0;
+static rmt_channel_handle_t s_last_channel = NULL;
+
+static bool append_symbol(rmt_channel_handle_t channel, rmt_symbol_word_t symbol)
+{
+    if (channel->num_symbols == channel->symbols_cap) {
+        size_t cap = channel->symbols_cap ? channel->symbols_cap * 2 : 1024;
+        rmt_symbol_word_t *symbols = realloc(channel->symbols, cap * sizeof(rmt_symbol_word_t));
+        if (symbols == NULL) {
+            return false;
+        }
+        channel->symbols = symbols;
+        channel->symbols_cap = cap;
+    }
+    channel->symbols[channel->num_symbols++] = symbol;
+    return true;
+}
+
+static size_t rmt_encode_bytes(rmt_encoder_t *encoder, rmt_channel_handle_t channel, const void *primary_data, size_t data_size, rmt_encode_state_t *ret_state)
+{
+    rmt_bytes_encoder_t *bytes_encoder = (rmt_bytes_encoder_t *)encoder;
+    const uint8_t *data = primary_data;
+    size_t encoded = 0;
+    for (size_t i = 0; i < data_size; i++) {
+        for (int bit = 0; bit < 8; bit++) {
+            int shift = bytes_encoder->msb_first ? 7 - bit : bit;
+            rmt_symbol_word_t symbol = (data[i] >> shift) & 1 ? bytes_encoder->bit1 : bytes_encoder->bit0;
+            if (!append_symbol(channel, symbol)) {
+                *ret_state = RMT_ENCODING_MEM_FULL;
+                return encoded;
+            }
+            encoded++;
+        }
+    }
+    *ret_state = RMT_ENCODING_COMPLETE;
+    return encoded;
+}
+
+static size_t rmt_encode_copy(rmt_encoder_t *encoder, rmt_channel_handle_t channel, const void *primary_data, size_t data_size, rmt_encode_state_t *ret_state)
+{
+    (void)encoder;
+    const rmt_symbol_word_t *symbols = primary_data;
+    size_t count = data_size / sizeof(rmt_symbol_word_t);
+    for (size_t i = 0; i < count; i++) {
+        if (!append_symbol(channel, symbols[i])) {
+            *ret_state = RMT_ENCODING_MEM_FULL;
+            return i;
+        }
+    }
+    *ret_state = RMT_ENCODING_COMPLETE;
+    return count;
+}
+
+static esp_err_t rmt_encoder_reset_nop(rmt_encoder_t *encoder)
+{
+    (void)encoder;
+    return ESP_OK;
+}
+
+static esp_err_t rmt_encoder_free(rmt_encoder_t *encoder)
+{
+    free(encoder);
+    return ESP_OK;
+}
+
+esp_err_t rmt_new_bytes_encoder(const rmt_bytes_encoder_config_t *config, rmt_encoder_handle_t *ret_encoder)
+{
+    if (config == NULL || ret_encoder == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    rmt_bytes_encoder_t *encoder = calloc(1, sizeof(rmt_bytes_encoder_t));
+    if (encoder == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    encoder->base.encode = rmt_encode_bytes;
+    encoder->base.reset = rmt_encoder_reset_nop;
+    encoder->base.del = rmt_encoder_free;
+    encoder->bit0 = config->bit0;
+    encoder->bit1 = config->bit1;
+    encoder->msb_first = config->flags.msb_first;
+    *ret_encoder = &encoder->base;
+    return ESP_OK;
+}
+
+esp_err_t rmt_new_copy_encoder(const rmt_copy_encoder_config_t *config, rmt_encoder_handle_t *ret_encoder)
+{
+    if (config == NULL || ret_encoder == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    rmt_encoder_t *encoder = calloc(1, sizeof(rmt_encoder_t));
+    if (encoder == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    encoder->encode = rmt_encode_copy;
+    encoder->reset = rmt_encoder_reset_nop;
+    encoder->del = rmt_encoder_free;
+    *ret_encoder = encoder;
+    return ESP_OK;
+}
+
+esp_err_t rmt_del_encoder(rmt_encoder_handle_t encoder)
+{
+    if (encoder == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return encoder->del(encoder);
+}
+
+esp_err_t rmt_encoder_reset(rmt_encoder_handle_t encoder)
+{
+    if (encoder == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return encoder->reset(encoder);
+}
+
+// 队首一帧发完: 出队并调用发送完成回调，再为下一帧定时
+static void wire_frame_done(void *arg)
+{
+    rmt_channel_handle_t channel = arg;
+    rmt_tx_done_event_data_t edata = {
+        .num_symbols = channel->done_symbols[channel->queue_head],
+    };
+    channel->queue_head = (channel->queue_head + 1) % channel->queue_depth;
+    channel->queue_len--;
+    channel->frames++;
+    if (channel->queue_len) {
+        esp_timer_start_once(channel->done_timer, channel->done_us[channel->queue_head] - esp_timer_get_time());
+    }
+    if (channel->on_trans_done) {
+        channel->on_trans_done(channel, &edata, channel->user_ctx);
+    }
+}
+
+static void free_channel(rmt_channel_handle_t channel)
+{
+    if (channel->done_timer) {
+        if (esp_timer_is_active(channel->done_timer)) {
+            esp_timer_stop(channel->done_timer);
+        }
+        esp_timer_delete(channel->done_timer);
+    }
+    free(channel->done_us);
+    free(channel->done_symbols);
+    free(channel->payload);
+    free(channel->symbols);
+    free(channel);
+}
+
+static esp_err_t wire_init(rmt_channel_handle_t channel, const rmt_tx_channel_config_t *config)
+{
+    channel->wire = true;
+    channel->resolution_hz = config->resolution_hz;
+    channel->enable_us = s_enable_us;
+    channel->disable_us = s_disable_us;
+    channel->queue_depth = config->trans_queue_depth ? config->trans_queue_depth : RMT_DEFAULT_QUEUE_DEPTH;
+    channel->done_us = calloc(channel->queue_depth, sizeof(int64_t));
+    channel->done_symbols = calloc(channel->queue_depth, sizeof(size_t));
+    if (channel->done_us == NULL || channel->done_symbols == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    esp_timer_create_args_t timer_args = {
+        .callback = wire_frame_done,
+        .arg = channel,
+    };
+    return esp_timer_create(&timer_args, &channel->done_timer);
+}
+
+esp_err_t rmt_new_tx_channel(const rmt_tx_channel_config_t *config, rmt_channel_handle_t *ret_chan)
+{
+    if (config == NULL || ret_chan == NULL || config->resolution_hz == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    rmt_channel_handle_t channel = calloc(1, sizeof(struct rmt_channel_t));
+    if (channel == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    channel->capture = s_capture;
+    if (s_wire) {
+        esp_err_t ret = wire_init(channel, config);
+        if (ret != ESP_OK) {
+            free_channel(channel);
+            return ret;
+        }
+    }
+    s_last_channel = channel;
+    *ret_chan = channel;
+    return ESP_OK;
+}
+
+esp_err_t rmt_del_channel(rmt_channel_handle_t channel)
+{
+    if (channel == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    // 与驱动相同: 只能删除已禁用的通道
+    if (channel->enabled) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (s_last_channel == channel) {
+        s_last_channel = NULL;
+    }
+    free_channel(channel);
+    return ESP_OK;
+}
+
+esp_err_t rmt_enable(rmt_channel_handle_t channel)
+{
+    if (channel == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (channel->enabled) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    channel->enabled = true;
+    if (channel->wire) {
+        host_timer_advance(channel->enable_us);
+    }
+    return ESP_OK;
+}
+
+esp_err_t rmt_disable(rmt_channel_handle_t channel)
+{
+    if (channel == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!channel->enabled) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    channel->enabled = false;
+    if (channel->wire) {
+        host_timer_advance(channel->disable_us);
+    }
+    return ESP_OK;
+}
+
+esp_err_t rmt_tx_register_event_callbacks(rmt_channel_handle_t tx_channel, const rmt_tx_event_callbacks_t *cbs, void *user_data)
+{
+    if (tx_channel == NULL || cbs == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (tx_channel->enabled) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    tx_channel->on_trans_done = cbs->on_trans_done;
+    tx_channel->user_ctx = user_data;
+    return ESP_OK;
+}
+
+static esp_err_t capture_frame(rmt_channel_handle_t channel, rmt_encoder_handle_t encoder, const void *payload, size_t payload_bytes)
+{
+    uint8_t *copy = realloc(channel->payload, payload_bytes ? payload_bytes : 1);
+    if (copy == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    memcpy(copy, payload, payload_bytes);
+    channel->payload = copy;
+    channel->payload_size = payload_bytes;
+
+    // 驱动在每次发送开始时复位编码器，然后反复调用直到编码完成
+    channel->num_symbols = 0;
+    rmt_encoder_reset(encoder);
+    for (int calls = 0; calls < RMT_ENCODE_MAX_CALLS; calls++) {
+        rmt_encode_state_t state = RMT_ENCODING_RESET;
+        encoder->encode(encoder, channel, payload, payload_bytes, &state);
+        if (state & RMT_ENCODING_COMPLETE) {
+            return ESP_OK;
+        }
+    }
+    return ESP_FAIL;
+}
+
+// 按编码出的符号时长把一帧排到线路上，队列满时等待队首一帧发完
+static esp_err_t wire_queue_frame(rmt_channel_handle_t channel)
+{
+    uint64_t ticks = 0;
+    for (size_t i = 0; i < channel->num_symbols; i++) {
+        ticks += channel->symbols[i].duration0 + channel->symbols[i].duration1;
+    }
+    int64_t duration_us = (int64_t)(ticks * 1000000 / channel->resolution_hz);
+
+    if (channel->queue_len == channel->queue_depth) {
+        host_timer_advance(channel->done_us[channel->queue_head] - esp_timer_get_time());
+    }
+    int64_t now = esp_timer_get_time();
+    int64_t start_us = channel->queue_len ? channel->busy_until_us : now;
+    channel->busy_until_us = start_us + duration_us;
+    channel->wire_us += duration_us;
+    size_t tail = (channel->queue_head + channel->queue_len) % channel->queue_depth;
+    channel->done_us[tail] = channel->busy_until_us;
+    channel->done_symbols[tail] = channel->num_symbols;
+    if (channel->queue_len++ == 0) {
+        return esp_timer_start_once(channel->done_timer, channel->busy_until_us - now);
+    }
+    return ESP_OK;
+}
+
+esp_err_t rmt_transmit(rmt_channel_handle_t tx_channel, rmt_encoder_handle_t encoder, const void *payload, size_t payload_bytes, const rmt_transmit_config_t *config)
+{
+    if (tx_channel == NULL || encoder == NULL || config == NULL || (payload == NULL && payload_bytes)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!tx_channel->enabled) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (tx_channel->capture || tx_channel->wire) {
+        esp_err_t ret = capture_frame(tx_channel, encoder, payload, payload_bytes);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+    if (tx_channel->wire) {
+        return wire_queue_frame(tx_channel);
+    }
+    tx_channel->frames++;
+    if (tx_channel->on_trans_done) {
+        rmt_tx_done_event_data_t edata = {
+            .num_symbols = tx_channel->num_symbols,
+        };
+        tx_channel->on_trans_done(tx_channel, &edata, tx_channel->user_ctx);
+    }
+    return ESP_OK;
+}
+
+esp_err_t rmt_tx_wait_all_done(rmt_channel_handle_t tx_channel, int timeout_ms)
+{
+    if (tx_channel == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!tx_channel->wire || tx_channel->queue_len == 0) {
+        return ESP_OK;
+    }
+    int64_t wait_us = tx_channel->busy_until_us - esp_timer_get_time();
+    if (timeout_ms >= 0 && wait_us > (int64_t)timeout_ms * 1000) {
+        host_timer_advance((int64_t)timeout_ms * 1000);
+        return ESP_ERR_TIMEOUT;
+    }
+    host_timer_advance(wait_us);
+    return ESP_OK;
+}
+
+void host_rmt_set_capture(bool enabled)
+{
+    s_capture = enabled;
+}
+
+void host_rmt_set_wire_time(bool enabled, uint32_t enable_us, uint32_t disable_us)
+{
+    s_wire = enabled;
+    s_enable_us = enable_us;
+    s_disable_us = disable_us;
+}
+
+uint64_t host_rmt_wire_us(rmt_channel_handle_t channel)
+{
+    return channel->wire_us;
+}
+
+rmt_channel_handle_t host_rmt_last_channel(void)
+{
+    return s_last_channel;
+}
+
+uint32_t host_rmt_frames(rmt_channel_handle_t channel)
+{
+    return channel->frames;
+}
+
+const uint8_t *host_rmt_last_payload(rmt_channel_handle_t channel, size_t *size)
+{
+    *size = channel->payload_size;
+    return channel->payload;
+}
+
+const rmt_symbol_word_t *host_rmt_last_symbols(rmt_channel_handle_t channel, size_t *num_symbols)
+{
+    *num_symbols = channel->num_symbols;
+    return channel->symbols;
+}
@@ -0,0 +1,259 @@
+// SPI主机替身: 排队的传输在驱动等待结果时按顺序完成，开启记录时保存MOSI上发出的字节
+// 字节在传输完成时才从发送缓冲区复制，驱动在完成前改写缓冲区会体现在记录的输出中
+// 可以注入欠载: 模拟任务被抢占太久，再次查询时排队的传输已全部发完，总线空闲
+#include <stdlib.h>
+#include <string.h>
+#include "driver/spi_master.h"
+#include "esp_rom_gpio.h"
+#include "soc/spi_periph.h"
+#include "host_idf.h"
+
+#define SPI_MAX_QUEUE_SIZE 16
+
+const spi_signal_conn_t spi_periph_signal[SPI_HOST_MAX] = {
+    {.spid_out = 1}, {.spid_out = 2}, {.spid_out = 3},
+};
+
+typedef struct {
+    bool initialized;
+    int max_transfer_sz;
+    spi_device_handle_t device;
+} spi_bus_t;
+
+struct spi_device_t {
+    spi_host_device_t host;
+    int clock_speed_hz;
+    int queue_size;
+    spi_transaction_t *pending[SPI_MAX_QUEUE_SIZE];   // 已排队、结果还未取走的传输，按排队顺序
+    int head;
+    int num_pending;
+    int num_done;               // pending中已经发完、结果还未取走的传输数 (从head开始)
+    uint32_t underrun_after;    // 注入欠载: 每排队这么多个传输触发一次，0表示不注入
+    uint32_t underrun_times;    // 还要触发的次数
+    uint32_t underrun_queued;   // 上次触发以来排队的传输数
+    bool capture;
+    uint32_t transactions;
+    uint8_t *output;
+    size_t output_size;
+    size_t output_cap;
+};
+
+static spi_bus_t s_buses[SPI_HOST_MAX];
+static bool s_capture = false;
+static spi_device_handle_t s_last_device = NULL;
+
+void esp_rom_gpio_connect_out_signal(uint32_t gpio_num, uint32_t signal_idx, bool out_inv, bool oen_inv)
+{
+    (void)gpio_num;
+    (void)signal_idx;
+    (void)out_inv;
+    (void)oen_inv;
+}
+
+void esp_rom_delay_us(uint32_t us)
+{
+    (void)us;
+}
+
+esp_err_t spi_bus_initialize(spi_host_device_t host_id, const spi_bus_config_t *bus_config, spi_dma_chan_t dma_chan)
+{
+    (void)dma_chan;
+    if (host_id <= SPI1_HOST || host_id >= SPI_HOST_MAX || bus_config == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_buses[host_id].initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    s_buses[host_id] = (spi_bus_t) {
+        .initialized = true,
+        .max_transfer_sz = bus_config->max_transfer_sz,
+    };
+    return ESP_OK;
+}
+
+esp_err_t spi_bus_free(spi_host_device_t host_id)
+{
+    if (host_id >= SPI_HOST_MAX || !s_buses[host_id].initialized || s_buses[host_id].device) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    s_buses[host_id].initialized = false;
+    return ESP_OK;
+}
+
+esp_err_t spi_bus_add_device(spi_host_device_t host_id, const spi_device_interface_config_t *dev_config, spi_device_handle_t *handle)
+{
+    if (host_id >= SPI_HOST_MAX || dev_config == NULL || handle == NULL ||
+            dev_config->queue_size <= 0 || dev_config->queue_size > SPI_MAX_QUEUE_SIZE) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    spi_bus_t *bus = &s_buses[host_id];
+    // 替身每条总线只支持一个设备
+    if (!bus->initialized || bus->device) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    spi_device_handle_t dev = calloc(1, sizeof(struct spi_device_t));
+    if (dev == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    dev->host = host_id;
+    dev->clock_speed_hz = dev_config->clock_speed_hz;
+    dev->queue_size = dev_config->queue_size;
+    dev->capture = s_capture;
+    bus->device = dev;
+    s_last_device = dev;
+    *handle = dev;
+    return ESP_OK;
+}
+
+esp_err_t spi_bus_remove_device(spi_device_handle_t handle)
+{
+    if (handle == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    // IDF要求先取走所有传输的结果
+    if (handle->num_pending) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    s_buses[handle->host].device = NULL;
+    if (s_last_device == handle) {
+        s_last_device = NULL;
+    }
+    free(handle->output);
+    free(handle);
+    return ESP_OK;
+}
+
+esp_err_t spi_device_queue_trans(spi_device_handle_t handle, spi_transaction_t *trans_desc, TickType_t ticks_to_wait)
+{
+    (void)ticks_to_wait;
+    if (handle == NULL || trans_desc == NULL || (trans_desc->length + 7) / 8 > (size_t)s_buses[handle->host].max_transfer_sz) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    // 单线程中没有其他任务会取走结果，队列满时等待不会结束
+    if (handle->num_pending == handle->queue_size) {
+        return ESP_ERR_TIMEOUT;
+    }
+    handle->pending[(handle->head + handle->num_pending) % SPI_MAX_QUEUE_SIZE] = trans_desc;
+    handle->num_pending++;
+    if (handle->underrun_times) {
+        handle->underrun_queued++;
+    }
+    return ESP_OK;
+}
+
+static bool append_output(spi_device_handle_t dev, const uint8_t *data, size_t size)
+{
+    if (dev->output_size + size > dev->output_cap) {
+        size_t cap = dev->output_cap ? dev->output_cap : 4096;
+        while (cap < dev->output_size + size) {
+            cap *= 2;
+        }
+        uint8_t *output = realloc(dev->output, cap);
+        if (output == NULL) {
+            return false;
+        }
+        dev->output = output;
+        dev->output_cap = cap;
+    }
+    memcpy(dev->output + dev->output_size, data, size);
+    dev->output_size += size;
+    return true;
+}
+
+// 最早一个未发完的传输发完
+static esp_err_t complete_next(spi_device_handle_t dev)
+{
+    spi_transaction_t *trans = dev->pending[(dev->head + dev->num_done) % SPI_MAX_QUEUE_SIZE];
+    dev->num_done++;
+    dev->transactions++;
+    if (dev->capture && !append_output(dev, trans->tx_buffer, trans->length / 8)) {
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+esp_err_t spi_device_get_trans_result(spi_device_handle_t handle, spi_transaction_t **trans_desc, TickType_t ticks_to_wait)
+{
+    if (handle == NULL || trans_desc == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (handle->num_pending == 0) {
+        return ESP_ERR_TIMEOUT;
+    }
+    if (ticks_to_wait == 0 && handle->underrun_times && handle->underrun_queued >= handle->underrun_after) {
+        // 任务回来时总线已经发完所有排队的传输
+        handle->underrun_times--;
+        handle->underrun_queued = 0;
+        while (handle->num_done < handle->num_pending) {
+            if (complete_next(handle) != ESP_OK) {
+                return ESP_ERR_NO_MEM;
+            }
+        }
+    }
+    if (handle->num_done == 0) {
+        // 总线比CPU慢: 不等待时传输总是还没完成
+        if (ticks_to_wait == 0) {
+            return ESP_ERR_TIMEOUT;
+        }
+        if (complete_next(handle) != ESP_OK) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    *trans_desc = handle->pending[handle->head];
+    handle->head = (handle->head + 1) % SPI_MAX_QUEUE_SIZE;
+    handle->num_pending--;
+    handle->num_done--;
+    return ESP_OK;
+}
+
+esp_err_t spi_device_transmit(spi_device_handle_t handle, spi_transaction_t *trans_desc)
+{
+    spi_transaction_t *done = NULL;
+    esp_err_t ret = spi_device_queue_trans(handle, trans_desc, portMAX_DELAY);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    return spi_device_get_trans_result(handle, &done, portMAX_DELAY);
+}
+
+esp_err_t spi_device_get_actual_freq(spi_device_handle_t handle, int *freq_khz)
+{
+    if (handle == NULL || freq_khz == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *freq_khz = handle->clock_speed_hz / 1000;
+    return ESP_OK;
+}
+
+void host_spi_set_capture(bool enabled)
+{
+    s_capture = enabled;
+}
+
+spi_device_handle_t host_spi_last_device(void)
+{
+    return s_last_device;
+}
+
+uint32_t host_spi_transactions(spi_device_handle_t device)
+{
+    return device->transactions;
+}
+
+const uint8_t *host_spi_output(spi_device_handle_t device, size_t *size)
+{
+    *size = device->output_size;
+    return device->output;
+}
+
+void host_spi_clear_output(spi_device_handle_t device)
+{
+    device->output_size = 0;
+}
+
+void host_spi_inject_underrun(spi_device_handle_t device, uint32_t after_transactions, uint32_t times)
+{
+    device->underrun_after = after_transactions;
+    device->underrun_times = times;
+    device->underrun_queued = 0;
+}
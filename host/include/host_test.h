@@ -0,0 +1,68 @@
+// 主机测试和基准测试的公共工具: 断言、计时、内存分配计数
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern int host_test_failures;
+
+// 检查失败时输出位置并记录，测试继续运行，最后由host_test_finish返回失败
+#define HOST_CHECK(cond) do {                                                           \
+        if (!(cond)) {                                                                  \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);   \
+            host_test_failures++;                                                       \
+        }                                                                               \
+    } while (0)
+
+#define HOST_CHECK_EQ(actual, expected) do {                                            \
+        long long actual_ = (long long)(actual);                                        \
+        long long expected_ = (long long)(expected);                                    \
+        if (actual_ != expected_) {                                                     \
+            fprintf(stderr, "%s:%d: check failed: %s == %s (%lld != %lld)\n",           \
+                    __FILE__, __LINE__, #actual, #expected, actual_, expected_);        \
+            host_test_failures++;                                                       \
+        }                                                                               \
+    } while (0)
+
+/**
+ * @brief 输出检查结果，返回进程退出码 (0为全部通过)
+ */
+int host_test_finish(const char *name);
+
+/**
+ * @brief 单调时钟，纳秒
+ */
+uint64_t host_now_ns(void);
+
+/**
+ * @brief 启动以来malloc/calloc/realloc的调用次数
+ */
+uint64_t host_alloc_count(void);
+
+/**
+ * @brief 运行rounds轮，每轮调用fn共iterations次，返回最快一轮中每次调用的平均耗时 (纳秒)
+ *
+ * 取最快一轮以排除调度和其他进程的干扰
+ */
+double host_bench_run(void (*fn)(void *arg), void *arg, uint32_t iterations, int rounds);
+
+/**
+ * @brief 基准测试是否以快速模式运行 (命令行带--quick，ctest使用)，快速模式只跑很少的迭代
+ */
+bool host_bench_quick(int argc, char **argv);
+
+// 阻止编译器优化掉基准测试中只写不读的结果
+static inline void host_clobber(const void *p)
+{
+    __asm__ volatile("" : : "g"(p) : "memory");
+}
+
+#ifdef __cplusplus
+}
+#endif
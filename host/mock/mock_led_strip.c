@@ -0,0 +1,215 @@
+#include <stdlib.h>
+#include <string.h>
+#include <sys/cdefs.h>
+#include "esp_check.h"
+#include "led_strip_interface.h"
+#include "led_strip_color_lut.h"
+#include "mock_led_strip.h"
+
+static const char *TAG = "mock_led_strip";
+
+typedef struct {
+    led_strip_t base;
+    uint32_t leds;
+    uint8_t bytes_per_pixel;
+    uint32_t refreshes;
+    led_strip_color_lut_t color_lut;
+    uint16_t *pixels16;     // 高深度模式下的16位颜色
+    uint8_t pixels[];
+} mock_strip_t;
+
+static bool range_valid(const mock_strip_t *mock, uint32_t start, uint32_t count)
+{
+    return start <= mock->leds && count <= mock->leds - start;
+}
+
+static void store(mock_strip_t *mock, uint32_t byte_index, uint8_t value)
+{
+    mock->pixels[byte_index] = value;
+    if (mock->pixels16) {
+        mock->pixels16[byte_index] = value * 257;
+    }
+}
+
+static esp_err_t mock_set_pixel(led_strip_t *strip, uint32_t index, uint32_t red, uint32_t green, uint32_t blue)
+{
+    mock_strip_t *mock = __containerof(strip, mock_strip_t, base);
+    ESP_RETURN_ON_FALSE(index < mock->leds, ESP_ERR_INVALID_ARG, TAG, "index out of maximum number of LEDs");
+    uint32_t start = index * mock->bytes_per_pixel;
+    store(mock, start, red);
+    store(mock, start + 1, green);
+    store(mock, start + 2, blue);
+    if (mock->bytes_per_pixel > 3) {
+        store(mock, start + 3, 0);
+    }
+    return ESP_OK;
+}
+
+static esp_err_t mock_set_pixel_rgbw(led_strip_t *strip, uint32_t index, uint32_t red, uint32_t green, uint32_t blue, uint32_t white)
+{
+    mock_strip_t *mock = __containerof(strip, mock_strip_t, base);
+    ESP_RETURN_ON_FALSE(index < mock->leds, ESP_ERR_INVALID_ARG, TAG, "index out of maximum number of LEDs");
+    ESP_RETURN_ON_FALSE(mock->bytes_per_pixel == 4, ESP_ERR_INVALID_ARG, TAG, "led doesn't have 4 components");
+    uint32_t start = index * mock->bytes_per_pixel;
+    store(mock, start, red);
+    store(mock, start + 1, green);
+    store(mock, start + 2, blue);
+    store(mock, start + 3, white);
+    return ESP_OK;
+}
+
+static esp_err_t mock_set_pixels(led_strip_t *strip, uint32_t start, uint32_t count, const uint8_t *colors)
+{
+    mock_strip_t *mock = __containerof(strip, mock_strip_t, base);
+    ESP_RETURN_ON_FALSE(range_valid(mock, start, count), ESP_ERR_INVALID_ARG, TAG, "pixel range out of maximum number of LEDs");
+    size_t offset = start * mock->bytes_per_pixel;
+    size_t len = count * mock->bytes_per_pixel;
+    memcpy(mock->pixels + offset, colors, len);
+    if (mock->pixels16) {
+        for (size_t i = 0; i < len; i++) {
+            mock->pixels16[offset + i] = colors[i] * 257;
+        }
+    }
+    return ESP_OK;
+}
+
+static esp_err_t mock_fill(led_strip_t *strip, uint32_t start, uint32_t count, uint32_t red, uint32_t green, uint32_t blue)
+{
+    mock_strip_t *mock = __containerof(strip, mock_strip_t, base);
+    ESP_RETURN_ON_FALSE(range_valid(mock, start, count), ESP_ERR_INVALID_ARG, TAG, "pixel range out of maximum number of LEDs");
+    for (uint32_t i = start; i < start + count; i++) {
+        mock_set_pixel(strip, i, red, green, blue);
+    }
+    return ESP_OK;
+}
+
+static esp_err_t mock_mirror(led_strip_t *strip, const led_strip_t *src)
+{
+    mock_strip_t *mock = __containerof(strip, mock_strip_t, base);
+    const mock_strip_t *src_mock = __containerof(src, mock_strip_t, base);
+    ESP_RETURN_ON_FALSE(mock->leds == src_mock->leds && mock->bytes_per_pixel == src_mock->bytes_per_pixel &&
+                        !mock->pixels16 == !src_mock->pixels16,
+                        ESP_ERR_INVALID_ARG, TAG, "strips have different length, color format or depth");
+    size_t len = mock->leds * mock->bytes_per_pixel;
+    memcpy(mock->pixels, src_mock->pixels, len);
+    if (mock->pixels16) {
+        memcpy(mock->pixels16, src_mock->pixels16, len * sizeof(uint16_t));
+    }
+    return ESP_OK;
+}
+
+static esp_err_t mock_set_pixels16(led_strip_t *strip, uint32_t start, uint32_t count, const uint16_t *colors)
+{
+    mock_strip_t *mock = __containerof(strip, mock_strip_t, base);
+    ESP_RETURN_ON_FALSE(range_valid(mock, start, count), ESP_ERR_INVALID_ARG, TAG, "pixel range out of maximum number of LEDs");
+    size_t offset = start * mock->bytes_per_pixel;
+    size_t len = count * mock->bytes_per_pixel;
+    memcpy(mock->pixels16 + offset, colors, len * sizeof(uint16_t));
+    for (size_t i = 0; i < len; i++) {
+        mock->pixels[offset + i] = colors[i] >> 8;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t mock_fill16(led_strip_t *strip, uint32_t start, uint32_t count, uint16_t red, uint16_t green, uint16_t blue)
+{
+    mock_strip_t *mock = __containerof(strip, mock_strip_t, base);
+    ESP_RETURN_ON_FALSE(range_valid(mock, start, count), ESP_ERR_INVALID_ARG, TAG, "pixel range out of maximum number of LEDs");
+    const uint16_t color[4] = {red, green, blue, 0};
+    for (uint32_t i = start; i < start + count; i++) {
+        for (uint8_t c = 0; c < mock->bytes_per_pixel; c++) {
+            mock->pixels16[i * mock->bytes_per_pixel + c] = color[c];
+            mock->pixels[i * mock->bytes_per_pixel + c] = color[c] >> 8;
+        }
+    }
+    return ESP_OK;
+}
+
+static esp_err_t mock_refresh(led_strip_t *strip)
+{
+    mock_strip_t *mock = __containerof(strip, mock_strip_t, base);
+    mock->refreshes++;
+    return ESP_OK;
+}
+
+static esp_err_t mock_wait_refresh_done(led_strip_t *strip, int32_t timeout_ms)
+{
+    (void)strip;
+    (void)timeout_ms;
+    return ESP_OK;
+}
+
+static esp_err_t mock_clear(led_strip_t *strip)
+{
+    mock_strip_t *mock = __containerof(strip, mock_strip_t, base);
+    size_t len = mock->leds * mock->bytes_per_pixel;
+    memset(mock->pixels, 0, len);
+    if (mock->pixels16) {
+        memset(mock->pixels16, 0, len * sizeof(uint16_t));
+    }
+    return mock_refresh(strip);
+}
+
+static esp_err_t mock_del(led_strip_t *strip)
+{
+    mock_strip_t *mock = __containerof(strip, mock_strip_t, base);
+    free(mock->pixels16);
+    free(mock);
+    return ESP_OK;
+}
+
+static led_strip_color_lut_t *mock_get_color_lut(led_strip_t *strip)
+{
+    mock_strip_t *mock = __containerof(strip, mock_strip_t, base);
+    return &mock->color_lut;
+}
+
+esp_err_t mock_led_strip_new(uint32_t leds, uint8_t bytes_per_pixel, bool high_depth, led_strip_handle_t *ret_strip)
+{
+    ESP_RETURN_ON_FALSE(leds && (bytes_per_pixel == 3 || bytes_per_pixel == 4) && ret_strip, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    mock_strip_t *mock = calloc(1, sizeof(mock_strip_t) + leds * bytes_per_pixel);
+    ESP_RETURN_ON_FALSE(mock, ESP_ERR_NO_MEM, TAG, "no mem for mock strip");
+    if (high_depth) {
+        mock->pixels16 = calloc(leds * bytes_per_pixel, sizeof(uint16_t));
+        if (mock->pixels16 == NULL) {
+            free(mock);
+            return ESP_ERR_NO_MEM;
+        }
+        mock->base.set_pixels16 = mock_set_pixels16;
+        mock->base.fill16 = mock_fill16;
+    }
+    mock->leds = leds;
+    mock->bytes_per_pixel = bytes_per_pixel;
+    led_strip_color_lut_init(&mock->color_lut);
+    mock->base.set_pixel = mock_set_pixel;
+    mock->base.set_pixel_rgbw = mock_set_pixel_rgbw;
+    mock->base.set_pixels = mock_set_pixels;
+    mock->base.fill = mock_fill;
+    mock->base.mirror = mock_mirror;
+    mock->base.refresh = mock_refresh;
+    mock->base.refresh_async = mock_refresh;
+    mock->base.wait_refresh_done = mock_wait_refresh_done;
+    mock->base.clear = mock_clear;
+    mock->base.del = mock_del;
+    mock->base.get_color_lut = mock_get_color_lut;
+    *ret_strip = &mock->base;
+    return ESP_OK;
+}
+
+const uint8_t *mock_led_strip_pixels(led_strip_handle_t strip)
+{
+    mock_strip_t *mock = __containerof(strip, mock_strip_t, base);
+    return mock->pixels;
+}
+
+const uint16_t *mock_led_strip_pixels16(led_strip_handle_t strip)
+{
+    mock_strip_t *mock = __containerof(strip, mock_strip_t, base);
+    return mock->pixels16;
+}
+
+uint32_t mock_led_strip_refreshes(led_strip_handle_t strip)
+{
+    mock_strip_t *mock = __containerof(strip, mock_strip_t, base);
+    return mock->refreshes;
+}
@@ -0,0 +1,40 @@
+// 内存中的led_strip_t实现: 只保存像素，不编码也不发送，用于单独测量效果和合成器的开销
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "led_strip.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 创建内存灯带
+ *
+ * @param leds LED数量
+ * @param bytes_per_pixel 3 (RGB) 或4 (RGBW)，像素按R,G,B(,W)顺序保存
+ * @param high_depth 是否支持16位颜色 (set_pixels16/fill16)
+ * @param ret_strip 返回的灯带句柄，用led_strip_del释放
+ */
+esp_err_t mock_led_strip_new(uint32_t leds, uint8_t bytes_per_pixel, bool high_depth, led_strip_handle_t *ret_strip);
+
+/**
+ * @brief 当前的8位像素 (高深度模式下为16位颜色的高8位)
+ */
+const uint8_t *mock_led_strip_pixels(led_strip_handle_t strip);
+
+/**
+ * @brief 当前的16位颜色 (只有高深度模式，否则为NULL)
+ */
+const uint16_t *mock_led_strip_pixels16(led_strip_handle_t strip);
+
+/**
+ * @brief 刷新次数 (refresh和refresh_async各算一次)
+ */
+uint32_t mock_led_strip_refreshes(led_strip_handle_t strip);
+
+#ifdef __cplusplus
+}
+#endif